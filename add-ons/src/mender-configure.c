@@ -33,6 +33,13 @@
 #define CONFIG_MENDER_CLIENT_CONFIGURE_REFRESH_INTERVAL (28800)
 #endif /* CONFIG_MENDER_CLIENT_CONFIGURE_REFRESH_INTERVAL */
 
+/**
+ * @brief Default wake-up slack (percentage of the period)
+ */
+#ifndef CONFIG_MENDER_CLIENT_WAKE_UP_SLACK
+#define CONFIG_MENDER_CLIENT_WAKE_UP_SLACK (10)
+#endif /* CONFIG_MENDER_CLIENT_WAKE_UP_SLACK */
+
 /**
  * @brief Mender configure instance
  */
@@ -164,6 +171,9 @@ mender_configure_init(void *config, void *callbacks) {
     mender_scheduler_work_params_t configure_work_params;
     configure_work_params.function = mender_configure_work_function;
     configure_work_params.period   = mender_configure_config.refresh_interval;
+    configure_work_params.slack    = CONFIG_MENDER_CLIENT_WAKE_UP_SLACK;
+    configure_work_params.priority = MENDER_SCHEDULER_WORK_PRIORITY_LOW;
+    configure_work_params.nestable = false;
     configure_work_params.name     = "mender_configure";
     if (MENDER_OK != (ret = mender_scheduler_work_create(&configure_work_params, &mender_configure_work_handle))) {
         mender_log_error("Unable to create configure work");
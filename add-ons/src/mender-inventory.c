@@ -32,6 +32,13 @@
 #define CONFIG_MENDER_CLIENT_INVENTORY_REFRESH_INTERVAL (28800)
 #endif /* CONFIG_MENDER_CLIENT_INVENTORY_REFRESH_INTERVAL */
 
+/**
+ * @brief Default wake-up slack (percentage of the period)
+ */
+#ifndef CONFIG_MENDER_CLIENT_WAKE_UP_SLACK
+#define CONFIG_MENDER_CLIENT_WAKE_UP_SLACK (10)
+#endif /* CONFIG_MENDER_CLIENT_WAKE_UP_SLACK */
+
 /**
  * @brief Mender inventory instance
  */
@@ -84,6 +91,9 @@ mender_inventory_init(void *config, void *callbacks) {
     mender_scheduler_work_params_t inventory_work_params;
     inventory_work_params.function = mender_inventory_work_function;
     inventory_work_params.period   = mender_inventory_config.refresh_interval;
+    inventory_work_params.slack    = CONFIG_MENDER_CLIENT_WAKE_UP_SLACK;
+    inventory_work_params.priority = MENDER_SCHEDULER_WORK_PRIORITY_LOW;
+    inventory_work_params.nestable = false;
     inventory_work_params.name     = "mender_inventory";
     if (MENDER_OK != (ret = mender_scheduler_work_create(&inventory_work_params, &mender_inventory_work_handle))) {
         mender_log_error("Unable to create inventory work");
@@ -46,10 +46,16 @@
 #define MENDER_TROUBLESHOOT_SBUFFER_INIT_SIZE (256)
 
 /**
- * @brief Mender troubleshoot instance
+ * @brief Mender troubleshoot instance, the control channel is activated with the client while the remote terminal is activated by the application
  */
+#ifdef CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL
+const mender_addon_instance_t mender_troubleshoot_addon_instance = {
+    .init = mender_troubleshoot_init, .activate = mender_troubleshoot_activate, .deactivate = mender_troubleshoot_deactivate, .exit = mender_troubleshoot_exit
+};
+#else
 const mender_addon_instance_t mender_troubleshoot_addon_instance
     = { .init = mender_troubleshoot_init, .activate = NULL, .deactivate = mender_troubleshoot_deactivate, .exit = mender_troubleshoot_exit };
+#endif /* CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL */
 
 /**
  * Proto type
@@ -74,6 +80,8 @@ typedef enum {
 #define MENDER_TROUBLESHOOT_MESSAGE_TYPE_SHELL_STOP                   "stop"
 #define MENDER_TROUBLESHOOT_MESSAGE_TYPE_MENDER_CLIENT_CHECK_UPDATE   "check-update"
 #define MENDER_TROUBLESHOOT_MESSAGE_TYPE_MENDER_CLIENT_SEND_INVENTORY "send-inventory"
+#define MENDER_TROUBLESHOOT_MESSAGE_TYPE_CONTROL_PING                 "ping"
+#define MENDER_TROUBLESHOOT_MESSAGE_TYPE_CONTROL_PONG                 "pong"
 
 /**
  * Status type
@@ -118,11 +126,15 @@ typedef struct {
  */
 static mender_troubleshoot_config_t mender_troubleshoot_config;
 
+#ifndef CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL
+
 /**
  * @brief Mender troubleshoot callbacks
  */
 static mender_troubleshoot_callbacks_t mender_troubleshoot_callbacks;
 
+#endif /* CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL */
+
 /**
  * @brief Mender troubleshoot work handle
  */
@@ -133,11 +145,22 @@ static void *mender_troubleshoot_healthcheck_work_handle = NULL;
  */
 static void *mender_troubleshoot_handle = NULL;
 
+/**
+ * @brief Flag set when the connection has been closed, the healthcheck work connects the device again
+ * @note The flag is set from the thread receiving the data of the connection, it is protected by the troubleshoot mutex
+ */
+static bool  mender_troubleshoot_disconnected = false;
+static void *mender_troubleshoot_mutex        = NULL;
+
+#ifndef CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL
+
 /**
  * @brief Mender troubleshoot shell session ID
  */
 static char *mender_troubleshoot_shell_sid = NULL;
 
+#endif /* CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL */
+
 /**
  * @brief Mender troubleshoot healthcheck work function
  * @return MENDER_OK if the function succeeds, error code otherwise
@@ -152,6 +175,8 @@ static mender_err_t mender_troubleshoot_healthcheck_work_function(void);
  */
 static mender_err_t mender_troubleshoot_data_received_callback(void *data, size_t length);
 
+#ifndef CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL
+
 /**
  * @brief Function called to perform the treatment of the shell messages
  * @param protomsg Received proto message
@@ -160,6 +185,8 @@ static mender_err_t mender_troubleshoot_data_received_callback(void *data, size_
  */
 static mender_err_t mender_troubleshoot_shell_message_handler(mender_troubleshoot_protomsg_t *protomsg, mender_troubleshoot_protomsg_t **response);
 
+#endif /* CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL */
+
 /**
  * @brief Function called to perform the treatment of the mender-client messages
  * @param protomsg Received proto message
@@ -168,6 +195,14 @@ static mender_err_t mender_troubleshoot_shell_message_handler(mender_troubleshoo
  */
 static mender_err_t mender_troubleshoot_mender_client_message_handler(mender_troubleshoot_protomsg_t *protomsg, mender_troubleshoot_protomsg_t **response);
 
+/**
+ * @brief Function called to perform the treatment of the control messages
+ * @param protomsg Received proto message
+ * @param response Response to be sent back to the server, NULL if no response to send
+ * @return MENDER_OK if the function succeeds, error code if an error occured
+ */
+static mender_err_t mender_troubleshoot_control_message_handler(mender_troubleshoot_protomsg_t *protomsg, mender_troubleshoot_protomsg_t **response);
+
 /**
  * @brief Function used to format acknowledgment messages
  * @param protomsg Received proto message
@@ -181,6 +216,16 @@ static mender_err_t mender_troubleshoot_format_acknowledgment(mender_troubleshoo
                                                               mender_troubleshoot_properties_status_t status,
                                                               mender_troubleshoot_protomsg_t        **response);
 
+#ifdef CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL
+
+/**
+ * @brief Function called to send control ping protomsg
+ * @return MENDER_OK if the function succeeds, error code if an error occured
+ */
+static mender_err_t mender_troubleshoot_send_control_ping_protomsg(void);
+
+#else
+
 /**
  * @brief Function called to send shell ping protomsg
  * @return MENDER_OK if the function succeeds, error code if an error occured
@@ -193,6 +238,8 @@ static mender_err_t mender_troubleshoot_send_shell_ping_protomsg(void);
  */
 static mender_err_t mender_troubleshoot_send_shell_stop_protomsg(void);
 
+#endif /* CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL */
+
 /**
  * @brief Unpack and decode Proto message
  * @param data Packed data to be decoded
@@ -307,15 +354,28 @@ mender_troubleshoot_init(void *config, void *callbacks) {
         mender_troubleshoot_config.healthcheck_interval = CONFIG_MENDER_CLIENT_TROUBLESHOOT_HEALTHCHECK_INTERVAL;
     }
 
-    /* Save callbacks */
+    /* Save callbacks, the shell is not available with the control channel only */
+#ifdef CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL
+    (void)callbacks;
+#else
     if (NULL != callbacks) {
         memcpy(&mender_troubleshoot_callbacks, callbacks, sizeof(mender_troubleshoot_callbacks_t));
     }
+#endif /* CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL */
+
+    /* Create troubleshoot mutex */
+    if (MENDER_OK != (ret = mender_scheduler_mutex_create(&mender_troubleshoot_mutex))) {
+        mender_log_error("Unable to create troubleshoot mutex");
+        return ret;
+    }
 
-    /* Create troubleshoot healthcheck work */
+    /* Create troubleshoot healthcheck work, it is not nestable because it uses the network and the troubleshoot mutex */
     mender_scheduler_work_params_t healthcheck_work_params;
     healthcheck_work_params.function = mender_troubleshoot_healthcheck_work_function;
     healthcheck_work_params.period   = mender_troubleshoot_config.healthcheck_interval;
+    healthcheck_work_params.slack    = 0;
+    healthcheck_work_params.priority = MENDER_SCHEDULER_WORK_PRIORITY_HIGH;
+    healthcheck_work_params.nestable = false;
     healthcheck_work_params.name     = "mender_troubleshoot_healthcheck";
     if (MENDER_OK != (ret = mender_scheduler_work_create(&healthcheck_work_params, &mender_troubleshoot_healthcheck_work_handle))) {
         mender_log_error("Unable to create healthcheck work");
@@ -347,6 +407,8 @@ mender_troubleshoot_deactivate(void) {
     /* Deactivate troubleshoot healthcheck work */
     mender_scheduler_work_deactivate(mender_troubleshoot_healthcheck_work_handle);
 
+#ifndef CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL
+
     /* Check if a session is already opened */
     if (NULL != mender_troubleshoot_shell_sid) {
 
@@ -358,9 +420,13 @@ mender_troubleshoot_deactivate(void) {
         }
     }
 
+#endif /* CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL */
+
     /* Check if connection is established */
     if (NULL != mender_troubleshoot_handle) {
 
+#ifndef CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL
+
         /* Check if a session is already opened */
         if (NULL != mender_troubleshoot_shell_sid) {
 
@@ -370,6 +436,8 @@ mender_troubleshoot_deactivate(void) {
             }
         }
 
+#endif /* CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL */
+
         /* Disconnect the device of the server */
         if (MENDER_OK != (ret = mender_api_troubleshoot_disconnect(mender_troubleshoot_handle))) {
             mender_log_error("Unable to disconnect the device of the server");
@@ -380,12 +448,16 @@ mender_troubleshoot_deactivate(void) {
         mender_client_network_release();
     }
 
+#ifndef CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL
+
     /* Release session ID */
     if (NULL != mender_troubleshoot_shell_sid) {
         free(mender_troubleshoot_shell_sid);
         mender_troubleshoot_shell_sid = NULL;
     }
 
+#endif /* CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL */
+
     return ret;
 }
 
@@ -393,6 +465,18 @@ mender_err_t
 mender_troubleshoot_shell_print(uint8_t *data, size_t length) {
 
     assert(NULL != data);
+
+#ifdef CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL
+
+    (void)length;
+
+    /* The shell is not available with the control channel only */
+    mender_log_error("Shell is not available with the troubleshoot control channel only");
+
+    return MENDER_NOT_IMPLEMENTED;
+
+#else
+
     mender_troubleshoot_protomsg_t *protomsg = NULL;
     mender_err_t                    ret      = MENDER_OK;
     void                           *payload  = NULL;
@@ -467,6 +551,8 @@ FAIL:
     }
 
     return ret;
+
+#endif /* CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL */
 }
 
 mender_err_t
@@ -476,12 +562,19 @@ mender_troubleshoot_exit(void) {
     mender_scheduler_work_delete(mender_troubleshoot_healthcheck_work_handle);
     mender_troubleshoot_healthcheck_work_handle = NULL;
 
+    /* Delete troubleshoot mutex */
+    mender_scheduler_mutex_delete(mender_troubleshoot_mutex);
+    mender_troubleshoot_mutex = NULL;
+
     /* Release memory */
+#ifndef CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL
     if (NULL != mender_troubleshoot_shell_sid) {
         free(mender_troubleshoot_shell_sid);
         mender_troubleshoot_shell_sid = NULL;
     }
+#endif /* CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL */
     mender_troubleshoot_config.healthcheck_interval = 0;
+    mender_troubleshoot_disconnected                = false;
 
     return MENDER_OK;
 }
@@ -490,10 +583,31 @@ static mender_err_t
 mender_troubleshoot_healthcheck_work_function(void) {
 
     mender_err_t ret = MENDER_OK;
+    bool         disconnected;
 
     /* Check if connection is established */
     if (NULL != mender_troubleshoot_handle) {
 
+        /* Check if the connection has been closed */
+        mender_scheduler_mutex_take(mender_troubleshoot_mutex, -1);
+        disconnected = mender_troubleshoot_disconnected;
+        mender_scheduler_mutex_give(mender_troubleshoot_mutex);
+        if (true == disconnected) {
+            mender_log_warning("Connection with the server has been closed");
+            ret = MENDER_FAIL;
+            goto FAIL;
+        }
+
+#ifdef CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL
+
+        /* Send healthcheck ping message over websocket connection, this permits to detect the connection is lost while it is idle */
+        if (MENDER_OK != (ret = mender_troubleshoot_send_control_ping_protomsg())) {
+            mender_log_error("Unable to send healthcheck message to the server");
+            goto FAIL;
+        }
+
+#else
+
         /* Check if a session is already opened */
         if (NULL != mender_troubleshoot_shell_sid) {
 
@@ -504,6 +618,8 @@ mender_troubleshoot_healthcheck_work_function(void) {
             }
         }
 
+#endif /* CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL */
+
     } else {
 
         /* Request access to the network */
@@ -513,6 +629,9 @@ mender_troubleshoot_healthcheck_work_function(void) {
         }
 
         /* Connect the device to the server */
+        mender_scheduler_mutex_take(mender_troubleshoot_mutex, -1);
+        mender_troubleshoot_disconnected = false;
+        mender_scheduler_mutex_give(mender_troubleshoot_mutex);
         if (MENDER_OK != (ret = mender_api_troubleshoot_connect(&mender_troubleshoot_data_received_callback, &mender_troubleshoot_handle))) {
             mender_log_error("Unable to connect the device to the server");
             goto END;
@@ -523,6 +642,8 @@ mender_troubleshoot_healthcheck_work_function(void) {
 
 FAIL:
 
+#ifndef CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL
+
     /* Check if a session is already opened */
     if (NULL != mender_troubleshoot_shell_sid) {
 
@@ -534,6 +655,8 @@ FAIL:
         }
     }
 
+#endif /* CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL */
+
     /* Check if connection is established */
     if (NULL != mender_troubleshoot_handle) {
 
@@ -547,12 +670,16 @@ FAIL:
         mender_client_network_release();
     }
 
+#ifndef CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL
+
     /* Release session ID */
     if (NULL != mender_troubleshoot_shell_sid) {
         free(mender_troubleshoot_shell_sid);
         mender_troubleshoot_shell_sid = NULL;
     }
 
+#endif /* CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL */
+
 END:
 
     return ret;
@@ -561,12 +688,19 @@ END:
 static mender_err_t
 mender_troubleshoot_data_received_callback(void *data, size_t length) {
 
-    assert(NULL != data);
     mender_err_t                    ret = MENDER_OK;
     mender_troubleshoot_protomsg_t *protomsg;
     mender_troubleshoot_protomsg_t *response = NULL;
     void                           *payload  = NULL;
 
+    /* Check if the connection has been closed, the device is connected again by the healthcheck work */
+    if (NULL == data) {
+        mender_scheduler_mutex_take(mender_troubleshoot_mutex, -1);
+        mender_troubleshoot_disconnected = true;
+        mender_scheduler_mutex_give(mender_troubleshoot_mutex);
+        return MENDER_OK;
+    }
+
     /* Unpack and decode message */
     if (NULL == (protomsg = mender_troubleshoot_unpack_protomsg(data, length))) {
         mender_log_error("Unable to decode message");
@@ -587,15 +721,19 @@ mender_troubleshoot_data_received_callback(void *data, size_t length) {
             mender_log_error("Invalid message received");
             ret = MENDER_FAIL;
             break;
+#ifndef CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL
         case MENDER_TROUBLESHOOT_PROTO_TYPE_SHELL:
             ret = mender_troubleshoot_shell_message_handler(protomsg, &response);
             break;
+#endif /* CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL */
         case MENDER_TROUBLESHOOT_PROTO_TYPE_MENDER_CLIENT:
             ret = mender_troubleshoot_mender_client_message_handler(protomsg, &response);
             break;
+        case MENDER_TROUBLESHOOT_PROTO_TYPE_CONTROL:
+            ret = mender_troubleshoot_control_message_handler(protomsg, &response);
+            break;
         case MENDER_TROUBLESHOOT_PROTO_TYPE_FILE_TRANSFER:
         case MENDER_TROUBLESHOOT_PROTO_TYPE_PORT_FORWARD:
-        case MENDER_TROUBLESHOOT_PROTO_TYPE_CONTROL:
         default:
             mender_log_error("Unsupported message received with proto type 0x%04x", protomsg->protohdr->proto);
             ret = MENDER_FAIL;
@@ -630,6 +768,8 @@ END:
     return ret;
 }
 
+#ifndef CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL
+
 static mender_err_t
 mender_troubleshoot_shell_message_handler(mender_troubleshoot_protomsg_t *protomsg, mender_troubleshoot_protomsg_t **response) {
 
@@ -784,6 +924,8 @@ FAIL:
     return ret;
 }
 
+#endif /* CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL */
+
 static mender_err_t
 mender_troubleshoot_mender_client_message_handler(mender_troubleshoot_protomsg_t *protomsg, mender_troubleshoot_protomsg_t **response) {
 
@@ -845,6 +987,42 @@ FAIL:
     return ret;
 }
 
+static mender_err_t
+mender_troubleshoot_control_message_handler(mender_troubleshoot_protomsg_t *protomsg, mender_troubleshoot_protomsg_t **response) {
+
+    assert(NULL != protomsg);
+    assert(NULL != protomsg->protohdr);
+    (void)response;
+    mender_err_t ret = MENDER_OK;
+
+    /* Verify integrity of the message */
+    if (NULL == protomsg->protohdr->typ) {
+        mender_log_error("Invalid message received");
+        ret = MENDER_FAIL;
+        goto END;
+    }
+
+    /* Treatment of the message depending of the message type */
+    if (!strcmp(protomsg->protohdr->typ, MENDER_TROUBLESHOOT_MESSAGE_TYPE_CONTROL_PING)) {
+
+        /* Nothing to do */
+
+    } else if (!strcmp(protomsg->protohdr->typ, MENDER_TROUBLESHOOT_MESSAGE_TYPE_CONTROL_PONG)) {
+
+        /* Nothing to do */
+
+    } else {
+
+        mender_log_error("Unsupported message received with message type '%s'", protomsg->protohdr->typ);
+        ret = MENDER_FAIL;
+        goto END;
+    }
+
+END:
+
+    return ret;
+}
+
 static mender_err_t
 mender_troubleshoot_format_acknowledgment(mender_troubleshoot_protomsg_t         *protomsg,
                                           char                                   *sid,
@@ -906,6 +1084,81 @@ FAIL:
     return ret;
 }
 
+#ifdef CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL
+
+static mender_err_t
+mender_troubleshoot_send_control_ping_protomsg(void) {
+
+    mender_troubleshoot_protomsg_t *protomsg = NULL;
+    mender_err_t                    ret      = MENDER_OK;
+    void                           *payload  = NULL;
+    size_t                          length   = 0;
+
+    /* Send control ping message */
+    if (NULL == (protomsg = (mender_troubleshoot_protomsg_t *)malloc(sizeof(mender_troubleshoot_protomsg_t)))) {
+        mender_log_error("Unable to allocate memory");
+        ret = MENDER_FAIL;
+        goto FAIL;
+    }
+    memset(protomsg, 0, sizeof(mender_troubleshoot_protomsg_t));
+    if (NULL == (protomsg->protohdr = (mender_troubleshoot_protohdr_t *)malloc(sizeof(mender_troubleshoot_protohdr_t)))) {
+        mender_log_error("Unable to allocate memory");
+        ret = MENDER_FAIL;
+        goto FAIL;
+    }
+    memset(protomsg->protohdr, 0, sizeof(mender_troubleshoot_protohdr_t));
+    protomsg->protohdr->proto = MENDER_TROUBLESHOOT_PROTO_TYPE_CONTROL;
+    if (NULL == (protomsg->protohdr->typ = strdup(MENDER_TROUBLESHOOT_MESSAGE_TYPE_CONTROL_PING))) {
+        mender_log_error("Unable to allocate memory");
+        ret = MENDER_FAIL;
+        goto FAIL;
+    }
+    if (NULL == (protomsg->protohdr->properties = (mender_troubleshoot_protohdr_properties_t *)malloc(sizeof(mender_troubleshoot_protohdr_properties_t)))) {
+        mender_log_error("Unable to allocate memory");
+        ret = MENDER_FAIL;
+        goto FAIL;
+    }
+    memset(protomsg->protohdr->properties, 0, sizeof(mender_troubleshoot_protohdr_properties_t));
+    if (NULL == (protomsg->protohdr->properties->timeout = (uint32_t *)malloc(sizeof(uint32_t)))) {
+        mender_log_error("Unable to allocate memory");
+        ret = MENDER_FAIL;
+        goto FAIL;
+    }
+    *protomsg->protohdr->properties->timeout = 2
+                                               * ((mender_troubleshoot_config.healthcheck_interval > 0) ? (uint32_t)mender_troubleshoot_config.healthcheck_interval
+                                                                                                        : CONFIG_MENDER_CLIENT_TROUBLESHOOT_HEALTHCHECK_INTERVAL);
+    if (NULL == (protomsg->protohdr->properties->status = (mender_troubleshoot_properties_status_t *)malloc(sizeof(mender_troubleshoot_properties_status_t)))) {
+        mender_log_error("Unable to allocate memory");
+        ret = MENDER_FAIL;
+        goto FAIL;
+    }
+    *protomsg->protohdr->properties->status = MENDER_TROUBLESHOOT_STATUS_TYPE_CONTROL;
+
+    /* Encode and pack the message */
+    if (MENDER_OK != (ret = mender_troubleshoot_pack_protomsg(protomsg, &payload, &length))) {
+        mender_log_error("Unable to encode message");
+        goto FAIL;
+    }
+
+    /* Send message */
+    if (MENDER_OK != (ret = mender_api_troubleshoot_send(mender_troubleshoot_handle, payload, length))) {
+        mender_log_error("Unable to send message");
+        goto FAIL;
+    }
+
+FAIL:
+
+    /* Release memory */
+    mender_troubleshoot_release_protomsg(protomsg);
+    if (NULL != payload) {
+        free(payload);
+    }
+
+    return ret;
+}
+
+#else
+
 static mender_err_t
 mender_troubleshoot_send_shell_ping_protomsg(void) {
 
@@ -949,7 +1202,9 @@ mender_troubleshoot_send_shell_ping_protomsg(void) {
         ret = MENDER_FAIL;
         goto FAIL;
     }
-    *protomsg->protohdr->properties->timeout = 2 * CONFIG_MENDER_CLIENT_TROUBLESHOOT_HEALTHCHECK_INTERVAL;
+    *protomsg->protohdr->properties->timeout = 2
+                                               * ((mender_troubleshoot_config.healthcheck_interval > 0) ? (uint32_t)mender_troubleshoot_config.healthcheck_interval
+                                                                                                        : CONFIG_MENDER_CLIENT_TROUBLESHOOT_HEALTHCHECK_INTERVAL);
     if (NULL == (protomsg->protohdr->properties->status = (mender_troubleshoot_properties_status_t *)malloc(sizeof(mender_troubleshoot_properties_status_t)))) {
         mender_log_error("Unable to allocate memory");
         ret = MENDER_FAIL;
@@ -1048,6 +1303,8 @@ FAIL:
     return ret;
 }
 
+#endif /* CONFIG_MENDER_CLIENT_TROUBLESHOOT_CONTROL_CHANNEL */
+
 static mender_troubleshoot_protomsg_t *
 mender_troubleshoot_unpack_protomsg(void *data, size_t length) {
 
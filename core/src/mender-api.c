@@ -18,10 +18,13 @@
  * limitations under the License.
  */
 
+#include <time.h>
 #include "mender-api.h"
 #include "mender-artifact.h"
 #include "mender-http.h"
 #include "mender-log.h"
+#include "mender-scheduler.h"
+#include "mender-storage.h"
 #include "mender-tls.h"
 #ifdef CONFIG_MENDER_CLIENT_ADD_ON_TROUBLESHOOT
 #include "mender-websocket.h"
@@ -39,15 +42,121 @@
 #define MENDER_API_PATH_GET_DEVICE_CONNECT           "/api/devices/v1/deviceconnect/connect"
 #define MENDER_API_PATH_PUT_DEVICE_ATTRIBUTES        "/api/devices/v1/inventory/device/attributes"
 
+/**
+ * @brief Maximum duration of the waits of the download rate limiter before checking the cancellation of the download (ms)
+ */
+#define MENDER_API_DOWNLOAD_THROTTLE_SLICE (100)
+
+/**
+ * @brief Percentage of the lifetime of the authentication token after which it is refreshed
+ */
+#define MENDER_API_JWT_REFRESH_RATIO (75)
+
 /**
  * @brief Mender API configuration
  */
 static mender_api_config_t mender_api_config;
 
 /**
- * @brief Authentication token
+ * @brief Authentication token and mutex
+ */
+static char *mender_api_jwt       = NULL;
+static void *mender_api_jwt_mutex = NULL;
+
+/**
+ * @brief Uptime after which the authentication token is refreshed (milliseconds)
+ */
+static int64_t mender_api_jwt_refresh_deadline = 0;
+
+/**
+ * @brief Flag to indicate the authentication token has been restored from the storage without time base, it is used once without being refreshed since its
+ *        age is unknown
+ */
+static bool mender_api_jwt_restored = false;
+
+/**
+ * @brief Callback used to get the identity of the device, it is saved to authenticate again when the token is rejected by the server
+ */
+static mender_err_t (*mender_api_get_identity)(mender_identity_t **identity) = NULL;
+
+/**
+ * @brief Authentication mutex, used to serialize the authentications performed by the works and to protect the authentication request cache
+ * @note It is always taken before the authentication token mutex
+ */
+static void *mender_api_authentication_mutex = NULL;
+
+/**
+ * @brief Authentication request cache, the payload and its signature are reused as long as the identity and the public key don't change
+ * @note The tenant token is part of the configuration of the API and can't change before the cache is released
+ */
+static char *mender_api_authentication_identity   = NULL;
+static char *mender_api_authentication_public_key = NULL;
+static char *mender_api_authentication_payload    = NULL;
+static char *mender_api_authentication_signature  = NULL;
+
+/**
+ * @brief Download rate limit (bytes per second) and burst size (bytes), 0 if not used
+ */
+static uint32_t mender_api_download_rate_limit = 0;
+static uint32_t mender_api_download_burst_size = 0;
+
+/**
+ * @brief Token bucket used to limit the download rate, tokens are expressed in thousandths of bytes to avoid rounding errors
+ */
+static int64_t mender_api_download_tokens    = 0;
+static int64_t mender_api_download_timestamp = 0;
+
+/**
+ * @brief Uptime until which the server requested to retry later (milliseconds), 0 if not requested
+ */
+static int64_t mender_api_retry_after_deadline = 0;
+
+/**
+ * @brief Perform authentication of the device with the identity callback saved previously, the token is stored to be reused after a restart
+ * @note The authentication mutex must be taken
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_api_authenticate(void);
+
+/**
+ * @brief Set the authentication token and compute the deadline to refresh it
+ * @param jwt Authentication token
+ * @param expiration Expiration of the authentication token (seconds since epoch), 0 if unknown
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_api_jwt_set(char *jwt, int64_t *expiration);
+
+/**
+ * @brief Restore the authentication token saved before the restart and compute the deadline to refresh it from its expiration when the time is known
+ */
+static void mender_api_jwt_restore(void);
+
+/**
+ * @brief Get a copy of the authentication token, so that it can be used while it is refreshed by another work
+ * @param jwt Copy of the authentication token, NULL if not authenticated
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_api_jwt_get(char **jwt);
+
+/**
+ * @brief Get the lifetime and the expiration of the authentication token from its "iat" and "exp" claims
+ * @param jwt Authentication token
+ * @param lifetime Lifetime of the authentication token (seconds)
+ * @param expiration Expiration of the authentication token (seconds since epoch)
+ * @return MENDER_OK if the function succeeds, error code otherwise
  */
-static char *mender_api_jwt = NULL;
+static mender_err_t mender_api_jwt_get_lifetime(char *jwt, uint32_t *lifetime, int64_t *expiration);
+
+/**
+ * @brief Perform HTTP request with the authentication token, authenticate again and retry once if the token is rejected by the server
+ * @param path Path of the request
+ * @param method Method
+ * @param payload Payload, NULL if empty
+ * @param response Response of the server
+ * @param status Status code
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_api_http_perform_authenticated(char *path, mender_http_method_t method, char *payload, char **response, int *status);
 
 /**
  * @brief HTTP callback used to handle text content
@@ -69,6 +178,18 @@ static mender_err_t mender_api_http_text_callback(mender_http_client_event_t eve
  */
 static mender_err_t mender_api_http_artifact_callback(mender_http_client_event_t event, void *data, size_t data_length, void *params);
 
+/**
+ * @brief Reset the token bucket used to limit the download rate, the bucket is full at the beginning of the download
+ */
+static void mender_api_download_throttle_reset(void);
+
+/**
+ * @brief Consume tokens for the data received and pace the download if the rate limit is reached
+ * @note The calling thread sleeps while the bucket is empty, this stops reading the socket and lets TCP flow control slow down the server
+ * @param length Length of the data received
+ */
+static void mender_api_download_throttle(size_t length);
+
 #ifdef CONFIG_MENDER_CLIENT_ADD_ON_TROUBLESHOOT
 
 /**
@@ -84,7 +205,12 @@ static mender_err_t mender_api_websocket_callback(mender_websocket_client_event_
 #endif /* CONFIG_MENDER_CLIENT_ADD_ON_TROUBLESHOOT */
 
 /**
- * @brief Print response error
+ * @brief Release the authentication request cache
+ */
+static void mender_api_authentication_cache_release(void);
+
+/**
+ * @brief Print response error and save the delay requested by the server when it is overloaded
  * @param response HTTP response, NULL if not available
  * @param status HTTP status
  */
@@ -102,6 +228,19 @@ mender_api_init(mender_api_config_t *config) {
     /* Save configuration */
     memcpy(&mender_api_config, config, sizeof(mender_api_config_t));
 
+    /* Create authentication token mutex */
+    if (MENDER_OK != (ret = mender_scheduler_mutex_create(&mender_api_jwt_mutex))) {
+        mender_log_error("Unable to create authentication token mutex");
+        return ret;
+    }
+    if (MENDER_OK != (ret = mender_scheduler_mutex_create(&mender_api_authentication_mutex))) {
+        mender_log_error("Unable to create authentication mutex");
+        return ret;
+    }
+
+    /* Restore the authentication token saved before the restart, it is used to access the server without authenticating again */
+    mender_api_jwt_restore();
+
     /* Initializations */
     mender_http_config_t mender_http_config = { .host = mender_api_config.host };
     if (MENDER_OK != (ret = mender_http_init(&mender_http_config))) {
@@ -123,6 +262,45 @@ mender_err_t
 mender_api_perform_authentication(mender_err_t (*get_identity)(mender_identity_t **identity)) {
 
     assert(NULL != get_identity);
+    mender_err_t ret;
+    bool         valid;
+
+    /* Take mutex used to serialize the authentications */
+    if (MENDER_OK != (ret = mender_scheduler_mutex_take(mender_api_authentication_mutex, -1))) {
+        mender_log_error("Unable to take mutex");
+        return ret;
+    }
+
+    /* Save the identity callback */
+    mender_api_get_identity = get_identity;
+
+    /* Take mutex used to protect access to the authentication token */
+    if (MENDER_OK != (ret = mender_scheduler_mutex_take(mender_api_jwt_mutex, -1))) {
+        mender_log_error("Unable to take mutex");
+        mender_scheduler_mutex_give(mender_api_authentication_mutex);
+        return ret;
+    }
+
+    /* Check if the authentication token can be reused, the token restored from the storage without time base is refreshed at the next authentication */
+    valid = (NULL != mender_api_jwt) && ((true == mender_api_jwt_restored) || (mender_scheduler_get_uptime() < mender_api_jwt_refresh_deadline));
+    mender_api_jwt_restored = false;
+
+    /* Release mutex used to protect access to the authentication token */
+    mender_scheduler_mutex_give(mender_api_jwt_mutex);
+
+    /* Perform authentication with the server if the token has to be refreshed */
+    ret = (true == valid) ? MENDER_OK : mender_api_authenticate();
+
+    /* Release mutex used to serialize the authentications */
+    mender_scheduler_mutex_give(mender_api_authentication_mutex);
+
+    return ret;
+}
+
+static mender_err_t
+mender_api_authenticate(void) {
+
+    assert(NULL != mender_api_get_identity);
     mender_err_t       ret;
     char              *public_key_pem       = NULL;
     cJSON             *json_identity        = NULL;
@@ -134,6 +312,7 @@ mender_api_perform_authentication(mender_err_t (*get_identity)(mender_identity_t
     char              *signature            = NULL;
     size_t             signature_length     = 0;
     int                status               = 0;
+    int64_t            expiration           = 0;
 
     /* Get public key in PEM format */
     if (MENDER_OK != (ret = mender_tls_get_public_key_pem(&public_key_pem))) {
@@ -142,7 +321,7 @@ mender_api_perform_authentication(mender_err_t (*get_identity)(mender_identity_t
     }
 
     /* Get identity */
-    if (MENDER_OK != (ret = get_identity(&identity))) {
+    if (MENDER_OK != (ret = mender_api_get_identity(&identity))) {
         mender_log_error("Unable to get identity");
         goto END;
     }
@@ -158,27 +337,45 @@ mender_api_perform_authentication(mender_err_t (*get_identity)(mender_identity_t
         goto END;
     }
 
-    /* Format payload */
-    if (NULL == (json_payload = cJSON_CreateObject())) {
-        mender_log_error("Unable to allocate memory");
-        ret = MENDER_FAIL;
-        goto END;
-    }
-    cJSON_AddStringToObject(json_payload, "id_data", unformatted_identity);
-    cJSON_AddStringToObject(json_payload, "pubkey", public_key_pem);
-    if (NULL != mender_api_config.tenant_token) {
-        cJSON_AddStringToObject(json_payload, "tenant_token", mender_api_config.tenant_token);
-    }
-    if (NULL == (payload = cJSON_PrintUnformatted(json_payload))) {
-        mender_log_error("Unable to allocate memory");
-        ret = MENDER_FAIL;
-        goto END;
-    }
+    /* Check if the cached authentication request is still valid, the payload is formatted and signed again only if the identity or the key has changed */
+    if ((NULL == mender_api_authentication_payload) || (0 != strcmp(mender_api_authentication_identity, unformatted_identity))
+        || (0 != strcmp(mender_api_authentication_public_key, public_key_pem))) {
 
-    /* Sign payload */
-    if (MENDER_OK != (ret = mender_tls_sign_payload(payload, &signature, &signature_length))) {
-        mender_log_error("Unable to sign payload");
-        goto END;
+        /* Release previous authentication request */
+        mender_api_authentication_cache_release();
+
+        /* Format payload */
+        if (NULL == (json_payload = cJSON_CreateObject())) {
+            mender_log_error("Unable to allocate memory");
+            ret = MENDER_FAIL;
+            goto END;
+        }
+        cJSON_AddStringToObject(json_payload, "id_data", unformatted_identity);
+        cJSON_AddStringToObject(json_payload, "pubkey", public_key_pem);
+        if (NULL != mender_api_config.tenant_token) {
+            cJSON_AddStringToObject(json_payload, "tenant_token", mender_api_config.tenant_token);
+        }
+        if (NULL == (payload = cJSON_PrintUnformatted(json_payload))) {
+            mender_log_error("Unable to allocate memory");
+            ret = MENDER_FAIL;
+            goto END;
+        }
+
+        /* Sign payload */
+        if (MENDER_OK != (ret = mender_tls_sign_payload(payload, &signature, &signature_length))) {
+            mender_log_error("Unable to sign payload");
+            goto END;
+        }
+
+        /* Save authentication request, the cache takes ownership of the buffers */
+        mender_api_authentication_identity   = unformatted_identity;
+        mender_api_authentication_public_key = public_key_pem;
+        mender_api_authentication_payload    = payload;
+        mender_api_authentication_signature  = signature;
+        unformatted_identity                 = NULL;
+        public_key_pem                       = NULL;
+        payload                              = NULL;
+        signature                            = NULL;
     }
 
     /* Perform HTTP request */
@@ -186,8 +383,8 @@ mender_api_perform_authentication(mender_err_t (*get_identity)(mender_identity_t
         != (ret = mender_http_perform(NULL,
                                       MENDER_API_PATH_POST_AUTHENTICATION_REQUESTS,
                                       MENDER_HTTP_POST,
-                                      payload,
-                                      signature,
+                                      mender_api_authentication_payload,
+                                      mender_api_authentication_signature,
                                       &mender_api_http_text_callback,
                                       (void *)&response,
                                       &status))) {
@@ -202,15 +399,13 @@ mender_api_perform_authentication(mender_err_t (*get_identity)(mender_identity_t
             ret = MENDER_FAIL;
             goto END;
         }
-        if (NULL != mender_api_jwt) {
-            free(mender_api_jwt);
-        }
-        if (NULL == (mender_api_jwt = strdup(response))) {
-            mender_log_error("Unable to allocate memory");
-            ret = MENDER_FAIL;
+        if (MENDER_OK != (ret = mender_api_jwt_set(response, &expiration))) {
             goto END;
         }
-        ret = MENDER_OK;
+        /* Store the authentication token with its expiration, it is reused after a restart */
+        if (MENDER_OK != mender_storage_set_authentication_token(response, expiration)) {
+            mender_log_warning("Unable to store authentication token");
+        }
     } else {
         mender_api_print_response_error(response, status);
         ret = MENDER_FAIL;
@@ -281,15 +476,7 @@ api_check_for_deployment_v2(int *status, void *response) {
     }
 
     /* Perform HTTP request */
-    if (MENDER_OK
-        != (ret = mender_http_perform(mender_api_jwt,
-                                      MENDER_API_PATH_POST_NEXT_DEPLOYMENT_V2,
-                                      MENDER_HTTP_POST,
-                                      payload,
-                                      NULL,
-                                      &mender_api_http_text_callback,
-                                      (void *)response,
-                                      status))) {
+    if (MENDER_OK != (ret = mender_api_http_perform_authenticated(MENDER_API_PATH_POST_NEXT_DEPLOYMENT_V2, MENDER_HTTP_POST, payload, response, status))) {
         mender_log_error("Unable to perform HTTP request");
         goto END;
     }
@@ -321,7 +508,7 @@ api_check_for_deployment_v1(int *status, void *response) {
     }
 
     /* Perform HTTP request */
-    if (MENDER_OK != (ret = mender_http_perform(mender_api_jwt, path, MENDER_HTTP_GET, NULL, NULL, &mender_api_http_text_callback, (void *)response, status))) {
+    if (MENDER_OK != (ret = mender_api_http_perform_authenticated(path, MENDER_HTTP_GET, NULL, response, status))) {
         mender_log_error("Unable to perform HTTP request");
         goto END;
     }
@@ -489,8 +676,7 @@ mender_api_publish_deployment_status(char *id, mender_deployment_status_t deploy
     snprintf(path, str_length, MENDER_API_PATH_PUT_DEPLOYMENT_STATUS, id);
 
     /* Perform HTTP request */
-    if (MENDER_OK
-        != (ret = mender_http_perform(mender_api_jwt, path, MENDER_HTTP_PUT, payload, NULL, &mender_api_http_text_callback, (void *)&response, &status))) {
+    if (MENDER_OK != (ret = mender_api_http_perform_authenticated(path, MENDER_HTTP_PUT, payload, &response, &status))) {
         mender_log_error("Unable to perform HTTP request");
         goto END;
     }
@@ -523,6 +709,15 @@ END:
     return ret;
 }
 
+mender_err_t
+mender_api_prepare_download_artifact(char *uri) {
+
+    assert(NULL != uri);
+
+    /* Pre-connect to the host of the artifact */
+    return mender_http_preconnect(uri);
+}
+
 mender_err_t
 mender_api_download_artifact(char *uri, mender_err_t (*callback)(char *, cJSON *, char *, size_t, void *, size_t, size_t)) {
 
@@ -533,7 +728,9 @@ mender_api_download_artifact(char *uri, mender_err_t (*callback)(char *, cJSON *
 
     /* Perform HTTP request */
     if (MENDER_OK != (ret = mender_http_perform(NULL, uri, MENDER_HTTP_GET, NULL, NULL, &mender_api_http_artifact_callback, callback, &status))) {
-        mender_log_error("Unable to perform HTTP request");
+        if (MENDER_CANCELLED != ret) {
+            mender_log_error("Unable to perform HTTP request");
+        }
         goto END;
     }
 
@@ -551,6 +748,32 @@ END:
     return ret;
 }
 
+mender_err_t
+mender_api_set_download_rate_limit(uint32_t rate_limit, uint32_t burst_size) {
+
+    /* Save rate limit, taken into account on the next data received */
+    mender_api_download_rate_limit = rate_limit;
+    mender_api_download_burst_size = burst_size;
+    if (0 != rate_limit) {
+        mender_log_info("Download rate limit set to %u bytes/s", (unsigned int)rate_limit);
+    }
+
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_api_get_retry_after(uint32_t *delay) {
+
+    assert(NULL != delay);
+    int64_t remaining = mender_api_retry_after_deadline - mender_scheduler_get_uptime();
+
+    /* Return the remaining delay, rounded up to the next second, and forget it */
+    *delay                          = (remaining > 0) ? (uint32_t)((remaining + 999) / 1000) : 0;
+    mender_api_retry_after_deadline = 0;
+
+    return MENDER_OK;
+}
+
 #ifdef CONFIG_MENDER_CLIENT_ADD_ON_CONFIGURE
 #ifndef CONFIG_MENDER_CLIENT_CONFIGURE_STORAGE
 
@@ -563,15 +786,7 @@ mender_api_download_configuration_data(mender_keystore_t **configuration) {
     int          status   = 0;
 
     /* Perform HTTP request */
-    if (MENDER_OK
-        != (ret = mender_http_perform(mender_api_jwt,
-                                      MENDER_API_PATH_GET_DEVICE_CONFIGURATION,
-                                      MENDER_HTTP_GET,
-                                      NULL,
-                                      NULL,
-                                      &mender_api_http_text_callback,
-                                      (void *)&response,
-                                      &status))) {
+    if (MENDER_OK != (ret = mender_api_http_perform_authenticated(MENDER_API_PATH_GET_DEVICE_CONFIGURATION, MENDER_HTTP_GET, NULL, &response, &status))) {
         mender_log_error("Unable to perform HTTP request");
         goto END;
     }
@@ -627,15 +842,7 @@ mender_api_publish_configuration_data(mender_keystore_t *configuration) {
     }
 
     /* Perform HTTP request */
-    if (MENDER_OK
-        != (ret = mender_http_perform(mender_api_jwt,
-                                      MENDER_API_PATH_PUT_DEVICE_CONFIGURATION,
-                                      MENDER_HTTP_PUT,
-                                      payload,
-                                      NULL,
-                                      &mender_api_http_text_callback,
-                                      (void *)&response,
-                                      &status))) {
+    if (MENDER_OK != (ret = mender_api_http_perform_authenticated(MENDER_API_PATH_PUT_DEVICE_CONFIGURATION, MENDER_HTTP_PUT, payload, &response, &status))) {
         mender_log_error("Unable to perform HTTP request");
         goto END;
     }
@@ -673,15 +880,24 @@ mender_err_t
 mender_api_troubleshoot_connect(mender_err_t (*callback)(void *, size_t), void **handle) {
 
     mender_err_t ret;
+    char        *jwt = NULL;
+
+    /* Get authentication token */
+    if (MENDER_OK != (ret = mender_api_jwt_get(&jwt))) {
+        goto END;
+    }
 
     /* Open websocket connection */
-    if (MENDER_OK != (ret = mender_websocket_connect(mender_api_jwt, MENDER_API_PATH_GET_DEVICE_CONNECT, &mender_api_websocket_callback, callback, handle))) {
+    if (MENDER_OK != (ret = mender_websocket_connect(jwt, MENDER_API_PATH_GET_DEVICE_CONNECT, &mender_api_websocket_callback, callback, handle))) {
         mender_log_error("Unable to open websocket connection");
         goto END;
     }
 
 END:
 
+    /* Release memory */
+    free(jwt);
+
     return ret;
 }
 
@@ -784,15 +1000,7 @@ mender_api_publish_inventory_data(mender_keystore_t *inventory) {
     }
 
     /* Perform HTTP request */
-    if (MENDER_OK
-        != (ret = mender_http_perform(mender_api_jwt,
-                                      MENDER_API_PATH_PUT_DEVICE_ATTRIBUTES,
-                                      MENDER_HTTP_PUT,
-                                      payload,
-                                      NULL,
-                                      &mender_api_http_text_callback,
-                                      (void *)&response,
-                                      &status))) {
+    if (MENDER_OK != (ret = mender_api_http_perform_authenticated(MENDER_API_PATH_PUT_DEVICE_ATTRIBUTES, MENDER_HTTP_PUT, payload, &response, &status))) {
         mender_log_error("Unable to perform HTTP request");
         goto END;
     }
@@ -838,10 +1046,234 @@ mender_api_exit(void) {
         free(mender_api_jwt);
         mender_api_jwt = NULL;
     }
+    mender_api_jwt_refresh_deadline = 0;
+    mender_api_jwt_restored         = false;
+    mender_api_get_identity         = NULL;
+    mender_scheduler_mutex_delete(mender_api_jwt_mutex);
+    mender_api_jwt_mutex = NULL;
+    mender_api_authentication_cache_release();
+    mender_scheduler_mutex_delete(mender_api_authentication_mutex);
+    mender_api_authentication_mutex = NULL;
+    mender_api_retry_after_deadline = 0;
 
     return MENDER_OK;
 }
 
+static mender_err_t
+mender_api_jwt_set(char *jwt, int64_t *expiration) {
+
+    assert(NULL != jwt);
+    assert(NULL != expiration);
+    mender_err_t ret;
+    char        *tmp;
+    uint32_t     lifetime = 0;
+
+    /* Copy the authentication token */
+    if (NULL == (tmp = strdup(jwt))) {
+        mender_log_error("Unable to allocate memory");
+        return MENDER_FAIL;
+    }
+
+    /* Take mutex used to protect access to the authentication token */
+    if (MENDER_OK != (ret = mender_scheduler_mutex_take(mender_api_jwt_mutex, -1))) {
+        mender_log_error("Unable to take mutex");
+        free(tmp);
+        return ret;
+    }
+
+    /* Save the authentication token, it is refreshed before it expires, or only when it is rejected if its lifetime is unknown */
+    free(mender_api_jwt);
+    mender_api_jwt = tmp;
+    if (MENDER_OK == mender_api_jwt_get_lifetime(jwt, &lifetime, expiration)) {
+        mender_api_jwt_refresh_deadline = mender_scheduler_get_uptime() + (int64_t)lifetime * 10 * MENDER_API_JWT_REFRESH_RATIO;
+    } else {
+        mender_api_jwt_refresh_deadline = INT64_MAX;
+        *expiration                     = 0;
+    }
+    mender_api_jwt_restored = false;
+
+    /* Release mutex used to protect access to the authentication token */
+    mender_scheduler_mutex_give(mender_api_jwt_mutex);
+
+    return MENDER_OK;
+}
+
+static void
+mender_api_jwt_restore(void) {
+
+    int64_t  expiration       = 0;
+    int64_t  token_expiration = 0;
+    uint32_t lifetime         = 0;
+    time_t   now;
+
+    /* Read the authentication token and its expiration */
+    if (MENDER_OK != mender_storage_get_authentication_token(&mender_api_jwt, &expiration)) {
+        return;
+    }
+    mender_log_info("Authentication token restored");
+
+    /* Compute the deadline to refresh the token from the time remaining before it expires, the time is considered known if the clock is later than the
+     * issue of the token, the deadline is already reached if the token should have been refreshed before the restart */
+    now = time(NULL);
+    if ((0 != expiration) && (MENDER_OK == mender_api_jwt_get_lifetime(mender_api_jwt, &lifetime, &token_expiration)) && (expiration == token_expiration)
+        && ((time_t)-1 != now) && ((int64_t)now >= expiration - (int64_t)lifetime)) {
+        int64_t refresh                 = expiration - (int64_t)lifetime + (int64_t)lifetime * MENDER_API_JWT_REFRESH_RATIO / 100;
+        mender_api_jwt_refresh_deadline = mender_scheduler_get_uptime() + (refresh - (int64_t)now) * 1000;
+        mender_api_jwt_restored         = false;
+    } else {
+        /* There is no time base to know the age of the token, it is used once and refreshed at the next authentication */
+        mender_log_info("Age of the authentication token is unknown, it is refreshed at the next authentication");
+        mender_api_jwt_refresh_deadline = 0;
+        mender_api_jwt_restored         = true;
+    }
+}
+
+static mender_err_t
+mender_api_jwt_get(char **jwt) {
+
+    assert(NULL != jwt);
+    mender_err_t ret;
+
+    /* Take mutex used to protect access to the authentication token */
+    if (MENDER_OK != (ret = mender_scheduler_mutex_take(mender_api_jwt_mutex, -1))) {
+        mender_log_error("Unable to take mutex");
+        return ret;
+    }
+
+    /* Copy the authentication token */
+    *jwt = NULL;
+    if ((NULL != mender_api_jwt) && (NULL == (*jwt = strdup(mender_api_jwt)))) {
+        mender_log_error("Unable to allocate memory");
+        ret = MENDER_FAIL;
+    }
+
+    /* Release mutex used to protect access to the authentication token */
+    mender_scheduler_mutex_give(mender_api_jwt_mutex);
+
+    return ret;
+}
+
+static mender_err_t
+mender_api_jwt_get_lifetime(char *jwt, uint32_t *lifetime, int64_t *expiration) {
+
+    assert(NULL != jwt);
+    assert(NULL != lifetime);
+    assert(NULL != expiration);
+    mender_err_t   ret = MENDER_FAIL;
+    char          *begin;
+    char          *end;
+    unsigned char *claims      = NULL;
+    size_t         claims_size = 0;
+    cJSON         *json_claims = NULL;
+
+    /* Locate the claims, they are the second part of the token */
+    if ((NULL == (begin = strchr(jwt, '.'))) || (NULL == (end = strchr(begin + 1, '.')))) {
+        mender_log_error("Invalid authentication token");
+        goto END;
+    }
+
+    /* Decode and parse the claims */
+    if (MENDER_OK != mender_utils_base64url_decode(begin + 1, (size_t)(end - begin - 1), &claims, &claims_size)) {
+        mender_log_error("Unable to decode authentication token");
+        goto END;
+    }
+    if (NULL == (json_claims = cJSON_Parse((char *)claims))) {
+        mender_log_error("Unable to parse authentication token");
+        goto END;
+    }
+
+    /* Compute the lifetime of the token */
+    cJSON *json_iat = cJSON_GetObjectItemCaseSensitive(json_claims, "iat");
+    cJSON *json_exp = cJSON_GetObjectItemCaseSensitive(json_claims, "exp");
+    if ((false == cJSON_IsNumber(json_iat)) || (false == cJSON_IsNumber(json_exp)) || (json_exp->valuedouble <= json_iat->valuedouble)) {
+        mender_log_info("Lifetime of the authentication token is unknown");
+        goto END;
+    }
+    *lifetime   = (uint32_t)(json_exp->valuedouble - json_iat->valuedouble);
+    *expiration = (int64_t)json_exp->valuedouble;
+    ret         = MENDER_OK;
+
+END:
+
+    /* Release memory */
+    if (NULL != json_claims) {
+        cJSON_Delete(json_claims);
+    }
+    free(claims);
+
+    return ret;
+}
+
+static mender_err_t
+mender_api_http_perform_authenticated(char *path, mender_http_method_t method, char *payload, char **response, int *status) {
+
+    assert(NULL != response);
+    assert(NULL != status);
+    mender_err_t ret;
+    char        *jwt = NULL;
+
+    /* Perform HTTP request with a copy of the authentication token, it may be refreshed meanwhile by another work */
+    if (MENDER_OK != (ret = mender_api_jwt_get(&jwt))) {
+        goto END;
+    }
+    if ((MENDER_OK != (ret = mender_http_perform(jwt, path, method, payload, NULL, &mender_api_http_text_callback, (void *)response, status)))
+        || (401 != *status) || (NULL == mender_api_get_identity)) {
+        goto END;
+    }
+    mender_log_info("Authentication token rejected");
+
+    /* Release the response of the rejected request */
+    free(*response);
+    *response = NULL;
+    *status   = 0;
+
+    /* Take mutex used to serialize the authentications, the token may have been refreshed meanwhile by another work */
+    if (MENDER_OK != (ret = mender_scheduler_mutex_take(mender_api_authentication_mutex, -1))) {
+        mender_log_error("Unable to take mutex");
+        goto END;
+    }
+
+    /* Forget the rejected token, it has expired or has been revoked, and authenticate again unless it has been refreshed meanwhile */
+    if (MENDER_OK == (ret = mender_scheduler_mutex_take(mender_api_jwt_mutex, -1))) {
+        bool rejected = (NULL == mender_api_jwt) || ((NULL != jwt) && (0 == strcmp(mender_api_jwt, jwt)));
+        if ((true == rejected) && (NULL != mender_api_jwt)) {
+            free(mender_api_jwt);
+            mender_api_jwt = NULL;
+            if (MENDER_OK != mender_storage_delete_authentication_token()) {
+                mender_log_warning("Unable to delete authentication token");
+            }
+        }
+        mender_scheduler_mutex_give(mender_api_jwt_mutex);
+        if (true == rejected) {
+            mender_log_info("Authenticating again");
+            ret = mender_api_authenticate();
+        }
+    } else {
+        mender_log_error("Unable to take mutex");
+    }
+
+    /* Release mutex used to serialize the authentications */
+    mender_scheduler_mutex_give(mender_api_authentication_mutex);
+    if (MENDER_OK != ret) {
+        goto END;
+    }
+
+    /* Retry the request once with the new token */
+    free(jwt);
+    jwt = NULL;
+    if (MENDER_OK != (ret = mender_api_jwt_get(&jwt))) {
+        goto END;
+    }
+    ret = mender_http_perform(jwt, path, method, payload, NULL, &mender_api_http_text_callback, (void *)response, status);
+
+END:
+
+    /* Release memory */
+    free(jwt);
+
+    return ret;
+}
+
 static mender_err_t
 mender_api_http_text_callback(mender_http_client_event_t event, void *data, size_t data_length, void *params) {
 
@@ -907,6 +1339,7 @@ mender_api_http_artifact_callback(mender_http_client_event_t event, void *data,
                 ret = MENDER_FAIL;
                 break;
             }
+            mender_api_download_throttle_reset();
             break;
         case MENDER_HTTP_EVENT_DATA_RECEIVED:
             /* Check input data */
@@ -929,6 +1362,19 @@ mender_api_http_artifact_callback(mender_http_client_event_t event, void *data,
                 mender_log_error("Unable to process data");
                 break;
             }
+
+            /* Pace the download if a rate limit is set */
+            mender_api_download_throttle(data_length);
+
+            /* Give pending nestable works of higher priority a chance to be executed during the download, the other works must wait because the
+             * network and the mutexes are in use by the download */
+            mender_scheduler_work_yield();
+
+            /* Stop the download if the work performing it has been cancelled */
+            if (true == mender_scheduler_work_is_cancelled()) {
+                mender_log_warning("Download cancelled");
+                ret = MENDER_CANCELLED;
+            }
             break;
         case MENDER_HTTP_EVENT_DISCONNECTED:
             break;
@@ -946,6 +1392,51 @@ mender_api_http_artifact_callback(mender_http_client_event_t event, void *data,
     return ret;
 }
 
+static void
+mender_api_download_throttle_reset(void) {
+
+    /* Fill the bucket */
+    uint32_t burst_size           = (0 != mender_api_download_burst_size) ? mender_api_download_burst_size : mender_api_download_rate_limit;
+    mender_api_download_tokens    = (int64_t)burst_size * 1000;
+    mender_api_download_timestamp = mender_scheduler_get_uptime();
+}
+
+static void
+mender_api_download_throttle(size_t length) {
+
+    uint32_t rate_limit = mender_api_download_rate_limit;
+    uint32_t burst_size = (0 != mender_api_download_burst_size) ? mender_api_download_burst_size : rate_limit;
+    int64_t  now;
+
+    /* Check if the rate limiter is enabled */
+    if (0 == rate_limit) {
+        return;
+    }
+
+    /* Refill the bucket depending of the time elapsed since the last refill, one token is one thousandth of byte */
+    now = mender_scheduler_get_uptime();
+    if (now > mender_api_download_timestamp) {
+        mender_api_download_tokens += (now - mender_api_download_timestamp) * (int64_t)rate_limit;
+        if (mender_api_download_tokens > (int64_t)burst_size * 1000) {
+            mender_api_download_tokens = (int64_t)burst_size * 1000;
+        }
+    }
+    mender_api_download_timestamp = now;
+
+    /* Consume tokens, the bucket may become negative when the data received exceed the available tokens */
+    mender_api_download_tokens -= (int64_t)length * 1000;
+
+    /* Wait until the debt is paid back, by slices so that the download can be cancelled meanwhile */
+    if (mender_api_download_tokens < 0) {
+        uint32_t delay = (uint32_t)((-mender_api_download_tokens + rate_limit - 1) / rate_limit);
+        while ((delay > 0) && (false == mender_scheduler_work_is_cancelled())) {
+            uint32_t slice = (delay > MENDER_API_DOWNLOAD_THROTTLE_SLICE) ? MENDER_API_DOWNLOAD_THROTTLE_SLICE : delay;
+            mender_scheduler_delay(slice);
+            delay -= slice;
+        }
+    }
+}
+
 #ifdef CONFIG_MENDER_CLIENT_ADD_ON_TROUBLESHOOT
 
 static mender_err_t
@@ -975,8 +1466,9 @@ mender_api_websocket_callback(mender_websocket_client_event_t event, void *data,
             }
             break;
         case MENDER_WEBSOCKET_EVENT_DISCONNECTED:
-            /* Nothing to do */
+            /* Inform the upper layer the connection is closed */
             mender_log_info("Troubleshoot client disconnected");
+            callback(NULL, 0);
             break;
         case MENDER_WEBSOCKET_EVENT_ERROR:
             /* Websocket connection fails */
@@ -994,11 +1486,34 @@ mender_api_websocket_callback(mender_websocket_client_event_t event, void *data,
 
 #endif /* CONFIG_MENDER_CLIENT_ADD_ON_TROUBLESHOOT */
 
+static void
+mender_api_authentication_cache_release(void) {
+
+    /* Release memory */
+    free(mender_api_authentication_identity);
+    mender_api_authentication_identity = NULL;
+    free(mender_api_authentication_public_key);
+    mender_api_authentication_public_key = NULL;
+    free(mender_api_authentication_payload);
+    mender_api_authentication_payload = NULL;
+    free(mender_api_authentication_signature);
+    mender_api_authentication_signature = NULL;
+}
+
 static void
 mender_api_print_response_error(char *response, int status) {
 
     char *desc;
 
+    /* Save the delay requested by the server if it is overloaded */
+    if ((429 == status) || (503 == status)) {
+        uint32_t delay = 0;
+        if ((MENDER_OK == mender_http_get_retry_after(&delay)) && (delay > 0)) {
+            mender_log_warning("Server requested to retry after %u seconds", (unsigned int)delay);
+            mender_api_retry_after_deadline = mender_scheduler_get_uptime() + (int64_t)delay * 1000;
+        }
+    }
+
     /* Treatment depending of the status */
     if (NULL != (desc = mender_utils_http_status_to_string(status))) {
         if (NULL != response) {
@@ -19,6 +19,8 @@
 
 #include "mender-artifact.h"
 #include "mender-log.h"
+#include "mender-scheduler.h"
+#include "mender-sha.h"
 
 /**
  * @brief TAR block size
@@ -120,6 +122,15 @@ static mender_err_t mender_artifact_read_meta_data(mender_artifact_ctx_t *ctx);
  */
 static mender_err_t mender_artifact_read_data(mender_artifact_ctx_t *ctx, mender_err_t (*callback)(char *, cJSON *, char *, size_t, void *, size_t, size_t));
 
+#ifdef CONFIG_MENDER_FULL_PARSE_ARTIFACT
+/**
+ * @brief Verify the checksum of the data file currently parsed against the one from the manifest
+ * @param ctx Artifact context
+ * @return MENDER_OK if the checksum is valid, error code otherwise
+ */
+static mender_err_t mender_artifact_verify_checksum(mender_artifact_ctx_t *ctx);
+#endif
+
 /**
  * @brief Drop content of the current file of the artifact
  * @param ctx Artifact context
@@ -310,6 +321,7 @@ mender_artifact_release_ctx(mender_artifact_ctx_t *ctx) {
             free(ctx->file.name);
         }
 #ifdef CONFIG_MENDER_FULL_PARSE_ARTIFACT
+        mender_sha256_end(ctx->file.sha256, NULL);
         mender_utils_free_linked_list(ctx->artifact_info.provides);
         mender_utils_free_linked_list(ctx->artifact_info.depends);
         mender_utils_free_linked_list(ctx->artifact_info.checksums);
@@ -863,10 +875,12 @@ mender_artifact_read_data(mender_artifact_ctx_t *ctx, mender_err_t (*callback)(c
     assert(NULL != ctx);
     assert(NULL != callback);
     size_t       index = 0;
+    int          end   = 0;
     mender_err_t ret;
 
-    /* Retrieve payload index */
-    if (1 != sscanf(ctx->file.name, "data/%u.tar", (unsigned int *)&index)) {
+    /* Retrieve payload index, the name is "data/xxxx.tar" optionally followed by "/" and the name of the file, the end of the prefix is checked */
+    if ((1 != sscanf(ctx->file.name, "data/%u.tar%n", (unsigned int *)&index, &end)) || (0 == end)
+        || (('\0' != ctx->file.name[end]) && ('/' != ctx->file.name[end]))) {
         mender_log_error("Invalid artifact format");
         return MENDER_FAIL;
     }
@@ -876,7 +890,7 @@ mender_artifact_read_data(mender_artifact_ctx_t *ctx, mender_err_t (*callback)(c
     }
 
     /* Check if a file name is provided (we don't check the extension because we don't know it) */
-    if (strlen("data/xxxx.tar") == strlen(ctx->file.name)) {
+    if ('\0' == ctx->file.name[end]) {
 
         /* Beginning of the data file */
         if (MENDER_OK != (ret = callback(ctx->payloads.values[index].type, ctx->payloads.values[index].meta_data, NULL, 0, NULL, 0, 0))) {
@@ -896,6 +910,12 @@ mender_artifact_read_data(mender_artifact_ctx_t *ctx, mender_err_t (*callback)(c
     /* Parse data until the end of the file has been reached */
     do {
 
+        /* Stop parsing if the work processing the artifact has been cancelled, large amount of data may be received at once */
+        if (true == mender_scheduler_work_is_cancelled()) {
+            mender_log_warning("Artifact processing cancelled");
+            return MENDER_CANCELLED;
+        }
+
         /* Check if enough data are received (at least one block) */
         if ((NULL == ctx->input.data) || (ctx->input.length < MENDER_ARTIFACT_STREAM_BLOCK_SIZE)) {
             return MENDER_OK;
@@ -905,6 +925,28 @@ mender_artifact_read_data(mender_artifact_ctx_t *ctx, mender_err_t (*callback)(c
         size_t length
             = ((ctx->file.size - ctx->file.index) > MENDER_ARTIFACT_STREAM_BLOCK_SIZE) ? MENDER_ARTIFACT_STREAM_BLOCK_SIZE : (ctx->file.size - ctx->file.index);
 
+#ifdef CONFIG_MENDER_FULL_PARSE_ARTIFACT
+        /* Begin the computation of the checksum with the first block of the file */
+        if (0 == ctx->file.index) {
+            if (MENDER_NOT_IMPLEMENTED == (ret = mender_sha256_begin(&ctx->file.sha256))) {
+                mender_log_error("SHA-256 is not available, unable to verify the checksum of '%s'", ctx->file.name);
+                ctx->file.sha256 = NULL;
+                return MENDER_FAIL;
+            } else if (MENDER_OK != ret) {
+                mender_log_error("Unable to compute the checksum of '%s'", ctx->file.name);
+                return ret;
+            }
+        }
+
+        /* Hash data */
+        if (NULL != ctx->file.sha256) {
+            if (MENDER_OK != (ret = mender_sha256_update(ctx->file.sha256, ctx->input.data, length))) {
+                mender_log_error("Unable to compute the checksum of '%s'", ctx->file.name);
+                return ret;
+            }
+        }
+#endif
+
         /* Invoke callback */
         if (MENDER_OK
             != (ret = callback(ctx->payloads.values[index].type,
@@ -929,9 +971,75 @@ mender_artifact_read_data(mender_artifact_ctx_t *ctx, mender_err_t (*callback)(c
 
     } while (ctx->file.index < ctx->file.size);
 
+#ifdef CONFIG_MENDER_FULL_PARSE_ARTIFACT
+    /* Verify the checksum of the file */
+    if (NULL != ctx->file.sha256) {
+        if (MENDER_OK != (ret = mender_artifact_verify_checksum(ctx))) {
+            return ret;
+        }
+    }
+#endif
+
     return MENDER_DONE;
 }
 
+#ifdef CONFIG_MENDER_FULL_PARSE_ARTIFACT
+static mender_err_t
+mender_artifact_verify_checksum(mender_artifact_ctx_t *ctx) {
+
+    assert(NULL != ctx);
+    assert(NULL != ctx->file.sha256);
+    unsigned char digest[MENDER_SHA256_DIGEST_SIZE];
+    char          checksum[2 * MENDER_SHA256_DIGEST_SIZE + 1];
+    char         *name = NULL;
+    mender_err_t  ret;
+
+    /* Compute the checksum of the file */
+    ret              = mender_sha256_end(ctx->file.sha256, digest);
+    ctx->file.sha256 = NULL;
+    if (MENDER_OK != ret) {
+        mender_log_error("Unable to compute the checksum of '%s'", ctx->file.name);
+        return ret;
+    }
+    for (size_t index = 0; index < MENDER_SHA256_DIGEST_SIZE; index++) {
+        snprintf(&checksum[2 * index], 3, "%02x", digest[index]);
+    }
+
+    /* Retrieve the name of the file in the manifest, "data/0000.tar/update.ext4" is listed as "data/0000/update.ext4" */
+    char *separator = strstr(ctx->file.name, ".tar/");
+    if (NULL == separator) {
+        mender_log_error("Invalid artifact format");
+        return MENDER_FAIL;
+    }
+    size_t str_length = strlen(ctx->file.name) - strlen(".tar") + 1;
+    if (NULL == (name = (char *)malloc(str_length))) {
+        mender_log_error("Unable to allocate memory");
+        return MENDER_FAIL;
+    }
+    snprintf(name, str_length, "%.*s%s", (int)(separator - ctx->file.name), ctx->file.name, separator + strlen(".tar"));
+
+    /* Compare with the checksum from the manifest */
+    ret                           = MENDER_FAIL;
+    mender_key_value_list_t *item = ctx->artifact_info.checksums;
+    while ((NULL != item) && ((NULL == item->value) || (0 != strcmp(name, item->value)))) {
+        item = item->next;
+    }
+    if (NULL == item) {
+        mender_log_error("Checksum of '%s' not found in the manifest", name);
+    } else if (0 != strcmp(checksum, item->key)) {
+        mender_log_error("Checksum of '%s' doesn't match the manifest", name);
+    } else {
+        mender_log_info("Checksum of '%s' verified", name);
+        ret = MENDER_OK;
+    }
+
+    /* Release memory */
+    free(name);
+
+    return ret;
+}
+#endif
+
 static mender_err_t
 mender_artifact_drop_file(mender_artifact_ctx_t *ctx) {
 
@@ -55,6 +55,68 @@
 #define CONFIG_MENDER_CLIENT_UPDATE_POLL_INTERVAL (1800)
 #endif /* CONFIG_MENDER_CLIENT_UPDATE_POLL_INTERVAL */
 
+/**
+ * @brief Default poll splay (seconds), the first poll of the server is delayed by a random duration up to this value, 0 means no splay
+ */
+#ifndef CONFIG_MENDER_CLIENT_POLL_SPLAY
+#define CONFIG_MENDER_CLIENT_POLL_SPLAY (60)
+#endif /* CONFIG_MENDER_CLIENT_POLL_SPLAY */
+
+/**
+ * @brief Default poll jitter (percentage of the poll interval), the poll interval is randomly shortened or lengthened up to this value, 0 means no jitter
+ */
+#ifndef CONFIG_MENDER_CLIENT_POLL_JITTER
+#define CONFIG_MENDER_CLIENT_POLL_JITTER (10)
+#endif /* CONFIG_MENDER_CLIENT_POLL_JITTER */
+
+/**
+ * @brief Default backoff maximum failures, the poll interval is doubled on each consecutive failure up to this count, 0 means no backoff
+ */
+#ifndef CONFIG_MENDER_CLIENT_BACKOFF_MAX_FAILURES
+#define CONFIG_MENDER_CLIENT_BACKOFF_MAX_FAILURES (4)
+#endif /* CONFIG_MENDER_CLIENT_BACKOFF_MAX_FAILURES */
+
+/**
+ * @brief Default wake-up slack (percentage of the period)
+ */
+#ifndef CONFIG_MENDER_CLIENT_WAKE_UP_SLACK
+#define CONFIG_MENDER_CLIENT_WAKE_UP_SLACK (10)
+#endif /* CONFIG_MENDER_CLIENT_WAKE_UP_SLACK */
+
+/**
+ * @brief Default network linger time (seconds), 0 means the network is released immediately
+ */
+#ifndef CONFIG_MENDER_CLIENT_NETWORK_LINGER_TIME
+#define CONFIG_MENDER_CLIENT_NETWORK_LINGER_TIME (10)
+#endif /* CONFIG_MENDER_CLIENT_NETWORK_LINGER_TIME */
+
+/**
+ * @brief Duration of the network lease taken when the add-ons are activated, they access the network immediately (seconds)
+ */
+#define MENDER_CLIENT_NETWORK_LEASE_ADDONS (30)
+
+/**
+ * @brief Default download rate limit (bytes per second), 0 means no limit
+ */
+#ifndef CONFIG_MENDER_CLIENT_DOWNLOAD_RATE_LIMIT
+#define CONFIG_MENDER_CLIENT_DOWNLOAD_RATE_LIMIT (0)
+#endif /* CONFIG_MENDER_CLIENT_DOWNLOAD_RATE_LIMIT */
+
+/**
+ * @brief Default download burst size (bytes), 0 means one second of the rate limit
+ */
+#ifndef CONFIG_MENDER_CLIENT_DOWNLOAD_BURST_SIZE
+#define CONFIG_MENDER_CLIENT_DOWNLOAD_BURST_SIZE (0)
+#endif /* CONFIG_MENDER_CLIENT_DOWNLOAD_BURST_SIZE */
+
+/**
+ * @brief Default size of the flash write buffer (bytes), 0 means each block of the artifact is written to the flash immediately
+ * @note The data are written to the flash by chunks of this size, it should be a multiple of the erase or page size of the flash
+ */
+#ifndef CONFIG_MENDER_CLIENT_FLASH_WRITE_BUFFER_SIZE
+#define CONFIG_MENDER_CLIENT_FLASH_WRITE_BUFFER_SIZE (4096)
+#endif /* CONFIG_MENDER_CLIENT_FLASH_WRITE_BUFFER_SIZE */
+
 /**
  * @brief Mender client configuration
  */
@@ -70,6 +132,7 @@ static mender_client_callbacks_t mender_client_callbacks;
  */
 typedef enum {
     MENDER_CLIENT_STATE_INITIALIZATION, /**< Perform initialization */
+    MENDER_CLIENT_STATE_KEYS,           /**< Wait for the authentication keys */
     MENDER_CLIENT_STATE_AUTHENTICATION, /**< Perform authentication with the server */
     MENDER_CLIENT_STATE_AUTHENTICATED,  /**< Perform updates */
 } mender_client_state_t;
@@ -85,6 +148,21 @@ static mender_client_state_t mender_client_state = MENDER_CLIENT_STATE_INITIALIZ
 static uint8_t mender_client_network_count = 0;
 static void   *mender_client_network_mutex = NULL;
 
+/**
+ * @brief Network state, the network remains connected after the last release until the end of the linger time or of the lease
+ */
+static bool    mender_client_network_connected       = false;
+static int64_t mender_client_network_linger_deadline = 0;
+static int64_t mender_client_network_lease_deadline  = 0;
+static void   *mender_client_network_work_handle     = NULL;
+
+/**
+ * @brief Network statistics, number of times the network has been connected and total connected time (ms)
+ */
+static uint32_t mender_client_network_connect_count  = 0;
+static uint64_t mender_client_network_connected_time = 0;
+static int64_t  mender_client_network_connect_uptime = 0;
+
 /**
  * @brief Deployment data (ID, artifact name and payload types), used to report deployment status after rebooting
  */
@@ -115,16 +193,40 @@ static mender_addon_instance_t **mender_client_addons_list  = NULL;
 static size_t                    mender_client_addons_count = 0;
 static void                     *mender_client_addons_mutex = NULL;
 
+/**
+ * @brief Count of consecutive failures to poll the server, used to back off the poll interval
+ */
+static uint32_t mender_client_poll_failures = 0;
+
+/**
+ * @brief State of the pseudo-random generator used to spread the polls of the devices, 0 if not seeded yet
+ */
+static uint32_t mender_client_random_state = 0;
+
 /**
  * @brief Mender client work handle
  */
 static void *mender_client_work_handle = NULL;
 
+/**
+ * @brief Authentication keys thread handle, state and mutex, the keys are retrieved or generated in background as soon as the client is initialized
+ */
+static void                      *mender_client_keys_thread_handle = NULL;
+static mender_client_keys_state_t mender_client_keys_state         = MENDER_CLIENT_KEYS_STATE_PENDING;
+static void                      *mender_client_keys_mutex         = NULL;
+
 /**
  * @brief Flash handle used to store temporary reference to write rootfs-image data
  */
 static void *mender_client_flash_handle = NULL;
 
+/**
+ * @brief Flash write buffer, the data of the artifact are combined and written to the flash by aligned chunks
+ */
+static uint8_t *mender_client_flash_buffer        = NULL;
+static size_t   mender_client_flash_buffer_length = 0;
+static size_t   mender_client_flash_buffer_index  = 0;
+
 /**
  * @brief Flag to indicate if the deployment needs to set pending image status
  */
@@ -141,12 +243,75 @@ static bool mender_client_deployment_needs_restart = false;
  */
 static mender_err_t mender_client_work_function(void);
 
+/**
+ * @brief Delay the first poll of the server by a random splay, so that the devices booting at the same time don't poll it in lockstep
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_client_poll_splay(void);
+
+/**
+ * @brief Schedule the next poll of the server, the poll interval is backed off after consecutive failures, jittered, and the delay requested by the server is honored
+ * @param result Result of the last poll
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_client_poll_schedule(mender_err_t result);
+
+/**
+ * @brief Get a pseudo-random number, the generator is seeded with the public key of the device and the uptime
+ * @note Authentication keys must be initialized before calling this function
+ * @return Pseudo-random number
+ */
+static uint32_t mender_client_random(void);
+
+/**
+ * @brief Mender client network work function, release the network at the end of the linger time or of the lease
+ * @note The network work is stopped or rearmed under the network management mutex, so the function never returns MENDER_DONE which would let the
+ *       scheduler stop a work rearmed meanwhile by a release or a lease of the network
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_client_network_work_function(void);
+
+/**
+ * @brief Keep the network connected until the end of the linger time or of the lease, whichever is later, release it if both are expired
+ * @note Network management mutex must be taken by the caller, the network work is rearmed or stopped accordingly
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_client_network_linger(void);
+
+/**
+ * @brief Release the network if it is connected and not used anymore
+ * @note Network management mutex must be taken by the caller
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_client_network_disconnect(void);
+
+/**
+ * @brief Start retrieving or generating the authentication keys in background, the previous thread is released first
+ * @note Authentication keys state must be pending
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_client_keys_start(void);
+
+/**
+ * @brief Mender client authentication keys thread, retrieve or generate the authentication keys and signal the update work once they are ready
+ * @note This is executed by a thread of lower priority than the work queue so that the generation of the keys on first boot delays neither the
+ *       initialization of the client nor the other works
+ * @param arg Not used
+ */
+static void mender_client_keys_thread(void *arg);
+
 /**
  * @brief Mender client initialization work function
  * @return MENDER_OK if the function succeeds, error code otherwise
  */
 static mender_err_t mender_client_initialization_work_function(void);
 
+/**
+ * @brief Check if the authentication keys are ready, the generation is started again if it has failed
+ * @return MENDER_DONE if the authentication keys are ready, MENDER_OK if they are still pending, error code otherwise
+ */
+static mender_err_t mender_client_keys_wait_function(void);
+
 /**
  * @brief Mender client authentication work function
  * @return MENDER_OK if the function succeeds, error code otherwise
@@ -226,6 +391,27 @@ static mender_err_t mender_client_download_artifact_callback(
 static mender_err_t mender_client_download_artifact_flash_callback(
     char *id, char *artifact_name, char *type, cJSON *meta_data, char *filename, size_t size, void *data, size_t index, size_t length);
 
+/**
+ * @brief Write data to the flash through the flash write buffer, the data are written immediately if the buffer is not available
+ * @note Data that are not contiguous with the content of the buffer cause it to be written to the flash first
+ * @param data Artifact data
+ * @param index Artifact data index
+ * @param length Artifact data length
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_client_flash_write(void *data, size_t index, size_t length);
+
+/**
+ * @brief Write the data pending in the flash write buffer to the flash
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_client_flash_flush(void);
+
+/**
+ * @brief Release the flash write buffer, pending data are dropped
+ */
+static void mender_client_flash_buffer_release(void);
+
 /**
  * @brief Publish deployment status of the device to the mender-server and invoke deployment status callback
  * @param id ID of the deployment
@@ -287,6 +473,21 @@ mender_client_init(mender_client_config_t *config, mender_client_callbacks_t *ca
         mender_client_config.update_poll_interval = CONFIG_MENDER_CLIENT_UPDATE_POLL_INTERVAL;
     }
     mender_client_config.recommissioning = config->recommissioning;
+    if (0 != config->download_rate_limit) {
+        mender_client_config.download_rate_limit = config->download_rate_limit;
+    } else {
+        mender_client_config.download_rate_limit = CONFIG_MENDER_CLIENT_DOWNLOAD_RATE_LIMIT;
+    }
+    if (0 != config->download_burst_size) {
+        mender_client_config.download_burst_size = config->download_burst_size;
+    } else {
+        mender_client_config.download_burst_size = CONFIG_MENDER_CLIENT_DOWNLOAD_BURST_SIZE;
+    }
+    if (0 != config->network_linger_time) {
+        mender_client_config.network_linger_time = config->network_linger_time;
+    } else {
+        mender_client_config.network_linger_time = CONFIG_MENDER_CLIENT_NETWORK_LINGER_TIME;
+    }
 
     /* Save callbacks */
     memcpy(&mender_client_callbacks, callbacks, sizeof(mender_client_callbacks_t));
@@ -318,6 +519,10 @@ mender_client_init(mender_client_config_t *config, mender_client_callbacks_t *ca
         mender_log_error("Unable to initialize API");
         goto END;
     }
+    if (MENDER_OK != (ret = mender_api_set_download_rate_limit(mender_client_config.download_rate_limit, mender_client_config.download_burst_size))) {
+        mender_log_error("Unable to set download rate limit");
+        goto END;
+    }
 
     /* Create network management mutex */
     if (MENDER_OK != (ret = mender_scheduler_mutex_create(&mender_client_network_mutex))) {
@@ -337,6 +542,12 @@ mender_client_init(mender_client_config_t *config, mender_client_callbacks_t *ca
         return ret;
     }
 
+    /* Create authentication keys mutex */
+    if (MENDER_OK != (ret = mender_scheduler_mutex_create(&mender_client_keys_mutex))) {
+        mender_log_error("Unable to create authentication keys mutex");
+        return ret;
+    }
+
     /* Register rootfs-image artifact type */
     if (MENDER_OK
         != (ret = mender_client_register_artifact_type("rootfs-image", &mender_client_download_artifact_flash_callback, true, config->artifact_name))) {
@@ -348,12 +559,33 @@ mender_client_init(mender_client_config_t *config, mender_client_callbacks_t *ca
     mender_scheduler_work_params_t update_work_params;
     update_work_params.function = mender_client_work_function;
     update_work_params.period   = mender_client_config.authentication_poll_interval;
+    update_work_params.slack    = CONFIG_MENDER_CLIENT_WAKE_UP_SLACK;
+    update_work_params.priority = MENDER_SCHEDULER_WORK_PRIORITY_NORMAL;
+    update_work_params.nestable = false;
     update_work_params.name     = "mender_client_update";
     if (MENDER_OK != (ret = mender_scheduler_work_create(&update_work_params, &mender_client_work_handle))) {
         mender_log_error("Unable to create update work");
         goto END;
     }
 
+    /* Create mender client network work, it is executed once the linger time or the lease expires */
+    mender_scheduler_work_params_t network_work_params;
+    network_work_params.function = mender_client_network_work_function;
+    network_work_params.period   = 0;
+    network_work_params.slack    = 0;
+    network_work_params.priority = MENDER_SCHEDULER_WORK_PRIORITY_NORMAL;
+    network_work_params.nestable = false;
+    network_work_params.name     = "mender_client_network";
+    if (MENDER_OK != (ret = mender_scheduler_work_create(&network_work_params, &mender_client_network_work_handle))) {
+        mender_log_error("Unable to create network work");
+        goto END;
+    }
+
+    /* Start retrieving or generating the authentication keys now, the rest of the initialization overlaps with it */
+    if (MENDER_OK != (ret = mender_client_keys_start())) {
+        goto END;
+    }
+
 END:
 
     return ret;
@@ -468,6 +700,12 @@ mender_client_activate(void) {
 
     mender_err_t ret;
 
+    /* Activate network work */
+    if (MENDER_OK != (ret = mender_scheduler_work_activate(mender_client_network_work_handle))) {
+        mender_log_error("Unable to activate network work");
+        goto END;
+    }
+
     /* Activate update work */
     if (MENDER_OK != (ret = mender_scheduler_work_activate(mender_client_work_handle))) {
         mender_log_error("Unable to activate update work");
@@ -505,6 +743,17 @@ mender_client_deactivate(void) {
     /* Deactivate mender client work */
     mender_scheduler_work_deactivate(mender_client_work_handle);
 
+    /* Deactivate network work and release the network immediately if it is lingering */
+    mender_scheduler_work_deactivate(mender_client_network_work_handle);
+    if (MENDER_OK == mender_scheduler_mutex_take(mender_client_network_mutex, -1)) {
+        mender_client_network_linger_deadline = 0;
+        mender_client_network_lease_deadline  = 0;
+        if (0 == mender_client_network_count) {
+            mender_client_network_linger();
+        }
+        mender_scheduler_mutex_give(mender_client_network_mutex);
+    }
+
     return ret;
 }
 
@@ -524,6 +773,15 @@ END:
     return ret;
 }
 
+mender_err_t
+mender_client_set_download_rate_limit(uint32_t rate_limit) {
+
+    /* Save and apply the new rate limit */
+    mender_client_config.download_rate_limit = rate_limit;
+
+    return mender_api_set_download_rate_limit(mender_client_config.download_rate_limit, mender_client_config.download_burst_size);
+}
+
 mender_err_t
 mender_client_network_connect(void) {
 
@@ -538,12 +796,21 @@ mender_client_network_connect(void) {
     /* Check the network management counter value */
     if (0 == mender_client_network_count) {
 
-        /* Request network access */
-        if (NULL != mender_client_callbacks.network_connect) {
-            if (MENDER_OK != (ret = mender_client_callbacks.network_connect())) {
-                mender_log_error("Unable to connect network");
-                goto END;
+        /* Cancel the release of the network if it is lingering */
+        if (true == mender_client_network_connected) {
+            mender_scheduler_work_set_period(mender_client_network_work_handle, 0);
+        } else {
+
+            /* Request network access */
+            if (NULL != mender_client_callbacks.network_connect) {
+                if (MENDER_OK != (ret = mender_client_callbacks.network_connect())) {
+                    mender_log_error("Unable to connect network");
+                    goto END;
+                }
             }
+            mender_client_network_connected      = true;
+            mender_client_network_connect_uptime = mender_scheduler_get_uptime();
+            mender_client_network_connect_count++;
         }
     }
 
@@ -575,16 +842,87 @@ mender_client_network_release(void) {
     /* Check the network management counter value */
     if (0 == mender_client_network_count) {
 
-        /* Release network access */
-        if (NULL != mender_client_callbacks.network_release) {
-            if (MENDER_OK != (ret = mender_client_callbacks.network_release())) {
-                mender_log_error("Unable to release network");
-                goto END;
-            }
+        /* Keep the network connected until the end of the linger time or of the lease */
+        mender_client_network_linger_deadline = mender_scheduler_get_uptime() + (int64_t)mender_client_config.network_linger_time * 1000;
+        ret                                   = mender_client_network_linger();
+    }
+
+    /* Release mutex used to protect access to the network management counter */
+    mender_scheduler_mutex_give(mender_client_network_mutex);
+
+    return ret;
+}
+
+mender_err_t
+mender_client_network_lease(uint32_t duration) {
+
+    mender_err_t ret;
+
+    /* Take mutex used to protect access to the network management counter */
+    if (MENDER_OK != (ret = mender_scheduler_mutex_take(mender_client_network_mutex, -1))) {
+        mender_log_error("Unable to take mutex");
+        return ret;
+    }
+
+    /* Extend the lease */
+    int64_t deadline = mender_scheduler_get_uptime() + (int64_t)duration * 1000;
+    if (deadline > mender_client_network_lease_deadline) {
+        mender_client_network_lease_deadline = deadline;
+
+        /* Delay the release of the network if it is lingering */
+        if ((0 == mender_client_network_count) && (true == mender_client_network_connected)) {
+            ret = mender_client_network_linger();
         }
     }
 
-END:
+    /* Release mutex used to protect access to the network management counter */
+    mender_scheduler_mutex_give(mender_client_network_mutex);
+
+    return ret;
+}
+
+mender_err_t
+mender_client_get_keys_state(mender_client_keys_state_t *state) {
+
+    assert(NULL != state);
+    mender_err_t ret;
+
+    /* Take mutex used to protect access to the authentication keys state */
+    if (MENDER_OK != (ret = mender_scheduler_mutex_take(mender_client_keys_mutex, -1))) {
+        mender_log_error("Unable to take mutex");
+        return ret;
+    }
+
+    /* Get the state of the authentication keys */
+    *state = mender_client_keys_state;
+
+    /* Release mutex used to protect access to the authentication keys state */
+    mender_scheduler_mutex_give(mender_client_keys_mutex);
+
+    return ret;
+}
+
+mender_err_t
+mender_client_network_get_statistics(uint32_t *connect_count, uint64_t *connected_time) {
+
+    mender_err_t ret;
+
+    /* Take mutex used to protect access to the network management counter */
+    if (MENDER_OK != (ret = mender_scheduler_mutex_take(mender_client_network_mutex, -1))) {
+        mender_log_error("Unable to take mutex");
+        return ret;
+    }
+
+    /* Retrieve statistics, the current connection is included */
+    if (NULL != connect_count) {
+        *connect_count = mender_client_network_connect_count;
+    }
+    if (NULL != connected_time) {
+        *connected_time = mender_client_network_connected_time;
+        if (true == mender_client_network_connected) {
+            *connected_time += (uint64_t)(mender_scheduler_get_uptime() - mender_client_network_connect_uptime);
+        }
+    }
 
     /* Release mutex used to protect access to the network management counter */
     mender_scheduler_mutex_give(mender_client_network_mutex);
@@ -615,9 +953,17 @@ mender_client_exit(void) {
     /* Release mutex used to protect access to the add-ons management list */
     mender_scheduler_mutex_give(mender_client_addons_mutex);
 
-    /* Delete mender client work */
+    /* Wait for the end of the authentication keys thread, it signals the update work, this blocks until the keys are retrieved or generated */
+    if (NULL != mender_client_keys_thread_handle) {
+        mender_scheduler_thread_join(mender_client_keys_thread_handle);
+        mender_client_keys_thread_handle = NULL;
+    }
+
+    /* Delete mender client works */
     mender_scheduler_work_delete(mender_client_work_handle);
     mender_client_work_handle = NULL;
+    mender_scheduler_work_delete(mender_client_network_work_handle);
+    mender_client_network_work_handle = NULL;
 
     /* Release all modules */
     mender_api_exit();
@@ -633,10 +979,17 @@ mender_client_exit(void) {
     mender_client_config.tenant_token                 = NULL;
     mender_client_config.authentication_poll_interval = 0;
     mender_client_config.update_poll_interval         = 0;
+    mender_client_config.network_linger_time          = 0;
     mender_client_network_count                       = 0;
+    mender_client_network_connected                   = false;
+    mender_client_network_linger_deadline             = 0;
+    mender_client_network_lease_deadline              = 0;
+    mender_client_poll_failures                       = 0;
+    mender_client_random_state                        = 0;
     mender_scheduler_mutex_give(mender_client_network_mutex);
     mender_scheduler_mutex_delete(mender_client_network_mutex);
     mender_client_network_mutex = NULL;
+    mender_client_flash_buffer_release();
     if (NULL != mender_client_deployment_data) {
         cJSON_Delete(mender_client_deployment_data);
         mender_client_deployment_data = NULL;
@@ -660,6 +1013,9 @@ mender_client_exit(void) {
     mender_scheduler_mutex_give(mender_client_addons_mutex);
     mender_scheduler_mutex_delete(mender_client_addons_mutex);
     mender_client_addons_mutex = NULL;
+    mender_client_keys_state   = MENDER_CLIENT_KEYS_STATE_PENDING;
+    mender_scheduler_mutex_delete(mender_client_keys_mutex);
+    mender_client_keys_mutex = NULL;
 
     return ret;
 }
@@ -676,7 +1032,21 @@ mender_client_work_function(void) {
             goto END;
         }
         /* Update client state */
+        mender_client_state = MENDER_CLIENT_STATE_KEYS;
+    }
+    /* Intentional pass-through */
+    if (MENDER_CLIENT_STATE_KEYS == mender_client_state) {
+        /* Wait for the authentication keys, they are retrieved or generated in background */
+        if (MENDER_DONE != (ret = mender_client_keys_wait_function())) {
+            goto END;
+        }
+        /* Update client state */
         mender_client_state = MENDER_CLIENT_STATE_AUTHENTICATION;
+        /* Delay the first poll of the server, the pseudo-random generator is seeded with the public key so this is done once the keys are ready */
+        if (0 != CONFIG_MENDER_CLIENT_POLL_SPLAY) {
+            ret = mender_client_poll_splay();
+            goto END;
+        }
     }
     /* Request access to the network */
     if (MENDER_OK != (ret = mender_client_network_connect())) {
@@ -688,13 +1058,13 @@ mender_client_work_function(void) {
         if (MENDER_DONE != (ret = mender_client_authentication_work_function())) {
             goto RELEASE;
         }
-        /* Update work period */
-        if (MENDER_OK != (ret = mender_scheduler_work_set_period(mender_client_work_handle, mender_client_config.update_poll_interval))) {
-            mender_log_error("Unable to set work period");
-            goto RELEASE;
-        }
         /* Update client state */
         mender_client_state = MENDER_CLIENT_STATE_AUTHENTICATED;
+    } else if (MENDER_CLIENT_STATE_AUTHENTICATED == mender_client_state) {
+        /* Refresh the authentication token before it expires, the current token is still used if it fails */
+        if (MENDER_OK != mender_api_perform_authentication(mender_client_callbacks.get_identity)) {
+            mender_log_warning("Unable to refresh authentication token");
+        }
     }
     /* Intentional pass-through */
     if (MENDER_CLIENT_STATE_AUTHENTICATED == mender_client_state) {
@@ -707,25 +1077,221 @@ RELEASE:
     /* Release access to the network */
     mender_client_network_release();
 
+    /* Schedule the next poll of the server, unless the work is being deactivated or the update is done, the scheduler then stops the work */
+    if ((false == mender_scheduler_work_is_cancelled()) && (MENDER_DONE != ret) && (MENDER_OK != mender_client_poll_schedule(ret))) {
+        mender_log_error("Unable to schedule the next poll of the server");
+    }
+
 END:
 
     return ret;
 }
 
 static mender_err_t
-mender_client_initialization_work_function(void) {
+mender_client_poll_splay(void) {
 
-    assert(NULL != mender_client_callbacks.get_user_provided_keys);
+    mender_err_t ret;
+
+    /* Execute the work again at the end of the splay */
+    uint32_t splay = 1 + mender_client_random() % CONFIG_MENDER_CLIENT_POLL_SPLAY;
+    mender_log_info("Polling the server in %u seconds", (unsigned int)splay);
+    if (MENDER_OK != (ret = mender_scheduler_work_set_period(mender_client_work_handle, splay))) {
+        mender_log_error("Unable to set work period");
+    }
+
+    return ret;
+}
+
+static mender_err_t
+mender_client_poll_schedule(mender_err_t result) {
+
+    uint32_t interval
+        = (MENDER_CLIENT_STATE_AUTHENTICATED == mender_client_state) ? mender_client_config.update_poll_interval : mender_client_config.authentication_poll_interval;
+    uint32_t retry_after = 0;
+
+    /* Count consecutive failures, the poll interval is doubled on each of them up to the maximum count */
+    if ((MENDER_OK == result) || (MENDER_DONE == result)) {
+        mender_client_poll_failures = 0;
+    } else if (mender_client_poll_failures < CONFIG_MENDER_CLIENT_BACKOFF_MAX_FAILURES) {
+        mender_client_poll_failures++;
+    }
+    uint64_t period = (uint64_t)interval << mender_client_poll_failures;
+
+    /* Randomly shorten or lengthen the period */
+    if (0 != CONFIG_MENDER_CLIENT_POLL_JITTER) {
+        uint64_t jitter = period * CONFIG_MENDER_CLIENT_POLL_JITTER / 100;
+        period          = period - jitter + mender_client_random() % (2 * jitter + 1);
+    }
+
+    /* Honor the delay requested by the server, it is limited to the maximum backoff so that the device is not silenced forever */
+    uint64_t max_period = (uint64_t)interval << CONFIG_MENDER_CLIENT_BACKOFF_MAX_FAILURES;
+    if ((MENDER_OK == mender_api_get_retry_after(&retry_after)) && (retry_after > period) && (period < max_period)) {
+        period = (retry_after < max_period) ? retry_after : max_period;
+    }
+    if (0 != mender_client_poll_failures) {
+        mender_log_info("Polling the server in %u seconds after %u consecutive failures", (unsigned int)period, (unsigned int)mender_client_poll_failures);
+    }
+
+    /* Execute the work again at the end of the period */
+    return mender_scheduler_work_set_period(mender_client_work_handle, (uint32_t)((0 == period) ? 1 : ((period > UINT32_MAX) ? UINT32_MAX : period)));
+}
+
+static uint32_t
+mender_client_random(void) {
+
+    /* Seed the generator, the public key is unique to the device so that the devices booting at the same time get different sequences */
+    if (0 == mender_client_random_state) {
+        char    *public_key = NULL;
+        uint32_t hash       = 2166136261U;
+        if (MENDER_OK == mender_tls_get_public_key_pem(&public_key)) {
+            for (char *c = public_key; '\0' != *c; c++) {
+                hash = (hash ^ (uint8_t)*c) * 16777619U;
+            }
+            free(public_key);
+        }
+        mender_client_random_state = hash ^ (uint32_t)mender_scheduler_get_uptime();
+        if (0 == mender_client_random_state) {
+            mender_client_random_state = 1;
+        }
+    }
+
+    /* Xorshift generator */
+    mender_client_random_state ^= mender_client_random_state << 13;
+    mender_client_random_state ^= mender_client_random_state >> 17;
+    mender_client_random_state ^= mender_client_random_state << 5;
+
+    return mender_client_random_state;
+}
+
+static mender_err_t
+mender_client_network_work_function(void) {
 
-    char        *storage_deployment_data = NULL;
     mender_err_t ret;
 
+    /* Take mutex used to protect access to the network management counter */
+    if (MENDER_OK != (ret = mender_scheduler_mutex_take(mender_client_network_mutex, -1))) {
+        mender_log_error("Unable to take mutex");
+        return ret;
+    }
+
+    /* Release the network, unless it is used again or the lease has been extended meanwhile, the network work has been stopped if it is used again */
+    if (0 == mender_client_network_count) {
+        ret = mender_client_network_linger();
+    }
+
+    /* Release mutex used to protect access to the network management counter */
+    mender_scheduler_mutex_give(mender_client_network_mutex);
+
+    return (MENDER_DONE == ret) ? MENDER_OK : ret;
+}
+
+static mender_err_t
+mender_client_network_linger(void) {
+
+    mender_err_t ret;
+
+    /* Compute the remaining time until the end of the linger time or of the lease, whichever is later */
+    int64_t deadline  = (mender_client_network_lease_deadline > mender_client_network_linger_deadline) ? mender_client_network_lease_deadline
+                                                                                                       : mender_client_network_linger_deadline;
+    int64_t remaining = deadline - mender_scheduler_get_uptime();
+
+    /* Execute the network work at the end of the remaining time, the period is rounded up to the next second */
+    if ((remaining > 0)
+        && (MENDER_OK == (ret = mender_scheduler_work_set_period(mender_client_network_work_handle, (uint32_t)((remaining + 999) / 1000))))) {
+        return MENDER_OK;
+    }
+
+    /* Stop the network work and release network access */
+    mender_scheduler_work_set_period(mender_client_network_work_handle, 0);
+
+    return mender_client_network_disconnect();
+}
+
+static mender_err_t
+mender_client_network_disconnect(void) {
+
+    mender_err_t ret = MENDER_OK;
+
+    /* Check if the network is connected */
+    if (true == mender_client_network_connected) {
+
+        /* Release network access */
+        if (NULL != mender_client_callbacks.network_release) {
+            if (MENDER_OK != (ret = mender_client_callbacks.network_release())) {
+                mender_log_error("Unable to release network");
+            }
+        }
+        mender_client_network_connected = false;
+        mender_client_network_connected_time += (uint64_t)(mender_scheduler_get_uptime() - mender_client_network_connect_uptime);
+    }
+
+    return ret;
+}
+
+static mender_err_t
+mender_client_keys_start(void) {
+
+    mender_err_t ret;
+
+    /* Release the previous thread, it has already published the state of the authentication keys */
+    if (NULL != mender_client_keys_thread_handle) {
+        mender_scheduler_thread_join(mender_client_keys_thread_handle);
+        mender_client_keys_thread_handle = NULL;
+    }
+
+    /* Start the thread */
+    if (MENDER_OK != (ret = mender_scheduler_thread_create(mender_client_keys_thread, NULL, "mender_client_keys", &mender_client_keys_thread_handle))) {
+        mender_log_error("Unable to create authentication keys thread");
+    }
+
+    return ret;
+}
+
+static void
+mender_client_keys_thread(void *arg) {
+
+    assert(NULL != mender_client_callbacks.get_user_provided_keys);
+    (void)arg;
+
+    mender_client_keys_state_t state = MENDER_CLIENT_KEYS_STATE_READY;
+    int64_t                    start = mender_scheduler_get_uptime();
+
+    /* Report the progress of the authentication keys */
+    if (NULL != mender_client_callbacks.keys_state) {
+        mender_client_callbacks.keys_state(MENDER_CLIENT_KEYS_STATE_PENDING, 0);
+    }
+
     /* Retrieve or generate authentication keys */
-    if (MENDER_OK != (ret = mender_tls_init_authentication_keys(mender_client_callbacks.get_user_provided_keys, mender_client_config.recommissioning))) {
+    if (MENDER_OK != mender_tls_init_authentication_keys(mender_client_callbacks.get_user_provided_keys, mender_client_config.recommissioning)) {
         mender_log_error("Unable to retrieve or generate authentication keys");
-        goto END;
+        state = MENDER_CLIENT_KEYS_STATE_FAILED;
+    }
+    uint32_t elapsed = (uint32_t)(mender_scheduler_get_uptime() - start);
+    if (MENDER_CLIENT_KEYS_STATE_READY == state) {
+        mender_log_info("Authentication keys ready in %u ms", (unsigned int)elapsed);
     }
 
+    /* Publish the state of the authentication keys */
+    if (MENDER_OK == mender_scheduler_mutex_take(mender_client_keys_mutex, -1)) {
+        mender_client_keys_state = state;
+        mender_scheduler_mutex_give(mender_client_keys_mutex);
+    }
+    if (NULL != mender_client_callbacks.keys_state) {
+        mender_client_callbacks.keys_state(state, elapsed);
+    }
+
+    /* Signal the completion to the update work, it waits for the keys to perform the authentication */
+    if (MENDER_CLIENT_KEYS_STATE_READY == state) {
+        mender_scheduler_work_execute(mender_client_work_handle);
+    }
+}
+
+static mender_err_t
+mender_client_initialization_work_function(void) {
+
+    char        *storage_deployment_data = NULL;
+    mender_err_t ret;
+
     /* Retrieve deployment data if it is found (following an update) */
     if (MENDER_OK != (ret = mender_storage_get_deployment_data(&storage_deployment_data))) {
         if (MENDER_NOT_FOUND != ret) {
@@ -745,10 +1311,6 @@ mender_client_initialization_work_function(void) {
 
     return MENDER_DONE;
 
-END:
-
-    return ret;
-
 REBOOT:
 
     /* Delete pending deployment */
@@ -762,6 +1324,48 @@ REBOOT:
     return ret;
 }
 
+static mender_err_t
+mender_client_keys_wait_function(void) {
+
+    mender_client_keys_state_t state;
+    mender_err_t               ret;
+
+    /* Take mutex used to protect access to the authentication keys state */
+    if (MENDER_OK != (ret = mender_scheduler_mutex_take(mender_client_keys_mutex, -1))) {
+        mender_log_error("Unable to take mutex");
+        return ret;
+    }
+
+    /* Get the state of the authentication keys, they are generated again at the next attempt if it has failed */
+    if (MENDER_CLIENT_KEYS_STATE_FAILED == (state = mender_client_keys_state)) {
+        mender_client_keys_state = MENDER_CLIENT_KEYS_STATE_PENDING;
+    }
+
+    /* Release mutex used to protect access to the authentication keys state */
+    mender_scheduler_mutex_give(mender_client_keys_mutex);
+
+    switch (state) {
+        case MENDER_CLIENT_KEYS_STATE_READY:
+            return MENDER_DONE;
+        case MENDER_CLIENT_KEYS_STATE_PENDING:
+            /* Wait for the authentication keys thread to execute the work once they are ready, the authentication poll interval only applies if
+             * the completion is signaled while the work is still executing */
+            mender_log_debug("Waiting for the authentication keys");
+            return mender_scheduler_work_set_period(mender_client_work_handle, mender_client_config.authentication_poll_interval);
+        default:
+            /* Retry to retrieve or generate the authentication keys, they are checked again at the next authentication poll */
+            mender_log_error("Authentication keys are not available, retrying");
+            if (MENDER_OK != (ret = mender_client_keys_start())) {
+                if (MENDER_OK == mender_scheduler_mutex_take(mender_client_keys_mutex, -1)) {
+                    mender_client_keys_state = MENDER_CLIENT_KEYS_STATE_FAILED;
+                    mender_scheduler_mutex_give(mender_client_keys_mutex);
+                }
+            }
+            mender_scheduler_work_set_period(mender_client_work_handle, mender_client_config.authentication_poll_interval);
+            return MENDER_FAIL;
+    }
+}
+
 static mender_err_t
 mender_client_authentication_work_function(void) {
 
@@ -913,7 +1517,8 @@ RELEASE:
         return ret;
     }
 
-    /* Activate add-ons */
+    /* Activate add-ons, they access the network immediately so it is leased to share the current connection */
+    mender_client_network_lease(MENDER_CLIENT_NETWORK_LEASE_ADDONS);
     if (NULL != mender_client_addons_list) {
         for (size_t index = 0; index < mender_client_addons_count; index++) {
             if (NULL != mender_client_addons_list[index]->activate) {
@@ -1094,10 +1699,25 @@ mender_client_update_work_function(void) {
     /* Download deployment artifact */
     mender_log_info(
         "Downloading deployment artifact with id '%s', artifact name '%s' and uri '%s'", deployment->id, deployment->artifact_name, deployment->uri);
+    if (MENDER_OK != mender_api_prepare_download_artifact(deployment->uri)) {
+        mender_log_debug("Unable to pre-connect to the artifact host");
+    }
     mender_client_publish_deployment_status(deployment->id, MENDER_DEPLOYMENT_STATUS_DOWNLOADING);
+    if (NULL != mender_client_callbacks.get_download_rate_limit) {
+        uint32_t rate_limit = mender_client_config.download_rate_limit;
+        if (MENDER_OK == mender_client_callbacks.get_download_rate_limit(&rate_limit)) {
+            mender_client_set_download_rate_limit(rate_limit);
+        }
+    }
     if (MENDER_OK != (ret = mender_api_download_artifact(deployment->uri, mender_client_download_artifact_callback))) {
-        mender_log_error("Unable to download artifact");
-        mender_client_publish_deployment_status(deployment->id, MENDER_DEPLOYMENT_STATUS_FAILURE);
+        if (MENDER_CANCELLED == ret) {
+            /* The deployment is not reported as failed, it is downloaded again the next time the server is polled */
+            mender_log_warning("Deployment cancelled");
+        } else {
+            mender_log_error("Unable to download artifact");
+            mender_client_publish_deployment_status(deployment->id, MENDER_DEPLOYMENT_STATUS_FAILURE);
+        }
+        mender_client_flash_buffer_release();
         if (true == mender_client_deployment_needs_set_pending_image) {
             mender_flash_abort_deployment(mender_client_flash_handle);
         }
@@ -1351,10 +1971,19 @@ mender_client_download_artifact_flash_callback(
                 mender_log_error("Unable to open flash handle");
                 goto END;
             }
+
+            /* Allocate the flash write buffer, the data are written immediately if it is not available */
+            mender_client_flash_buffer_length = 0;
+            mender_client_flash_buffer_index  = 0;
+            if ((0 < CONFIG_MENDER_CLIENT_FLASH_WRITE_BUFFER_SIZE) && (NULL == mender_client_flash_buffer)) {
+                if (NULL == (mender_client_flash_buffer = (uint8_t *)malloc(CONFIG_MENDER_CLIENT_FLASH_WRITE_BUFFER_SIZE))) {
+                    mender_log_warning("Unable to allocate flash write buffer, data are written block by block");
+                }
+            }
         }
 
         /* Write data */
-        if (MENDER_OK != (ret = mender_flash_write(mender_client_flash_handle, data, index, length))) {
+        if (MENDER_OK != (ret = mender_client_flash_write(data, index, length))) {
             mender_log_error("Unable to write data to flash");
             goto END;
         }
@@ -1362,6 +1991,14 @@ mender_client_download_artifact_flash_callback(
         /* Check if the flash handle must be closed */
         if (index + length >= size) {
 
+            /* Write pending data and release the flash write buffer */
+            ret = mender_client_flash_flush();
+            mender_client_flash_buffer_release();
+            if (MENDER_OK != ret) {
+                mender_log_error("Unable to write data to flash");
+                goto END;
+            }
+
             /* Close the flash handle */
             if (MENDER_OK != (ret = mender_flash_close(mender_client_flash_handle))) {
                 mender_log_error("Unable to close flash handle");
@@ -1378,6 +2015,78 @@ END:
     return ret;
 }
 
+static mender_err_t
+mender_client_flash_write(void *data, size_t index, size_t length) {
+
+    mender_err_t ret;
+    size_t       size;
+
+    /* Write data immediately if the flash write buffer is not available */
+    if (NULL == mender_client_flash_buffer) {
+        return mender_flash_write(mender_client_flash_handle, data, index, length);
+    }
+
+    /* Write pending data and restart the buffer at the given index if the data are not contiguous with the content of the buffer */
+    if (index != mender_client_flash_buffer_index + mender_client_flash_buffer_length) {
+        if (MENDER_OK != (ret = mender_client_flash_flush())) {
+            return ret;
+        }
+        mender_client_flash_buffer_index = index;
+    }
+
+    /* Append data to the flash write buffer, and write it to the flash each time it is full */
+    while (length > 0) {
+        size = ((CONFIG_MENDER_CLIENT_FLASH_WRITE_BUFFER_SIZE - mender_client_flash_buffer_length) < length)
+                   ? (CONFIG_MENDER_CLIENT_FLASH_WRITE_BUFFER_SIZE - mender_client_flash_buffer_length)
+                   : length;
+        memcpy(&mender_client_flash_buffer[mender_client_flash_buffer_length], data, size);
+        mender_client_flash_buffer_length += size;
+        data = (void *)(((uint8_t *)data) + size);
+        length -= size;
+        if (CONFIG_MENDER_CLIENT_FLASH_WRITE_BUFFER_SIZE == mender_client_flash_buffer_length) {
+            if (MENDER_OK != (ret = mender_client_flash_flush())) {
+                return ret;
+            }
+        }
+    }
+
+    return MENDER_OK;
+}
+
+static mender_err_t
+mender_client_flash_flush(void) {
+
+    mender_err_t ret;
+
+    /* Check if data are pending */
+    if ((NULL == mender_client_flash_buffer) || (0 == mender_client_flash_buffer_length)) {
+        return MENDER_OK;
+    }
+
+    /* Write pending data, the index is aligned on the size of the buffer except for the last chunk of the file or after non-contiguous data */
+    if (MENDER_OK
+        != (ret = mender_flash_write(
+                mender_client_flash_handle, mender_client_flash_buffer, mender_client_flash_buffer_index, mender_client_flash_buffer_length))) {
+        return ret;
+    }
+    mender_client_flash_buffer_index += mender_client_flash_buffer_length;
+    mender_client_flash_buffer_length = 0;
+
+    return MENDER_OK;
+}
+
+static void
+mender_client_flash_buffer_release(void) {
+
+    /* Release memory */
+    if (NULL != mender_client_flash_buffer) {
+        free(mender_client_flash_buffer);
+        mender_client_flash_buffer = NULL;
+    }
+    mender_client_flash_buffer_length = 0;
+    mender_client_flash_buffer_index  = 0;
+}
+
 static mender_err_t
 mender_client_publish_deployment_status(char *id, mender_deployment_status_t deployment_status) {
 
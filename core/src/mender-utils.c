@@ -143,6 +143,119 @@ mender_utils_strendwith(const char *s1, const char *s2) {
     return (0 == strncmp(s1 + strlen(s1) - strlen(s2), s2, strlen(s2)));
 }
 
+bool
+mender_utils_memisfilled(const void *data, size_t length, uint8_t value) {
+
+    assert(NULL != data);
+    const uint8_t *ptr     = (const uint8_t *)data;
+    uintptr_t      pattern = ((uintptr_t)-1 / 0xFF) * value;
+    uintptr_t      word;
+    uintptr_t      diff;
+
+    /* Check leading bytes until the pointer is aligned */
+    while ((0 < length) && (0 != ((uintptr_t)ptr % sizeof(uintptr_t)))) {
+        if (value != *ptr) {
+            return false;
+        }
+        ptr++;
+        length--;
+    }
+
+    /* Check aligned words, the differences are accumulated over several words so that the compiler can vectorize the loop */
+    while (length >= 8 * sizeof(uintptr_t)) {
+        const uint8_t *aligned = (const uint8_t *)__builtin_assume_aligned(ptr, sizeof(uintptr_t));
+        diff                   = 0;
+        for (size_t index = 0; index < 8; index++) {
+            memcpy(&word, &aligned[index * sizeof(uintptr_t)], sizeof(uintptr_t));
+            diff |= word ^ pattern;
+        }
+        if (0 != diff) {
+            return false;
+        }
+        ptr += 8 * sizeof(uintptr_t);
+        length -= 8 * sizeof(uintptr_t);
+    }
+
+    /* Check trailing bytes */
+    while (0 < length) {
+        if (value != *ptr) {
+            return false;
+        }
+        ptr++;
+        length--;
+    }
+
+    return true;
+}
+
+mender_err_t
+mender_utils_base64url_decode(const char *src, size_t src_length, unsigned char **dst, size_t *dst_length) {
+
+    assert(NULL != src);
+    assert(NULL != dst);
+    assert(NULL != dst_length);
+    uint32_t bits  = 0;
+    size_t   count = 0;
+
+    /* Ignore padding */
+    while ((src_length > 0) && ('=' == src[src_length - 1])) {
+        src_length--;
+    }
+
+    /* Allocate memory, each group of 4 characters is decoded to 3 bytes */
+    if (NULL == (*dst = (unsigned char *)malloc(src_length * 3 / 4 + 1))) {
+        mender_log_error("Unable to allocate memory");
+        return MENDER_FAIL;
+    }
+    *dst_length = 0;
+
+    /* Decode data */
+    for (size_t index = 0; index < src_length; index++) {
+        char    c = src[index];
+        uint8_t value;
+        if ((c >= 'A') && (c <= 'Z')) {
+            value = (uint8_t)(c - 'A');
+        } else if ((c >= 'a') && (c <= 'z')) {
+            value = (uint8_t)(c - 'a' + 26);
+        } else if ((c >= '0') && (c <= '9')) {
+            value = (uint8_t)(c - '0' + 52);
+        } else if (('-' == c) || ('+' == c)) {
+            value = 62;
+        } else if (('_' == c) || ('/' == c)) {
+            value = 63;
+        } else {
+            mender_log_error("Invalid base64url data");
+            free(*dst);
+            *dst = NULL;
+            return MENDER_FAIL;
+        }
+        bits = (bits << 6) | value;
+        if (++count >= 4) {
+            (*dst)[(*dst_length)++] = (unsigned char)(bits >> 16);
+            (*dst)[(*dst_length)++] = (unsigned char)(bits >> 8);
+            (*dst)[(*dst_length)++] = (unsigned char)bits;
+            bits                    = 0;
+            count                   = 0;
+        }
+    }
+
+    /* Decode the remaining bytes */
+    if (1 == count) {
+        mender_log_error("Invalid base64url data");
+        free(*dst);
+        *dst = NULL;
+        return MENDER_FAIL;
+    } else if (2 == count) {
+        (*dst)[(*dst_length)++] = (unsigned char)(bits >> 4);
+    } else if (3 == count) {
+        (*dst)[(*dst_length)++] = (unsigned char)(bits >> 10);
+        (*dst)[(*dst_length)++] = (unsigned char)(bits >> 2);
+    }
+    (*dst)[*dst_length] = '\0';
+
+    return MENDER_OK;
+}
+
 char *
 mender_utils_deployment_status_to_string(mender_deployment_status_t deployment_status) {
 
@@ -58,6 +58,9 @@ mender_err_t mender_api_init(mender_api_config_t *config);
 
 /**
  * @brief Perform authentication of the device, retrieve token from mender-server used for the next requests
+ * @note The token is stored and reused until it has to be refreshed, the token restored after a restart is used once before being refreshed
+ * @note The requests rejected because the token has expired are retried once after authenticating again
+ * @param get_identity Callback used to get the identity of the device
  * @return MENDER_OK if the function succeeds, error code otherwise
  */
 mender_err_t mender_api_perform_authentication(mender_err_t (*get_identity)(mender_identity_t **identity));
@@ -77,6 +80,13 @@ mender_err_t mender_api_check_for_deployment(mender_api_deployment_data_t *deplo
  */
 mender_err_t mender_api_publish_deployment_status(char *id, mender_deployment_status_t deployment_status);
 
+/**
+ * @brief Prepare the download of the artifact, the connection to the host of the artifact is established in background
+ * @param uri URI of the deployment received from mender_api_check_for_deployment function
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+mender_err_t mender_api_prepare_download_artifact(char *uri);
+
 /**
  * @brief Download artifact from the mender-server
  * @param uri URI of the deployment received from mender_api_check_for_deployment function
@@ -85,6 +95,23 @@ mender_err_t mender_api_publish_deployment_status(char *id, mender_deployment_st
  */
 mender_err_t mender_api_download_artifact(char *uri, mender_err_t (*callback)(char *, cJSON *, char *, size_t, void *, size_t, size_t));
 
+/**
+ * @brief Set download rate limit of the artifacts
+ * @note This function can be called at any time, the new rate limit applies immediately to the download in progress
+ * @param rate_limit Download rate limit (bytes per second), 0 to disable the rate limiter
+ * @param burst_size Maximum amount of data that can be received at once (bytes), 0 to use one second of the rate limit
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+mender_err_t mender_api_set_download_rate_limit(uint32_t rate_limit, uint32_t burst_size);
+
+/**
+ * @brief Retrieve the delay requested by the server with the Retry-After header of the last 429 or 503 response
+ * @note The delay is forgotten once it has been retrieved
+ * @param delay Remaining delay (seconds), 0 if the server did not request to retry later
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+mender_err_t mender_api_get_retry_after(uint32_t *delay);
+
 #ifdef CONFIG_MENDER_CLIENT_ADD_ON_CONFIGURE
 #ifndef CONFIG_MENDER_CLIENT_CONFIGURE_STORAGE
 
@@ -110,7 +137,7 @@ mender_err_t mender_api_publish_configuration_data(mender_keystore_t *configurat
 
 /**
  * @brief Connect the device and make it available to the server
- * @param callback Callback function to be invoked to perform the treatment of the data from the websocket
+ * @param callback Callback function to be invoked to perform the treatment of the data from the websocket, invoked with NULL data when the connection is closed
  * @param handle Connection handle
  * @return MENDER_OK if the function succeeds, error code otherwise
  */
@@ -74,7 +74,10 @@ typedef struct {
         char  *name;  /**< Name of the file currently parsed */
         size_t size;  /**< Size of the file currently parsed (bytes) */
         size_t index; /**< Index of the data in the file currently parsed (bytes), incremented block by block */
-    } file;           /**< Information about the file currently parsed */
+#ifdef CONFIG_MENDER_FULL_PARSE_ARTIFACT
+        void *sha256; /**< Handle of the SHA-256 computation of the file currently parsed, NULL if the checksum is not verified */
+#endif
+    } file; /**< Information about the file currently parsed */
 } mender_artifact_ctx_t;
 
 #ifdef CONFIG_MENDER_FULL_PARSE_ARTIFACT
@@ -28,17 +28,31 @@ extern "C" {
 #include "mender-addon.h"
 #include "mender-utils.h"
 
+/**
+ * @brief Authentication keys states
+ * @note The keys_state callback is invoked from the authentication keys thread with the pending state when the keys start being retrieved or generated,
+ *       then with the ready or failed state once it is done
+ */
+typedef enum {
+    MENDER_CLIENT_KEYS_STATE_PENDING, /**< Authentication keys are being retrieved or generated */
+    MENDER_CLIENT_KEYS_STATE_READY,   /**< Authentication keys are ready */
+    MENDER_CLIENT_KEYS_STATE_FAILED,  /**< Unable to retrieve or generate authentication keys, this is retried at the next authentication poll */
+} mender_client_keys_state_t;
+
 /**
  * @brief Mender client configuration
  */
 typedef struct {
-    char   *artifact_name;                /**< Artifact name */
-    char   *device_type;                  /**< Device type */
-    char   *host;                         /**< URL of the mender server */
-    char   *tenant_token;                 /**< Tenant token used to authenticate on the mender server (optional) */
-    int32_t authentication_poll_interval; /**< Authentication poll interval, default is 60 seconds, -1 permits to disable periodic execution */
-    int32_t update_poll_interval;         /**< Update poll interval, default is 1800 seconds, -1 permits to disable periodic execution */
-    bool    recommissioning;              /**< Used to force creation of new authentication keys */
+    char    *artifact_name;                /**< Artifact name */
+    char    *device_type;                  /**< Device type */
+    char    *host;                         /**< URL of the mender server */
+    char    *tenant_token;                 /**< Tenant token used to authenticate on the mender server (optional) */
+    int32_t  authentication_poll_interval; /**< Authentication poll interval, default is 60 seconds, -1 permits to disable periodic execution */
+    int32_t  update_poll_interval;         /**< Update poll interval, default is 1800 seconds, -1 permits to disable periodic execution */
+    bool     recommissioning;              /**< Used to force creation of new authentication keys */
+    uint32_t download_rate_limit;          /**< Download rate limit of the artifacts (bytes per second), default is no limit */
+    uint32_t download_burst_size;          /**< Download burst size when the rate is limited (bytes), default is one second of the rate limit */
+    uint32_t network_linger_time;          /**< Time the network remains connected after it is released (seconds), default is 10 seconds */
 } mender_client_config_t;
 
 /**
@@ -54,6 +68,9 @@ typedef struct {
     mender_err_t (*get_identity)(mender_identity_t **identity);            /**< Invoked to retrieve identity */
     mender_err_t (*get_user_provided_keys)(
         char **user_provided_key, size_t *user_provided_key_length); /**< Invoked to retrieve buffer and buffer size of PEM encoded user-provided key */
+    mender_err_t (*get_download_rate_limit)(uint32_t *rate_limit); /**< Invoked before downloading an artifact to adjust the download rate limit (optional) */
+    mender_err_t (*keys_state)(
+        mender_client_keys_state_t state, uint32_t elapsed); /**< Invoked on the progress of the authentication keys with the elapsed time (ms) (optional) */
 } mender_client_callbacks_t;
 
 /**
@@ -101,6 +118,7 @@ mender_err_t mender_client_activate(void);
 /**
  * @brief Deactivate mender client
  * @note This function stops synchronization with the server
+ * @note A deployment in progress is cancelled, it is not reported as failed and it is downloaded again once the client is activated
  * @return MENDER_OK if the function succeeds, error code otherwise
  */
 mender_err_t mender_client_deactivate(void);
@@ -113,6 +131,14 @@ mender_err_t mender_client_deactivate(void);
  */
 mender_err_t mender_client_execute(void);
 
+/**
+ * @brief Function used to change the download rate limit of the artifacts
+ * @note The new rate limit applies immediately, including to the download in progress
+ * @param rate_limit Download rate limit (bytes per second), 0 to disable the rate limiter
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+mender_err_t mender_client_set_download_rate_limit(uint32_t rate_limit);
+
 /**
  * @brief Function to be called from add-ons to request network access
  * @return MENDER_OK if network is connected following the request, error code otherwise
@@ -125,6 +151,29 @@ mender_err_t mender_client_network_connect(void);
  */
 mender_err_t mender_client_network_release(void);
 
+/**
+ * @brief Function to be called from add-ons to declare an upcoming network access
+ * @note If the network is released before the end of the lease, it remains connected until then so that the next access shares the same connection
+ * @param duration Duration of the lease (seconds)
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+mender_err_t mender_client_network_lease(uint32_t duration);
+
+/**
+ * @brief Function used to retrieve the state of the authentication keys, they are retrieved or generated in background from the initialization
+ * @param state Authentication keys state
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+mender_err_t mender_client_get_keys_state(mender_client_keys_state_t *state);
+
+/**
+ * @brief Function used to retrieve network usage statistics
+ * @param connect_count Number of times the network has been connected, NULL if not needed
+ * @param connected_time Total time the network has been connected, including the current connection (milliseconds), NULL if not needed
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+mender_err_t mender_client_network_get_statistics(uint32_t *connect_count, uint64_t *connected_time);
+
 /**
  * @brief Release mender client
  * @return MENDER_OK if the function succeeds, error code otherwise
@@ -62,6 +62,7 @@ mender_err_t mender_http_init(mender_http_config_t *config);
 
 /**
  * @brief Perform HTTP request
+ * @note The request is interrupted if the calling work is cancelled, MENDER_CANCELLED is then returned
  * @param jwt Token, NULL if not authenticated yet
  * @param path Path of the request
  * @param method Method
@@ -81,6 +82,45 @@ mender_err_t mender_http_perform(char                *jwt,
                                  void *params,
                                  int  *status);
 
+/**
+ * @brief Perform HTTP request asynchronously
+ * @note The request is queued and performed by the HTTP event loop of the platform, several requests can progress concurrently
+ * @note The callbacks are invoked from the context of the HTTP event loop, they should not block
+ * @param jwt Token, NULL if not authenticated yet
+ * @param path Path of the request
+ * @param method Method
+ * @param payload Payload, NULL if empty
+ * @param signature Signature of the payload, NULL if it is not required
+ * @param callback Callback invoked on HTTP events
+ * @param done Callback invoked when the request is completed with the result and the status code
+ * @param params Parameters passed to the callbacks, NULL if not used
+ * @return MENDER_OK if the request has been queued, error code otherwise
+ */
+mender_err_t mender_http_perform_async(char                *jwt,
+                                       char                *path,
+                                       mender_http_method_t method,
+                                       char                *payload,
+                                       char                *signature,
+                                       mender_err_t (*callback)(mender_http_client_event_t, void *, size_t, void *),
+                                       void (*done)(mender_err_t, int, void *),
+                                       void *params);
+
+/**
+ * @brief Retrieve the delay requested by the server with the Retry-After header of the last response
+ * @note Only the delay-seconds form of the header is supported, the delay is 0 if the header was not present
+ * @param delay Delay (seconds)
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+mender_err_t mender_http_get_retry_after(uint32_t *delay);
+
+/**
+ * @brief Pre-connect to the host of an URL in background, so that DNS resolution and connection are done when the request is performed
+ * @note The connection is used by the GET request performed with the same URL, the other requests leave it untouched, it is released by the next pre-connection
+ * @param path URL
+ * @return MENDER_OK if the pre-connection has been started, error code otherwise
+ */
+mender_err_t mender_http_preconnect(char *path);
+
 /**
  * @brief Release mender http
  * @return MENDER_OK if the function succeeds, error code otherwise
@@ -26,15 +26,50 @@ extern "C" {
 
 #include "mender-utils.h"
 
+/**
+ * @brief Work priority, pending works of higher priority are executed first
+ */
+typedef enum {
+    MENDER_SCHEDULER_WORK_PRIORITY_LOW = 0, /**< Background works, for example periodic publication of data */
+    MENDER_SCHEDULER_WORK_PRIORITY_NORMAL,  /**< Default priority */
+    MENDER_SCHEDULER_WORK_PRIORITY_HIGH,    /**< Interactive works, requiring low latency */
+    MENDER_SCHEDULER_WORK_PRIORITY_COUNT    /**< Number of priorities, not a valid priority */
+} mender_scheduler_work_priority_t;
+
 /**
  * @brief Work parameters
  */
 typedef struct {
-    mender_err_t (*function)(void); /**< Work function */
-    int32_t period;                 /**< Work period (seconds), negative or null value permits to disable periodic execution */
-    char   *name;                   /**< Work name */
+    mender_err_t (*function)(void);            /**< Work function, its periodic execution is stopped when it returns MENDER_DONE */
+    int32_t                          period;   /**< Work period (seconds), negative or null value permits to disable periodic execution */
+    uint32_t                         slack;    /**< Work slack (percentage of the period, lower than 100), the periodic execution can be advanced by up to the
+                                                    slack to share the wake-up of another work, 0 to disable */
+    mender_scheduler_work_priority_t priority; /**< Work priority */
+    bool                             nestable; /**< Work can be executed by mender_scheduler_work_yield inside another work, it must not use the network
+                                                    nor take the mutexes the other works may hold while they yield */
+    char                            *name;     /**< Work name */
 } mender_scheduler_work_params_t;
 
+/**
+ * @brief Number of buckets of the histograms of the works
+ * @note Bucket 0 counts the values lower than 1ms, bucket i counts the values in [2^(i-1), 2^i[ ms, the last bucket counts all the greater values
+ */
+#define MENDER_SCHEDULER_WORK_HISTOGRAM_SIZE (16)
+
+/**
+ * @brief Work statistics
+ */
+typedef struct {
+    uint32_t triggers;                                                 /**< Number of times the work has been triggered, by its timer or explicitly */
+    uint32_t dropped;                                                  /**< Number of triggers dropped because the work was already pending or executing */
+    uint32_t executions;                                               /**< Number of executions of the work */
+    uint32_t latency_max;                                              /**< Maximum delay between the trigger and the start of an execution (ms) */
+    uint32_t duration_max;                                             /**< Maximum duration of an execution (ms) */
+    uint64_t duration_total;                                           /**< Cumulated duration of the executions (ms) */
+    uint32_t latency_histogram[MENDER_SCHEDULER_WORK_HISTOGRAM_SIZE];  /**< Histogram of the delays between the trigger and the start of the executions */
+    uint32_t duration_histogram[MENDER_SCHEDULER_WORK_HISTOGRAM_SIZE]; /**< Histogram of the durations of the executions */
+} mender_scheduler_work_stats_t;
+
 /**
  * @brief Initialization of the scheduler
  * @return MENDER_OK if the function succeeds, error code otherwise
@@ -71,8 +106,41 @@ mender_err_t mender_scheduler_work_set_period(void *handle, uint32_t period);
  */
 mender_err_t mender_scheduler_work_execute(void *handle);
 
+/**
+ * @brief Function used to execute the pending works of higher priority than the calling work
+ * @note This function is intended to be called periodically from long works, it does nothing if it is not called from a work
+ * @note The works of higher priority are executed on the stack of the calling work, so the work queue stack must be sized for the deepest calling work
+ *       plus the deepest work of higher priority; nesting is limited to one level, the function does nothing if it is called from a work it executes
+ * @note Only the nestable works are executed, the function returns as soon as the pending work of highest priority is not nestable, this work is then
+ *       left pending in the work queue
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+mender_err_t mender_scheduler_work_yield(void);
+
+/**
+ * @brief Function used to check if the deactivation of the calling work has been requested
+ * @note This function is intended to be called periodically from long works, which should then return as soon as possible to let the deactivation complete
+ * @return true if the calling work has been cancelled, false otherwise or if it is not called from a work
+ */
+bool mender_scheduler_work_is_cancelled(void);
+
+/**
+ * @brief Function used to get the calling work
+ * @return Work handle, NULL if the function is not called from a work
+ */
+void *mender_scheduler_work_get_current(void);
+
+/**
+ * @brief Function used to check if the deactivation of a work has been requested
+ * @note This function can be called from any thread, it permits to watch a work blocked in a function that doesn't permit to check the cancellation
+ * @param handle Work handle
+ * @return true if the work has been cancelled, false otherwise
+ */
+bool mender_scheduler_work_is_deactivating(void *handle);
+
 /**
  * @brief Function used to deactivate a work
+ * @note If the work is executing, it is cancelled and the function waits until it returns
  * @param handle Work handle
  * @return MENDER_OK if the function succeeds, error code otherwise
  */
@@ -85,6 +153,37 @@ mender_err_t mender_scheduler_work_deactivate(void *handle);
  */
 mender_err_t mender_scheduler_work_delete(void *handle);
 
+/**
+ * @brief Function used to retrieve the statistics of a work
+ * @note The statistics are only collected if CONFIG_MENDER_SCHEDULER_STATISTICS is enabled, the duration of an execution includes the works executed
+ *       while it yields
+ * @param handle Work handle
+ * @param stats Work statistics
+ * @param reset Reset the statistics of the work once they have been retrieved
+ * @return MENDER_OK if the function succeeds, MENDER_NOT_IMPLEMENTED if the statistics are not collected, error code otherwise
+ */
+mender_err_t mender_scheduler_work_get_stats(void *handle, mender_scheduler_work_stats_t *stats, bool reset);
+
+/**
+ * @brief Function used to create a thread of lower priority than the work queue, it is used to execute long computations without delaying the works
+ * @note The thread stack size and priority are given by CONFIG_MENDER_SCHEDULER_THREAD_STACK_SIZE and CONFIG_MENDER_SCHEDULER_THREAD_PRIORITY, the
+ *       platforms with static allocation permit a single thread at a time
+ * @param function Thread function
+ * @param arg Argument of the thread function
+ * @param name Thread name
+ * @param handle Thread handle if the function succeeds, NULL otherwise
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+mender_err_t mender_scheduler_thread_create(void (*function)(void *), void *arg, char *name, void **handle);
+
+/**
+ * @brief Function used to wait for the end of a thread and release it
+ * @note This blocks until the thread function returns, the thread can't be cancelled
+ * @param handle Thread handle
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+mender_err_t mender_scheduler_thread_join(void *handle);
+
 /**
  * @brief Function used to create a mutex
  * @param handle Mutex handle if the function succeeds, NULL otherwise
@@ -114,6 +213,19 @@ mender_err_t mender_scheduler_mutex_give(void *handle);
  */
 mender_err_t mender_scheduler_mutex_delete(void *handle);
 
+/**
+ * @brief Function used to suspend the calling thread
+ * @param delay_ms Delay (milliseconds)
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+mender_err_t mender_scheduler_delay(uint32_t delay_ms);
+
+/**
+ * @brief Function used to get the monotonic time elapsed since the start of the system
+ * @return Uptime (milliseconds), 0 if it is not supported by the platform
+ */
+int64_t mender_scheduler_get_uptime(void);
+
 /**
  * @brief Release mender scheduler
  * @return MENDER_OK if the function succeeds, error code otherwise
@@ -0,0 +1,63 @@
+/**
+ * @file      mender-sha.h
+ * @brief     Mender SHA interface
+ *
+ * Copyright joelguittet and mender-mcu-client contributors
+ * Copyright Northern.tech AS
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MENDER_SHA_H__
+#define __MENDER_SHA_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "mender-utils.h"
+
+/**
+ * @brief Size of the SHA-256 digest (bytes)
+ */
+#define MENDER_SHA256_DIGEST_SIZE (32)
+
+/**
+ * @brief Begin the computation of a SHA-256 digest
+ * @param handle Handle of the computation to be used with mender SHA-256 functions
+ * @return MENDER_OK if the function succeeds, MENDER_NOT_IMPLEMENTED if SHA-256 is not available on the platform, error code otherwise
+ */
+mender_err_t mender_sha256_begin(void **handle);
+
+/**
+ * @brief Add data to the computation of a SHA-256 digest
+ * @param handle Handle from mender_sha256_begin
+ * @param data Data to be hashed
+ * @param length Length of the data to be hashed
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+mender_err_t mender_sha256_update(void *handle, const void *data, size_t length);
+
+/**
+ * @brief End the computation of a SHA-256 digest and release the handle
+ * @param handle Handle from mender_sha256_begin
+ * @param digest Digest of the data, MENDER_SHA256_DIGEST_SIZE bytes, NULL to abort the computation
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+mender_err_t mender_sha256_end(void *handle, unsigned char *digest);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __MENDER_SHA_H__ */
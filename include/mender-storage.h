@@ -61,6 +61,28 @@ mender_err_t mender_storage_get_authentication_keys(unsigned char **private_key,
  */
 mender_err_t mender_storage_delete_authentication_keys(void);
 
+/**
+ * @brief Set authentication token
+ * @param token Authentication token to store
+ * @param expiration Expiration of the authentication token to store (seconds since epoch), 0 if unknown
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+mender_err_t mender_storage_set_authentication_token(char *token, int64_t expiration);
+
+/**
+ * @brief Get authentication token
+ * @param token Authentication token from storage, NULL if not found
+ * @param expiration Expiration of the authentication token from storage (seconds since epoch), 0 if unknown
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+mender_err_t mender_storage_get_authentication_token(char **token, int64_t *expiration);
+
+/**
+ * @brief Delete authentication token and its expiration
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+mender_err_t mender_storage_delete_authentication_token(void);
+
 /**
  * @brief Set deployment data
  * @param deployment_data Deployment data to store
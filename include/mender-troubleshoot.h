@@ -43,6 +43,7 @@ typedef struct {
 
 /**
  * @brief Mender troubleshoot callbacks
+ * @note Callbacks are not used with the troubleshoot control channel only, the remote terminal is not available
  */
 typedef struct {
     mender_err_t (*shell_begin)(uint16_t, uint16_t);  /**< Invoked when shell is connected */
@@ -62,6 +63,7 @@ mender_err_t mender_troubleshoot_init(void *config, void *callbacks);
 /**
  * @brief Activate mender troubleshoot add-on
  * @note This function connects the device to the server
+ * @note This function is invoked by the client with the troubleshoot control channel only, it should be invoked by the application otherwise
  * @return MENDER_OK if the function succeeds, error code otherwise
  */
 mender_err_t mender_troubleshoot_activate(void);
@@ -75,6 +77,7 @@ mender_err_t mender_troubleshoot_deactivate(void);
 
 /**
  * @brief Send shell data to the server
+ * @note This function returns MENDER_NOT_IMPLEMENTED with the troubleshoot control channel only
  * @param data Data to send to the server for printing in the console
  * @param length Length of data to send to the server
  * @return MENDER_OK if the function succeeds, error code otherwise
@@ -43,6 +43,7 @@ typedef enum {
     MENDER_FAIL            = -1, /**< Failure */
     MENDER_NOT_FOUND       = -2, /**< Not found */
     MENDER_NOT_IMPLEMENTED = -3, /**< Not implemented */
+    MENDER_CANCELLED       = -4, /**< Cancelled */
 } mender_err_t;
 
 /**
@@ -121,6 +122,25 @@ bool mender_utils_strbeginwith(const char *s1, const char *s2);
  */
 bool mender_utils_strendwith(const char *s1, const char *s2);
 
+/**
+ * @brief Function used to check if a buffer is filled with a single byte value
+ * @param data Buffer to be checked
+ * @param length Length of the buffer
+ * @param value Byte value to look for
+ * @return true if all the bytes of the buffer are equal to the value, false otherwise
+ */
+bool mender_utils_memisfilled(const void *data, size_t length, uint8_t value);
+
+/**
+ * @brief Function used to decode base64url data, padding is optional
+ * @param src Data to decode
+ * @param src_length Length of the data to decode
+ * @param dst Decoded data, terminated with an additional null character
+ * @param dst_length Length of the decoded data
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+mender_err_t mender_utils_base64url_decode(const char *src, size_t src_length, unsigned char **dst, size_t *dst_length);
+
 /**
  * @brief Function used to create a key-store
  * @param length Length of the key-store
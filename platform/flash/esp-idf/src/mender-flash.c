@@ -18,17 +18,76 @@
  */
 
 #include <esp_ota_ops.h>
+#if __has_include("FreeRTOS.h")
+#include <FreeRTOS.h>
+#include <semphr.h>
+#include <task.h>
+#else
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#endif /* __has_include("FreeRTOS.h") */
 #include "mender-flash.h"
 #include "mender-log.h"
 
+/**
+ * @brief Default flash erase task stack size (kB)
+ */
+#ifndef CONFIG_MENDER_FLASH_ERASE_TASK_STACK_SIZE
+#define CONFIG_MENDER_FLASH_ERASE_TASK_STACK_SIZE (3)
+#endif /* CONFIG_MENDER_FLASH_ERASE_TASK_STACK_SIZE */
+
+/**
+ * @brief Default flash erase task priority
+ */
+#ifndef CONFIG_MENDER_FLASH_ERASE_TASK_PRIORITY
+#define CONFIG_MENDER_FLASH_ERASE_TASK_PRIORITY (5)
+#endif /* CONFIG_MENDER_FLASH_ERASE_TASK_PRIORITY */
+
+/**
+ * @brief Flash sector size, the update partition is erased up to the end of the sector containing the last byte of the artifact
+ */
+#define MENDER_FLASH_SECTOR_SIZE (4 * 1024)
+
+/**
+ * @brief Flash block size, the update partition is erased by blocks so that the flash driver uses block erase commands which are faster
+ */
+#define MENDER_FLASH_BLOCK_SIZE (64 * 1024)
+
 /**
  * @brief Flash handle
  */
 typedef struct {
-    const esp_partition_t *partition;  /**< Update partition to which the firmware is flashed */
-    esp_ota_handle_t       ota_handle; /**< OTA handle used to flash the firmware */
+    const esp_partition_t *partition;      /**< Update partition to which the firmware is flashed */
+    esp_ota_handle_t       ota_handle;     /**< OTA handle used to flash the firmware */
+    size_t                 erase_size;     /**< Size of the update partition to be erased, 0 if it is erased on demand by esp_ota_write */
+    volatile size_t        erase_offset;   /**< Erase frontier, data below this offset can be written */
+    volatile bool          erase_exit;     /**< Flag used to request the erase task to terminate */
+    volatile bool          erase_done;     /**< Flag used to indicate the erase task has terminated */
+    SemaphoreHandle_t      erase_sem;      /**< Erase semaphore, given each time a block has been erased and when the erase task terminates, NULL if not used */
+    SemaphoreHandle_t      erase_exit_sem; /**< Erase exit semaphore, given by the erase task when it terminates, NULL if not used */
 } mender_flash_handle_t;
 
+/**
+ * @brief Flash erase task, erase the update partition in background while the artifact is downloaded
+ * @param arg Flash handle
+ */
+static void mender_flash_erase_task(void *arg);
+
+/**
+ * @brief Wait for the flash erase task to terminate
+ * @param handle Flash handle
+ * @param abort Request the erase task to terminate without erasing the rest of the update partition
+ * @return MENDER_OK if the update partition has been erased, error code otherwise
+ */
+static mender_err_t mender_flash_erase_wait(mender_flash_handle_t *handle, bool abort);
+
+/**
+ * @brief Release the semaphores of the flash erase task
+ * @param handle Flash handle
+ */
+static void mender_flash_erase_release(mender_flash_handle_t *handle);
+
 mender_err_t
 mender_flash_open(char *name, size_t size, void **handle) {
 
@@ -40,7 +99,7 @@ mender_flash_open(char *name, size_t size, void **handle) {
     mender_log_info("Start flashing artifact '%s' with size %d", name, size);
 
     /* Allocate memory to store the flash handle */
-    if (NULL == (*handle = malloc(sizeof(mender_flash_handle_t)))) {
+    if (NULL == (*handle = calloc(1, sizeof(mender_flash_handle_t)))) {
         mender_log_error("Unable to allocate memory");
         return MENDER_FAIL;
     }
@@ -48,7 +107,7 @@ mender_flash_open(char *name, size_t size, void **handle) {
     /* Check for the next update partition */
     if (NULL == (((mender_flash_handle_t *)(*handle))->partition = esp_ota_get_next_update_partition(NULL))) {
         mender_log_error("Unable to find next update partition");
-        return MENDER_FAIL;
+        goto FAIL;
     }
     mender_log_info("Next update partition is '%s', subtype %d at offset 0x%x and with size %d",
                     ((mender_flash_handle_t *)(*handle))->partition->label,
@@ -56,21 +115,75 @@ mender_flash_open(char *name, size_t size, void **handle) {
                     ((mender_flash_handle_t *)(*handle))->partition->address,
                     ((mender_flash_handle_t *)(*handle))->partition->size);
 
-    /* Begin OTA with sequential writes */
+    /* Check the artifact fits in the update partition */
+    if (size > ((mender_flash_handle_t *)(*handle))->partition->size) {
+        mender_log_error("Artifact is too large for the update partition");
+        goto FAIL;
+    }
+
+    /* Begin OTA with sequential writes if the size of the artifact is unknown, the update partition is erased on demand by esp_ota_write */
+    if (0 == size) {
+        if (ESP_OK
+            != (err = esp_ota_begin(
+                    ((mender_flash_handle_t *)(*handle))->partition, OTA_WITH_SEQUENTIAL_WRITES, &((mender_flash_handle_t *)(*handle))->ota_handle))) {
+            mender_log_error("esp_ota_begin failed (%s)", esp_err_to_name(err));
+            goto FAIL;
+        }
+        return MENDER_OK;
+    }
+
+    /* Begin OTA with the size of the first sector only, esp_ota_begin erases it and esp_ota_write doesn't erase on demand after that */
     if (ESP_OK
-        != (err
-            = esp_ota_begin(((mender_flash_handle_t *)(*handle))->partition, OTA_WITH_SEQUENTIAL_WRITES, &((mender_flash_handle_t *)(*handle))->ota_handle))) {
+        != (err = esp_ota_begin(
+                ((mender_flash_handle_t *)(*handle))->partition, MENDER_FLASH_SECTOR_SIZE, &((mender_flash_handle_t *)(*handle))->ota_handle))) {
         mender_log_error("esp_ota_begin failed (%s)", esp_err_to_name(err));
-        return MENDER_FAIL;
+        goto FAIL;
+    }
+    ((mender_flash_handle_t *)(*handle))->erase_size   = (size + MENDER_FLASH_SECTOR_SIZE - 1) & ~(MENDER_FLASH_SECTOR_SIZE - 1);
+    ((mender_flash_handle_t *)(*handle))->erase_offset = MENDER_FLASH_SECTOR_SIZE;
+    if (((mender_flash_handle_t *)(*handle))->erase_offset >= ((mender_flash_handle_t *)(*handle))->erase_size) {
+        return MENDER_OK;
+    }
+
+    /* Start erasing the rest of the update partition in background, writes only wait if they overtake the erase frontier */
+    if ((NULL == (((mender_flash_handle_t *)(*handle))->erase_sem = xSemaphoreCreateBinary()))
+        || (NULL == (((mender_flash_handle_t *)(*handle))->erase_exit_sem = xSemaphoreCreateBinary()))
+        || (pdPASS
+            != xTaskCreate(mender_flash_erase_task,
+                           "mender_flash",
+                           (configSTACK_DEPTH_TYPE)(CONFIG_MENDER_FLASH_ERASE_TASK_STACK_SIZE * 1024),
+                           *handle,
+                           CONFIG_MENDER_FLASH_ERASE_TASK_PRIORITY,
+                           NULL))) {
+
+        /* Erase the update partition now, esp_ota_write doesn't do it */
+        mender_log_warning("Unable to create erase task, erasing update partition");
+        mender_flash_erase_release((mender_flash_handle_t *)(*handle));
+        if (ESP_OK
+            != (err = esp_partition_erase_range(((mender_flash_handle_t *)(*handle))->partition,
+                                                ((mender_flash_handle_t *)(*handle))->erase_offset,
+                                                ((mender_flash_handle_t *)(*handle))->erase_size - ((mender_flash_handle_t *)(*handle))->erase_offset))) {
+            mender_log_error("esp_partition_erase_range failed (%s)", esp_err_to_name(err));
+            esp_ota_abort(((mender_flash_handle_t *)(*handle))->ota_handle);
+            goto FAIL;
+        }
+        ((mender_flash_handle_t *)(*handle))->erase_offset = ((mender_flash_handle_t *)(*handle))->erase_size;
     }
 
     return MENDER_OK;
+
+FAIL:
+
+    /* Release memory */
+    free(*handle);
+    *handle = NULL;
+
+    return MENDER_FAIL;
 }
 
 mender_err_t
 mender_flash_write(void *handle, void *data, size_t index, size_t length) {
 
-    (void)index;
     esp_err_t err;
 
     /* Check flash handle */
@@ -79,6 +192,17 @@ mender_flash_write(void *handle, void *data, size_t index, size_t length) {
         return MENDER_FAIL;
     }
 
+    /* Wait for the erase task if the data overtake the erase frontier, esp_ota_write writes the data at the index */
+    if (NULL != ((mender_flash_handle_t *)handle)->erase_sem) {
+        while ((((mender_flash_handle_t *)handle)->erase_offset < index + length) && (false == ((mender_flash_handle_t *)handle)->erase_done)) {
+            xSemaphoreTake(((mender_flash_handle_t *)handle)->erase_sem, portMAX_DELAY);
+        }
+        if (((mender_flash_handle_t *)handle)->erase_offset < index + length) {
+            mender_log_error("Unable to erase update partition");
+            return MENDER_FAIL;
+        }
+    }
+
     /* Write data received to the update partition */
     if (ESP_OK != (err = esp_ota_write(((mender_flash_handle_t *)handle)->ota_handle, data, length))) {
         mender_log_error("esp_ota_write failed (%s)", esp_err_to_name(err));
@@ -94,6 +218,9 @@ mender_flash_abort_deployment(void *handle) {
     /* Check flash handle */
     if (NULL != handle) {
 
+        /* Stop erasing the update partition */
+        mender_flash_erase_wait((mender_flash_handle_t *)handle, true);
+
         /* Abort current deployment */
         esp_ota_abort(((mender_flash_handle_t *)handle)->ota_handle);
 
@@ -115,6 +242,12 @@ mender_flash_close(void *handle) {
         return MENDER_FAIL;
     }
 
+    /* Wait for the erase task to terminate */
+    if (MENDER_OK != mender_flash_erase_wait((mender_flash_handle_t *)handle, false)) {
+        mender_log_error("Unable to erase update partition");
+        return MENDER_FAIL;
+    }
+
     /* Ending current deployment */
     if (ESP_OK != (err = esp_ota_end(((mender_flash_handle_t *)handle)->ota_handle))) {
         if (ESP_ERR_OTA_VALIDATE_FAILED == err) {
@@ -181,3 +314,77 @@ mender_flash_is_image_confirmed(void) {
     /* Check if the image is still pending */
     return (ESP_OTA_IMG_VALID == img_state);
 }
+
+static void
+mender_flash_erase_task(void *arg) {
+
+    assert(NULL != arg);
+    mender_flash_handle_t *handle = (mender_flash_handle_t *)arg;
+    size_t                 offset = handle->erase_offset;
+    size_t                 length;
+    esp_err_t              err;
+
+    /* Erase the update partition by blocks until the end of the artifact, or until the task is requested to terminate */
+    while ((offset < handle->erase_size) && (false == handle->erase_exit)) {
+        length = MENDER_FLASH_BLOCK_SIZE - (offset % MENDER_FLASH_BLOCK_SIZE);
+        length = (length < handle->erase_size - offset) ? length : (handle->erase_size - offset);
+        if (ESP_OK != (err = esp_partition_erase_range(handle->partition, offset, length))) {
+            mender_log_error("esp_partition_erase_range failed (%s)", esp_err_to_name(err));
+            break;
+        }
+        offset += length;
+
+        /* Move the erase frontier and wake up the writer */
+        handle->erase_offset = offset;
+        xSemaphoreGive(handle->erase_sem);
+    }
+
+    /* Indicate the task has terminated and wake up the writer */
+    handle->erase_done = true;
+    xSemaphoreGive(handle->erase_sem);
+
+    /* Release the waiter, the handle must not be used after this point */
+    xSemaphoreGive(handle->erase_exit_sem);
+
+    /* Delete the task */
+    vTaskDelete(NULL);
+}
+
+static mender_err_t
+mender_flash_erase_wait(mender_flash_handle_t *handle, bool abort) {
+
+    assert(NULL != handle);
+
+    mender_err_t ret;
+
+    /* Check if the erase task is used */
+    if (NULL == handle->erase_exit_sem) {
+        return MENDER_OK;
+    }
+
+    /* Wait for the erase task to terminate */
+    handle->erase_exit = abort;
+    xSemaphoreTake(handle->erase_exit_sem, portMAX_DELAY);
+    ret = (handle->erase_offset < handle->erase_size) ? MENDER_FAIL : MENDER_OK;
+
+    /* Release memory */
+    mender_flash_erase_release(handle);
+
+    return ret;
+}
+
+static void
+mender_flash_erase_release(mender_flash_handle_t *handle) {
+
+    assert(NULL != handle);
+
+    /* Release memory */
+    if (NULL != handle->erase_sem) {
+        vSemaphoreDelete(handle->erase_sem);
+        handle->erase_sem = NULL;
+    }
+    if (NULL != handle->erase_exit_sem) {
+        vSemaphoreDelete(handle->erase_exit_sem);
+        handle->erase_exit_sem = NULL;
+    }
+}
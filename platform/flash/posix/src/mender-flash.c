@@ -17,6 +17,10 @@
  * limitations under the License.
  */
 
+#ifdef CONFIG_MENDER_FLASH_SPARSE_WRITES
+#define _GNU_SOURCE
+#include <fcntl.h>
+#endif /* CONFIG_MENDER_FLASH_SPARSE_WRITES */
 #include <errno.h>
 #include <unistd.h>
 #include "mender-flash.h"
@@ -34,50 +38,169 @@
  */
 #define MENDER_FLASH_REQUEST_UPGRADE CONFIG_MENDER_FLASH_PATH "request_upgrade"
 
+/**
+ * @brief Flash handle
+ */
+typedef struct {
+    FILE *file; /**< Update file, NULL once it is closed */
+#ifdef CONFIG_MENDER_FLASH_SPARSE_WRITES
+    size_t         size;          /**< Size of the artifact, the update file is truncated to this size when it is closed */
+    size_t         current_size;  /**< Size of the update file before the deployment, data are compared to its content */
+    unsigned char *buffer;        /**< Buffer used to read the current content of the update file */
+    size_t         buffer_length; /**< Length of the buffer */
+    size_t         unchanged;     /**< Number of bytes skipped because they are unchanged */
+    size_t         sparse;        /**< Number of zero-filled bytes skipped or deallocated from the update file */
+#endif /* CONFIG_MENDER_FLASH_SPARSE_WRITES */
+} mender_flash_handle_t;
+
+/**
+ * @brief Last flash handle opened, the handle remains allocated after it is closed because it is used to set the pending image
+ * @note Artifacts with several files open several handles, the previous one is released when the next one is opened
+ */
+static mender_flash_handle_t *mender_flash_handle = NULL;
+
+/**
+ * @brief Release flash handle, the update file is closed if it is still opened
+ * @param handle Flash handle
+ */
+static void mender_flash_release(mender_flash_handle_t *handle);
+
+#ifdef CONFIG_MENDER_FLASH_SPARSE_WRITES
+
+/**
+ * @brief Check if data are unchanged compared to the current content of the update file
+ * @param handle Flash handle
+ * @param data Data to be written
+ * @param index Index of the data to be written
+ * @param length Length of the data to be written
+ * @return true if the data are unchanged, false otherwise
+ */
+static bool mender_flash_is_unchanged(mender_flash_handle_t *handle, void *data, size_t index, size_t length);
+
+#endif /* CONFIG_MENDER_FLASH_SPARSE_WRITES */
+
 mender_err_t
 mender_flash_open(char *name, size_t size, void **handle) {
 
     assert(NULL != name);
     assert(NULL != handle);
     char *path = NULL;
+#ifdef CONFIG_MENDER_FLASH_SPARSE_WRITES
+    long current_size;
+#endif /* CONFIG_MENDER_FLASH_SPARSE_WRITES */
 
     /* Print current file name and size */
     mender_log_info("Start flashing artifact '%s' with size %d", name, size);
 
+    /* Release the handle of the previous file of the artifact if any */
+    mender_flash_release(mender_flash_handle);
+    mender_flash_handle = NULL;
+
+    /* Allocate memory to store the flash handle */
+    if (NULL == (*handle = calloc(1, sizeof(mender_flash_handle_t)))) {
+        mender_log_error("Unable to allocate memory");
+        return MENDER_FAIL;
+    }
+
     /* Compute path */
     size_t str_length = strlen(CONFIG_MENDER_FLASH_PATH) + strlen(name) + 1;
     if (NULL == (path = (char *)malloc(str_length))) {
         mender_log_error("Unable to allocate memory");
+        free(*handle);
+        *handle = NULL;
         return MENDER_FAIL;
     }
     snprintf(path, str_length, "%s%s", CONFIG_MENDER_FLASH_PATH, name);
 
+#ifdef CONFIG_MENDER_FLASH_SPARSE_WRITES
+
+    /* Begin deployment on top of the current update file, so that unchanged data are not written again */
+    ((mender_flash_handle_t *)(*handle))->size = size;
+    if (NULL != (((mender_flash_handle_t *)(*handle))->file = fopen(path, "r+b"))) {
+        if ((0 == fseek(((mender_flash_handle_t *)(*handle))->file, 0, SEEK_END))
+            && (0 < (current_size = ftell(((mender_flash_handle_t *)(*handle))->file)))) {
+            ((mender_flash_handle_t *)(*handle))->current_size = (size_t)current_size;
+        }
+    } else if (NULL == (((mender_flash_handle_t *)(*handle))->file = fopen(path, "w+b"))) {
+        mender_log_error("fopen failed (%d)", errno);
+        free(path);
+        free(*handle);
+        *handle = NULL;
+        return MENDER_FAIL;
+    }
+
+#else
+
     /* Begin deployment with sequential writes */
-    if (NULL == (*handle = fopen(path, "wb"))) {
+    if (NULL == (((mender_flash_handle_t *)(*handle))->file = fopen(path, "wb"))) {
         mender_log_error("fopen failed (%d)", errno);
         free(path);
+        free(*handle);
+        *handle = NULL;
         return MENDER_FAIL;
     }
 
+#endif /* CONFIG_MENDER_FLASH_SPARSE_WRITES */
+
     /* Release memory */
     free(path);
 
+    /* Save the handle so that it is released even if the deployment is not completed */
+    mender_flash_handle = (mender_flash_handle_t *)(*handle);
+
     return MENDER_OK;
 }
 
 mender_err_t
 mender_flash_write(void *handle, void *data, size_t index, size_t length) {
 
-    (void)index;
-
     /* Check flash handle */
-    if (NULL == handle) {
+    if ((NULL == handle) || (NULL == ((mender_flash_handle_t *)handle)->file)) {
         mender_log_error("Invalid flash handle");
         return MENDER_FAIL;
     }
 
+#ifdef CONFIG_MENDER_FLASH_SPARSE_WRITES
+
+    /* Skip data unchanged compared to the current content of the update file */
+    if (true == mender_flash_is_unchanged((mender_flash_handle_t *)handle, data, index, length)) {
+        ((mender_flash_handle_t *)handle)->unchanged += length;
+        return MENDER_OK;
+    }
+
+    /* Skip zero-filled data, they are holes of the update file */
+    if (true == mender_utils_memisfilled(data, length, 0)) {
+        if (index >= ((mender_flash_handle_t *)handle)->current_size) {
+            /* Data beyond the current end of the file, it is extended when the file is closed or when the next data are written */
+            ((mender_flash_handle_t *)handle)->sparse += length;
+            return MENDER_OK;
+        }
+#ifdef FALLOC_FL_PUNCH_HOLE
+        /* Data inside the file, deallocate the range, the data are written if this is not supported by the file system */
+        if (index + length <= ((mender_flash_handle_t *)handle)->current_size) {
+            fflush(((mender_flash_handle_t *)handle)->file);
+            if (0 == fallocate(fileno(((mender_flash_handle_t *)handle)->file), FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, (off_t)index, (off_t)length)) {
+                ((mender_flash_handle_t *)handle)->sparse += length;
+                return MENDER_OK;
+            }
+        }
+#endif /* FALLOC_FL_PUNCH_HOLE */
+    }
+
+    /* Move to the index of the data, previous data may have been skipped */
+    if (0 != fseek(((mender_flash_handle_t *)handle)->file, (long)index, SEEK_SET)) {
+        mender_log_error("fseek failed (%d)", errno);
+        return MENDER_FAIL;
+    }
+
+#else
+
+    (void)index;
+
+#endif /* CONFIG_MENDER_FLASH_SPARSE_WRITES */
+
     /* Write data received to the update file */
-    if (fwrite(data, sizeof(unsigned char), length, handle) != length) {
+    if (fwrite(data, sizeof(unsigned char), length, ((mender_flash_handle_t *)handle)->file) != length) {
         mender_log_error("fwrite failed (%d)", length);
         return MENDER_FAIL;
     }
@@ -88,16 +211,37 @@ mender_flash_write(void *handle, void *data, size_t index, size_t length) {
 mender_err_t
 mender_flash_close(void *handle) {
 
+    mender_err_t ret = MENDER_OK;
+
     /* Check flash handle */
-    if (NULL == handle) {
+    if ((NULL == handle) || (NULL == ((mender_flash_handle_t *)handle)->file)) {
         mender_log_error("Invalid flash handle");
         return MENDER_FAIL;
     }
 
+#ifdef CONFIG_MENDER_FLASH_SPARSE_WRITES
+
+    /* Set the size of the update file, the trailing zero-filled data are a hole and the previous content beyond the artifact is removed */
+    fflush(((mender_flash_handle_t *)handle)->file);
+    if (0 != ftruncate(fileno(((mender_flash_handle_t *)handle)->file), (off_t)((mender_flash_handle_t *)handle)->size)) {
+        mender_log_error("ftruncate failed (%d)", errno);
+        ret = MENDER_FAIL;
+    }
+    mender_log_info("Flashing skipped %u bytes unchanged and %u bytes zero-filled",
+                    (unsigned int)((mender_flash_handle_t *)handle)->unchanged,
+                    (unsigned int)((mender_flash_handle_t *)handle)->sparse);
+
+    /* Release memory */
+    free(((mender_flash_handle_t *)handle)->buffer);
+    ((mender_flash_handle_t *)handle)->buffer = NULL;
+
+#endif /* CONFIG_MENDER_FLASH_SPARSE_WRITES */
+
     /* Close update file */
-    fclose(handle);
+    fclose(((mender_flash_handle_t *)handle)->file);
+    ((mender_flash_handle_t *)handle)->file = NULL;
 
-    return MENDER_OK;
+    return ret;
 }
 
 mender_err_t
@@ -116,6 +260,12 @@ mender_flash_set_pending_image(void *handle) {
         } else {
             fclose(file);
         }
+
+        /* Release memory */
+        mender_flash_release((mender_flash_handle_t *)handle);
+        if (mender_flash_handle == handle) {
+            mender_flash_handle = NULL;
+        }
     }
 
     return ret;
@@ -128,7 +278,10 @@ mender_flash_abort_deployment(void *handle) {
     if (NULL != handle) {
 
         /* Release memory */
-        fclose(handle);
+        mender_flash_release((mender_flash_handle_t *)handle);
+        if (mender_flash_handle == handle) {
+            mender_flash_handle = NULL;
+        }
     }
 
     return MENDER_OK;
@@ -159,3 +312,53 @@ mender_flash_is_image_confirmed(void) {
     /* Check if the image it still pending */
     return (0 != access(MENDER_FLASH_REQUEST_UPGRADE, F_OK));
 }
+
+static void
+mender_flash_release(mender_flash_handle_t *handle) {
+
+    /* Check flash handle */
+    if (NULL != handle) {
+
+        /* Close update file if it is still opened */
+        if (NULL != handle->file) {
+            fclose(handle->file);
+        }
+
+        /* Release memory */
+#ifdef CONFIG_MENDER_FLASH_SPARSE_WRITES
+        free(handle->buffer);
+#endif /* CONFIG_MENDER_FLASH_SPARSE_WRITES */
+        free(handle);
+    }
+}
+
+#ifdef CONFIG_MENDER_FLASH_SPARSE_WRITES
+
+static bool
+mender_flash_is_unchanged(mender_flash_handle_t *handle, void *data, size_t index, size_t length) {
+
+    assert(NULL != handle);
+    unsigned char *tmp;
+
+    /* Check if the data are inside the current update file */
+    if (index + length > handle->current_size) {
+        return false;
+    }
+
+    /* Read the current content of the update file */
+    if (handle->buffer_length < length) {
+        if (NULL == (tmp = (unsigned char *)realloc(handle->buffer, length))) {
+            return false;
+        }
+        handle->buffer        = tmp;
+        handle->buffer_length = length;
+    }
+    if ((0 != fseek(handle->file, (long)index, SEEK_SET)) || (fread(handle->buffer, sizeof(unsigned char), length, handle->file) != length)) {
+        return false;
+    }
+
+    /* Compare with the data to be written */
+    return (0 == memcmp(handle->buffer, data, length));
+}
+
+#endif /* CONFIG_MENDER_FLASH_SPARSE_WRITES */
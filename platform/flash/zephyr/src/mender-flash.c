@@ -19,10 +19,90 @@
 
 #include <zephyr/dfu/flash_img.h>
 #include <zephyr/dfu/mcuboot.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
 #include <zephyr/sys/reboot.h>
 #include "mender-flash.h"
 #include "mender-log.h"
 
+#ifdef CONFIG_MENDER_FLASH_ERASE_IN_BACKGROUND
+
+/**
+ * @brief Default flash erase thread stack size (kB)
+ */
+#ifndef CONFIG_MENDER_FLASH_ERASE_THREAD_STACK_SIZE
+#define CONFIG_MENDER_FLASH_ERASE_THREAD_STACK_SIZE (2)
+#endif /* CONFIG_MENDER_FLASH_ERASE_THREAD_STACK_SIZE */
+
+/**
+ * @brief Default flash erase thread priority
+ */
+#ifndef CONFIG_MENDER_FLASH_ERASE_THREAD_PRIORITY
+#define CONFIG_MENDER_FLASH_ERASE_THREAD_PRIORITY (5)
+#endif /* CONFIG_MENDER_FLASH_ERASE_THREAD_PRIORITY */
+
+#endif /* CONFIG_MENDER_FLASH_ERASE_IN_BACKGROUND */
+
+/**
+ * @brief Flash handle
+ */
+typedef struct {
+    struct flash_img_context ctx; /**< Flash image context used to flash the firmware */
+#ifdef CONFIG_MENDER_FLASH_ERASE_IN_BACKGROUND
+    size_t          erase_size;   /**< Size of the update slot erased by the erase thread */
+    volatile size_t erase_offset; /**< Erase frontier, data below this offset can be written */
+    volatile bool   erase_exit;   /**< Flag used to request the erase thread to terminate */
+    volatile bool   erase_done;   /**< Flag used to indicate the erase thread has terminated */
+    mender_err_t    erase_ret;    /**< Result of the erase thread, including the erase of the image trailer */
+    struct k_sem    erase_sem;    /**< Erase semaphore, given each time a page has been erased and when the erase thread terminates */
+#endif /* CONFIG_MENDER_FLASH_ERASE_IN_BACKGROUND */
+} mender_flash_handle_t;
+
+#ifdef CONFIG_MENDER_FLASH_ERASE_IN_BACKGROUND
+
+/**
+ * @brief Mender flash erase thread stack
+ */
+K_THREAD_STACK_DEFINE(mender_flash_erase_thread_stack, CONFIG_MENDER_FLASH_ERASE_THREAD_STACK_SIZE * 1024);
+
+/**
+ * @brief Mender flash erase thread handle
+ */
+static struct k_thread mender_flash_erase_thread_handle;
+
+/**
+ * @brief Flag used to indicate the flash erase thread has been started and must be joined
+ */
+static bool mender_flash_erase_started = false;
+
+/**
+ * @brief Flash erase thread, erase the update slot in background while the artifact is downloaded
+ * @param p1 Flash handle
+ * @param p2 Not used
+ * @param p3 Not used
+ */
+static void mender_flash_erase_thread(void *p1, void *p2, void *p3);
+
+/**
+ * @brief Erase the page of the update slot containing the offset, up to the end of the page
+ * @param fa Flash area of the update slot
+ * @param offset Offset in the update slot
+ * @param length Length erased, from the offset to the end of the page
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_flash_erase_page(const struct flash_area *fa, size_t offset, size_t *length);
+
+/**
+ * @brief Wait for the flash erase thread to terminate
+ * @param handle Flash handle
+ * @param abort Request the erase thread to terminate without erasing the rest of the update slot
+ * @return MENDER_OK if the update slot has been erased, error code otherwise
+ */
+static mender_err_t mender_flash_erase_wait(mender_flash_handle_t *handle, bool abort);
+
+#endif /* CONFIG_MENDER_FLASH_ERASE_IN_BACKGROUND */
+
 mender_err_t
 mender_flash_open(char *name, size_t size, void **handle) {
 
@@ -34,24 +114,57 @@ mender_flash_open(char *name, size_t size, void **handle) {
     mender_log_info("Start flashing artifact '%s' with size %d", name, size);
 
     /* Allocate memory to store the flash handle */
-    if (NULL == (*handle = malloc(sizeof(struct flash_img_context)))) {
+    if (NULL == (*handle = calloc(1, sizeof(mender_flash_handle_t)))) {
         mender_log_error("Unable to allocate memory");
         return MENDER_FAIL;
     }
 
     /* Begin deployment with sequential writes */
-    if ((result = flash_img_init((struct flash_img_context *)*handle)) < 0) {
+    if ((result = flash_img_init(&((mender_flash_handle_t *)(*handle))->ctx)) < 0) {
         mender_log_error("flash_img_init failed (%d)", result);
-        return MENDER_FAIL;
+        goto FAIL;
+    }
+
+#ifdef CONFIG_MENDER_FLASH_ERASE_IN_BACKGROUND
+
+    /* Check the artifact fits in the update slot */
+    if (size > ((mender_flash_handle_t *)(*handle))->ctx.flash_area->fa_size) {
+        mender_log_error("Artifact is too large for the update slot");
+        goto FAIL;
     }
 
+    /* Start erasing the update slot in background, writes only wait if they overtake the erase frontier */
+    ((mender_flash_handle_t *)(*handle))->erase_size = size;
+    k_sem_init(&((mender_flash_handle_t *)(*handle))->erase_sem, 0, 1);
+    k_thread_create(&mender_flash_erase_thread_handle,
+                    mender_flash_erase_thread_stack,
+                    CONFIG_MENDER_FLASH_ERASE_THREAD_STACK_SIZE * 1024,
+                    mender_flash_erase_thread,
+                    *handle,
+                    NULL,
+                    NULL,
+                    CONFIG_MENDER_FLASH_ERASE_THREAD_PRIORITY,
+                    0,
+                    K_NO_WAIT);
+    k_thread_name_set(&mender_flash_erase_thread_handle, "mender_flash");
+    mender_flash_erase_started = true;
+
+#endif /* CONFIG_MENDER_FLASH_ERASE_IN_BACKGROUND */
+
     return MENDER_OK;
+
+FAIL:
+
+    /* Release memory */
+    free(*handle);
+    *handle = NULL;
+
+    return MENDER_FAIL;
 }
 
 mender_err_t
 mender_flash_write(void *handle, void *data, size_t index, size_t length) {
 
-    (void)index;
     int result;
 
     /* Check flash handle */
@@ -60,8 +173,25 @@ mender_flash_write(void *handle, void *data, size_t index, size_t length) {
         return MENDER_FAIL;
     }
 
+#ifdef CONFIG_MENDER_FLASH_ERASE_IN_BACKGROUND
+
+    /* Wait for the erase thread if the data overtake the erase frontier */
+    while ((((mender_flash_handle_t *)handle)->erase_offset < index + length) && (false == ((mender_flash_handle_t *)handle)->erase_done)) {
+        k_sem_take(&((mender_flash_handle_t *)handle)->erase_sem, K_FOREVER);
+    }
+    if (((mender_flash_handle_t *)handle)->erase_offset < index + length) {
+        mender_log_error("Unable to erase update slot");
+        return MENDER_FAIL;
+    }
+
+#else
+
+    (void)index;
+
+#endif /* CONFIG_MENDER_FLASH_ERASE_IN_BACKGROUND */
+
     /* Write data received to the update partition */
-    if ((result = flash_img_buffered_write((struct flash_img_context *)handle, (const uint8_t *)data, length, false)) < 0) {
+    if ((result = flash_img_buffered_write(&((mender_flash_handle_t *)handle)->ctx, (const uint8_t *)data, length, false)) < 0) {
         mender_log_error("flash_img_buffered_write failed (%d)", result);
         return MENDER_FAIL;
     }
@@ -80,8 +210,18 @@ mender_flash_close(void *handle) {
         return MENDER_FAIL;
     }
 
+#ifdef CONFIG_MENDER_FLASH_ERASE_IN_BACKGROUND
+
+    /* Wait for the erase thread to terminate, the image trailer is erased last */
+    if (MENDER_OK != mender_flash_erase_wait((mender_flash_handle_t *)handle, false)) {
+        mender_log_error("Unable to erase update slot");
+        return MENDER_FAIL;
+    }
+
+#endif /* CONFIG_MENDER_FLASH_ERASE_IN_BACKGROUND */
+
     /* Flush data received to the update partition */
-    if ((result = flash_img_buffered_write((struct flash_img_context *)handle, NULL, 0, true)) < 0) {
+    if ((result = flash_img_buffered_write(&((mender_flash_handle_t *)handle)->ctx, NULL, 0, true)) < 0) {
         mender_log_error("flash_img_buffered_write failed (%d)", result);
         return MENDER_FAIL;
     }
@@ -116,6 +256,13 @@ mender_flash_abort_deployment(void *handle) {
     /* Check flash handle */
     if (NULL != handle) {
 
+#ifdef CONFIG_MENDER_FLASH_ERASE_IN_BACKGROUND
+
+        /* Stop erasing the update slot */
+        mender_flash_erase_wait((mender_flash_handle_t *)handle, true);
+
+#endif /* CONFIG_MENDER_FLASH_ERASE_IN_BACKGROUND */
+
         /* Release memory */
         free(handle);
     }
@@ -148,3 +295,91 @@ mender_flash_is_image_confirmed(void) {
     /* Check if the image it still pending */
     return boot_is_img_confirmed();
 }
+
+#ifdef CONFIG_MENDER_FLASH_ERASE_IN_BACKGROUND
+
+static void
+mender_flash_erase_thread(void *p1, void *p2, void *p3) {
+
+    assert(NULL != p1);
+    (void)p2;
+    (void)p3;
+    mender_flash_handle_t   *handle = (mender_flash_handle_t *)p1;
+    const struct flash_area *fa     = handle->ctx.flash_area;
+    size_t                   offset = 0;
+    size_t                   length;
+
+    /* Erase the update slot page by page until the end of the artifact, or until the thread is requested to terminate */
+    handle->erase_ret = MENDER_OK;
+    while ((offset < handle->erase_size) && (false == handle->erase_exit)) {
+        if (MENDER_OK != (handle->erase_ret = mender_flash_erase_page(fa, offset, &length))) {
+            break;
+        }
+        offset += length;
+
+        /* Move the erase frontier and wake up the writer */
+        handle->erase_offset = offset;
+        k_sem_give(&handle->erase_sem);
+    }
+
+    /* Erase the image trailer if it is beyond the artifact, MCUboot requires it to be erased to request the upgrade */
+    if ((MENDER_OK == handle->erase_ret) && (false == handle->erase_exit)) {
+        offset = MAX(boot_get_trailer_status_offset(fa->fa_size), offset);
+        while ((MENDER_OK == handle->erase_ret) && (offset < fa->fa_size)) {
+            if (MENDER_OK == (handle->erase_ret = mender_flash_erase_page(fa, offset, &length))) {
+                offset += length;
+            }
+        }
+    }
+    if (true == handle->erase_exit) {
+        handle->erase_ret = MENDER_FAIL;
+    }
+
+    /* Indicate the thread has terminated and wake up the writer */
+    handle->erase_done = true;
+    k_sem_give(&handle->erase_sem);
+}
+
+static mender_err_t
+mender_flash_erase_page(const struct flash_area *fa, size_t offset, size_t *length) {
+
+    assert(NULL != fa);
+    assert(NULL != length);
+    struct flash_pages_info info;
+    int                     result;
+
+    /* Retrieve the page containing the offset, page offsets are relative to the flash device */
+    if ((result = flash_get_page_info_by_offs(flash_area_get_device(fa), fa->fa_off + offset, &info)) < 0) {
+        mender_log_error("flash_get_page_info_by_offs failed (%d)", result);
+        return MENDER_FAIL;
+    }
+    *length = info.start_offset + info.size - (fa->fa_off + offset);
+
+    /* Erase up to the end of the page */
+    if ((result = flash_area_erase(fa, offset, *length)) < 0) {
+        mender_log_error("flash_area_erase failed (%d)", result);
+        return MENDER_FAIL;
+    }
+
+    return MENDER_OK;
+}
+
+static mender_err_t
+mender_flash_erase_wait(mender_flash_handle_t *handle, bool abort) {
+
+    assert(NULL != handle);
+
+    /* Check if the erase thread has been started */
+    if (false == mender_flash_erase_started) {
+        return MENDER_OK;
+    }
+
+    /* Wait for the erase thread to terminate */
+    handle->erase_exit = abort;
+    k_thread_join(&mender_flash_erase_thread_handle, K_FOREVER);
+    mender_flash_erase_started = false;
+
+    return handle->erase_ret;
+}
+
+#endif /* CONFIG_MENDER_FLASH_ERASE_IN_BACKGROUND */
@@ -18,10 +18,21 @@
  */
 
 #include <errno.h>
+#include <strings.h>
 #include <esp_http_client.h>
 #include <esp_crt_bundle.h>
+#if __has_include("FreeRTOS.h")
+#include <FreeRTOS.h>
+#include <semphr.h>
+#include <task.h>
+#else
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#endif /* __has_include("FreeRTOS.h") */
 #include "mender-http.h"
 #include "mender-log.h"
+#include "mender-scheduler.h"
 #include "mender-utils.h"
 
 /**
@@ -34,11 +45,82 @@
  */
 #define MENDER_HTTP_RECV_BUF_LENGTH (512)
 
+/**
+ * @brief Default HTTP event loop task stack size (kB)
+ */
+#ifndef CONFIG_MENDER_HTTP_EVENT_LOOP_TASK_STACK_SIZE
+#define CONFIG_MENDER_HTTP_EVENT_LOOP_TASK_STACK_SIZE (8)
+#endif /* CONFIG_MENDER_HTTP_EVENT_LOOP_TASK_STACK_SIZE */
+
+/**
+ * @brief Default HTTP event loop task priority
+ */
+#ifndef CONFIG_MENDER_HTTP_EVENT_LOOP_TASK_PRIORITY
+#define CONFIG_MENDER_HTTP_EVENT_LOOP_TASK_PRIORITY (5)
+#endif /* CONFIG_MENDER_HTTP_EVENT_LOOP_TASK_PRIORITY */
+
+/**
+ * @brief Default HTTP event loop poll interval (milliseconds)
+ */
+#ifndef CONFIG_MENDER_HTTP_EVENT_LOOP_POLL_INTERVAL
+#define CONFIG_MENDER_HTTP_EVENT_LOOP_POLL_INTERVAL (10)
+#endif /* CONFIG_MENDER_HTTP_EVENT_LOOP_POLL_INTERVAL */
+
+/**
+ * @brief Asynchronous request
+ */
+typedef struct mender_http_async_request_s {
+    esp_http_client_handle_t client;  /**< HTTP client of the request */
+    char                    *url;     /**< URL of the request, NULL if the path is already an URL */
+    char                    *bearer;  /**< Authorization header, NULL if not used */
+    char                    *payload; /**< Payload of the request, NULL if empty */
+    mender_err_t (*callback)(mender_http_client_event_t, void *, size_t, void *); /**< Callback invoked on HTTP events */
+    void (*done)(mender_err_t, int, void *);                                      /**< Callback invoked when the request is completed */
+    void                               *params; /**< Parameters passed to the callbacks, NULL if not used */
+    mender_err_t                        ret;    /**< Last callback return value */
+    struct mender_http_async_request_s *next;   /**< Next request of the list */
+} mender_http_async_request_t;
+
 /**
  * @brief Mender HTTP configuration
  */
 static mender_http_config_t mender_http_config;
 
+/**
+ * @brief HTTP event loop task handle
+ */
+static TaskHandle_t mender_http_event_loop_task_handle = NULL;
+
+/**
+ * @brief Flag used to request the HTTP event loop task to terminate
+ */
+static bool mender_http_event_loop_exit = false;
+
+/**
+ * @brief HTTP event loop mutex, used to protect the list of pending requests and the event loop state
+ */
+static SemaphoreHandle_t mender_http_event_loop_mutex = NULL;
+
+/**
+ * @brief HTTP event loop semaphore, used to wake up the event loop when it is idle
+ */
+static SemaphoreHandle_t mender_http_event_loop_sem = NULL;
+
+/**
+ * @brief HTTP event loop exit semaphore, given by the event loop task when it terminates
+ */
+static SemaphoreHandle_t mender_http_event_loop_exit_sem = NULL;
+
+/**
+ * @brief Asynchronous requests waiting to be started by the event loop
+ */
+static mender_http_async_request_t *mender_http_pending_requests = NULL;
+
+/**
+ * @brief Delay requested by the server with the Retry-After header of the last response (seconds)
+ */
+static uint32_t mender_http_retry_after = 0;
+
 /**
  * @brief Convert mender HTTP method to ESP HTTP client method
  * @param method Mender HTTP method
@@ -46,6 +128,39 @@ static mender_http_config_t mender_http_config;
  */
 static esp_http_client_method_t mender_http_method_to_esp_http_client_method(mender_http_method_t method);
 
+/**
+ * @brief HTTP event loop task, used to perform asynchronous requests
+ * @param arg Not used
+ */
+static void mender_http_event_loop_task(void *arg);
+
+/**
+ * @brief HTTP client event handler of synchronous requests, used to read the Retry-After header
+ * @param evt HTTP client event
+ * @return ESP_OK if the function succeeds, error code otherwise
+ */
+static esp_err_t mender_http_event_handler(esp_http_client_event_t *evt);
+
+/**
+ * @brief HTTP client event handler of asynchronous requests
+ * @param evt HTTP client event
+ * @return ESP_OK if the function succeeds, error code otherwise
+ */
+static esp_err_t mender_http_async_event_handler(esp_http_client_event_t *evt);
+
+/**
+ * @brief Complete asynchronous request, invoke the callbacks and release memory
+ * @param request Asynchronous request
+ * @param err Result of the request
+ */
+static void mender_http_async_request_complete(mender_http_async_request_t *request, esp_err_t err);
+
+/**
+ * @brief Release asynchronous request
+ * @param request Asynchronous request
+ */
+static void mender_http_async_request_release(mender_http_async_request_t *request);
+
 mender_err_t
 mender_http_init(mender_http_config_t *config) {
 
@@ -55,6 +170,20 @@ mender_http_init(mender_http_config_t *config) {
     /* Save configuration */
     memcpy(&mender_http_config, config, sizeof(mender_http_config_t));
 
+    /* Create event loop mutex and semaphores */
+    if (NULL == (mender_http_event_loop_mutex = xSemaphoreCreateMutex())) {
+        mender_log_error("Unable to create event loop mutex");
+        return MENDER_FAIL;
+    }
+    if (NULL == (mender_http_event_loop_sem = xSemaphoreCreateBinary())) {
+        mender_log_error("Unable to create event loop semaphore");
+        return MENDER_FAIL;
+    }
+    if (NULL == (mender_http_event_loop_exit_sem = xSemaphoreCreateBinary())) {
+        mender_log_error("Unable to create event loop semaphore");
+        return MENDER_FAIL;
+    }
+
     return MENDER_OK;
 }
 
@@ -89,8 +218,14 @@ mender_http_perform(char                *jwt,
     }
 
     /* Configuration of the client */
-    esp_http_client_config_t config
-        = { .url = (NULL != url) ? url : path, .user_agent = MENDER_HTTP_USER_AGENT, .crt_bundle_attach = esp_crt_bundle_attach, .buffer_size_tx = 2048 };
+    esp_http_client_config_t config = { .url               = (NULL != url) ? url : path,
+                                        .user_agent        = MENDER_HTTP_USER_AGENT,
+                                        .crt_bundle_attach = esp_crt_bundle_attach,
+                                        .buffer_size_tx    = 2048,
+                                        .event_handler     = mender_http_event_handler };
+
+    /* Forget the Retry-After header of the previous response */
+    mender_http_retry_after = 0;
 
     /* Initialization of the client */
     if (NULL == (client = esp_http_client_init(&config))) {
@@ -146,6 +281,14 @@ mender_http_perform(char                *jwt,
     /* Read data until all have been received */
     do {
 
+        /* Stop reading if the work performing the request has been cancelled, reading is bounded by the timeout of the client */
+        if (true == mender_scheduler_work_is_cancelled()) {
+            mender_log_warning("HTTP request cancelled");
+            callback(MENDER_HTTP_EVENT_ERROR, NULL, 0, params);
+            ret = MENDER_CANCELLED;
+            goto END;
+        }
+
         char data[MENDER_HTTP_RECV_BUF_LENGTH];
         int  read_length = esp_http_client_read(client, data, sizeof(data));
         if (read_length < 0) {
@@ -192,10 +335,174 @@ END:
     return ret;
 }
 
+mender_err_t
+mender_http_perform_async(char                *jwt,
+                          char                *path,
+                          mender_http_method_t method,
+                          char                *payload,
+                          char                *signature,
+                          mender_err_t (*callback)(mender_http_client_event_t, void *, size_t, void *),
+                          void (*done)(mender_err_t, int, void *),
+                          void *params) {
+
+    assert(NULL != path);
+    assert(NULL != callback);
+    mender_http_async_request_t *request = NULL;
+
+    /* Allocate memory for the request */
+    if (NULL == (request = (mender_http_async_request_t *)calloc(1, sizeof(mender_http_async_request_t)))) {
+        mender_log_error("Unable to allocate memory");
+        goto FAIL;
+    }
+    request->callback = callback;
+    request->done     = done;
+    request->params   = params;
+    request->ret      = MENDER_OK;
+
+    /* Compute URL if required */
+    if ((false == mender_utils_strbeginwith(path, "http://")) && (false == mender_utils_strbeginwith(path, "https://"))) {
+        size_t str_length = strlen(mender_http_config.host) + strlen(path) + 1;
+        if (NULL == (request->url = (char *)malloc(str_length))) {
+            mender_log_error("Unable to allocate memory");
+            goto FAIL;
+        }
+        snprintf(request->url, str_length, "%s%s", mender_http_config.host, path);
+    }
+
+    /* Configuration of the client, asynchronous mode is only supported with HTTPS, requests using HTTP block the event loop */
+    esp_http_client_config_t config = { .url               = (NULL != request->url) ? request->url : path,
+                                        .user_agent        = MENDER_HTTP_USER_AGENT,
+                                        .crt_bundle_attach = esp_crt_bundle_attach,
+                                        .buffer_size_tx    = 2048,
+                                        .event_handler     = mender_http_async_event_handler,
+                                        .user_data         = request,
+                                        .is_async          = true };
+
+    /* Initialization of the client */
+    if (NULL == (request->client = esp_http_client_init(&config))) {
+        mender_log_error("Unable to allocate memory");
+        goto FAIL;
+    }
+    esp_http_client_set_method(request->client, mender_http_method_to_esp_http_client_method(method));
+    if (NULL != jwt) {
+        size_t str_length = strlen("Bearer ") + strlen(jwt) + 1;
+        if (NULL == (request->bearer = (char *)malloc(str_length))) {
+            mender_log_error("Unable to allocate memory");
+            goto FAIL;
+        }
+        snprintf(request->bearer, str_length, "Bearer %s", jwt);
+        esp_http_client_set_header(request->client, "Authorization", request->bearer);
+    }
+    if (NULL != signature) {
+        esp_http_client_set_header(request->client, "X-MEN-Signature", signature);
+    }
+    if (NULL != payload) {
+        esp_http_client_set_header(request->client, "Content-Type", "application/json");
+        if (NULL == (request->payload = strdup(payload))) {
+            mender_log_error("Unable to allocate memory");
+            goto FAIL;
+        }
+        esp_http_client_set_post_field(request->client, request->payload, (int)strlen(request->payload));
+    }
+
+    /* Take mutex used to protect the event loop */
+    xSemaphoreTake(mender_http_event_loop_mutex, portMAX_DELAY);
+
+    /* Start the event loop task if it is not already running */
+    if (NULL == mender_http_event_loop_task_handle) {
+        mender_http_event_loop_exit = false;
+        if (pdPASS
+            != xTaskCreate(mender_http_event_loop_task,
+                           "mender_http",
+                           (configSTACK_DEPTH_TYPE)(CONFIG_MENDER_HTTP_EVENT_LOOP_TASK_STACK_SIZE * 1024),
+                           NULL,
+                           CONFIG_MENDER_HTTP_EVENT_LOOP_TASK_PRIORITY,
+                           &mender_http_event_loop_task_handle)) {
+            mender_log_error("Unable to create HTTP event loop task");
+            mender_http_event_loop_task_handle = NULL;
+            xSemaphoreGive(mender_http_event_loop_mutex);
+            goto FAIL;
+        }
+    }
+
+    /* Append the request to the list of pending requests */
+    if (NULL == mender_http_pending_requests) {
+        mender_http_pending_requests = request;
+    } else {
+        mender_http_async_request_t *last = mender_http_pending_requests;
+        while (NULL != last->next) {
+            last = last->next;
+        }
+        last->next = request;
+    }
+
+    /* Release mutex used to protect the event loop */
+    xSemaphoreGive(mender_http_event_loop_mutex);
+
+    /* Wake up the event loop */
+    xSemaphoreGive(mender_http_event_loop_sem);
+
+    return MENDER_OK;
+
+FAIL:
+
+    /* Release memory */
+    mender_http_async_request_release(request);
+
+    return MENDER_FAIL;
+}
+
+mender_err_t
+mender_http_get_retry_after(uint32_t *delay) {
+
+    assert(NULL != delay);
+
+    /* Return the delay of the last response */
+    *delay = mender_http_retry_after;
+
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_http_preconnect(char *path) {
+
+    (void)path;
+
+    /* Connections of the HTTP client can't be handed over to another client */
+    return MENDER_NOT_IMPLEMENTED;
+}
+
 mender_err_t
 mender_http_exit(void) {
 
-    /* Nothing to do */
+    bool started = false;
+
+    /* Request the event loop task to terminate and wait for it */
+    if (NULL != mender_http_event_loop_mutex) {
+        xSemaphoreTake(mender_http_event_loop_mutex, portMAX_DELAY);
+        started                     = (NULL != mender_http_event_loop_task_handle);
+        mender_http_event_loop_exit = true;
+        xSemaphoreGive(mender_http_event_loop_mutex);
+    }
+    if (true == started) {
+        xSemaphoreGive(mender_http_event_loop_sem);
+        xSemaphoreTake(mender_http_event_loop_exit_sem, portMAX_DELAY);
+    }
+
+    /* Release memory */
+    if (NULL != mender_http_event_loop_exit_sem) {
+        vSemaphoreDelete(mender_http_event_loop_exit_sem);
+        mender_http_event_loop_exit_sem = NULL;
+    }
+    if (NULL != mender_http_event_loop_sem) {
+        vSemaphoreDelete(mender_http_event_loop_sem);
+        mender_http_event_loop_sem = NULL;
+    }
+    if (NULL != mender_http_event_loop_mutex) {
+        vSemaphoreDelete(mender_http_event_loop_mutex);
+        mender_http_event_loop_mutex = NULL;
+    }
+
     return MENDER_OK;
 }
 
@@ -215,3 +522,152 @@ mender_http_method_to_esp_http_client_method(mender_http_method_t method) {
 
     return HTTP_METHOD_MAX;
 }
+
+static void
+mender_http_event_loop_task(void *arg) {
+
+    (void)arg;
+    mender_http_async_request_t  *active = NULL;
+    mender_http_async_request_t  *request;
+    mender_http_async_request_t **item;
+    esp_err_t                     err;
+
+    /* Perform asynchronous requests until the event loop is stopped */
+    while (true) {
+
+        /* Wait for a new request if the event loop is idle, poll the requests in progress otherwise */
+        xSemaphoreTake(mender_http_event_loop_sem, (NULL == active) ? portMAX_DELAY : pdMS_TO_TICKS(CONFIG_MENDER_HTTP_EVENT_LOOP_POLL_INTERVAL));
+
+        /* Retrieve pending requests */
+        xSemaphoreTake(mender_http_event_loop_mutex, portMAX_DELAY);
+        if (true == mender_http_event_loop_exit) {
+            xSemaphoreGive(mender_http_event_loop_mutex);
+            break;
+        }
+        if (NULL != mender_http_pending_requests) {
+            item = &active;
+            while (NULL != *item) {
+                item = &(*item)->next;
+            }
+            *item                        = mender_http_pending_requests;
+            mender_http_pending_requests = NULL;
+        }
+        xSemaphoreGive(mender_http_event_loop_mutex);
+
+        /* Make each request progress, a request is done when it does not need to wait for the socket anymore */
+        item = &active;
+        while (NULL != (request = *item)) {
+            if (ESP_ERR_HTTP_EAGAIN == (err = esp_http_client_perform(request->client))) {
+                item = &request->next;
+            } else {
+                *item = request->next;
+                mender_http_async_request_complete(request, err);
+            }
+        }
+    }
+
+    /* Abort requests that are still in progress or pending */
+    xSemaphoreTake(mender_http_event_loop_mutex, portMAX_DELAY);
+    item = &active;
+    while (NULL != *item) {
+        item = &(*item)->next;
+    }
+    *item                              = mender_http_pending_requests;
+    mender_http_pending_requests       = NULL;
+    mender_http_event_loop_task_handle = NULL;
+    xSemaphoreGive(mender_http_event_loop_mutex);
+    while (NULL != (request = active)) {
+        active = request->next;
+        mender_http_async_request_complete(request, ESP_FAIL);
+    }
+
+    /* Inform the event loop task is terminated and delete it */
+    xSemaphoreGive(mender_http_event_loop_exit_sem);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t
+mender_http_event_handler(esp_http_client_event_t *evt) {
+
+    assert(NULL != evt);
+
+    /* Only the delay-seconds form of the Retry-After header is supported */
+    if ((HTTP_EVENT_ON_HEADER == evt->event_id) && (NULL != evt->header_key) && (NULL != evt->header_value)
+        && (0 == strcasecmp(evt->header_key, "Retry-After"))) {
+        char         *end   = NULL;
+        unsigned long value = strtoul(evt->header_value, &end, 10);
+        if ((end != evt->header_value) && ('\0' == *end)) {
+            mender_http_retry_after = (value > UINT32_MAX) ? UINT32_MAX : (uint32_t)value;
+        }
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t
+mender_http_async_event_handler(esp_http_client_event_t *evt) {
+
+    assert(NULL != evt);
+    mender_http_async_request_t *request = (mender_http_async_request_t *)evt->user_data;
+
+    /* Stop invoking the callback if an error occurred */
+    if (MENDER_OK != request->ret) {
+        return ESP_FAIL;
+    }
+
+    /* Transmit events and data received to the upper layer */
+    if (HTTP_EVENT_ON_CONNECTED == evt->event_id) {
+        if (MENDER_OK != (request->ret = request->callback(MENDER_HTTP_EVENT_CONNECTED, NULL, 0, request->params))) {
+            mender_log_error("An error occurred");
+            return ESP_FAIL;
+        }
+    } else if ((HTTP_EVENT_ON_DATA == evt->event_id) && (evt->data_len > 0)) {
+        if (MENDER_OK != (request->ret = request->callback(MENDER_HTTP_EVENT_DATA_RECEIVED, evt->data, (size_t)evt->data_len, request->params))) {
+            mender_log_error("An error occurred, stop reading data");
+            return ESP_FAIL;
+        }
+    }
+
+    return ESP_OK;
+}
+
+static void
+mender_http_async_request_complete(mender_http_async_request_t *request, esp_err_t err) {
+
+    assert(NULL != request);
+    mender_err_t ret    = request->ret;
+    int          status = 0;
+
+    /* Invoke the callbacks */
+    if ((ESP_OK == err) && (MENDER_OK == ret)) {
+        status = esp_http_client_get_status_code(request->client);
+        if (MENDER_OK != (ret = request->callback(MENDER_HTTP_EVENT_DISCONNECTED, NULL, 0, request->params))) {
+            mender_log_error("An error occurred");
+        }
+    } else if (MENDER_OK == ret) {
+        mender_log_error("Unable to perform HTTP request: %s", esp_err_to_name(err));
+        request->callback(MENDER_HTTP_EVENT_ERROR, NULL, 0, request->params);
+        ret = MENDER_FAIL;
+    }
+    if (NULL != request->done) {
+        request->done(ret, status, request->params);
+    }
+
+    /* Release memory */
+    mender_http_async_request_release(request);
+}
+
+static void
+mender_http_async_request_release(mender_http_async_request_t *request) {
+
+    /* Release memory */
+    if (NULL != request) {
+        if (NULL != request->client) {
+            esp_http_client_cleanup(request->client);
+        }
+        free(request->payload);
+        free(request->bearer);
+        free(request->url);
+        free(request);
+    }
+}
@@ -18,8 +18,13 @@
  */
 
 #include <curl/curl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <strings.h>
+#include <time.h>
 #include "mender-http.h"
 #include "mender-log.h"
+#include "mender-scheduler.h"
 #include "mender-utils.h"
 
 /**
@@ -32,22 +37,356 @@
 #endif /* MENDER_CLIENT_VERSION */
 
 /**
- * @brief User data
+ * @brief Default HTTP event loop poll timeout (milliseconds)
  */
-typedef struct {
+#ifndef CONFIG_MENDER_HTTP_EVENT_LOOP_POLL_TIMEOUT
+#define CONFIG_MENDER_HTTP_EVENT_LOOP_POLL_TIMEOUT (1000)
+#endif /* CONFIG_MENDER_HTTP_EVENT_LOOP_POLL_TIMEOUT */
+
+/**
+ * @brief Default number of concurrent connections used to download artifacts, 1 to disable parallel ranged downloads
+ */
+#ifndef CONFIG_MENDER_HTTP_PARALLEL_DOWNLOAD_CONNECTIONS
+#define CONFIG_MENDER_HTTP_PARALLEL_DOWNLOAD_CONNECTIONS (1)
+#endif /* CONFIG_MENDER_HTTP_PARALLEL_DOWNLOAD_CONNECTIONS */
+
+/**
+ * @brief Default size of the segments of parallel ranged downloads (kB)
+ */
+#ifndef CONFIG_MENDER_HTTP_PARALLEL_DOWNLOAD_SEGMENT_SIZE
+#define CONFIG_MENDER_HTTP_PARALLEL_DOWNLOAD_SEGMENT_SIZE (256)
+#endif /* CONFIG_MENDER_HTTP_PARALLEL_DOWNLOAD_SEGMENT_SIZE */
+
+/**
+ * @brief Default number of consecutive retries without receiving data of each segment of artifact downloads, transfers are resumed from the last byte received
+ */
+#ifndef CONFIG_MENDER_HTTP_DOWNLOAD_RETRIES
+#define CONFIG_MENDER_HTTP_DOWNLOAD_RETRIES (3)
+#endif /* CONFIG_MENDER_HTTP_DOWNLOAD_RETRIES */
+
+/**
+ * @brief Default connect timeout, including TLS handshake (seconds), 0 to use the default of curl
+ */
+#ifndef CONFIG_MENDER_HTTP_CONNECT_TIMEOUT
+#define CONFIG_MENDER_HTTP_CONNECT_TIMEOUT (30)
+#endif /* CONFIG_MENDER_HTTP_CONNECT_TIMEOUT */
+
+/**
+ * @brief Default timeout waiting for the first byte of the response once the request is sent (seconds), 0 to disable
+ */
+#ifndef CONFIG_MENDER_HTTP_FIRST_BYTE_TIMEOUT
+#define CONFIG_MENDER_HTTP_FIRST_BYTE_TIMEOUT (60)
+#endif /* CONFIG_MENDER_HTTP_FIRST_BYTE_TIMEOUT */
+
+/**
+ * @brief Default timeout between two chunks of data (seconds), 0 to disable
+ */
+#ifndef CONFIG_MENDER_HTTP_IDLE_TIMEOUT
+#define CONFIG_MENDER_HTTP_IDLE_TIMEOUT (60)
+#endif /* CONFIG_MENDER_HTTP_IDLE_TIMEOUT */
+
+/**
+ * @brief Default low speed limit (bytes/s), transfers slower than this limit during the low speed time are aborted, 0 to disable
+ */
+#ifndef CONFIG_MENDER_HTTP_LOW_SPEED_LIMIT
+#define CONFIG_MENDER_HTTP_LOW_SPEED_LIMIT (128)
+#endif /* CONFIG_MENDER_HTTP_LOW_SPEED_LIMIT */
+
+/**
+ * @brief Default low speed time (seconds)
+ */
+#ifndef CONFIG_MENDER_HTTP_LOW_SPEED_TIME
+#define CONFIG_MENDER_HTTP_LOW_SPEED_TIME (120)
+#endif /* CONFIG_MENDER_HTTP_LOW_SPEED_TIME */
+
+/**
+ * @brief HTTP request
+ */
+typedef struct mender_http_curl_request_s {
+    CURL              *curl;            /**< Easy handle of the request */
+    struct curl_slist *headers;         /**< Headers of the request */
+    char              *url;             /**< URL of the request, NULL if the path is already an URL */
+    char              *bearer;          /**< Authorization header, NULL if not used */
+    char              *x_men_signature; /**< Signature header, NULL if not used */
     mender_err_t (*callback)(mender_http_client_event_t, void *, size_t, void *); /**< Callback invoked on HTTP events */
-    void *params;                                                                 /**< Parameters passed to the callback, NULL if not used */
-} mender_http_curl_user_data_t;
+    void (*done)(mender_err_t, int, void *);                                      /**< Callback invoked when an asynchronous request is completed */
+    void                              *params;      /**< Parameters passed to the callbacks, NULL if not used */
+    int64_t                            timestamp;   /**< Time of the last activity (milliseconds), 0 if not connected yet */
+    curl_off_t                         transferred; /**< Length of the data transferred at the time of the last activity */
+    struct mender_http_curl_request_s *next;        /**< Next request of the list */
+} mender_http_curl_request_t;
+
+/**
+ * @brief Artifact download segment
+ */
+typedef struct {
+    struct mender_http_curl_download_s *download;  /**< Download the segment belongs to */
+    mender_http_curl_request_t         *request;   /**< Request in progress, NULL if the segment is not started or completed */
+    size_t                              index;     /**< Index of the segment */
+    size_t                              offset;    /**< Offset of the segment in the artifact */
+    size_t                              length;    /**< Length of the segment, 0 if unknown */
+    size_t                              received;  /**< Length of the data received */
+    size_t                              resumed;   /**< Length of the data received when the request in progress has been started */
+    size_t                              delivered; /**< Length of the data transmitted to the upper layer */
+    char                               *buffer;    /**< Reorder buffer, used to store data until previous segments are completed */
+    int                                 retries;   /**< Number of consecutive retries without receiving data */
+    bool                                completed; /**< Flag indicating the segment has been received entirely */
+} mender_http_curl_segment_t;
+
+/**
+ * @brief Artifact download
+ */
+typedef struct mender_http_curl_download_s {
+    char *url;                                                                                        /**< URL of the artifact */
+    mender_err_t (*callback)(mender_http_client_event_t, void *, size_t, void *);                     /**< Callback invoked on HTTP events */
+    void                      *params;                                                                /**< Parameters passed to the callback */
+    CURLM                     *multi;                                                                 /**< Multi handle used to perform the segments */
+    mender_http_curl_segment_t segments[CONFIG_MENDER_HTTP_PARALLEL_DOWNLOAD_CONNECTIONS];            /**< Segments in progress */
+    size_t                     segment_size;                                                          /**< Size of the segments, 0 to download the artifact at once */
+    size_t                     total;                                                                 /**< Size of the artifact, 0 if unknown */
+    size_t                     count;                                                                 /**< Number of segments, 0 if unknown yet */
+    size_t                     head;                                                                  /**< Index of the next segment to deliver */
+    size_t                     next;                                                                  /**< Index of the next segment to start */
+    bool                       ranged;                                                                /**< Flag indicating the server supports ranges */
+    bool                       connected;                                                             /**< Flag indicating the connected event was sent */
+    int                        status;                                                                /**< Status code */
+    mender_err_t               ret;                                                                   /**< Result of the callback */
+} mender_http_curl_download_t;
 
 /**
  * @brief Mender HTTP configuration
  */
 static mender_http_config_t mender_http_config;
 
+/**
+ * @brief HTTP event loop multi handle, used to perform asynchronous requests
+ */
+static CURLM *mender_http_multi_handle = NULL;
+
+/**
+ * @brief HTTP event loop thread handle
+ */
+static pthread_t mender_http_event_loop_thread_handle;
+
+/**
+ * @brief Flag used to indicate the HTTP event loop thread is running
+ */
+static bool mender_http_event_loop_started = false;
+
+/**
+ * @brief Flag used to request the HTTP event loop thread to terminate
+ */
+static bool mender_http_event_loop_exit = false;
+
+/**
+ * @brief HTTP event loop mutex, used to protect the list of pending requests and the event loop state
+ */
+static pthread_mutex_t mender_http_event_loop_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Asynchronous requests waiting to be added to the event loop
+ */
+static mender_http_curl_request_t *mender_http_pending_requests = NULL;
+
+/**
+ * @brief Asynchronous requests in progress in the event loop, only accessed from the event loop thread
+ */
+static mender_http_curl_request_t *mender_http_active_requests = NULL;
+
+/**
+ * @brief Pre-connection mutex, used to protect the pre-connection state
+ */
+static pthread_mutex_t mender_http_preconnect_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Pre-connection thread handle
+ */
+static pthread_t mender_http_preconnect_thread_handle;
+
+/**
+ * @brief Pre-connection URL, NULL if no pre-connection is in progress
+ */
+static char *mender_http_preconnect_url = NULL;
+
+/**
+ * @brief Pre-connection multi handle, used by the pre-connection thread until it terminates
+ */
+static CURLM *mender_http_preconnect_multi_handle = NULL;
+
+/**
+ * @brief Flag used to interrupt the pre-connection thread
+ */
+static atomic_bool mender_http_preconnect_cancel = false;
+
+/**
+ * @brief Share handle of the pre-connection and of the downloads, the DNS cache, the TLS sessions and the connection cache are shared so that the
+ *        download benefits from the resolution and the handshake performed in background
+ */
+static CURLSH *mender_http_share_handle = NULL;
+
+/**
+ * @brief Share handle mutexes, used to protect each kind of data shared between the pre-connection thread and the download
+ */
+static pthread_mutex_t mender_http_share_mutex[CURL_LOCK_DATA_LAST];
+
+/**
+ * @brief Delay requested by the server with the Retry-After header of the last response (seconds)
+ */
+static atomic_uint mender_http_retry_after = 0;
+
+/**
+ * @brief Create HTTP request
+ * @param jwt Token, NULL if not authenticated yet
+ * @param path Path of the request
+ * @param method Method
+ * @param payload Payload, NULL if empty
+ * @param signature Signature of the payload, NULL if it is not required
+ * @param callback Callback invoked on HTTP events
+ * @param params Parameters passed to the callback, NULL if not used
+ * @param request Request created
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_http_request_create(char                *jwt,
+                                               char                *path,
+                                               mender_http_method_t method,
+                                               char                *payload,
+                                               char                *signature,
+                                               mender_err_t (*callback)(mender_http_client_event_t, void *, size_t, void *),
+                                               void                        *params,
+                                               mender_http_curl_request_t **request);
+
+/**
+ * @brief Complete HTTP request, read status code and invoke the callback
+ * @param request Request
+ * @param result Result of the transfer
+ * @param status Status code
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_http_request_complete(mender_http_curl_request_t *request, CURLcode result, int *status);
+
+/**
+ * @brief Release HTTP request
+ * @param request Request
+ */
+static void mender_http_request_release(mender_http_curl_request_t *request);
+
+/**
+ * @brief Download artifact using ranged requests, transfers are resumed on failure
+ * @note Several segments are downloaded concurrently if parallel downloads are enabled, they are reassembled in order before being transmitted to the callback
+ * @param url URL of the artifact
+ * @param callback Callback invoked on HTTP events
+ * @param params Parameters passed to the callback, NULL if not used
+ * @param status Status code
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_http_download(char *url, mender_err_t (*callback)(mender_http_client_event_t, void *, size_t, void *), void *params, int *status);
+
+/**
+ * @brief Start or restart segment of an artifact download from the first byte not received yet
+ * @param download Download
+ * @param segment Segment
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_http_download_segment_start(mender_http_curl_download_t *download, mender_http_curl_segment_t *segment);
+
+/**
+ * @brief Release segment of an artifact download
+ * @param download Download
+ * @param segment Segment
+ */
+static void mender_http_download_segment_release(mender_http_curl_download_t *download, mender_http_curl_segment_t *segment);
+
+/**
+ * @brief Transmit data of the completed segments to the upper layer in order
+ * @param download Download
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_http_download_deliver(mender_http_curl_download_t *download);
+
+/**
+ * @brief HTTP PREREQ callback of artifact downloads, used to inform the client is connected to the server
+ * @param params User data
+ * @param conn_primary_ip Primary IP of the remote server
+ * @param conn_local_ip Originating IP of the connection
+ * @param conn_primary_port Primary port number on the remote server
+ * @param conn_local_port Originating port number of the connection
+ * @return CURL_PREREQFUNC_OK if the function succeeds, CURL_PREREQFUNC_ABORT otherwise
+ */
+static int mender_http_download_prereq_callback(void *params, char *conn_primary_ip, char *conn_local_ip, int conn_primary_port, int conn_local_port);
+
+/**
+ * @brief HTTP header callback of artifact downloads, used to retrieve the size of the artifact
+ * @param data Header line
+ * @param size Size of the data
+ * @param nmemb Number of element
+ * @param params User data
+ * @return Real size of data if the function succeeds, 0 otherwise
+ */
+static size_t mender_http_download_header_callback(char *data, size_t size, size_t nmemb, void *params);
+
+/**
+ * @brief HTTP write callback of artifact downloads, used to retrieve data of the segments
+ * @param data Data from the server
+ * @param size Size of the data
+ * @param nmemb Number of element
+ * @param params User data
+ * @return Real size of data if the function succeeds, 0 otherwise
+ */
+static size_t mender_http_download_write_callback(char *data, size_t size, size_t nmemb, void *params);
+
+/**
+ * @brief HTTP event loop thread, used to perform asynchronous requests
+ * @param arg Not used
+ * @return Not used
+ */
+static void *mender_http_event_loop_thread(void *arg);
+
+/**
+ * @brief Pre-connection thread, used to resolve the host and establish the connection in background
+ * @param arg Pre-connection request
+ * @return Not used
+ */
+static void *mender_http_preconnect_thread(void *arg);
+
+/**
+ * @brief Pre-connection callback, no data is received since only the connection is established
+ * @param event Event
+ * @param data Data received
+ * @param data_length Data length
+ * @param params Not used
+ * @return Always MENDER_OK
+ */
+static mender_err_t mender_http_preconnect_callback(mender_http_client_event_t event, void *data, size_t data_length, void *params);
+
+/**
+ * @brief Terminate the pre-connection, it is completed if it matches the URL so that its DNS resolution and TLS session are in the share handle, or
+ *        interrupted otherwise
+ * @note The wait is bounded by the connect timeout of the pre-connection
+ * @param path URL of the request to be performed, NULL to release the pre-connection
+ */
+static void mender_http_preconnect_wait(char *path);
+
+/**
+ * @brief Share handle lock callback
+ * @param handle Easy handle
+ * @param data Data to be locked
+ * @param access Access requested
+ * @param params Not used
+ */
+static void mender_http_share_lock_callback(CURL *handle, curl_lock_data data, curl_lock_access access, void *params);
+
+/**
+ * @brief Share handle unlock callback
+ * @param handle Easy handle
+ * @param data Data to be unlocked
+ * @param params Not used
+ */
+static void mender_http_share_unlock_callback(CURL *handle, curl_lock_data data, void *params);
+
 /**
  * @brief HTTP PREREQ callback, used to inform the client is connected to the server
  * @param params User data
- * @param conn_primary_ip Primary IP of the remote server 
+ * @param conn_primary_ip Primary IP of the remote server
  * @param conn_local_ip Originating IP of the connection
  * @param conn_primary_port Primary port number on the remote server
  * @param conn_local_port Originating port number of the connection
@@ -55,6 +394,23 @@ static mender_http_config_t mender_http_config;
  */
 static int mender_http_prereq_callback(void *params, char *conn_primary_ip, char *conn_local_ip, int conn_primary_port, int conn_local_port);
 
+/**
+ * @brief HTTP progress callback, used to abort stalled transfers
+ * @param params User data
+ * @param dltotal Total number of bytes expected to be downloaded
+ * @param dlnow Number of bytes downloaded so far
+ * @param ultotal Total number of bytes expected to be uploaded
+ * @param ulnow Number of bytes uploaded so far
+ * @return 0 if the function succeeds, 1 to abort the transfer
+ */
+static int mender_http_xferinfo_callback(void *params, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
+
+/**
+ * @brief Get monotonic time
+ * @return Time (milliseconds)
+ */
+static int64_t mender_http_get_time(void);
+
 /**
  * @brief HTTP write callback, used to retrieve data from the server
  * @param data Data from the server
@@ -70,6 +426,7 @@ mender_http_init(mender_http_config_t *config) {
 
     assert(NULL != config);
     assert(NULL != config->host);
+    CURLSHcode err;
 
     /* Save configuration */
     memcpy(&mender_http_config, config, sizeof(mender_http_config_t));
@@ -77,6 +434,29 @@ mender_http_init(mender_http_config_t *config) {
     /* Initialization of curl */
     curl_global_init(CURL_GLOBAL_DEFAULT);
 
+    /* Initialization of the multi handle used by the event loop */
+    if (NULL == (mender_http_multi_handle = curl_multi_init())) {
+        mender_log_error("Unable to allocate memory");
+        return MENDER_FAIL;
+    }
+
+    /* Initialization of the share handle used by the pre-connection and the downloads */
+    for (size_t index = 0; index < CURL_LOCK_DATA_LAST; index++) {
+        pthread_mutex_init(&mender_http_share_mutex[index], NULL);
+    }
+    if (NULL == (mender_http_share_handle = curl_share_init())) {
+        mender_log_error("Unable to allocate memory");
+        return MENDER_FAIL;
+    }
+    if ((CURLSHE_OK != (err = curl_share_setopt(mender_http_share_handle, CURLSHOPT_LOCKFUNC, &mender_http_share_lock_callback)))
+        || (CURLSHE_OK != (err = curl_share_setopt(mender_http_share_handle, CURLSHOPT_UNLOCKFUNC, &mender_http_share_unlock_callback)))
+        || (CURLSHE_OK != (err = curl_share_setopt(mender_http_share_handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS)))
+        || (CURLSHE_OK != (err = curl_share_setopt(mender_http_share_handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION)))
+        || (CURLSHE_OK != (err = curl_share_setopt(mender_http_share_handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT)))) {
+        mender_log_error("Unable to configure HTTP share handle: %s", curl_share_strerror(err));
+        return MENDER_FAIL;
+    }
+
     return MENDER_OK;
 }
 
@@ -93,168 +473,975 @@ mender_http_perform(char                *jwt,
     assert(NULL != path);
     assert(NULL != callback);
     assert(NULL != status);
-    CURLcode           err;
-    mender_err_t       ret             = MENDER_OK;
-    CURL              *curl            = NULL;
-    char              *url             = NULL;
-    char              *bearer          = NULL;
-    char              *x_men_signature = NULL;
-    struct curl_slist *headers         = NULL;
+    mender_err_t                ret;
+    mender_http_curl_request_t *request = NULL;
+
+    /* Artifacts are downloaded from pre-signed URLs, use ranged requests so that transfers can be resumed */
+    if ((MENDER_HTTP_GET == method) && (NULL == jwt) && (NULL == payload)
+        && ((true == mender_utils_strbeginwith(path, "http://")) || (true == mender_utils_strbeginwith(path, "https://")))) {
+        return mender_http_download(path, callback, params, status);
+    }
+
+    /* Create request */
+    if (MENDER_OK != (ret = mender_http_request_create(jwt, path, method, payload, signature, callback, params, &request))) {
+        mender_log_error("Unable to create HTTP request");
+        goto END;
+    }
+
+    /* Perform request */
+    ret = mender_http_request_complete(request, curl_easy_perform(request->curl), status);
+
+END:
+
+    /* Release memory */
+    mender_http_request_release(request);
+
+    return ret;
+}
+
+mender_err_t
+mender_http_perform_async(char                *jwt,
+                          char                *path,
+                          mender_http_method_t method,
+                          char                *payload,
+                          char                *signature,
+                          mender_err_t (*callback)(mender_http_client_event_t, void *, size_t, void *),
+                          void (*done)(mender_err_t, int, void *),
+                          void *params) {
+
+    assert(NULL != path);
+    assert(NULL != callback);
+    mender_err_t                ret;
+    mender_http_curl_request_t *request = NULL;
+    int                         result;
+
+    /* Create request */
+    if (MENDER_OK != (ret = mender_http_request_create(jwt, path, method, payload, signature, callback, params, &request))) {
+        mender_log_error("Unable to create HTTP request");
+        mender_http_request_release(request);
+        return ret;
+    }
+    request->done = done;
+
+    /* Take mutex used to protect the event loop */
+    pthread_mutex_lock(&mender_http_event_loop_mutex);
+
+    /* Start the event loop thread if it is not already running */
+    if (false == mender_http_event_loop_started) {
+        mender_http_event_loop_exit = false;
+        if (0 != (result = pthread_create(&mender_http_event_loop_thread_handle, NULL, mender_http_event_loop_thread, NULL))) {
+            mender_log_error("Unable to create HTTP event loop thread (%d)", result);
+            pthread_mutex_unlock(&mender_http_event_loop_mutex);
+            mender_http_request_release(request);
+            return MENDER_FAIL;
+        }
+        mender_http_event_loop_started = true;
+    }
+
+    /* Append the request to the list of pending requests */
+    if (NULL == mender_http_pending_requests) {
+        mender_http_pending_requests = request;
+    } else {
+        mender_http_curl_request_t *last = mender_http_pending_requests;
+        while (NULL != last->next) {
+            last = last->next;
+        }
+        last->next = request;
+    }
+
+    /* Release mutex used to protect the event loop */
+    pthread_mutex_unlock(&mender_http_event_loop_mutex);
+
+    /* Wake up the event loop so that the request is started immediately */
+    curl_multi_wakeup(mender_http_multi_handle);
+
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_http_get_retry_after(uint32_t *delay) {
+
+    assert(NULL != delay);
+
+    /* Return the delay of the last response */
+    *delay = (uint32_t)atomic_load(&mender_http_retry_after);
+
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_http_preconnect(char *path) {
+
+    assert(NULL != path);
+    mender_err_t                ret;
+    mender_http_curl_request_t *request = NULL;
+    CURLcode                    cerr;
+    CURLMcode                   err;
+    int                         result;
+
+    /* Release previous pre-connection if any */
+    mender_http_preconnect_wait(NULL);
+
+    /* Create request, only the connection is established, the DNS resolution and the TLS session are kept in the share handle for the download */
+    if (MENDER_OK != (ret = mender_http_request_create(NULL, path, MENDER_HTTP_GET, NULL, NULL, &mender_http_preconnect_callback, NULL, &request))) {
+        mender_log_error("Unable to create HTTP request");
+        goto FAIL;
+    }
+    if (CURLE_OK != (cerr = curl_easy_setopt(request->curl, CURLOPT_CONNECT_ONLY, 1L))) {
+        mender_log_error("Unable to set HTTP connect only: %s", curl_easy_strerror(cerr));
+        goto FAIL;
+    }
+    if (CURLE_OK != (cerr = curl_easy_setopt(request->curl, CURLOPT_SHARE, mender_http_share_handle))) {
+        mender_log_error("Unable to set HTTP share handle: %s", curl_easy_strerror(cerr));
+        goto FAIL;
+    }
+
+    /* Take mutex used to protect the pre-connection */
+    pthread_mutex_lock(&mender_http_preconnect_mutex);
+
+    /* Start the pre-connection in background */
+    if ((NULL == (mender_http_preconnect_url = strdup(path))) || (NULL == (mender_http_preconnect_multi_handle = curl_multi_init()))) {
+        mender_log_error("Unable to allocate memory");
+        goto FAIL_LOCKED;
+    }
+    if (CURLM_OK != (err = curl_multi_add_handle(mender_http_preconnect_multi_handle, request->curl))) {
+        mender_log_error("Unable to start HTTP request: %s", curl_multi_strerror(err));
+        goto FAIL_LOCKED;
+    }
+    atomic_store(&mender_http_preconnect_cancel, false);
+    if (0 != (result = pthread_create(&mender_http_preconnect_thread_handle, NULL, mender_http_preconnect_thread, request))) {
+        mender_log_error("Unable to create HTTP pre-connection thread (%d)", result);
+        curl_multi_remove_handle(mender_http_preconnect_multi_handle, request->curl);
+        goto FAIL_LOCKED;
+    }
+
+    /* Release mutex used to protect the pre-connection */
+    pthread_mutex_unlock(&mender_http_preconnect_mutex);
+
+    return MENDER_OK;
+
+FAIL_LOCKED:
+
+    /* Release memory */
+    if (NULL != mender_http_preconnect_multi_handle) {
+        curl_multi_cleanup(mender_http_preconnect_multi_handle);
+        mender_http_preconnect_multi_handle = NULL;
+    }
+    free(mender_http_preconnect_url);
+    mender_http_preconnect_url = NULL;
+
+    /* Release mutex used to protect the pre-connection */
+    pthread_mutex_unlock(&mender_http_preconnect_mutex);
+
+FAIL:
+
+    /* Release memory */
+    mender_http_request_release(request);
+
+    return MENDER_FAIL;
+}
+
+mender_err_t
+mender_http_exit(void) {
+
+    bool started;
+
+    /* Release pre-connection if any */
+    mender_http_preconnect_wait(NULL);
+
+    /* Request the event loop thread to terminate */
+    pthread_mutex_lock(&mender_http_event_loop_mutex);
+    started                        = mender_http_event_loop_started;
+    mender_http_event_loop_exit    = true;
+    mender_http_event_loop_started = false;
+    pthread_mutex_unlock(&mender_http_event_loop_mutex);
+    if (true == started) {
+        curl_multi_wakeup(mender_http_multi_handle);
+        pthread_join(mender_http_event_loop_thread_handle, NULL);
+    }
+
+    /* Cleaning */
+    if (NULL != mender_http_multi_handle) {
+        curl_multi_cleanup(mender_http_multi_handle);
+        mender_http_multi_handle = NULL;
+    }
+    if (NULL != mender_http_share_handle) {
+        curl_share_cleanup(mender_http_share_handle);
+        mender_http_share_handle = NULL;
+        for (size_t index = 0; index < CURL_LOCK_DATA_LAST; index++) {
+            pthread_mutex_destroy(&mender_http_share_mutex[index]);
+        }
+    }
+    curl_global_cleanup();
+
+    return MENDER_OK;
+}
+
+static mender_err_t
+mender_http_request_create(char                *jwt,
+                           char                *path,
+                           mender_http_method_t method,
+                           char                *payload,
+                           char                *signature,
+                           mender_err_t (*callback)(mender_http_client_event_t, void *, size_t, void *),
+                           void                        *params,
+                           mender_http_curl_request_t **request) {
+
+    assert(NULL != path);
+    assert(NULL != callback);
+    assert(NULL != request);
+    CURLcode err;
+
+    /* Allocate memory for the request */
+    if (NULL == (*request = (mender_http_curl_request_t *)calloc(1, sizeof(mender_http_curl_request_t)))) {
+        mender_log_error("Unable to allocate memory");
+        return MENDER_FAIL;
+    }
+    (*request)->callback = callback;
+    (*request)->params   = params;
 
     /* Compute URL if required */
     if ((false == mender_utils_strbeginwith(path, "http://")) && (false == mender_utils_strbeginwith(path, "https://"))) {
         size_t str_length = strlen(mender_http_config.host) + strlen(path) + 1;
-        if (NULL == (url = (char *)malloc(str_length))) {
+        if (NULL == ((*request)->url = (char *)malloc(str_length))) {
             mender_log_error("Unable to allocate memory");
-            ret = MENDER_FAIL;
-            goto END;
+            return MENDER_FAIL;
         }
-        snprintf(url, str_length, "%s%s", mender_http_config.host, path);
+        snprintf((*request)->url, str_length, "%s%s", mender_http_config.host, path);
     }
 
     /* Initialization of the client */
-    if (NULL == (curl = curl_easy_init())) {
+    if (NULL == ((*request)->curl = curl_easy_init())) {
         mender_log_error("Unable to allocate memory");
-        ret = MENDER_FAIL;
-        goto END;
+        return MENDER_FAIL;
     }
 
     /* Configuration of the client */
-    if (CURLE_OK != (err = curl_easy_setopt(curl, CURLOPT_URL, (NULL != url) ? url : path))) {
+    if (CURLE_OK != (err = curl_easy_setopt((*request)->curl, CURLOPT_URL, (NULL != (*request)->url) ? (*request)->url : path))) {
         mender_log_error("Unable to set HTTP URL: %s", curl_easy_strerror(err));
-        ret = MENDER_FAIL;
-        goto END;
+        return MENDER_FAIL;
     }
-    if (CURLE_OK != (err = curl_easy_setopt(curl, CURLOPT_USERAGENT, MENDER_HTTP_USER_AGENT))) {
+    if (CURLE_OK != (err = curl_easy_setopt((*request)->curl, CURLOPT_USERAGENT, MENDER_HTTP_USER_AGENT))) {
         mender_log_error("Unable to set HTTP User-Agent: %s", curl_easy_strerror(err));
-        ret = MENDER_FAIL;
-        goto END;
+        return MENDER_FAIL;
     }
-    if (CURLE_OK != (err = curl_easy_setopt(curl, CURLOPT_SSLVERSION, CURL_SSLVERSION_TLSv1_2))) {
+    if (CURLE_OK != (err = curl_easy_setopt((*request)->curl, CURLOPT_SSLVERSION, CURL_SSLVERSION_TLSv1_2))) {
         mender_log_error("Unable to set TLSv1.2: %s", curl_easy_strerror(err));
-        ret = MENDER_FAIL;
-        goto END;
+        return MENDER_FAIL;
     }
-    mender_http_curl_user_data_t user_data = { .callback = callback, .params = params };
-    if (CURLE_OK != (err = curl_easy_setopt(curl, CURLOPT_PREREQFUNCTION, &mender_http_prereq_callback))) {
+    if (CURLE_OK != (err = curl_easy_setopt((*request)->curl, CURLOPT_PREREQFUNCTION, &mender_http_prereq_callback))) {
         mender_log_error("Unable to set HTTP PREREQ function: %s", curl_easy_strerror(err));
-        ret = MENDER_FAIL;
-        goto END;
+        return MENDER_FAIL;
     }
-    if (CURLE_OK != (err = curl_easy_setopt(curl, CURLOPT_PREREQDATA, &user_data))) {
+    if (CURLE_OK != (err = curl_easy_setopt((*request)->curl, CURLOPT_PREREQDATA, *request))) {
         mender_log_error("Unable to set HTTP PREREQ data: %s", curl_easy_strerror(err));
-        ret = MENDER_FAIL;
-        goto END;
+        return MENDER_FAIL;
     }
-    if (CURLE_OK != (err = curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &mender_http_write_callback))) {
+    if (CURLE_OK != (err = curl_easy_setopt((*request)->curl, CURLOPT_WRITEFUNCTION, &mender_http_write_callback))) {
         mender_log_error("Unable to set HTTP write function: %s", curl_easy_strerror(err));
-        ret = MENDER_FAIL;
-        goto END;
+        return MENDER_FAIL;
     }
-    if (CURLE_OK != (err = curl_easy_setopt(curl, CURLOPT_WRITEDATA, &user_data))) {
+    if (CURLE_OK != (err = curl_easy_setopt((*request)->curl, CURLOPT_WRITEDATA, *request))) {
         mender_log_error("Unable to set HTTP write data: %s", curl_easy_strerror(err));
-        ret = MENDER_FAIL;
-        goto END;
+        return MENDER_FAIL;
+    }
+    if (CURLE_OK != (err = curl_easy_setopt((*request)->curl, CURLOPT_PRIVATE, *request))) {
+        mender_log_error("Unable to set HTTP private data: %s", curl_easy_strerror(err));
+        return MENDER_FAIL;
+    }
+
+    /* Configuration of the timeouts, stalled transfers are aborted */
+    if (CURLE_OK != (err = curl_easy_setopt((*request)->curl, CURLOPT_CONNECTTIMEOUT, (long)CONFIG_MENDER_HTTP_CONNECT_TIMEOUT))) {
+        mender_log_error("Unable to set HTTP connect timeout: %s", curl_easy_strerror(err));
+        return MENDER_FAIL;
+    }
+    if (CURLE_OK != (err = curl_easy_setopt((*request)->curl, CURLOPT_LOW_SPEED_LIMIT, (long)CONFIG_MENDER_HTTP_LOW_SPEED_LIMIT))) {
+        mender_log_error("Unable to set HTTP low speed limit: %s", curl_easy_strerror(err));
+        return MENDER_FAIL;
+    }
+    if (CURLE_OK != (err = curl_easy_setopt((*request)->curl, CURLOPT_LOW_SPEED_TIME, (long)CONFIG_MENDER_HTTP_LOW_SPEED_TIME))) {
+        mender_log_error("Unable to set HTTP low speed time: %s", curl_easy_strerror(err));
+        return MENDER_FAIL;
+    }
+    if (CURLE_OK != (err = curl_easy_setopt((*request)->curl, CURLOPT_XFERINFOFUNCTION, &mender_http_xferinfo_callback))) {
+        mender_log_error("Unable to set HTTP progress function: %s", curl_easy_strerror(err));
+        return MENDER_FAIL;
     }
+    if (CURLE_OK != (err = curl_easy_setopt((*request)->curl, CURLOPT_XFERINFODATA, *request))) {
+        mender_log_error("Unable to set HTTP progress data: %s", curl_easy_strerror(err));
+        return MENDER_FAIL;
+    }
+    if (CURLE_OK != (err = curl_easy_setopt((*request)->curl, CURLOPT_NOPROGRESS, 0L))) {
+        mender_log_error("Unable to enable HTTP progress function: %s", curl_easy_strerror(err));
+        return MENDER_FAIL;
+    }
+
     if (NULL != jwt) {
         size_t str_length = strlen("Authorization: Bearer ") + strlen(jwt) + 1;
-        if (NULL == (bearer = (char *)malloc(str_length))) {
+        if (NULL == ((*request)->bearer = (char *)malloc(str_length))) {
             mender_log_error("Unable to allocate memory");
-            ret = MENDER_FAIL;
-            goto END;
+            return MENDER_FAIL;
         }
-        snprintf(bearer, str_length, "Authorization: Bearer %s", jwt);
-        headers = curl_slist_append(headers, bearer);
+        snprintf((*request)->bearer, str_length, "Authorization: Bearer %s", jwt);
+        (*request)->headers = curl_slist_append((*request)->headers, (*request)->bearer);
     }
     if (NULL != signature) {
         size_t str_length = strlen("X-MEN-Signature: ") + strlen(signature) + 1;
-        if (NULL == (x_men_signature = (char *)malloc(str_length))) {
+        if (NULL == ((*request)->x_men_signature = (char *)malloc(str_length))) {
             mender_log_error("Unable to allocate memory");
-            ret = MENDER_FAIL;
-            goto END;
+            return MENDER_FAIL;
         }
-        snprintf(x_men_signature, str_length, "X-MEN-Signature: %s", signature);
-        headers = curl_slist_append(headers, x_men_signature);
+        snprintf((*request)->x_men_signature, str_length, "X-MEN-Signature: %s", signature);
+        (*request)->headers = curl_slist_append((*request)->headers, (*request)->x_men_signature);
     }
     if (NULL != payload) {
-        headers = curl_slist_append(headers, "Content-Type: application/json");
+        (*request)->headers = curl_slist_append((*request)->headers, "Content-Type: application/json");
     }
-    if (NULL != headers) {
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    if (NULL != (*request)->headers) {
+        curl_easy_setopt((*request)->curl, CURLOPT_HTTPHEADER, (*request)->headers);
     }
 
-    /* Write data if payload is defined */
+    /* Write data if payload is defined, payload is copied because asynchronous requests may outlive the caller buffer */
     if (NULL != payload) {
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload);
+        curl_easy_setopt((*request)->curl, CURLOPT_COPYPOSTFIELDS, payload);
         if (MENDER_HTTP_PUT == method) {
-            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
+            curl_easy_setopt((*request)->curl, CURLOPT_CUSTOMREQUEST, "PUT");
         }
     }
 
-    /* Perform request */
-    if (CURLE_OK != (err = curl_easy_perform(curl))) {
-        mender_log_error("Unable to perform HTTP request: %s", curl_easy_strerror(err));
-        callback(MENDER_HTTP_EVENT_ERROR, NULL, 0, params);
-        ret = MENDER_FAIL;
-        goto END;
+    return MENDER_OK;
+}
+
+static mender_err_t
+mender_http_request_complete(mender_http_curl_request_t *request, CURLcode result, int *status) {
+
+    assert(NULL != request);
+    assert(NULL != status);
+    CURLcode     err;
+    mender_err_t ret;
+
+    /* Check result of the transfer, it is aborted by the progress callback if the work performing the request has been cancelled */
+    if ((CURLE_ABORTED_BY_CALLBACK == result) && (true == mender_scheduler_work_is_cancelled())) {
+        mender_log_warning("HTTP request cancelled");
+        request->callback(MENDER_HTTP_EVENT_ERROR, NULL, 0, request->params);
+        return MENDER_CANCELLED;
+    }
+    if (CURLE_OK != result) {
+        mender_log_error("Unable to perform HTTP request: %s", curl_easy_strerror(result));
+        request->callback(MENDER_HTTP_EVENT_ERROR, NULL, 0, request->params);
+        return MENDER_FAIL;
     }
 
     /* Read HTTP status code */
     long response_code;
-    if (CURLE_OK != (err = curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code))) {
+    if (CURLE_OK != (err = curl_easy_getinfo(request->curl, CURLINFO_RESPONSE_CODE, &response_code))) {
         mender_log_error("Unable to read HTTP response code: %s", curl_easy_strerror(err));
+        return MENDER_FAIL;
+    }
+    *status = (int)response_code;
+
+    /* Read Retry-After header, only the delay-seconds form is reported by curl */
+    curl_off_t retry_after;
+    if ((CURLE_OK != curl_easy_getinfo(request->curl, CURLINFO_RETRY_AFTER, &retry_after)) || (retry_after < 0)) {
+        retry_after = 0;
+    }
+    atomic_store(&mender_http_retry_after, (unsigned int)((retry_after > UINT32_MAX) ? UINT32_MAX : retry_after));
+    if (MENDER_OK != (ret = request->callback(MENDER_HTTP_EVENT_DISCONNECTED, NULL, 0, request->params))) {
+        mender_log_error("An error occurred");
+        return ret;
+    }
+
+    return MENDER_OK;
+}
+
+static void
+mender_http_request_release(mender_http_curl_request_t *request) {
+
+    /* Release memory */
+    if (NULL != request) {
+        if (NULL != request->curl) {
+            curl_easy_cleanup(request->curl);
+        }
+        if (NULL != request->headers) {
+            curl_slist_free_all(request->headers);
+        }
+        free(request->x_men_signature);
+        free(request->bearer);
+        free(request->url);
+        free(request);
+    }
+}
+
+static mender_err_t
+mender_http_download(char *url, mender_err_t (*callback)(mender_http_client_event_t, void *, size_t, void *), void *params, int *status) {
+
+    assert(NULL != url);
+    assert(NULL != callback);
+    assert(NULL != status);
+    mender_err_t                 ret       = MENDER_OK;
+    bool                         completed = false;
+    mender_http_curl_download_t *download;
+    mender_http_curl_segment_t  *segment;
+    CURLMcode                    err;
+    CURLMsg                     *msg;
+    int                          running;
+    int                          msgs_left;
+
+    /* Allocate memory for the download */
+    if (NULL == (download = (mender_http_curl_download_t *)calloc(1, sizeof(mender_http_curl_download_t)))) {
+        mender_log_error("Unable to allocate memory");
+        return MENDER_FAIL;
+    }
+    download->url          = url;
+    download->callback     = callback;
+    download->params       = params;
+    download->segment_size = (CONFIG_MENDER_HTTP_PARALLEL_DOWNLOAD_CONNECTIONS > 1) ? (CONFIG_MENDER_HTTP_PARALLEL_DOWNLOAD_SEGMENT_SIZE * 1024) : 0;
+    download->ret          = MENDER_OK;
+
+    /* Wait for the pre-connection if any, the DNS resolution and the TLS session are then reused from the share handle */
+    mender_http_preconnect_wait(url);
+
+    /* Initialization of the multi handle, connections are reused between the segments through the connection cache of the share handle */
+    if (NULL == (download->multi = curl_multi_init())) {
+        mender_log_error("Unable to allocate memory");
         ret = MENDER_FAIL;
         goto END;
     }
-    *status = (int)response_code;
+
+    /* Start the first segment, the response indicates if the server supports ranges and the size of the artifact */
+    download->next = 1;
+    if (MENDER_OK != (ret = mender_http_download_segment_start(download, &download->segments[0]))) {
+        goto END;
+    }
+
+    /* Perform transfers until all the segments are delivered */
+    while ((0 == download->count) || (download->head < download->count)) {
+
+        /* Stop the download if the work performing it has been cancelled, the sockets are polled with a timeout so this is checked regularly */
+        if (true == mender_scheduler_work_is_cancelled()) {
+            mender_log_warning("Download cancelled");
+            ret = MENDER_CANCELLED;
+            goto END;
+        }
+
+        /* Perform transfers */
+        if (CURLM_OK != (err = curl_multi_perform(download->multi, &running))) {
+            mender_log_error("Unable to perform HTTP requests: %s", curl_multi_strerror(err));
+            ret = MENDER_FAIL;
+            goto END;
+        }
+        if (MENDER_OK != download->ret) {
+            mender_log_error("An error occurred, stop reading data");
+            ret = download->ret;
+            goto END;
+        }
+
+        /* Check the segments that are done */
+        while (NULL != (msg = curl_multi_info_read(download->multi, &msgs_left))) {
+            if (CURLMSG_DONE == msg->msg) {
+                CURLcode result = msg->data.result;
+                long     response_code = 0;
+                curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&segment);
+                curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &response_code);
+                mender_http_download_segment_release(download, segment);
+                if (false == download->ranged) {
+                    download->status = (int)response_code;
+                }
+                if ((CURLE_OK == result) && ((0 == segment->length) || (segment->received == segment->length))) {
+                    segment->completed = true;
+                    if (0 == download->count) {
+                        /* The server does not support ranges, the response is transmitted as is */
+                        download->count = 1;
+                    }
+                } else if (((true == download->ranged) || (0 == segment->received))
+                           && ((segment->received > segment->resumed) || (segment->retries < CONFIG_MENDER_HTTP_DOWNLOAD_RETRIES))) {
+                    /* Retries are counted only when no data has been received, servers may reply partial responses shorter than requested */
+                    segment->retries = (segment->received > segment->resumed) ? 0 : (segment->retries + 1);
+                    mender_log_warning("Unable to download segment %zu (%s), retrying", segment->index, curl_easy_strerror(result));
+                    if (MENDER_OK != (ret = mender_http_download_segment_start(download, segment))) {
+                        goto END;
+                    }
+                } else {
+                    mender_log_error("Unable to download segment %zu: %s", segment->index, curl_easy_strerror(result));
+                    ret = MENDER_FAIL;
+                    goto END;
+                }
+            }
+        }
+
+        /* Transmit data to the upper layer in order */
+        if (MENDER_OK != (ret = mender_http_download_deliver(download))) {
+            goto END;
+        }
+
+        /* Start the next segments, the window is limited to the number of connections to bound the reorder buffers */
+        while ((true == download->ranged) && (download->next < download->count)
+               && (download->next < download->head + CONFIG_MENDER_HTTP_PARALLEL_DOWNLOAD_CONNECTIONS)) {
+            segment = &download->segments[download->next % CONFIG_MENDER_HTTP_PARALLEL_DOWNLOAD_CONNECTIONS];
+            memset(segment, 0, sizeof(mender_http_curl_segment_t));
+            segment->index  = download->next;
+            segment->offset = download->next * download->segment_size;
+            segment->length = download->total - segment->offset;
+            if (segment->length > download->segment_size) {
+                segment->length = download->segment_size;
+            }
+            download->next++;
+            if (MENDER_OK != (ret = mender_http_download_segment_start(download, segment))) {
+                goto END;
+            }
+        }
+
+        /* Wait for activity on the sockets or the timeout */
+        if ((0 == download->count) || (download->head < download->count)) {
+            if (CURLM_OK != (err = curl_multi_poll(download->multi, NULL, 0, CONFIG_MENDER_HTTP_EVENT_LOOP_POLL_TIMEOUT, NULL))) {
+                mender_log_error("Unable to poll HTTP requests: %s", curl_multi_strerror(err));
+                ret = MENDER_FAIL;
+                goto END;
+            }
+        }
+    }
+
+    /* Ranged responses are reported as a complete response to the upper layer */
+    *status   = (true == download->ranged) ? 200 : download->status;
+    completed = true;
     if (MENDER_OK != (ret = callback(MENDER_HTTP_EVENT_DISCONNECTED, NULL, 0, params))) {
         mender_log_error("An error occurred");
-        goto END;
     }
 
 END:
 
+    /* Inform the upper layer in case of failure */
+    if ((MENDER_OK != ret) && (false == completed)) {
+        callback(MENDER_HTTP_EVENT_ERROR, NULL, 0, params);
+    }
+
     /* Release memory */
-    if (NULL != curl) {
-        curl_easy_cleanup(curl);
+    for (size_t index = 0; index < CONFIG_MENDER_HTTP_PARALLEL_DOWNLOAD_CONNECTIONS; index++) {
+        mender_http_download_segment_release(download, &download->segments[index]);
+        free(download->segments[index].buffer);
     }
-    if (NULL != headers) {
-        curl_slist_free_all(headers);
+    if (NULL != download->multi) {
+        curl_multi_cleanup(download->multi);
     }
-    if (NULL != x_men_signature) {
-        free(x_men_signature);
+    free(download);
+
+    return ret;
+}
+
+static mender_err_t
+mender_http_download_segment_start(mender_http_curl_download_t *download, mender_http_curl_segment_t *segment) {
+
+    assert(NULL != download);
+    assert(NULL != segment);
+    mender_err_t ret;
+    CURLcode     err;
+    CURLMcode    merr;
+    char         range[48];
+
+    /* Create request */
+    segment->download = download;
+    segment->resumed  = segment->received;
+    if (MENDER_OK
+        != (ret = mender_http_request_create(NULL, download->url, MENDER_HTTP_GET, NULL, NULL, download->callback, download->params, &segment->request))) {
+        mender_log_error("Unable to create HTTP request");
+        goto FAIL;
+    }
+
+    /* Request the data of the segment not received yet, the length of the first segment is not known before the first response */
+    if (0 != segment->length) {
+        snprintf(range, sizeof(range), "%zu-%zu", segment->offset + segment->received, segment->offset + segment->length - 1);
+    } else if (0 != download->segment_size) {
+        snprintf(range, sizeof(range), "%zu-%zu", segment->offset + segment->received, segment->offset + download->segment_size - 1);
+    } else {
+        snprintf(range, sizeof(range), "%zu-", segment->offset + segment->received);
     }
-    if (NULL != bearer) {
-        free(bearer);
+    if (CURLE_OK != (err = curl_easy_setopt(segment->request->curl, CURLOPT_RANGE, range))) {
+        mender_log_error("Unable to set HTTP range: %s", curl_easy_strerror(err));
+        goto FAIL;
     }
-    if (NULL != url) {
-        free(url);
+    if (CURLE_OK != (err = curl_easy_setopt(segment->request->curl, CURLOPT_SHARE, mender_http_share_handle))) {
+        mender_log_error("Unable to set HTTP share handle: %s", curl_easy_strerror(err));
+        goto FAIL;
     }
 
-    return ret;
+    /* Configuration of the callbacks of the segment */
+    if (CURLE_OK != (err = curl_easy_setopt(segment->request->curl, CURLOPT_PREREQFUNCTION, &mender_http_download_prereq_callback))) {
+        mender_log_error("Unable to set HTTP PREREQ function: %s", curl_easy_strerror(err));
+        goto FAIL;
+    }
+    if (CURLE_OK != (err = curl_easy_setopt(segment->request->curl, CURLOPT_PREREQDATA, segment))) {
+        mender_log_error("Unable to set HTTP PREREQ data: %s", curl_easy_strerror(err));
+        goto FAIL;
+    }
+    if (CURLE_OK != (err = curl_easy_setopt(segment->request->curl, CURLOPT_HEADERFUNCTION, &mender_http_download_header_callback))) {
+        mender_log_error("Unable to set HTTP header function: %s", curl_easy_strerror(err));
+        goto FAIL;
+    }
+    if (CURLE_OK != (err = curl_easy_setopt(segment->request->curl, CURLOPT_HEADERDATA, segment))) {
+        mender_log_error("Unable to set HTTP header data: %s", curl_easy_strerror(err));
+        goto FAIL;
+    }
+    if (CURLE_OK != (err = curl_easy_setopt(segment->request->curl, CURLOPT_WRITEFUNCTION, &mender_http_download_write_callback))) {
+        mender_log_error("Unable to set HTTP write function: %s", curl_easy_strerror(err));
+        goto FAIL;
+    }
+    if (CURLE_OK != (err = curl_easy_setopt(segment->request->curl, CURLOPT_WRITEDATA, segment))) {
+        mender_log_error("Unable to set HTTP write data: %s", curl_easy_strerror(err));
+        goto FAIL;
+    }
+    if (CURLE_OK != (err = curl_easy_setopt(segment->request->curl, CURLOPT_PRIVATE, segment))) {
+        mender_log_error("Unable to set HTTP private data: %s", curl_easy_strerror(err));
+        goto FAIL;
+    }
+
+    /* Start the transfer */
+    if (CURLM_OK != (merr = curl_multi_add_handle(download->multi, segment->request->curl))) {
+        mender_log_error("Unable to start HTTP request: %s", curl_multi_strerror(merr));
+        goto FAIL;
+    }
+
+    return MENDER_OK;
+
+FAIL:
+
+    /* Release memory */
+    mender_http_request_release(segment->request);
+    segment->request = NULL;
+
+    return MENDER_FAIL;
 }
 
-mender_err_t
-mender_http_exit(void) {
+static void
+mender_http_download_segment_release(mender_http_curl_download_t *download, mender_http_curl_segment_t *segment) {
 
-    /* Cleaning */
-    curl_global_cleanup();
+    assert(NULL != download);
+    assert(NULL != segment);
+
+    /* Stop the transfer and release memory */
+    if (NULL != segment->request) {
+        curl_multi_remove_handle(download->multi, segment->request->curl);
+        mender_http_request_release(segment->request);
+        segment->request = NULL;
+    }
+}
+
+static mender_err_t
+mender_http_download_deliver(mender_http_curl_download_t *download) {
+
+    assert(NULL != download);
+    mender_http_curl_segment_t *segment;
+
+    /* Transmit the segments in order, until the first one which is not completed */
+    while (download->head < download->next) {
+        segment = &download->segments[download->head % CONFIG_MENDER_HTTP_PARALLEL_DOWNLOAD_CONNECTIONS];
+
+        /* Transmit data stored in the reorder buffer */
+        if (segment->delivered < segment->received) {
+            if (MENDER_OK
+                != (download->ret = download->callback(
+                        MENDER_HTTP_EVENT_DATA_RECEIVED, segment->buffer + segment->delivered, segment->received - segment->delivered, download->params))) {
+                mender_log_error("An error occurred, stop reading data");
+                return download->ret;
+            }
+            segment->delivered = segment->received;
+        }
+        if (false == segment->completed) {
+            break;
+        }
+
+        /* Segment is done, next data are transmitted directly to the upper layer */
+        free(segment->buffer);
+        segment->buffer = NULL;
+        download->head++;
+    }
+
+    return MENDER_OK;
+}
+
+static int
+mender_http_download_prereq_callback(void *params, char *conn_primary_ip, char *conn_local_ip, int conn_primary_port, int conn_local_port) {
+
+    assert(NULL != params);
+    mender_http_curl_segment_t  *segment  = (mender_http_curl_segment_t *)params;
+    mender_http_curl_download_t *download = segment->download;
+    (void)conn_primary_ip;
+    (void)conn_local_ip;
+    (void)conn_primary_port;
+    (void)conn_local_port;
+
+    /* Start monitoring the transfer */
+    segment->request->timestamp = mender_http_get_time();
+
+    /* Invoke callback on the first connection only */
+    if (false == download->connected) {
+        download->connected = true;
+        if (MENDER_OK != (download->ret = download->callback(MENDER_HTTP_EVENT_CONNECTED, NULL, 0, download->params))) {
+            mender_log_error("An error occurred");
+            return CURL_PREREQFUNC_ABORT;
+        }
+    }
+
+    return CURL_PREREQFUNC_OK;
+}
+
+static size_t
+mender_http_download_header_callback(char *data, size_t size, size_t nmemb, void *params) {
+
+    assert(NULL != params);
+    mender_http_curl_segment_t  *segment  = (mender_http_curl_segment_t *)params;
+    mender_http_curl_download_t *download = segment->download;
+    size_t                       realsize = size * nmemb;
+    long                         response_code;
+    char                         line[128];
+    char                        *total;
+
+    /* Retrieve the size of the artifact from the "Content-Range: bytes 0-x/total" header of the first partial response */
+    if ((0 == download->count) && (realsize < sizeof(line)) && (0 == strncasecmp(data, "Content-Range:", strlen("Content-Range:")))) {
+        memcpy(line, data, realsize);
+        line[realsize] = '\0';
+        if ((CURLE_OK == curl_easy_getinfo(segment->request->curl, CURLINFO_RESPONSE_CODE, &response_code)) && (206 == response_code)
+            && (NULL != (total = strchr(line, '/'))) && (0 != (download->total = (size_t)strtoull(total + 1, NULL, 10)))) {
+            download->ranged = true;
+            download->count  = (0 != download->segment_size) ? ((download->total + download->segment_size - 1) / download->segment_size) : 1;
+            segment->length  = (download->count > 1) ? download->segment_size : download->total;
+            mender_log_debug("Downloading %zu bytes using %zu segments", download->total, download->count);
+        }
+    }
+
+    return realsize;
+}
+
+static size_t
+mender_http_download_write_callback(char *data, size_t size, size_t nmemb, void *params) {
+
+    assert(NULL != params);
+    mender_http_curl_segment_t  *segment  = (mender_http_curl_segment_t *)params;
+    mender_http_curl_download_t *download = segment->download;
+    size_t                       realsize = size * nmemb;
+    long                         response_code;
+
+    /* Check the response of the segment, the server must reply partial content once ranges are used */
+    if (true == download->ranged) {
+        if ((CURLE_OK != curl_easy_getinfo(segment->request->curl, CURLINFO_RESPONSE_CODE, &response_code)) || (206 != response_code)) {
+            mender_log_error("Unexpected response to segment %zu (%ld)", segment->index, response_code);
+            return 0;
+        }
+        if (segment->received + realsize > segment->length) {
+            mender_log_error("Unexpected length of segment %zu", segment->index);
+            return 0;
+        }
+    }
+
+    /* Transmit data directly to the upper layer if previous segments are done, store it in the reorder buffer otherwise */
+    if ((segment->index == download->head) && (segment->delivered == segment->received)) {
+        if (MENDER_OK != (download->ret = download->callback(MENDER_HTTP_EVENT_DATA_RECEIVED, (void *)data, realsize, download->params))) {
+            mender_log_error("An error occurred, stop reading data");
+            return 0;
+        }
+        segment->delivered += realsize;
+    } else {
+        if ((NULL == segment->buffer) && (NULL == (segment->buffer = (char *)malloc(segment->length)))) {
+            mender_log_error("Unable to allocate memory");
+            download->ret = MENDER_FAIL;
+            return 0;
+        }
+        memcpy(segment->buffer + segment->received, data, realsize);
+    }
+    segment->received += realsize;
+
+    return realsize;
+}
+
+static void *
+mender_http_event_loop_thread(void *arg) {
+
+    (void)arg;
+    mender_http_curl_request_t *request;
+    mender_http_curl_request_t *next;
+    CURLMcode                   err;
+    CURLMsg                    *msg;
+    int                         running;
+    int                         msgs_left;
+
+    /* Perform asynchronous requests until the event loop is stopped */
+    while (true) {
+
+        /* Retrieve pending requests */
+        pthread_mutex_lock(&mender_http_event_loop_mutex);
+        if (true == mender_http_event_loop_exit) {
+            pthread_mutex_unlock(&mender_http_event_loop_mutex);
+            break;
+        }
+        request                      = mender_http_pending_requests;
+        mender_http_pending_requests = NULL;
+        pthread_mutex_unlock(&mender_http_event_loop_mutex);
 
+        /* Add pending requests to the multi handle */
+        while (NULL != request) {
+            next = request->next;
+            if (CURLM_OK != (err = curl_multi_add_handle(mender_http_multi_handle, request->curl))) {
+                mender_log_error("Unable to start HTTP request: %s", curl_multi_strerror(err));
+                request->callback(MENDER_HTTP_EVENT_ERROR, NULL, 0, request->params);
+                if (NULL != request->done) {
+                    request->done(MENDER_FAIL, 0, request->params);
+                }
+                mender_http_request_release(request);
+            } else {
+                request->next               = mender_http_active_requests;
+                mender_http_active_requests = request;
+            }
+            request = next;
+        }
+
+        /* Perform transfers */
+        if (CURLM_OK != (err = curl_multi_perform(mender_http_multi_handle, &running))) {
+            mender_log_error("Unable to perform HTTP requests: %s", curl_multi_strerror(err));
+        }
+
+        /* Complete the requests that are done */
+        while (NULL != (msg = curl_multi_info_read(mender_http_multi_handle, &msgs_left))) {
+            if (CURLMSG_DONE == msg->msg) {
+                CURLcode result = msg->data.result;
+                int      status = 0;
+                curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&request);
+                curl_multi_remove_handle(mender_http_multi_handle, msg->easy_handle);
+                mender_http_curl_request_t **item = &mender_http_active_requests;
+                while (request != *item) {
+                    item = &(*item)->next;
+                }
+                *item            = request->next;
+                mender_err_t ret = mender_http_request_complete(request, result, &status);
+                if (NULL != request->done) {
+                    request->done(ret, status, request->params);
+                }
+                mender_http_request_release(request);
+            }
+        }
+
+        /* Wait for activity on the sockets, a new request or the timeout */
+        if (CURLM_OK != (err = curl_multi_poll(mender_http_multi_handle, NULL, 0, CONFIG_MENDER_HTTP_EVENT_LOOP_POLL_TIMEOUT, NULL))) {
+            mender_log_error("Unable to poll HTTP requests: %s", curl_multi_strerror(err));
+        }
+    }
+
+    /* Abort requests that are still in progress or pending */
+    pthread_mutex_lock(&mender_http_event_loop_mutex);
+    request                      = mender_http_pending_requests;
+    mender_http_pending_requests = NULL;
+    pthread_mutex_unlock(&mender_http_event_loop_mutex);
+    while (NULL != mender_http_active_requests) {
+        next = mender_http_active_requests->next;
+        curl_multi_remove_handle(mender_http_multi_handle, mender_http_active_requests->curl);
+        mender_http_active_requests->next = request;
+        request                           = mender_http_active_requests;
+        mender_http_active_requests       = next;
+    }
+    while (NULL != request) {
+        next = request->next;
+        request->callback(MENDER_HTTP_EVENT_ERROR, NULL, 0, request->params);
+        if (NULL != request->done) {
+            request->done(MENDER_FAIL, 0, request->params);
+        }
+        mender_http_request_release(request);
+        request = next;
+    }
+
+    return NULL;
+}
+
+static void *
+mender_http_preconnect_thread(void *arg) {
+
+    assert(NULL != arg);
+    mender_http_curl_request_t *request = (mender_http_curl_request_t *)arg;
+    CURLM                      *multi   = mender_http_preconnect_multi_handle;
+    int                         running = 1;
+
+    /* Establish the connection, the thread is interrupted if the pre-connection is released meanwhile, it is bounded by the connect timeout anyway */
+    while ((running > 0) && (false == atomic_load(&mender_http_preconnect_cancel))) {
+        if ((CURLM_OK != curl_multi_perform(multi, &running)) || (CURLM_OK != curl_multi_poll(multi, NULL, 0, CONFIG_MENDER_HTTP_EVENT_LOOP_POLL_TIMEOUT, NULL))) {
+            break;
+        }
+    }
+    curl_multi_remove_handle(multi, request->curl);
+
+    /* Release memory */
+    mender_http_request_release(request);
+
+    return NULL;
+}
+
+static mender_err_t
+mender_http_preconnect_callback(mender_http_client_event_t event, void *data, size_t data_length, void *params) {
+
+    (void)event;
+    (void)data;
+    (void)data_length;
+    (void)params;
+
+    /* Nothing to do */
     return MENDER_OK;
 }
 
+static void
+mender_http_preconnect_wait(char *path) {
+
+    /* Take mutex used to protect the pre-connection */
+    pthread_mutex_lock(&mender_http_preconnect_mutex);
+
+    /* Terminate the pre-connection, it is interrupted if it is not used by the caller */
+    if (NULL != mender_http_preconnect_url) {
+        if ((NULL == path) || (0 != strcmp(path, mender_http_preconnect_url))) {
+            atomic_store(&mender_http_preconnect_cancel, true);
+            curl_multi_wakeup(mender_http_preconnect_multi_handle);
+        }
+        pthread_join(mender_http_preconnect_thread_handle, NULL);
+        curl_multi_cleanup(mender_http_preconnect_multi_handle);
+        mender_http_preconnect_multi_handle = NULL;
+        free(mender_http_preconnect_url);
+        mender_http_preconnect_url = NULL;
+    }
+
+    /* Release mutex used to protect the pre-connection */
+    pthread_mutex_unlock(&mender_http_preconnect_mutex);
+}
+
+static void
+mender_http_share_lock_callback(CURL *handle, curl_lock_data data, curl_lock_access access, void *params) {
+
+    (void)handle;
+    (void)access;
+    (void)params;
+
+    /* Take mutex used to protect the shared data */
+    pthread_mutex_lock(&mender_http_share_mutex[data]);
+}
+
+static void
+mender_http_share_unlock_callback(CURL *handle, curl_lock_data data, void *params) {
+
+    (void)handle;
+    (void)params;
+
+    /* Release mutex used to protect the shared data */
+    pthread_mutex_unlock(&mender_http_share_mutex[data]);
+}
+
 static int
 mender_http_prereq_callback(void *params, char *conn_primary_ip, char *conn_local_ip, int conn_primary_port, int conn_local_port) {
 
     assert(NULL != params);
-    mender_http_curl_user_data_t *user_data = (mender_http_curl_user_data_t *)params;
+    mender_http_curl_request_t *request = (mender_http_curl_request_t *)params;
     (void)conn_primary_ip;
     (void)conn_local_ip;
     (void)conn_primary_port;
     (void)conn_local_port;
 
+    /* Start monitoring the transfer */
+    request->timestamp = mender_http_get_time();
+
     /* Invoke callback */
-    if (MENDER_OK != user_data->callback(MENDER_HTTP_EVENT_CONNECTED, NULL, 0, user_data->params)) {
+    if (MENDER_OK != request->callback(MENDER_HTTP_EVENT_CONNECTED, NULL, 0, request->params)) {
         mender_log_error("An error occurred");
         return CURL_PREREQFUNC_ABORT;
     }
@@ -266,12 +1453,12 @@ static size_t
 mender_http_write_callback(char *data, size_t size, size_t nmemb, void *params) {
 
     assert(NULL != params);
-    mender_http_curl_user_data_t *user_data = (mender_http_curl_user_data_t *)params;
-    size_t                        realsize  = size * nmemb;
+    mender_http_curl_request_t *request  = (mender_http_curl_request_t *)params;
+    size_t                      realsize = size * nmemb;
 
     /* Transmit data received to the upper layer */
     if (realsize > 0) {
-        if (MENDER_OK != user_data->callback(MENDER_HTTP_EVENT_DATA_RECEIVED, (void *)data, realsize, user_data->params)) {
+        if (MENDER_OK != request->callback(MENDER_HTTP_EVENT_DATA_RECEIVED, (void *)data, realsize, request->params)) {
             mender_log_error("An error occurred, stop reading data");
             return -1;
         }
@@ -279,3 +1466,55 @@ mender_http_write_callback(char *data, size_t size, size_t nmemb, void *params)
 
     return realsize;
 }
+
+static int
+mender_http_xferinfo_callback(void *params, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow) {
+
+    assert(NULL != params);
+    mender_http_curl_request_t *request = (mender_http_curl_request_t *)params;
+    int64_t                     now;
+    (void)dltotal;
+    (void)ultotal;
+
+    /* Abort the transfer if the work performing the request has been cancelled */
+    if (true == mender_scheduler_work_is_cancelled()) {
+        return 1;
+    }
+
+    /* Connection phase is monitored by the connect timeout */
+    if (0 == request->timestamp) {
+        return 0;
+    }
+
+    /* Restart the timer each time data are transferred */
+    now = mender_http_get_time();
+    if (dlnow + ulnow != request->transferred) {
+        request->transferred = dlnow + ulnow;
+        request->timestamp   = now;
+        return 0;
+    }
+
+    /* Check the first byte timeout until the response is received, the idle timeout then */
+    if (0 == dlnow) {
+        if ((CONFIG_MENDER_HTTP_FIRST_BYTE_TIMEOUT > 0) && (now - request->timestamp > CONFIG_MENDER_HTTP_FIRST_BYTE_TIMEOUT * 1000)) {
+            mender_log_error("No response received after %d seconds, aborting", CONFIG_MENDER_HTTP_FIRST_BYTE_TIMEOUT);
+            return 1;
+        }
+    } else if ((CONFIG_MENDER_HTTP_IDLE_TIMEOUT > 0) && (now - request->timestamp > CONFIG_MENDER_HTTP_IDLE_TIMEOUT * 1000)) {
+        mender_log_error("No data received after %d seconds, aborting", CONFIG_MENDER_HTTP_IDLE_TIMEOUT);
+        return 1;
+    }
+
+    return 0;
+}
+
+static int64_t
+mender_http_get_time(void) {
+
+    struct timespec now;
+
+    /* Read monotonic clock */
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
@@ -51,6 +51,47 @@ mender_http_perform(char                *jwt,
     return MENDER_NOT_IMPLEMENTED;
 }
 
+__attribute__((weak)) mender_err_t
+mender_http_perform_async(char                *jwt,
+                          char                *path,
+                          mender_http_method_t method,
+                          char                *payload,
+                          char                *signature,
+                          mender_err_t (*callback)(mender_http_client_event_t, void *, size_t, void *),
+                          void (*done)(mender_err_t, int, void *),
+                          void *params) {
+
+    (void)jwt;
+    (void)path;
+    (void)method;
+    (void)payload;
+    (void)signature;
+    (void)callback;
+    (void)done;
+    (void)params;
+
+    /* Nothing to do */
+    return MENDER_NOT_IMPLEMENTED;
+}
+
+__attribute__((weak)) mender_err_t
+mender_http_get_retry_after(uint32_t *delay) {
+
+    (void)delay;
+
+    /* Nothing to do */
+    return MENDER_NOT_IMPLEMENTED;
+}
+
+__attribute__((weak)) mender_err_t
+mender_http_preconnect(char *path) {
+
+    (void)path;
+
+    /* Nothing to do */
+    return MENDER_NOT_IMPLEMENTED;
+}
+
 __attribute__((weak)) mender_err_t
 mender_http_exit(void) {
 
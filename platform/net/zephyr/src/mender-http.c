@@ -17,12 +17,46 @@
  * limitations under the License.
  */
 
+#include <errno.h>
+#include <strings.h>
 #include <version.h>
 #include <zephyr/net/http/client.h>
+#include <zephyr/net/http/parser.h>
+#include <zephyr/net/socket.h>
 #include <zephyr/kernel.h>
 #include "mender-http.h"
 #include "mender-log.h"
 #include "mender-net.h"
+#include "mender-scheduler.h"
+#include "mender-utils.h"
+
+/**
+ * @brief Default HTTP event loop thread stack size (kB)
+ */
+#ifndef CONFIG_MENDER_HTTP_EVENT_LOOP_THREAD_STACK_SIZE
+#define CONFIG_MENDER_HTTP_EVENT_LOOP_THREAD_STACK_SIZE (8)
+#endif /* CONFIG_MENDER_HTTP_EVENT_LOOP_THREAD_STACK_SIZE */
+
+/**
+ * @brief Default HTTP event loop thread priority
+ */
+#ifndef CONFIG_MENDER_HTTP_EVENT_LOOP_THREAD_PRIORITY
+#define CONFIG_MENDER_HTTP_EVENT_LOOP_THREAD_PRIORITY (5)
+#endif /* CONFIG_MENDER_HTTP_EVENT_LOOP_THREAD_PRIORITY */
+
+/**
+ * @brief Default maximum number of asynchronous requests in progress in the HTTP event loop
+ */
+#ifndef CONFIG_MENDER_HTTP_EVENT_LOOP_MAX_REQUESTS
+#define CONFIG_MENDER_HTTP_EVENT_LOOP_MAX_REQUESTS (4)
+#endif /* CONFIG_MENDER_HTTP_EVENT_LOOP_MAX_REQUESTS */
+
+/**
+ * @brief Default HTTP event loop poll timeout (milliseconds)
+ */
+#ifndef CONFIG_MENDER_HTTP_EVENT_LOOP_POLL_TIMEOUT
+#define CONFIG_MENDER_HTTP_EVENT_LOOP_POLL_TIMEOUT (100)
+#endif /* CONFIG_MENDER_HTTP_EVENT_LOOP_POLL_TIMEOUT */
 
 /**
  * @brief HTTP User-Agent
@@ -35,9 +69,51 @@
 #define MENDER_HTTP_RECV_BUF_LENGTH (512)
 
 /**
- * @brief Request timeout (milliseconds)
+ * @brief Default request timeout (seconds)
+ */
+#ifndef CONFIG_MENDER_HTTP_REQUEST_TIMEOUT
+#define CONFIG_MENDER_HTTP_REQUEST_TIMEOUT (600)
+#endif /* CONFIG_MENDER_HTTP_REQUEST_TIMEOUT */
+
+/**
+ * @brief Default timeout waiting for the first byte of the response once the request is sent (seconds), 0 to disable
  */
-#define MENDER_HTTP_REQUEST_TIMEOUT (600 * MSEC_PER_SEC)
+#ifndef CONFIG_MENDER_HTTP_FIRST_BYTE_TIMEOUT
+#define CONFIG_MENDER_HTTP_FIRST_BYTE_TIMEOUT (60)
+#endif /* CONFIG_MENDER_HTTP_FIRST_BYTE_TIMEOUT */
+
+/**
+ * @brief Default timeout between two chunks of data (seconds), 0 to disable
+ */
+#ifndef CONFIG_MENDER_HTTP_IDLE_TIMEOUT
+#define CONFIG_MENDER_HTTP_IDLE_TIMEOUT (60)
+#endif /* CONFIG_MENDER_HTTP_IDLE_TIMEOUT */
+
+/**
+ * @brief Default low speed limit (bytes/s), transfers slower than this limit during the low speed time are aborted, 0 to disable
+ */
+#ifndef CONFIG_MENDER_HTTP_LOW_SPEED_LIMIT
+#define CONFIG_MENDER_HTTP_LOW_SPEED_LIMIT (128)
+#endif /* CONFIG_MENDER_HTTP_LOW_SPEED_LIMIT */
+
+/**
+ * @brief Default low speed time (seconds)
+ */
+#ifndef CONFIG_MENDER_HTTP_LOW_SPEED_TIME
+#define CONFIG_MENDER_HTTP_LOW_SPEED_TIME (120)
+#endif /* CONFIG_MENDER_HTTP_LOW_SPEED_TIME */
+
+/**
+ * @brief Default number of consecutive retries without receiving data of artifact downloads, transfers are resumed from the last byte received
+ */
+#ifndef CONFIG_MENDER_HTTP_DOWNLOAD_RETRIES
+#define CONFIG_MENDER_HTTP_DOWNLOAD_RETRIES (3)
+#endif /* CONFIG_MENDER_HTTP_DOWNLOAD_RETRIES */
+
+/**
+ * @brief Period of the watchdog of the synchronous requests (milliseconds)
+ */
+#define MENDER_HTTP_WATCHDOG_PERIOD (1000)
 
 /**
  * @brief Request context
@@ -46,13 +122,118 @@ typedef struct {
     mender_err_t (*callback)(mender_http_client_event_t, void *, size_t, void *); /**< Callback to be invoked when data are received */
     void        *params;                                                          /**< Callback parameters */
     mender_err_t ret;                                                             /**< Last callback return value */
+    int          sock;                                                            /**< Client socket */
+    char         header[32];    /**< Beginning of the header line being received, only short headers are of interest */
+    size_t       header_length; /**< Length of the header line being received */
+    bool         headers_done;  /**< Flag used to indicate the headers of the response have been completely received */
+    void                   *work;      /**< Work performing the request, NULL if it is not performed from a work */
+    bool                    receiving; /**< Flag used to indicate the first byte of the response has been received */
+    atomic_t                timestamp; /**< Time the request has been sent or the last data have been received (milliseconds, 32 bits uptime) */
+    struct k_work_delayable watchdog;  /**< Work used to abort the request when it is cancelled or when data are not received in time */
+    atomic_t                timed_out; /**< Flag used to indicate the request has been aborted by the watchdog because data are not received in time */
+    atomic_t                cancelled; /**< Flag used to indicate the request has been aborted by the watchdog because the work has been cancelled */
+    atomic_t                speed_received;  /**< Length of the data received since the beginning of the low speed window */
+    uint32_t                speed_timestamp; /**< Beginning of the low speed window (milliseconds, 32 bits uptime), only used by the watchdog */
+    bool                    complete;        /**< Flag used to indicate the response has been completely received */
+    bool                    body_started;    /**< Flag used to indicate the beginning of the body of the response has been received */
+    size_t                  offset;          /**< Offset of the data requested when a download is resumed, 0 otherwise */
+    size_t                  range_start;     /**< Offset of the data given by the Content-Range header of the response, SIZE_MAX if not present */
+    size_t                  skip;            /**< Length of the body to be skipped, data already transmitted to the upper layer */
+    size_t                  received;        /**< Length of the body transmitted to the upper layer */
 } mender_http_request_context;
 
+/**
+ * @brief Asynchronous request
+ */
+typedef struct mender_http_async_request_s {
+    char              *host;      /**< Host of the request */
+    char              *port;      /**< Port of the request */
+    char              *request;   /**< Request to be sent, including headers and payload */
+    int                sock;      /**< Client socket, -1 if not connected */
+    struct http_parser parser;    /**< Parser of the response */
+    bool               complete;  /**< Flag used to indicate the response has been completely received */
+    bool               receiving; /**< Flag used to indicate the first byte of the response has been received */
+    int64_t            start;     /**< Time the request has been sent (milliseconds) */
+    int64_t            timestamp; /**< Time of the last activity on the socket (milliseconds) */
+    mender_err_t (*callback)(mender_http_client_event_t, void *, size_t, void *); /**< Callback invoked on HTTP events */
+    void (*done)(mender_err_t, int, void *);                                      /**< Callback invoked when the request is completed */
+    void                               *params; /**< Parameters passed to the callbacks, NULL if not used */
+    mender_err_t                        ret;    /**< Last callback return value */
+    struct mender_http_async_request_s *next;   /**< Next request of the list */
+} mender_http_async_request_t;
+
 /**
  * @brief Mender HTTP configuration
  */
 static mender_http_config_t mender_http_config;
 
+/**
+ * @brief Mender HTTP event loop thread stack
+ */
+K_THREAD_STACK_DEFINE(mender_http_event_loop_thread_stack, CONFIG_MENDER_HTTP_EVENT_LOOP_THREAD_STACK_SIZE * 1024);
+
+/**
+ * @brief Mender HTTP event loop thread handle
+ */
+static struct k_thread mender_http_event_loop_thread_handle;
+
+/**
+ * @brief Flag used to indicate the HTTP event loop thread is running
+ */
+static bool mender_http_event_loop_started = false;
+
+/**
+ * @brief Flag used to request the HTTP event loop thread to terminate
+ */
+static bool mender_http_event_loop_exit = false;
+
+/**
+ * @brief HTTP event loop mutex, used to protect the list of pending requests and the event loop state
+ */
+static K_MUTEX_DEFINE(mender_http_event_loop_mutex);
+
+/**
+ * @brief HTTP event loop semaphore, used to wake up the event loop when it is idle
+ */
+static K_SEM_DEFINE(mender_http_event_loop_sem, 0, 1);
+
+/**
+ * @brief Asynchronous requests waiting to be started by the event loop
+ */
+static mender_http_async_request_t *mender_http_pending_requests = NULL;
+
+/**
+ * @brief Pre-connection URL, host and port, NULL if no pre-connection is in progress
+ */
+static char *mender_http_preconnect_path = NULL;
+static char *mender_http_preconnect_host = NULL;
+static char *mender_http_preconnect_port = NULL;
+
+/**
+ * @brief Flag used to indicate the pre-connection is waiting to be performed by the event loop
+ */
+static bool mender_http_preconnect_pending = false;
+
+/**
+ * @brief Pre-connection socket, -1 if not connected
+ */
+static int mender_http_preconnect_sock = -1;
+
+/**
+ * @brief Pre-connection semaphore, given by the event loop when the pre-connection is done
+ */
+static K_SEM_DEFINE(mender_http_preconnect_sem, 0, 1);
+
+/**
+ * @brief Delay requested by the server with the Retry-After header of the last response (seconds)
+ */
+static uint32_t mender_http_retry_after = 0;
+
+/**
+ * @brief HTTP response parser settings used by asynchronous requests
+ */
+static struct http_parser_settings mender_http_parser_settings;
+
 /**
  * @brief HTTP response callback, invoked to handle data received
  * @param response HTTP response structure
@@ -61,6 +242,21 @@ static mender_http_config_t mender_http_config;
  */
 static void mender_http_response_cb(struct http_response *response, enum http_final_call final_call, void *user_data);
 
+/**
+ * @brief Parse the headers of the response of synchronous requests, used to read the Retry-After and Content-Range headers
+ * @param request_context Request context
+ * @param data Data received
+ * @param length Length of the data
+ */
+static void mender_http_parse_headers(mender_http_request_context *request_context, const char *data, size_t length);
+
+/**
+ * @brief Watchdog of the synchronous requests, shut the socket down when the work performing the request is cancelled, when the first byte or the next
+ *        chunk of data is not received in time or when the transfer is too slow, this is checked periodically because the request may be blocked
+ * @param work Watchdog work
+ */
+static void mender_http_watchdog_handler(struct k_work *work);
+
 /**
  * @brief Convert mender HTTP method to Zephyr HTTP client method
  * @param method Mender HTTP method
@@ -68,6 +264,72 @@ static void mender_http_response_cb(struct http_response *response, enum http_fi
  */
 static enum http_method mender_http_method_to_zephyr_http_client_method(mender_http_method_t method);
 
+/**
+ * @brief Start the HTTP event loop thread if it is not already running, the event loop mutex must be taken
+ */
+static void mender_http_event_loop_start(void);
+
+/**
+ * @brief HTTP event loop thread, used to perform asynchronous requests
+ * @param p1 Not used
+ * @param p2 Not used
+ * @param p3 Not used
+ */
+static void mender_http_event_loop_thread(void *p1, void *p2, void *p3);
+
+/**
+ * @brief Terminate the pre-connection and retrieve the socket, the pre-connection is left untouched if it has been done for another URL
+ * @param path URL of the GET request to be performed, NULL to release the pre-connection
+ * @return Connected socket if the pre-connection has been done for the URL, -1 otherwise
+ */
+static int mender_http_preconnect_take(char *path);
+
+/**
+ * @brief Allocate and format the request of an asynchronous request
+ * @param format Format string
+ * @return Pointer to the allocated string if the function succeeds, NULL otherwise
+ */
+static char *mender_http_async_request_printf(const char *format, ...);
+
+/**
+ * @brief Start asynchronous request, connect to the server and send the request
+ * @param request Asynchronous request
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_http_async_request_start(mender_http_async_request_t *request);
+
+/**
+ * @brief Receive data of asynchronous request and feed the response parser
+ * @param request Asynchronous request
+ * @param buffer Receive buffer
+ * @param length Length of the receive buffer
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_http_async_request_receive(mender_http_async_request_t *request, char *buffer, size_t length);
+
+/**
+ * @brief Complete asynchronous request, invoke the callbacks and release memory
+ * @param request Asynchronous request
+ * @param ret Result of the request
+ */
+static void mender_http_async_request_complete(mender_http_async_request_t *request, mender_err_t ret);
+
+/**
+ * @brief HTTP parser body callback, invoked to handle data received by asynchronous requests
+ * @param parser HTTP parser
+ * @param at Data received
+ * @param length Length of the data
+ * @return 0 if the function succeeds, non-zero value to stop parsing otherwise
+ */
+static int mender_http_parser_on_body(struct http_parser *parser, const char *at, size_t length);
+
+/**
+ * @brief HTTP parser message complete callback, invoked when the response of asynchronous requests is completely received
+ * @param parser HTTP parser
+ * @return 0 if the function succeeds, non-zero value to stop parsing otherwise
+ */
+static int mender_http_parser_on_message_complete(struct http_parser *parser);
+
 mender_err_t
 mender_http_init(mender_http_config_t *config) {
 
@@ -77,6 +339,11 @@ mender_http_init(mender_http_config_t *config) {
     /* Save configuration */
     memcpy(&mender_http_config, config, sizeof(mender_http_config_t));
 
+    /* Initialization of the response parser settings used by asynchronous requests */
+    http_parser_settings_init(&mender_http_parser_settings);
+    mender_http_parser_settings.on_body             = mender_http_parser_on_body;
+    mender_http_parser_settings.on_message_complete = mender_http_parser_on_message_complete;
+
     return MENDER_OK;
 }
 
@@ -103,7 +370,7 @@ mender_http_perform(char                *jwt,
     assert(NULL != status);
     mender_err_t                ret                = MENDER_FAIL;
     struct http_request         request            = { 0 };
-    mender_http_request_context request_context    = { callback = callback, params = params, ret = MENDER_OK };
+    mender_http_request_context request_context    = { .callback = callback, .params = params, .ret = MENDER_OK, .sock = -1 };
     const char                 *header_fields[6]   = { NULL }; /* The list is NULL terminated; make sure the size reflects it */
     size_t                      header_fields_size = sizeof(header_fields) / sizeof(header_fields[0]);
     char                       *host               = NULL;
@@ -115,6 +382,10 @@ mender_http_perform(char                *jwt,
     char *host_header      = NULL;
     char *auth_header      = NULL;
     char *signature_header = NULL;
+    char *range_header     = NULL;
+
+    /* Forget the Retry-After header of the previous response */
+    mender_http_retry_after = 0;
 
     /* Retrieve host, port and url */
     if (MENDER_OK != mender_net_get_host_port_url(path, mender_http_config.host, &host, &port, &url)) {
@@ -173,35 +444,132 @@ mender_http_perform(char                *jwt,
 
     request.header_fields = header_fields;
 
-    /* Connect to the server */
-    sock = mender_net_connect(host, port);
-    if (sock < 0) {
-        mender_log_error("Unable to open HTTP client connection");
-        goto END;
-    }
-    if (MENDER_OK != (ret = callback(MENDER_HTTP_EVENT_CONNECTED, NULL, 0, params))) {
-        mender_log_error("An error occurred while calling 'MENDER_HTTP_EVENT_CONNECTED' callback");
-        goto END;
-    }
+    /* Artifacts are downloaded from pre-signed URLs, the transfer is not limited in time and it is resumed with ranged requests on failure */
+    bool   download = (MENDER_HTTP_GET == method) && (NULL == jwt) && (NULL == payload)
+                      && ((true == mender_utils_strbeginwith(path, "http://")) || (true == mender_utils_strbeginwith(path, "https://")));
+    bool   resuming = false;
+    size_t resumed  = 0;
+    int    retries  = 0;
 
-    /* Perform HTTP request */
-    if (http_client_req(sock, &request, MENDER_HTTP_REQUEST_TIMEOUT, (void *)&request_context) < 0) {
-        mender_log_error("Unable to write data");
-        goto END;
-    }
+    /* Start the watchdog, the cancellation is checked with the work performing the request because the response callback is only invoked with data */
+    request_context.work = mender_scheduler_work_get_current();
+    k_work_init_delayable(&request_context.watchdog, mender_http_watchdog_handler);
 
-    /* Check if an error occured during the treatment of data */
-    if (MENDER_OK != (ret = request_context.ret)) {
-        goto END;
-    }
+    while (true) {
 
-    /* Read HTTP status code */
-    if (0 == request.internal.response.http_status_code) {
-        mender_log_error("An error occurred, connection has been closed");
-        callback(MENDER_HTTP_EVENT_ERROR, NULL, 0, params);
-        goto END;
-    } else {
-        *status = request.internal.response.http_status_code;
+        /* Request the data not received yet when the download is resumed, the Range header is the last one of the list */
+        if (request_context.received > 0) {
+            for (size_t index = 0; (NULL != range_header) && (index < header_fields_size); index++) {
+                if (header_fields[index] == range_header) {
+                    header_fields[index] = NULL;
+                }
+            }
+            free(range_header);
+            range_header = header_alloc_and_add(header_fields, header_fields_size, "Range: bytes=%zu-\r\n", request_context.received);
+            if (NULL == range_header) {
+                mender_log_error("Unable to add 'Range' header");
+                ret = MENDER_FAIL;
+                goto END;
+            }
+        }
+
+        /* Connect to the server, the connection may have been established in background already for the download of the artifact */
+        if ((MENDER_HTTP_GET != method) || (true == resuming) || ((sock = mender_http_preconnect_take(path)) < 0)) {
+            sock = mender_net_connect(host, port);
+        }
+        if ((sock < 0) && (false == resuming)) {
+            mender_log_error("Unable to open HTTP client connection");
+            ret = MENDER_FAIL;
+            goto END;
+        }
+        if ((sock >= 0) && (false == resuming)) {
+            if (MENDER_OK != (ret = callback(MENDER_HTTP_EVENT_CONNECTED, NULL, 0, params))) {
+                mender_log_error("An error occurred while calling 'MENDER_HTTP_EVENT_CONNECTED' callback");
+                goto END;
+            }
+        }
+        request_context.sock = sock;
+
+        /* Perform HTTP request, the connection failures of resumed downloads are retried */
+        int result = -ENOTCONN;
+        if (sock >= 0) {
+            request_context.header_length = 0;
+            request_context.headers_done  = false;
+            request_context.receiving     = false;
+            request_context.complete      = false;
+            request_context.body_started  = false;
+            request_context.offset        = request_context.received;
+            request_context.range_start   = SIZE_MAX;
+            request_context.skip          = 0;
+            atomic_set(&request_context.timed_out, 0);
+            atomic_set(&request_context.speed_received, 0);
+            request_context.speed_timestamp = k_uptime_get_32();
+            atomic_set(&request_context.timestamp, (atomic_val_t)request_context.speed_timestamp);
+            k_work_schedule(&request_context.watchdog, K_MSEC(MENDER_HTTP_WATCHDOG_PERIOD));
+            result = http_client_req(
+                sock, &request, (true == download) ? SYS_FOREVER_MS : (CONFIG_MENDER_HTTP_REQUEST_TIMEOUT * MSEC_PER_SEC), (void *)&request_context);
+
+            /* Stop the watchdog, the request context must not be used anymore once the function returns */
+            struct k_work_sync sync;
+            k_work_cancel_delayable_sync(&request_context.watchdog, &sync);
+        }
+
+        /* Check if an error occured during the treatment of data, the request is interrupted if it has been cancelled */
+        if (MENDER_OK != (ret = request_context.ret)) {
+            goto END;
+        }
+        if (0 != atomic_get(&request_context.cancelled)) {
+            ret = MENDER_CANCELLED;
+            goto END;
+        }
+
+        /* Resume the download if it has been interrupted, retries are counted only when no data has been received */
+        int status_code = (sock >= 0) ? request.internal.response.http_status_code : 0;
+        if ((true == download) && ((0 != atomic_get(&request_context.timed_out)) || (result < 0) || (false == request_context.complete))
+            && ((0 == status_code) || (200 == status_code) || (206 == status_code))
+            && ((request_context.received > resumed) || (retries < CONFIG_MENDER_HTTP_DOWNLOAD_RETRIES))) {
+            retries  = (request_context.received > resumed) ? 0 : (retries + 1);
+            resumed  = request_context.received;
+            resuming = true;
+            mender_log_warning("Download interrupted after %zu bytes, resuming", request_context.received);
+            if (sock >= 0) {
+                mender_net_disconnect(sock);
+                sock = -1;
+            }
+            continue;
+        }
+        if (sock < 0) {
+            mender_log_error("Unable to open HTTP client connection");
+            callback(MENDER_HTTP_EVENT_ERROR, NULL, 0, params);
+            ret = MENDER_FAIL;
+            goto END;
+        }
+        if (0 != atomic_get(&request_context.timed_out)) {
+            callback(MENDER_HTTP_EVENT_ERROR, NULL, 0, params);
+            ret = MENDER_FAIL;
+            goto END;
+        }
+        if (result < 0) {
+            mender_log_error("Unable to write data");
+            ret = MENDER_FAIL;
+            goto END;
+        }
+
+        /* Read HTTP status code, the partial content of resumed downloads is reported as the whole content */
+        if (0 == status_code) {
+            mender_log_error("An error occurred, connection has been closed");
+            callback(MENDER_HTTP_EVENT_ERROR, NULL, 0, params);
+            ret = MENDER_FAIL;
+            goto END;
+        } else if ((true == download) && (false == request_context.complete)) {
+            mender_log_error("Unable to download artifact, the response is incomplete");
+            callback(MENDER_HTTP_EVENT_ERROR, NULL, 0, params);
+            ret = MENDER_FAIL;
+            goto END;
+        } else {
+            *status = ((NULL != range_header) && (206 == status_code)) ? 200 : status_code;
+        }
+        break;
     }
     if (MENDER_OK != (ret = callback(MENDER_HTTP_EVENT_DISCONNECTED, NULL, 0, params))) {
         mender_log_error("An error occurred while calling 'MENDER_HTTP_EVENT_DISCONNECTED' callback");
@@ -224,16 +592,175 @@ END:
     free(host_header);
     free(auth_header);
     free(signature_header);
+    free(range_header);
 
     free(request.recv_buf);
 
     return ret;
 }
 
+mender_err_t
+mender_http_perform_async(char                *jwt,
+                          char                *path,
+                          mender_http_method_t method,
+                          char                *payload,
+                          char                *signature,
+                          mender_err_t (*callback)(mender_http_client_event_t, void *, size_t, void *),
+                          void (*done)(mender_err_t, int, void *),
+                          void *params) {
+
+    assert(NULL != path);
+    assert(NULL != callback);
+    mender_http_async_request_t *request = NULL;
+    char                        *url     = NULL;
+
+    /* Allocate memory for the request */
+    if (NULL == (request = (mender_http_async_request_t *)calloc(1, sizeof(mender_http_async_request_t)))) {
+        mender_log_error("Unable to allocate memory");
+        goto FAIL;
+    }
+    request->sock     = -1;
+    request->callback = callback;
+    request->done     = done;
+    request->params   = params;
+    request->ret      = MENDER_OK;
+
+    /* Retrieve host, port and url */
+    if (MENDER_OK != mender_net_get_host_port_url(path, mender_http_config.host, &request->host, &request->port, &url)) {
+        mender_log_error("Unable to retrieve host/port/url");
+        goto FAIL;
+    }
+
+    /* Build the request, the connection is closed by the server at the end of the response */
+    if (NULL
+        == (request->request = mender_http_async_request_printf("%s %s HTTP/1.1\r\n"
+                                                                "Host: %s\r\n" MENDER_HEADER_HTTP_USER_AGENT "Connection: close\r\n"
+                                                                "%s%s%s%s%s%s%s"
+                                                                "Content-Length: %u\r\n\r\n%s",
+                                                                http_method_str(mender_http_method_to_zephyr_http_client_method(method)),
+                                                                url,
+                                                                request->host,
+                                                                (NULL != jwt) ? "Authorization: Bearer " : "",
+                                                                (NULL != jwt) ? jwt : "",
+                                                                (NULL != jwt) ? "\r\n" : "",
+                                                                (NULL != signature) ? "X-MEN-Signature: " : "",
+                                                                (NULL != signature) ? signature : "",
+                                                                (NULL != signature) ? "\r\n" : "",
+                                                                (NULL != payload) ? "Content-Type: application/json\r\n" : "",
+                                                                (NULL != payload) ? (unsigned int)strlen(payload) : 0,
+                                                                (NULL != payload) ? payload : ""))) {
+        mender_log_error("Unable to build request");
+        goto FAIL;
+    }
+    free(url);
+    url = NULL;
+
+    /* Take mutex used to protect the event loop */
+    k_mutex_lock(&mender_http_event_loop_mutex, K_FOREVER);
+
+    /* Start the event loop thread if it is not already running */
+    mender_http_event_loop_start();
+
+    /* Append the request to the list of pending requests */
+    if (NULL == mender_http_pending_requests) {
+        mender_http_pending_requests = request;
+    } else {
+        mender_http_async_request_t *last = mender_http_pending_requests;
+        while (NULL != last->next) {
+            last = last->next;
+        }
+        last->next = request;
+    }
+
+    /* Release mutex used to protect the event loop */
+    k_mutex_unlock(&mender_http_event_loop_mutex);
+
+    /* Wake up the event loop */
+    k_sem_give(&mender_http_event_loop_sem);
+
+    return MENDER_OK;
+
+FAIL:
+
+    /* Release memory */
+    if (NULL != request) {
+        free(request->host);
+        free(request->port);
+        free(request->request);
+        free(request);
+    }
+    free(url);
+
+    return MENDER_FAIL;
+}
+
+mender_err_t
+mender_http_get_retry_after(uint32_t *delay) {
+
+    assert(NULL != delay);
+
+    /* Return the delay of the last response */
+    *delay = mender_http_retry_after;
+
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_http_preconnect(char *path) {
+
+    assert(NULL != path);
+    char *copy = NULL;
+    char *host = NULL;
+    char *port = NULL;
+    char *url  = NULL;
+
+    /* Release previous pre-connection if any */
+    mender_http_preconnect_take(NULL);
+
+    /* Retrieve host and port */
+    if ((NULL == (copy = strdup(path))) || (MENDER_OK != mender_net_get_host_port_url(path, mender_http_config.host, &host, &port, &url))) {
+        mender_log_error("Unable to retrieve host/port/url");
+        free(copy);
+        free(host);
+        free(port);
+        free(url);
+        return MENDER_FAIL;
+    }
+    free(url);
+
+    /* Request the event loop to connect to the server in background */
+    k_mutex_lock(&mender_http_event_loop_mutex, K_FOREVER);
+    mender_http_event_loop_start();
+    mender_http_preconnect_path    = copy;
+    mender_http_preconnect_host    = host;
+    mender_http_preconnect_port    = port;
+    mender_http_preconnect_pending = true;
+    k_sem_reset(&mender_http_preconnect_sem);
+    k_mutex_unlock(&mender_http_event_loop_mutex);
+    k_sem_give(&mender_http_event_loop_sem);
+
+    return MENDER_OK;
+}
+
 mender_err_t
 mender_http_exit(void) {
 
-    /* Nothing to do */
+    bool started;
+
+    /* Release pre-connection if any */
+    mender_http_preconnect_take(NULL);
+
+    /* Request the event loop thread to terminate */
+    k_mutex_lock(&mender_http_event_loop_mutex, K_FOREVER);
+    started                        = mender_http_event_loop_started;
+    mender_http_event_loop_exit    = true;
+    mender_http_event_loop_started = false;
+    k_mutex_unlock(&mender_http_event_loop_mutex);
+    if (true == started) {
+        k_sem_give(&mender_http_event_loop_sem);
+        k_thread_join(&mender_http_event_loop_thread_handle, K_FOREVER);
+    }
+
     return MENDER_OK;
 }
 
@@ -241,22 +768,166 @@ static void
 mender_http_response_cb(struct http_response *response, enum http_final_call final_call, void *user_data) {
 
     assert(NULL != response);
-    (void)final_call;
     assert(NULL != user_data);
 
     /* Retrieve request context */
     mender_http_request_context *request_context = (mender_http_request_context *)user_data;
 
+    /* Indicate data have been received to the watchdog */
+    request_context->receiving = true;
+    atomic_set(&request_context->timestamp, (atomic_val_t)k_uptime_get_32());
+    if (HTTP_DATA_FINAL == final_call) {
+        request_context->complete = true;
+    }
+
+    /* Parse the headers, the receive buffer is reported each time it is full so the data are never reported twice */
+    if ((false == request_context->headers_done) && (NULL != response->recv_buf)) {
+        mender_http_parse_headers(request_context, (const char *)response->recv_buf, response->data_len);
+    }
+
+    /* Stop receiving data if the work performing the request has been cancelled */
+    if ((MENDER_OK == request_context->ret) && (true == mender_scheduler_work_is_cancelled())) {
+        mender_log_warning("HTTP request cancelled");
+        request_context->ret = MENDER_CANCELLED;
+        zsock_shutdown(request_context->sock, ZSOCK_SHUT_RD);
+        return;
+    }
+
     /* Check if data is available */
     if ((true == response->body_found) && (NULL != response->body_frag_start) && (0 != response->body_frag_len) && (MENDER_OK == request_context->ret)) {
+        char  *data   = (char *)response->body_frag_start;
+        size_t length = response->body_frag_len;
+        atomic_add(&request_context->speed_received, (atomic_val_t)length);
+
+        /* Check the beginning of the response when the download is resumed, the whole content is replied if the server ignores the range */
+        if ((false == request_context->body_started) && (request_context->offset > 0)) {
+            if (200 == response->http_status_code) {
+                request_context->skip = request_context->offset;
+            } else if ((206 != response->http_status_code) || (request_context->range_start != request_context->offset)) {
+                mender_log_error("Unable to resume download, unexpected response");
+                request_context->ret = MENDER_FAIL;
+                zsock_shutdown(request_context->sock, ZSOCK_SHUT_RD);
+                return;
+            }
+        }
+        request_context->body_started = true;
+
+        /* Skip the data already transmitted */
+        if (request_context->skip > 0) {
+            size_t skipped = (length < request_context->skip) ? length : request_context->skip;
+            data += skipped;
+            length -= skipped;
+            request_context->skip -= skipped;
+        }
 
         /* Transmit data received to the upper layer */
-        if (MENDER_OK
-            != (request_context->ret = request_context->callback(
-                    MENDER_HTTP_EVENT_DATA_RECEIVED, (void *)response->body_frag_start, response->body_frag_len, request_context->params))) {
-            mender_log_error("An error occurred, stop reading data");
+        if (length > 0) {
+            if (MENDER_OK != (request_context->ret = request_context->callback(MENDER_HTTP_EVENT_DATA_RECEIVED, data, length, request_context->params))) {
+                mender_log_error("An error occurred, stop reading data");
+            }
+            request_context->received += length;
+        }
+    }
+}
+
+static void
+mender_http_parse_headers(mender_http_request_context *request_context, const char *data, size_t length) {
+
+    assert(NULL != request_context);
+    assert(NULL != data);
+
+    /* Read the headers line by line until the empty line separating them from the body */
+    for (size_t index = 0; (index < length) && (false == request_context->headers_done); index++) {
+        if ('\n' == data[index]) {
+            request_context->header[request_context->header_length] = '\0';
+            if (0 == request_context->header_length) {
+                request_context->headers_done = true;
+            } else if (0 == strncasecmp(request_context->header, "Retry-After:", strlen("Retry-After:"))) {
+                /* Only the delay-seconds form of the Retry-After header is supported */
+                char         *value = request_context->header + strlen("Retry-After:");
+                char         *end   = NULL;
+                unsigned long delay;
+                while (' ' == *value) {
+                    value++;
+                }
+                delay = strtoul(value, &end, 10);
+                while (' ' == *end) {
+                    end++;
+                }
+                if ((end != value) && ('\0' == *end)) {
+                    mender_http_retry_after = (delay > UINT32_MAX) ? UINT32_MAX : (uint32_t)delay;
+                }
+            } else if (0 == strncasecmp(request_context->header, "Content-Range:", strlen("Content-Range:"))) {
+                /* Only the beginning of the range is of interest, the header line may be truncated */
+                char              *value = request_context->header + strlen("Content-Range:");
+                char              *end   = NULL;
+                unsigned long long start;
+                while (' ' == *value) {
+                    value++;
+                }
+                if (0 == strncasecmp(value, "bytes ", strlen("bytes "))) {
+                    value += strlen("bytes ");
+                    start = strtoull(value, &end, 10);
+                    if ((end != value) && ('-' == *end) && (start <= SIZE_MAX)) {
+                        request_context->range_start = (size_t)start;
+                    }
+                }
+            }
+            request_context->header_length = 0;
+        } else if (('\r' != data[index]) && (request_context->header_length < sizeof(request_context->header) - 1)) {
+            request_context->header[request_context->header_length++] = data[index];
+        }
+    }
+}
+
+static void
+mender_http_watchdog_handler(struct k_work *work) {
+
+    assert(NULL != work);
+
+    /* Retrieve request context */
+    mender_http_request_context *request_context = CONTAINER_OF(k_work_delayable_from_work(work), mender_http_request_context, watchdog);
+
+    /* Check if the work performing the request has been cancelled */
+    if ((NULL != request_context->work) && (true == mender_scheduler_work_is_deactivating(request_context->work))) {
+        mender_log_warning("HTTP request cancelled");
+        atomic_set(&request_context->cancelled, 1);
+        zsock_shutdown(request_context->sock, ZSOCK_SHUT_RD);
+        return;
+    }
+
+    /* Check if the first byte or the next chunk of data has been received in time, the socket is shut down so that the request returns */
+    uint32_t elapsed = k_uptime_get_32() - (uint32_t)atomic_get(&request_context->timestamp);
+    if ((false == request_context->receiving) && (CONFIG_MENDER_HTTP_FIRST_BYTE_TIMEOUT > 0)
+        && (elapsed > CONFIG_MENDER_HTTP_FIRST_BYTE_TIMEOUT * MSEC_PER_SEC)) {
+        mender_log_error("No response received after %d seconds, aborting", CONFIG_MENDER_HTTP_FIRST_BYTE_TIMEOUT);
+        atomic_set(&request_context->timed_out, 1);
+        zsock_shutdown(request_context->sock, ZSOCK_SHUT_RD);
+        return;
+    }
+    if ((true == request_context->receiving) && (CONFIG_MENDER_HTTP_IDLE_TIMEOUT > 0) && (elapsed > CONFIG_MENDER_HTTP_IDLE_TIMEOUT * MSEC_PER_SEC)) {
+        mender_log_error("No data received after %d seconds, aborting", CONFIG_MENDER_HTTP_IDLE_TIMEOUT);
+        atomic_set(&request_context->timed_out, 1);
+        zsock_shutdown(request_context->sock, ZSOCK_SHUT_RD);
+        return;
+    }
+
+    /* Check the average speed of the transfer over the low speed time, the window starts again each time it is checked */
+    uint32_t window = k_uptime_get_32() - request_context->speed_timestamp;
+    if ((CONFIG_MENDER_HTTP_LOW_SPEED_LIMIT > 0) && (window >= CONFIG_MENDER_HTTP_LOW_SPEED_TIME * MSEC_PER_SEC)) {
+        uint64_t received = (uint64_t)atomic_set(&request_context->speed_received, 0);
+        if (received * MSEC_PER_SEC < (uint64_t)CONFIG_MENDER_HTTP_LOW_SPEED_LIMIT * window) {
+            mender_log_error(
+                "Transfer slower than %d bytes/s during %d seconds, aborting", CONFIG_MENDER_HTTP_LOW_SPEED_LIMIT, CONFIG_MENDER_HTTP_LOW_SPEED_TIME);
+            atomic_set(&request_context->timed_out, 1);
+            zsock_shutdown(request_context->sock, ZSOCK_SHUT_RD);
+            return;
         }
+        request_context->speed_timestamp += window;
     }
+
+    /* Check again later */
+    k_work_schedule(k_work_delayable_from_work(work), K_MSEC(MENDER_HTTP_WATCHDOG_PERIOD));
 }
 
 static enum http_method
@@ -276,3 +947,349 @@ mender_http_method_to_zephyr_http_client_method(mender_http_method_t method) {
             return -1;
     }
 }
+
+static void
+mender_http_event_loop_start(void) {
+
+    /* Start the event loop thread if it is not already running */
+    if (false == mender_http_event_loop_started) {
+        mender_http_event_loop_exit = false;
+        k_thread_create(&mender_http_event_loop_thread_handle,
+                        mender_http_event_loop_thread_stack,
+                        CONFIG_MENDER_HTTP_EVENT_LOOP_THREAD_STACK_SIZE * 1024,
+                        mender_http_event_loop_thread,
+                        NULL,
+                        NULL,
+                        NULL,
+                        CONFIG_MENDER_HTTP_EVENT_LOOP_THREAD_PRIORITY,
+                        0,
+                        K_NO_WAIT);
+        k_thread_name_set(&mender_http_event_loop_thread_handle, "mender_http");
+        mender_http_event_loop_started = true;
+    }
+}
+
+static void
+mender_http_event_loop_thread(void *p1, void *p2, void *p3) {
+
+    (void)p1;
+    (void)p2;
+    (void)p3;
+    mender_http_async_request_t *active[CONFIG_MENDER_HTTP_EVENT_LOOP_MAX_REQUESTS] = { NULL };
+    struct zsock_pollfd          fds[CONFIG_MENDER_HTTP_EVENT_LOOP_MAX_REQUESTS];
+    size_t                       count = 0;
+    mender_http_async_request_t *request;
+    char                        *buffer;
+
+    /* Allocate receive buffer, shared by all the requests */
+    if (NULL == (buffer = (char *)malloc(MENDER_HTTP_RECV_BUF_LENGTH))) {
+        mender_log_error("Unable to allocate memory");
+    }
+
+    /* Perform asynchronous requests until the event loop is stopped */
+    while (true) {
+
+        /* Wait for a new request if the event loop is idle */
+        if (0 == count) {
+            k_sem_take(&mender_http_event_loop_sem, K_FOREVER);
+        }
+
+        /* Start pending requests, as long as the maximum number of requests in progress is not reached */
+        k_mutex_lock(&mender_http_event_loop_mutex, K_FOREVER);
+        if (true == mender_http_event_loop_exit) {
+            k_mutex_unlock(&mender_http_event_loop_mutex);
+            break;
+        }
+        while ((NULL != mender_http_pending_requests) && (count < CONFIG_MENDER_HTTP_EVENT_LOOP_MAX_REQUESTS)) {
+            request                      = mender_http_pending_requests;
+            mender_http_pending_requests = request->next;
+            request->next                = NULL;
+            k_mutex_unlock(&mender_http_event_loop_mutex);
+            if ((NULL == buffer) || (MENDER_OK != mender_http_async_request_start(request))) {
+                mender_http_async_request_complete(request, MENDER_FAIL);
+            } else {
+                active[count++] = request;
+            }
+            k_mutex_lock(&mender_http_event_loop_mutex, K_FOREVER);
+        }
+
+        /* Perform the pre-connection, host and port are not released before the semaphore is given */
+        if (true == mender_http_preconnect_pending) {
+            char *host                     = mender_http_preconnect_host;
+            char *port                     = mender_http_preconnect_port;
+            mender_http_preconnect_pending = false;
+            k_mutex_unlock(&mender_http_event_loop_mutex);
+            int sock = mender_net_connect(host, port);
+            k_mutex_lock(&mender_http_event_loop_mutex, K_FOREVER);
+            mender_http_preconnect_sock = sock;
+            k_sem_give(&mender_http_preconnect_sem);
+        }
+        k_mutex_unlock(&mender_http_event_loop_mutex);
+        if (0 == count) {
+            continue;
+        }
+
+        /* Wait for activity on the sockets */
+        for (size_t index = 0; index < count; index++) {
+            fds[index].fd      = active[index]->sock;
+            fds[index].events  = ZSOCK_POLLIN;
+            fds[index].revents = 0;
+        }
+        if (zsock_poll(fds, count, CONFIG_MENDER_HTTP_EVENT_LOOP_POLL_TIMEOUT) < 0) {
+            mender_log_error("Unable to poll HTTP requests, errno = %d", errno);
+        }
+
+        /* Receive data and complete the requests that are done */
+        size_t index = 0;
+        while (index < count) {
+            mender_err_t ret = MENDER_OK;
+            int64_t      now = k_uptime_get();
+            request          = active[index];
+            if (0 != fds[index].revents) {
+                ret = mender_http_async_request_receive(request, buffer, MENDER_HTTP_RECV_BUF_LENGTH);
+            } else if (now - request->start > CONFIG_MENDER_HTTP_REQUEST_TIMEOUT * MSEC_PER_SEC) {
+                mender_log_error("Request timeout");
+                ret = MENDER_FAIL;
+            } else if ((false == request->receiving) && (CONFIG_MENDER_HTTP_FIRST_BYTE_TIMEOUT > 0)
+                       && (now - request->timestamp > CONFIG_MENDER_HTTP_FIRST_BYTE_TIMEOUT * MSEC_PER_SEC)) {
+                mender_log_error("No response received after %d seconds, aborting", CONFIG_MENDER_HTTP_FIRST_BYTE_TIMEOUT);
+                ret = MENDER_FAIL;
+            } else if ((true == request->receiving) && (CONFIG_MENDER_HTTP_IDLE_TIMEOUT > 0)
+                       && (now - request->timestamp > CONFIG_MENDER_HTTP_IDLE_TIMEOUT * MSEC_PER_SEC)) {
+                mender_log_error("No data received after %d seconds, aborting", CONFIG_MENDER_HTTP_IDLE_TIMEOUT);
+                ret = MENDER_FAIL;
+            }
+            if ((MENDER_OK != ret) || (true == request->complete)) {
+                mender_http_async_request_complete(request, ret);
+                active[index] = active[count - 1];
+                fds[index]    = fds[count - 1];
+                count--;
+            } else {
+                index++;
+            }
+        }
+    }
+
+    /* Abort requests that are still in progress or pending */
+    for (size_t index = 0; index < count; index++) {
+        mender_http_async_request_complete(active[index], MENDER_FAIL);
+    }
+    k_mutex_lock(&mender_http_event_loop_mutex, K_FOREVER);
+    while (NULL != (request = mender_http_pending_requests)) {
+        mender_http_pending_requests = request->next;
+        mender_http_async_request_complete(request, MENDER_FAIL);
+    }
+    if (true == mender_http_preconnect_pending) {
+        mender_http_preconnect_pending = false;
+        k_sem_give(&mender_http_preconnect_sem);
+    }
+    k_mutex_unlock(&mender_http_event_loop_mutex);
+
+    /* Release memory */
+    free(buffer);
+}
+
+static int
+mender_http_preconnect_take(char *path) {
+
+    char               *preconnect_path;
+    char               *preconnect_host;
+    char               *preconnect_port;
+    int                 sock = -1;
+    struct zsock_pollfd fds;
+
+    /* Claim the pre-connection if any, unless it has been done for another URL */
+    k_mutex_lock(&mender_http_event_loop_mutex, K_FOREVER);
+    if ((NULL == mender_http_preconnect_path) || ((NULL != path) && (0 != strcmp(path, mender_http_preconnect_path)))) {
+        k_mutex_unlock(&mender_http_event_loop_mutex);
+        return -1;
+    }
+    preconnect_path             = mender_http_preconnect_path;
+    preconnect_host             = mender_http_preconnect_host;
+    preconnect_port             = mender_http_preconnect_port;
+    mender_http_preconnect_path = NULL;
+    mender_http_preconnect_host = NULL;
+    mender_http_preconnect_port = NULL;
+    k_mutex_unlock(&mender_http_event_loop_mutex);
+
+    /* Wait for the end of the pre-connection, it is performing the handshakes the caller would have to do anyway */
+    k_sem_take(&mender_http_preconnect_sem, K_FOREVER);
+    k_mutex_lock(&mender_http_event_loop_mutex, K_FOREVER);
+    if (NULL != path) {
+        sock = mender_http_preconnect_sock;
+    } else if (mender_http_preconnect_sock >= 0) {
+        mender_net_disconnect(mender_http_preconnect_sock);
+    }
+    mender_http_preconnect_sock = -1;
+    k_mutex_unlock(&mender_http_event_loop_mutex);
+
+    /* Release memory */
+    free(preconnect_path);
+    free(preconnect_host);
+    free(preconnect_port);
+
+    /* Discard the connection if it has been closed by the server meanwhile */
+    if (sock >= 0) {
+        fds.fd      = sock;
+        fds.events  = ZSOCK_POLLIN;
+        fds.revents = 0;
+        if (0 != zsock_poll(&fds, 1, 0)) {
+            mender_net_disconnect(sock);
+            sock = -1;
+        }
+    }
+
+    return sock;
+}
+
+static char *
+mender_http_async_request_printf(const char *format, ...) {
+
+    assert(NULL != format);
+    char   *str = NULL;
+    va_list args;
+
+    /* Allocate and format the string */
+    va_start(args, format);
+    int ret = vasprintf(&str, format, args);
+    va_end(args);
+    if (ret < 0) {
+        mender_log_error("Unable to allocate memory");
+        return NULL;
+    }
+
+    return str;
+}
+
+static mender_err_t
+mender_http_async_request_start(mender_http_async_request_t *request) {
+
+    assert(NULL != request);
+    size_t  length = strlen(request->request);
+    size_t  offset = 0;
+    ssize_t sent;
+
+    /* Connect to the server */
+    if ((request->sock = mender_net_connect(request->host, request->port)) < 0) {
+        mender_log_error("Unable to open HTTP client connection");
+        return MENDER_FAIL;
+    }
+    if (MENDER_OK != (request->ret = request->callback(MENDER_HTTP_EVENT_CONNECTED, NULL, 0, request->params))) {
+        mender_log_error("An error occurred while calling 'MENDER_HTTP_EVENT_CONNECTED' callback");
+        return request->ret;
+    }
+
+    /* Send the request */
+    while (offset < length) {
+        if ((sent = zsock_send(request->sock, request->request + offset, length - offset, 0)) < 0) {
+            mender_log_error("Unable to write data, errno = %d", errno);
+            return MENDER_FAIL;
+        }
+        offset += (size_t)sent;
+    }
+
+    /* Release the request, only the response is expected now */
+    free(request->request);
+    request->request = NULL;
+
+    /* Initialization of the response parser */
+    http_parser_init(&request->parser, HTTP_RESPONSE);
+    request->parser.data = request;
+    request->start       = k_uptime_get();
+    request->timestamp   = request->start;
+
+    return MENDER_OK;
+}
+
+static mender_err_t
+mender_http_async_request_receive(mender_http_async_request_t *request, char *buffer, size_t length) {
+
+    assert(NULL != request);
+    assert(NULL != buffer);
+    ssize_t received;
+
+    /* Read available data without blocking the other requests */
+    if ((received = zsock_recv(request->sock, buffer, length, ZSOCK_MSG_DONTWAIT)) < 0) {
+        if ((EAGAIN == errno) || (EWOULDBLOCK == errno)) {
+            return MENDER_OK;
+        }
+        mender_log_error("An error occurred, unable to read data, errno = %d", errno);
+        return MENDER_FAIL;
+    }
+    request->receiving = true;
+    request->timestamp = k_uptime_get();
+
+    /* Feed the response parser, a zero length indicates the connection has been closed */
+    http_parser_execute(&request->parser, &mender_http_parser_settings, buffer, (size_t)received);
+    if (MENDER_OK != request->ret) {
+        return request->ret;
+    }
+    if (HPE_OK != HTTP_PARSER_ERRNO(&request->parser)) {
+        mender_log_error("Unable to parse HTTP response: %s", http_errno_description(HTTP_PARSER_ERRNO(&request->parser)));
+        return MENDER_FAIL;
+    }
+    if ((0 == received) && (false == request->complete)) {
+        mender_log_error("An error occurred, connection has been closed");
+        return MENDER_FAIL;
+    }
+
+    return MENDER_OK;
+}
+
+static void
+mender_http_async_request_complete(mender_http_async_request_t *request, mender_err_t ret) {
+
+    assert(NULL != request);
+    int status = 0;
+
+    /* Invoke the callbacks */
+    if (MENDER_OK == ret) {
+        status = request->parser.status_code;
+        if (MENDER_OK != (ret = request->callback(MENDER_HTTP_EVENT_DISCONNECTED, NULL, 0, request->params))) {
+            mender_log_error("An error occurred while calling 'MENDER_HTTP_EVENT_DISCONNECTED' callback");
+        }
+    } else if (MENDER_OK == request->ret) {
+        request->callback(MENDER_HTTP_EVENT_ERROR, NULL, 0, request->params);
+    }
+    if (NULL != request->done) {
+        request->done(ret, status, request->params);
+    }
+
+    /* Close connection */
+    if (request->sock >= 0) {
+        mender_net_disconnect(request->sock);
+    }
+
+    /* Release memory */
+    free(request->host);
+    free(request->port);
+    free(request->request);
+    free(request);
+}
+
+static int
+mender_http_parser_on_body(struct http_parser *parser, const char *at, size_t length) {
+
+    assert(NULL != parser);
+    mender_http_async_request_t *request = (mender_http_async_request_t *)parser->data;
+
+    /* Transmit data received to the upper layer */
+    if (MENDER_OK != (request->ret = request->callback(MENDER_HTTP_EVENT_DATA_RECEIVED, (void *)at, length, request->params))) {
+        mender_log_error("An error occurred, stop reading data");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int
+mender_http_parser_on_message_complete(struct http_parser *parser) {
+
+    assert(NULL != parser);
+    mender_http_async_request_t *request = (mender_http_async_request_t *)parser->data;
+
+    /* Response has been completely received */
+    request->complete = true;
+
+    return 0;
+}
@@ -45,6 +45,20 @@
 #define CONFIG_MENDER_SCHEDULER_WORK_QUEUE_PRIORITY (5)
 #endif /* CONFIG_MENDER_SCHEDULER_WORK_QUEUE_PRIORITY */
 
+/**
+ * @brief Default thread stack size (kB)
+ */
+#ifndef CONFIG_MENDER_SCHEDULER_THREAD_STACK_SIZE
+#define CONFIG_MENDER_SCHEDULER_THREAD_STACK_SIZE (20)
+#endif /* CONFIG_MENDER_SCHEDULER_THREAD_STACK_SIZE */
+
+/**
+ * @brief Default thread priority, lower than the work queue priority
+ */
+#ifndef CONFIG_MENDER_SCHEDULER_THREAD_PRIORITY
+#define CONFIG_MENDER_SCHEDULER_THREAD_PRIORITY (1)
+#endif /* CONFIG_MENDER_SCHEDULER_THREAD_PRIORITY */
+
 /**
  * @brief Default work queue length
  */
@@ -52,22 +66,149 @@
 #define CONFIG_MENDER_SCHEDULER_WORK_QUEUE_LENGTH (10)
 #endif /* CONFIG_MENDER_SCHEDULER_WORK_QUEUE_LENGTH */
 
+#ifdef CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION
+
+#if (1 != configSUPPORT_STATIC_ALLOCATION) || (1 != INCLUDE_xTimerPendFunctionCall)
+#error "Static allocation of the scheduler requires configSUPPORT_STATIC_ALLOCATION and INCLUDE_xTimerPendFunctionCall"
+#endif /* configSUPPORT_STATIC_ALLOCATION || INCLUDE_xTimerPendFunctionCall */
+
+/**
+ * @brief Default maximum number of works when static allocation is used
+ */
+#ifndef CONFIG_MENDER_SCHEDULER_STATIC_WORKS
+#define CONFIG_MENDER_SCHEDULER_STATIC_WORKS (8)
+#endif /* CONFIG_MENDER_SCHEDULER_STATIC_WORKS */
+
+/**
+ * @brief Default maximum number of mutexes when static allocation is used
+ */
+#ifndef CONFIG_MENDER_SCHEDULER_STATIC_MUTEXES
+#define CONFIG_MENDER_SCHEDULER_STATIC_MUTEXES (12)
+#endif /* CONFIG_MENDER_SCHEDULER_STATIC_MUTEXES */
+
+/**
+ * @brief Maximum length of the name of the works when static allocation is used, including the terminating null character
+ */
+#define MENDER_SCHEDULER_WORK_NAME_LENGTH (32)
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION */
+
+/**
+ * @brief Maximum time waiting for the timer command queue to accept a command (ticks)
+ */
+#define MENDER_SCHEDULER_TIMER_COMMAND_TIMEOUT (1000 / portTICK_PERIOD_MS)
+
 /**
  * @brief Work context
  */
-typedef struct {
-    mender_scheduler_work_params_t params;       /**< Work parameters */
-    SemaphoreHandle_t              sem_handle;   /**< Semaphore used to indicate work is pending or executing */
-    TimerHandle_t                  timer_handle; /**< Timer used to periodically execute work */
-    bool                           activated;    /**< Flag indicating the work is activated */
+typedef struct mender_scheduler_work_context_s {
+    mender_scheduler_work_params_t          params;       /**< Work parameters */
+    SemaphoreHandle_t                       sem_handle;   /**< Semaphore used to indicate work is pending or executing */
+    TimerHandle_t                           timer_handle; /**< Timer used to periodically execute work */
+    bool                                    activated;    /**< Flag indicating the work is activated */
+    volatile bool                           cancelled;    /**< Flag indicating the deactivation of the work is pending */
+    struct mender_scheduler_work_context_s *next;         /**< Next work in the list of works */
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+    int64_t                       trigger_time; /**< Time of the last trigger submitting the work to the work queue (us) */
+    mender_scheduler_work_stats_t stats;        /**< Work statistics */
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
+#ifdef CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION
+    StaticSemaphore_t sem_buffer;                              /**< Memory of the semaphore */
+    StaticTimer_t     timer_buffer;                            /**< Memory of the timer */
+    char              name[MENDER_SCHEDULER_WORK_NAME_LENGTH]; /**< Name of the work */
+    bool              used;                                    /**< Flag indicating the work context is allocated */
+#endif /* CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION */
 } mender_scheduler_work_context_t;
 
 /**
- * @brief Function used to handle work context timer when it expires
+ * @brief Thread context
+ */
+typedef struct {
+    void (*function)(void *);        /**< Thread function */
+    void             *arg;           /**< Argument of the thread function */
+    TaskHandle_t      thread_handle; /**< Thread handle */
+    SemaphoreHandle_t sem_handle;    /**< Semaphore given when the thread function returns */
+#ifdef CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION
+    StaticTask_t      thread_buffer; /**< Memory of the thread */
+    StaticSemaphore_t sem_buffer;    /**< Memory of the semaphore */
+    bool              used;          /**< Flag indicating the thread context is allocated */
+#endif /* CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION */
+} mender_scheduler_thread_context_t;
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION
+
+/**
+ * @brief Mutex context
+ */
+typedef struct {
+    SemaphoreHandle_t handle; /**< Mutex handle */
+    StaticSemaphore_t buffer; /**< Memory of the mutex */
+    bool              used;   /**< Flag indicating the mutex context is allocated */
+} mender_scheduler_mutex_context_t;
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION */
+
+/**
+ * @brief Allocate work context, from the pool of work contexts when static allocation is used
+ * @param name Name of the work
+ * @return Work context if the function succeeds, NULL otherwise
+ */
+static mender_scheduler_work_context_t *mender_scheduler_work_alloc(char *name);
+
+/**
+ * @brief Release work context
+ * @note The timer of the work must have been deleted before, the release is deferred to the timer service task when static allocation is used
+ * @param work_context Work context
+ */
+static void mender_scheduler_work_free(mender_scheduler_work_context_t *work_context);
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION
+
+/**
+ * @brief Function used to give back the work context to the pool once the timer service task has processed the deletion of its timer
+ * @param param Work context
+ * @param unused Not used
+ */
+static void mender_scheduler_work_free_callback(void *param, uint32_t unused);
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION */
+
+/**
+ * @brief Convert a work period to a timer period, the computation is done in 64 bits and the result is clamped to the maximum timer period
+ * @param period Work period (seconds), it must be positive
+ * @return Timer period (ticks)
+ */
+static TickType_t mender_scheduler_period_to_ticks(int32_t period);
+
+/**
+ * @brief Function used to handle work context timer when it expires, the works whose slack window is open share the wake-up
  * @param handle Timer handler
  */
 static void mender_scheduler_timer_callback(TimerHandle_t handle);
 
+/**
+ * @brief Submit work to the work queue, unless it is not activated, already pending or executing
+ * @param work_context Work context
+ */
+static void mender_scheduler_work_submit(mender_scheduler_work_context_t *work_context);
+
+/**
+ * @brief Retrieve work of highest priority from the work queues
+ * @param priority Minimum priority of the work to retrieve
+ * @param nestable Only retrieve the work if it is nestable, it is left in the work queue otherwise
+ * @param work_context Work context
+ * @return MENDER_OK if the function succeeds, MENDER_FAIL if the work queues are empty or if the work of highest priority is not nestable
+ */
+static mender_err_t mender_scheduler_work_queue_receive(mender_scheduler_work_priority_t  priority,
+                                                        bool                              nestable,
+                                                        mender_scheduler_work_context_t **work_context);
+
+/**
+ * @brief Execute work function
+ * @param work_context Work context
+ */
+static void mender_scheduler_work_run(mender_scheduler_work_context_t *work_context);
+
 /**
  * @brief Thread used to handle work queue
  * @param arg Not used
@@ -75,16 +216,177 @@ static void mender_scheduler_timer_callback(TimerHandle_t handle);
 static void mender_scheduler_work_queue_thread(void *arg);
 
 /**
- * @brief Work queue handle
+ * @brief Thread created by mender_scheduler_thread_create, it executes the thread function and waits to be deleted by mender_scheduler_thread_join
+ * @param arg Thread context
+ */
+static void mender_scheduler_thread(void *arg);
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+
+/**
+ * @brief Read the system uptime with the resolution needed by the statistics
+ * @return Current time (us)
+ */
+static int64_t mender_scheduler_stats_get_time(void);
+
+/**
+ * @brief Record a trigger of the work
+ * @param work_context Work context
+ * @param dropped Flag indicating the trigger has been dropped because the work is already pending or executing
+ */
+static void mender_scheduler_stats_trigger(mender_scheduler_work_context_t *work_context, bool dropped);
+
+/**
+ * @brief Record an execution of the work
+ * @param work_context Work context
+ * @param start Start time of the execution (us)
+ * @param end End time of the execution (us)
+ */
+static void mender_scheduler_stats_execute(mender_scheduler_work_context_t *work_context, int64_t start, int64_t end);
+
+/**
+ * @brief Compute the bucket of the histograms of the works corresponding to the value
+ * @param value Value (ms)
+ * @return Index of the bucket
+ */
+static size_t mender_scheduler_stats_histogram_index(uint32_t value);
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
+
+/**
+ * @brief List of works, and mutex used to protect it
+ */
+static mender_scheduler_work_context_t *mender_scheduler_works       = NULL;
+static SemaphoreHandle_t                mender_scheduler_works_mutex = NULL;
+
+/**
+ * @brief Work queue handles, one per priority
+ */
+static QueueHandle_t mender_scheduler_work_queue_handles[MENDER_SCHEDULER_WORK_PRIORITY_COUNT] = { NULL };
+
+/**
+ * @brief Work queue semaphore, counting the works in the work queues
+ */
+static SemaphoreHandle_t mender_scheduler_work_queue_sem_handle = NULL;
+
+/**
+ * @brief Work queue thread handle
+ */
+static TaskHandle_t mender_scheduler_work_queue_thread_handle = NULL;
+
+/**
+ * @brief Work currently executed by the work queue thread, NULL if no work is executing
+ */
+static mender_scheduler_work_context_t *mender_scheduler_work_current = NULL;
+
+/**
+ * @brief Flag indicating the work queue thread is executing works of higher priority from mender_scheduler_work_yield
+ */
+static bool mender_scheduler_work_yielding = false;
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION
+
+/**
+ * @brief Pool of work contexts
+ */
+static mender_scheduler_work_context_t mender_scheduler_work_pool[CONFIG_MENDER_SCHEDULER_STATIC_WORKS];
+
+/**
+ * @brief Pool of mutexes
+ */
+static mender_scheduler_mutex_context_t mender_scheduler_mutex_pool[CONFIG_MENDER_SCHEDULER_STATIC_MUTEXES];
+
+/**
+ * @brief Thread context and stack, a single thread can exist at a time
+ */
+static mender_scheduler_thread_context_t mender_scheduler_thread_context;
+static StackType_t                       mender_scheduler_thread_stack[CONFIG_MENDER_SCHEDULER_THREAD_STACK_SIZE * 1024 / sizeof(StackType_t)];
+
+/**
+ * @brief Memory of the mutex used to protect the list of works
+ */
+static StaticSemaphore_t mender_scheduler_works_mutex_buffer;
+
+/**
+ * @brief Memory of the work queues
+ */
+static StaticQueue_t mender_scheduler_work_queue_buffers[MENDER_SCHEDULER_WORK_PRIORITY_COUNT];
+static uint8_t       mender_scheduler_work_queue_storage[MENDER_SCHEDULER_WORK_PRIORITY_COUNT]
+                                                  [CONFIG_MENDER_SCHEDULER_WORK_QUEUE_LENGTH * sizeof(mender_scheduler_work_context_t *)];
+
+/**
+ * @brief Memory of the work queue semaphore
+ */
+static StaticSemaphore_t mender_scheduler_work_queue_sem_buffer;
+
+/**
+ * @brief Memory of the work queue thread
  */
-static QueueHandle_t mender_scheduler_work_queue_handle = NULL;
+static StaticTask_t mender_scheduler_work_queue_thread_buffer;
+static StackType_t  mender_scheduler_work_queue_thread_stack[CONFIG_MENDER_SCHEDULER_WORK_QUEUE_STACK_SIZE * 1024 / sizeof(StackType_t)];
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION */
 
 mender_err_t
 mender_scheduler_init(void) {
 
-    /* Create and start work queue */
-    if (NULL == (mender_scheduler_work_queue_handle = xQueueCreate(CONFIG_MENDER_SCHEDULER_WORK_QUEUE_LENGTH, sizeof(mender_scheduler_work_context_t *)))) {
-        mender_log_error("Unable to create work queue");
+#ifdef CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION
+
+    /* Create mutex used to protect the list of works */
+    if (NULL == (mender_scheduler_works_mutex = xSemaphoreCreateMutexStatic(&mender_scheduler_works_mutex_buffer))) {
+        mender_log_error("Unable to create mutex");
+        return MENDER_FAIL;
+    }
+
+    /* Create and start work queues */
+    for (size_t priority = 0; priority < MENDER_SCHEDULER_WORK_PRIORITY_COUNT; priority++) {
+        if (NULL
+            == (mender_scheduler_work_queue_handles[priority] = xQueueCreateStatic(CONFIG_MENDER_SCHEDULER_WORK_QUEUE_LENGTH,
+                                                                                   sizeof(mender_scheduler_work_context_t *),
+                                                                                   mender_scheduler_work_queue_storage[priority],
+                                                                                   &mender_scheduler_work_queue_buffers[priority]))) {
+            mender_log_error("Unable to create work queue");
+            return MENDER_FAIL;
+        }
+    }
+    if (NULL
+        == (mender_scheduler_work_queue_sem_handle = xSemaphoreCreateCountingStatic(
+                MENDER_SCHEDULER_WORK_PRIORITY_COUNT * CONFIG_MENDER_SCHEDULER_WORK_QUEUE_LENGTH, 0, &mender_scheduler_work_queue_sem_buffer))) {
+        mender_log_error("Unable to create work queue semaphore");
+        return MENDER_FAIL;
+    }
+    if (NULL
+        == (mender_scheduler_work_queue_thread_handle = xTaskCreateStatic(mender_scheduler_work_queue_thread,
+                                                                          "mender_scheduler_work_queue",
+                                                                          sizeof(mender_scheduler_work_queue_thread_stack) / sizeof(StackType_t),
+                                                                          NULL,
+                                                                          CONFIG_MENDER_SCHEDULER_WORK_QUEUE_PRIORITY,
+                                                                          mender_scheduler_work_queue_thread_stack,
+                                                                          &mender_scheduler_work_queue_thread_buffer))) {
+        mender_log_error("Unable to create work queue thread");
+        return MENDER_FAIL;
+    }
+
+#else
+
+    /* Create mutex used to protect the list of works */
+    if (NULL == (mender_scheduler_works_mutex = xSemaphoreCreateMutex())) {
+        mender_log_error("Unable to create mutex");
+        return MENDER_FAIL;
+    }
+
+    /* Create and start work queues */
+    for (size_t priority = 0; priority < MENDER_SCHEDULER_WORK_PRIORITY_COUNT; priority++) {
+        if (NULL
+            == (mender_scheduler_work_queue_handles[priority] = xQueueCreate(CONFIG_MENDER_SCHEDULER_WORK_QUEUE_LENGTH, sizeof(mender_scheduler_work_context_t *)))) {
+            mender_log_error("Unable to create work queue");
+            return MENDER_FAIL;
+        }
+    }
+    if (NULL
+        == (mender_scheduler_work_queue_sem_handle
+            = xSemaphoreCreateCounting(MENDER_SCHEDULER_WORK_PRIORITY_COUNT * CONFIG_MENDER_SCHEDULER_WORK_QUEUE_LENGTH, 0))) {
+        mender_log_error("Unable to create work queue semaphore");
         return MENDER_FAIL;
     }
     if (pdPASS
@@ -93,11 +395,13 @@ mender_scheduler_init(void) {
                        (configSTACK_DEPTH_TYPE)(CONFIG_MENDER_SCHEDULER_WORK_QUEUE_STACK_SIZE * 1024 / sizeof(configSTACK_DEPTH_TYPE)),
                        NULL,
                        CONFIG_MENDER_SCHEDULER_WORK_QUEUE_PRIORITY,
-                       NULL)) {
+                       &mender_scheduler_work_queue_thread_handle)) {
         mender_log_error("Unable to create work queue thread");
         return MENDER_FAIL;
     }
 
+#endif /* CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION */
+
     return MENDER_OK;
 }
 
@@ -107,42 +411,54 @@ mender_scheduler_work_create(mender_scheduler_work_params_t *work_params, void *
     assert(NULL != work_params);
     assert(NULL != work_params->function);
     assert(NULL != work_params->name);
+    assert(work_params->slack < 100);
+    assert(work_params->priority < MENDER_SCHEDULER_WORK_PRIORITY_COUNT);
     assert(NULL != handle);
 
     /* Create work context */
-    mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)malloc(sizeof(mender_scheduler_work_context_t));
+    mender_scheduler_work_context_t *work_context = mender_scheduler_work_alloc(work_params->name);
     if (NULL == work_context) {
         mender_log_error("Unable to allocate memory");
-        goto FAIL;
+        return MENDER_FAIL;
     }
-    memset(work_context, 0, sizeof(mender_scheduler_work_context_t));
 
     /* Copy work parameters */
     work_context->params.function = work_params->function;
     work_context->params.period   = work_params->period;
-    if (NULL == (work_context->params.name = strdup(work_params->name))) {
-        mender_log_error("Unable to allocate memory");
-        goto FAIL;
-    }
+    work_context->params.slack    = work_params->slack;
+    work_context->params.priority = work_params->priority;
+    work_context->params.nestable = work_params->nestable;
 
     /* Create semaphore used to protect work function */
-    if (NULL == (work_context->sem_handle = xSemaphoreCreateBinary())) {
+#ifdef CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION
+    work_context->sem_handle = xSemaphoreCreateBinaryStatic(&work_context->sem_buffer);
+#else
+    work_context->sem_handle = xSemaphoreCreateBinary();
+#endif /* CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION */
+    if (NULL == work_context->sem_handle) {
         mender_log_error("Unable to create semaphore");
         goto FAIL;
     }
 
     /* Create timer to handle the work periodically */
-    if (NULL
-        == (work_context->timer_handle
-            = xTimerCreate(work_context->params.name,
-                           (work_context->params.period > 0) ? ((1000 * work_context->params.period) / portTICK_PERIOD_MS) : portMAX_DELAY,
-                           pdTRUE,
-                           work_context,
-                           mender_scheduler_timer_callback))) {
+    TickType_t period = (work_context->params.period > 0) ? mender_scheduler_period_to_ticks(work_context->params.period) : portMAX_DELAY;
+#ifdef CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION
+    work_context->timer_handle
+        = xTimerCreateStatic(work_context->params.name, period, pdTRUE, work_context, mender_scheduler_timer_callback, &work_context->timer_buffer);
+#else
+    work_context->timer_handle = xTimerCreate(work_context->params.name, period, pdTRUE, work_context, mender_scheduler_timer_callback);
+#endif /* CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION */
+    if (NULL == work_context->timer_handle) {
         mender_log_error("Unable to create timer");
         goto FAIL;
     }
 
+    /* Insert the work in the list of works */
+    xSemaphoreTake(mender_scheduler_works_mutex, portMAX_DELAY);
+    work_context->next     = mender_scheduler_works;
+    mender_scheduler_works = work_context;
+    xSemaphoreGive(mender_scheduler_works_mutex);
+
     /* Return handle to the new work */
     *handle = (void *)work_context;
 
@@ -150,19 +466,11 @@ mender_scheduler_work_create(mender_scheduler_work_params_t *work_params, void *
 
 FAIL:
 
-    /* Release memory */
-    if (NULL != work_context) {
-        if (NULL != work_context->timer_handle) {
-            xTimerDelete(work_context->timer_handle, portMAX_DELAY);
-        }
-        if (NULL != work_context->sem_handle) {
-            vSemaphoreDelete(work_context->sem_handle);
-        }
-        if (NULL != work_context->params.name) {
-            free(work_context->params.name);
-        }
-        free(work_context);
+    /* Release memory, the timer is not created at this point */
+    if (NULL != work_context->sem_handle) {
+        vSemaphoreDelete(work_context->sem_handle);
     }
+    mender_scheduler_work_free(work_context);
 
     return MENDER_FAIL;
 }
@@ -185,13 +493,13 @@ mender_scheduler_work_activate(void *handle) {
     if (work_context->params.period > 0) {
 
         /* Start the timer to handle the work */
-        if (pdPASS != xTimerStart(work_context->timer_handle, portMAX_DELAY)) {
+        if (pdPASS != xTimerStart(work_context->timer_handle, MENDER_SCHEDULER_TIMER_COMMAND_TIMEOUT)) {
             mender_log_error("Unable to start timer");
             return MENDER_FAIL;
         }
 
         /* Execute the work now */
-        mender_scheduler_timer_callback(work_context->timer_handle);
+        mender_scheduler_work_submit(work_context);
     }
 
     /* Indicate the work has been activated */
@@ -208,15 +516,17 @@ mender_scheduler_work_set_period(void *handle, uint32_t period) {
     /* Get work context */
     mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)handle;
 
-    /* Set timer period */
-    work_context->params.period = period;
+    /* Set timer period, it is clamped to the maximum period of the work parameters */
+    work_context->params.period = (period > INT32_MAX) ? INT32_MAX : (int32_t)period;
     if (work_context->params.period > 0) {
-        if (pdPASS != xTimerChangePeriod(work_context->timer_handle, (1000 * work_context->params.period) / portTICK_PERIOD_MS, portMAX_DELAY)) {
+        if (pdPASS
+            != xTimerChangePeriod(
+                work_context->timer_handle, mender_scheduler_period_to_ticks(work_context->params.period), MENDER_SCHEDULER_TIMER_COMMAND_TIMEOUT)) {
             mender_log_error("Unable to change timer period");
             return MENDER_FAIL;
         }
     } else {
-        if (pdPASS != xTimerStop(work_context->timer_handle, portMAX_DELAY)) {
+        if (pdPASS != xTimerStop(work_context->timer_handle, MENDER_SCHEDULER_TIMER_COMMAND_TIMEOUT)) {
             mender_log_error("Unable to stop timer");
             return MENDER_FAIL;
         }
@@ -234,11 +544,70 @@ mender_scheduler_work_execute(void *handle) {
     mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)handle;
 
     /* Execute the work now */
-    mender_scheduler_timer_callback(work_context->timer_handle);
+    mender_scheduler_work_submit(work_context);
+
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_scheduler_work_yield(void) {
+
+    mender_scheduler_work_context_t *work_context = NULL;
+
+    /* Nothing to do if the function is not called from a work, or from a work already executed by this function (nesting is limited to one level) */
+    if ((xTaskGetCurrentTaskHandle() != mender_scheduler_work_queue_thread_handle) || (NULL == mender_scheduler_work_current)
+        || (true == mender_scheduler_work_yielding)) {
+        return MENDER_OK;
+    }
+
+    /* Execute the pending nestable works of higher priority, the semaphore counting the works in the work queues is adjusted accordingly */
+    mender_scheduler_work_context_t *current = mender_scheduler_work_current;
+    mender_scheduler_work_yielding           = true;
+    while ((current->params.priority + 1 < MENDER_SCHEDULER_WORK_PRIORITY_COUNT)
+           && (MENDER_OK == mender_scheduler_work_queue_receive(current->params.priority + 1, true, &work_context))) {
+        xSemaphoreTake(mender_scheduler_work_queue_sem_handle, 0);
+        mender_scheduler_work_run(work_context);
+    }
+    mender_scheduler_work_yielding = false;
+    mender_scheduler_work_current  = current;
 
     return MENDER_OK;
 }
 
+bool
+mender_scheduler_work_is_cancelled(void) {
+
+    /* Check if the deactivation of the calling work is pending */
+    if ((xTaskGetCurrentTaskHandle() != mender_scheduler_work_queue_thread_handle) || (NULL == mender_scheduler_work_current)) {
+        return false;
+    }
+
+    return mender_scheduler_work_current->cancelled;
+}
+
+void *
+mender_scheduler_work_get_current(void) {
+
+    /* Return the work executed by the work queue thread if it is the calling thread */
+    if (xTaskGetCurrentTaskHandle() != mender_scheduler_work_queue_thread_handle) {
+        return NULL;
+    }
+
+    return mender_scheduler_work_current;
+}
+
+bool
+mender_scheduler_work_is_deactivating(void *handle) {
+
+    assert(NULL != handle);
+
+    /* Get work context */
+    mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)handle;
+
+    /* Check if the deactivation of the work is pending */
+    return work_context->cancelled;
+}
+
 mender_err_t
 mender_scheduler_work_deactivate(void *handle) {
 
@@ -251,16 +620,22 @@ mender_scheduler_work_deactivate(void *handle) {
     if (true == work_context->activated) {
 
         /* Stop the timer used to periodically execute the work (if it is running) */
-        xTimerStop(work_context->timer_handle, portMAX_DELAY);
-        while (pdFALSE != xTimerIsTimerActive(work_context->timer_handle)) {
-            vTaskDelay(1);
+        if (pdPASS == xTimerStop(work_context->timer_handle, MENDER_SCHEDULER_TIMER_COMMAND_TIMEOUT)) {
+            while (pdFALSE != xTimerIsTimerActive(work_context->timer_handle)) {
+                vTaskDelay(1);
+            }
+        } else {
+            mender_log_error("Unable to stop timer");
         }
 
-        /* Wait if the work is pending or executing */
+        /* Cancel the work and wait if it is pending or executing */
+        work_context->cancelled = true;
         if (pdPASS != xSemaphoreTake(work_context->sem_handle, portMAX_DELAY)) {
             mender_log_error("Work '%s' is pending or executing", work_context->params.name);
+            work_context->cancelled = false;
             return MENDER_FAIL;
         }
+        work_context->cancelled = false;
 
         /* Indicate the work has been deactivated */
         work_context->activated = false;
@@ -277,13 +652,160 @@ mender_scheduler_work_delete(void *handle) {
     /* Get work context */
     mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)handle;
 
+    /* Remove the work from the list of works */
+    xSemaphoreTake(mender_scheduler_works_mutex, portMAX_DELAY);
+    for (mender_scheduler_work_context_t **item = &mender_scheduler_works; NULL != *item; item = &(*item)->next) {
+        if (work_context == *item) {
+            *item = work_context->next;
+            break;
+        }
+    }
+    xSemaphoreGive(mender_scheduler_works_mutex);
+
     /* Release memory */
     xTimerDelete(work_context->timer_handle, portMAX_DELAY);
     vSemaphoreDelete(work_context->sem_handle);
-    if (NULL != work_context->params.name) {
-        free(work_context->params.name);
+    mender_scheduler_work_free(work_context);
+
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_scheduler_work_get_stats(void *handle, mender_scheduler_work_stats_t *stats, bool reset) {
+
+    assert(NULL != handle);
+    assert(NULL != stats);
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+
+    /* Get work context */
+    mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)handle;
+
+    /* Copy the statistics of the work, and reset them if requested */
+    vTaskSuspendAll();
+    memcpy(stats, &work_context->stats, sizeof(mender_scheduler_work_stats_t));
+    if (true == reset) {
+        memset(&work_context->stats, 0, sizeof(mender_scheduler_work_stats_t));
     }
-    free(work_context);
+    xTaskResumeAll();
+
+    return MENDER_OK;
+
+#else
+
+    (void)handle;
+    (void)stats;
+    (void)reset;
+
+    /* Statistics are not collected */
+    return MENDER_NOT_IMPLEMENTED;
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
+}
+
+mender_err_t
+mender_scheduler_thread_create(void (*function)(void *), void *arg, char *name, void **handle) {
+
+    assert(NULL != function);
+    assert(NULL != name);
+    assert(NULL != handle);
+
+    mender_scheduler_thread_context_t *thread_context = NULL;
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION
+
+    /* Retrieve the thread context if it is free */
+    vTaskSuspendAll();
+    if (false == mender_scheduler_thread_context.used) {
+        thread_context = &mender_scheduler_thread_context;
+        memset(thread_context, 0, sizeof(mender_scheduler_thread_context_t));
+        thread_context->used = true;
+    }
+    xTaskResumeAll();
+    if (NULL == thread_context) {
+        mender_log_error("Unable to create thread '%s', a single thread is available", name);
+        goto FAIL;
+    }
+    thread_context->function = function;
+    thread_context->arg      = arg;
+
+    /* Create semaphore and start the thread */
+    thread_context->sem_handle = xSemaphoreCreateBinaryStatic(&thread_context->sem_buffer);
+    if (NULL
+        == (thread_context->thread_handle = xTaskCreateStatic(mender_scheduler_thread,
+                                                              name,
+                                                              sizeof(mender_scheduler_thread_stack) / sizeof(StackType_t),
+                                                              thread_context,
+                                                              CONFIG_MENDER_SCHEDULER_THREAD_PRIORITY,
+                                                              mender_scheduler_thread_stack,
+                                                              &thread_context->thread_buffer))) {
+        mender_log_error("Unable to create thread '%s'", name);
+        thread_context->used = false;
+        goto FAIL;
+    }
+
+#else
+
+    /* Create thread context */
+    if (NULL == (thread_context = (mender_scheduler_thread_context_t *)malloc(sizeof(mender_scheduler_thread_context_t)))) {
+        mender_log_error("Unable to allocate memory");
+        goto FAIL;
+    }
+    thread_context->function = function;
+    thread_context->arg      = arg;
+
+    /* Create semaphore and start the thread */
+    if (NULL == (thread_context->sem_handle = xSemaphoreCreateBinary())) {
+        mender_log_error("Unable to create thread '%s' semaphore", name);
+        free(thread_context);
+        goto FAIL;
+    }
+    if (pdPASS
+        != xTaskCreate(mender_scheduler_thread,
+                       name,
+                       (configSTACK_DEPTH_TYPE)(CONFIG_MENDER_SCHEDULER_THREAD_STACK_SIZE * 1024 / sizeof(configSTACK_DEPTH_TYPE)),
+                       thread_context,
+                       CONFIG_MENDER_SCHEDULER_THREAD_PRIORITY,
+                       &thread_context->thread_handle)) {
+        mender_log_error("Unable to create thread '%s'", name);
+        vSemaphoreDelete(thread_context->sem_handle);
+        free(thread_context);
+        goto FAIL;
+    }
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION */
+
+    /* Return handle to the thread */
+    *handle = (void *)thread_context;
+
+    return MENDER_OK;
+
+FAIL:
+
+    *handle = NULL;
+
+    return MENDER_FAIL;
+}
+
+mender_err_t
+mender_scheduler_thread_join(void *handle) {
+
+    assert(NULL != handle);
+
+    /* Get thread context */
+    mender_scheduler_thread_context_t *thread_context = (mender_scheduler_thread_context_t *)handle;
+
+    /* Wait for the end of the thread function, then delete the thread */
+    xSemaphoreTake(thread_context->sem_handle, portMAX_DELAY);
+    vTaskDelete(thread_context->thread_handle);
+    vSemaphoreDelete(thread_context->sem_handle);
+
+    /* Release the thread context */
+#ifdef CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION
+    thread_context->used = false;
+#else
+    free(thread_context);
+#endif /* CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION */
 
     return MENDER_OK;
 }
@@ -293,11 +815,37 @@ mender_scheduler_mutex_create(void **handle) {
 
     assert(NULL != handle);
 
+#ifdef CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION
+
+    /* Retrieve a free mutex from the pool */
+    mender_scheduler_mutex_context_t *mutex_context = NULL;
+    vTaskSuspendAll();
+    for (size_t index = 0; index < CONFIG_MENDER_SCHEDULER_STATIC_MUTEXES; index++) {
+        if (false == mender_scheduler_mutex_pool[index].used) {
+            mutex_context       = &mender_scheduler_mutex_pool[index];
+            mutex_context->used = true;
+            break;
+        }
+    }
+    xTaskResumeAll();
+    if (NULL == mutex_context) {
+        mender_log_error("No more mutex available, increase the pool size");
+        return MENDER_FAIL;
+    }
+
+    /* Create mutex */
+    mutex_context->handle = xSemaphoreCreateMutexStatic(&mutex_context->buffer);
+    *handle               = (void *)mutex_context->handle;
+
+#else
+
     /* Create mutex */
     if (NULL == (*handle = (void *)xSemaphoreCreateMutex())) {
         return MENDER_FAIL;
     }
 
+#endif /* CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION */
+
     return MENDER_OK;
 }
 
@@ -335,22 +883,146 @@ mender_scheduler_mutex_delete(void *handle) {
     /* Release memory */
     vSemaphoreDelete((SemaphoreHandle_t)handle);
 
+#ifdef CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION
+
+    /* Give back the mutex to the pool */
+    for (size_t index = 0; index < CONFIG_MENDER_SCHEDULER_STATIC_MUTEXES; index++) {
+        if ((true == mender_scheduler_mutex_pool[index].used) && ((SemaphoreHandle_t)handle == mender_scheduler_mutex_pool[index].handle)) {
+            mender_scheduler_mutex_pool[index].handle = NULL;
+            mender_scheduler_mutex_pool[index].used   = false;
+            break;
+        }
+    }
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION */
+
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_scheduler_delay(uint32_t delay_ms) {
+
+    /* Suspend the calling thread */
+    vTaskDelay(delay_ms / portTICK_PERIOD_MS);
+
     return MENDER_OK;
 }
 
+int64_t
+mender_scheduler_get_uptime(void) {
+
+    /* Read tick count, wrapping of the counter is not handled */
+    return (int64_t)xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
 mender_err_t
 mender_scheduler_exit(void) {
 
-    /* Submit empty work to the work queue, this ask the work queue thread to terminate */
+    /* Submit empty work to the work queue of lowest priority, this ask the work queue thread to terminate once pending works are executed */
     mender_scheduler_work_context_t *work_context = NULL;
-    if (pdPASS != xQueueSend(mender_scheduler_work_queue_handle, &work_context, portMAX_DELAY)) {
+    if (pdPASS != xQueueSend(mender_scheduler_work_queue_handles[MENDER_SCHEDULER_WORK_PRIORITY_LOW], &work_context, portMAX_DELAY)) {
         mender_log_error("Unable to submit empty work to the work queue");
         return MENDER_FAIL;
     }
+    xSemaphoreGive(mender_scheduler_work_queue_sem_handle);
 
     return MENDER_OK;
 }
 
+static mender_scheduler_work_context_t *
+mender_scheduler_work_alloc(char *name) {
+
+    assert(NULL != name);
+    mender_scheduler_work_context_t *work_context = NULL;
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION
+
+    /* Retrieve a free work context from the pool */
+    vTaskSuspendAll();
+    for (size_t index = 0; index < CONFIG_MENDER_SCHEDULER_STATIC_WORKS; index++) {
+        if (false == mender_scheduler_work_pool[index].used) {
+            work_context = &mender_scheduler_work_pool[index];
+            memset(work_context, 0, sizeof(mender_scheduler_work_context_t));
+            work_context->used = true;
+            break;
+        }
+    }
+    xTaskResumeAll();
+    if (NULL == work_context) {
+        mender_log_error("No more work available, increase the pool size");
+        return NULL;
+    }
+
+    /* Copy the name of the work, it is truncated if it is too long */
+    strncpy(work_context->name, name, sizeof(work_context->name) - 1);
+    work_context->params.name = work_context->name;
+
+#else
+
+    /* Allocate work context */
+    if (NULL == (work_context = (mender_scheduler_work_context_t *)malloc(sizeof(mender_scheduler_work_context_t)))) {
+        return NULL;
+    }
+    memset(work_context, 0, sizeof(mender_scheduler_work_context_t));
+
+    /* Copy the name of the work */
+    if (NULL == (work_context->params.name = strdup(name))) {
+        free(work_context);
+        return NULL;
+    }
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION */
+
+    return work_context;
+}
+
+static void
+mender_scheduler_work_free(mender_scheduler_work_context_t *work_context) {
+
+    assert(NULL != work_context);
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION
+
+    /* The memory of the timer is accessed by the timer service task until the deletion command is processed, the commands are processed in order */
+    if ((NULL != work_context->timer_handle) && (pdPASS == xTimerPendFunctionCall(mender_scheduler_work_free_callback, work_context, 0, portMAX_DELAY))) {
+        return;
+    }
+
+    /* Give back the work context to the pool */
+    work_context->used = false;
+
+#else
+
+    /* Release memory */
+    free(work_context->params.name);
+    free(work_context);
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION */
+}
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION
+
+static void
+mender_scheduler_work_free_callback(void *param, uint32_t unused) {
+
+    assert(NULL != param);
+    (void)unused;
+
+    /* Give back the work context to the pool */
+    ((mender_scheduler_work_context_t *)param)->used = false;
+}
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATIC_ALLOCATION */
+
+static TickType_t
+mender_scheduler_period_to_ticks(int32_t period) {
+
+    /* Compute the timer period, portMAX_DELAY is reserved to block indefinitely */
+    uint64_t ticks = ((uint64_t)period * 1000) / portTICK_PERIOD_MS;
+
+    return (ticks < (uint64_t)portMAX_DELAY) ? (TickType_t)ticks : (portMAX_DELAY - 1);
+}
+
 static void
 mender_scheduler_timer_callback(TimerHandle_t handle) {
 
@@ -360,17 +1032,102 @@ mender_scheduler_timer_callback(TimerHandle_t handle) {
     mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)pvTimerGetTimerID(handle);
     assert(NULL != work_context);
 
+    /* Submit the work to the work queue */
+    mender_scheduler_work_submit(work_context);
+
+    /* Submit the works whose slack window is open so that they share the wake-up, their timers are aligned on this wake-up
+     * The timer service task must never block, the works are only expired at their own deadline if the list of works is being modified */
+    if (pdPASS != xSemaphoreTake(mender_scheduler_works_mutex, 0)) {
+        return;
+    }
+    for (mender_scheduler_work_context_t *other = mender_scheduler_works; NULL != other; other = other->next) {
+        if ((other != work_context) && (true == other->activated) && (other->params.period > 0) && (other->params.slack > 0)
+            && (pdFALSE != xTimerIsTimerActive(other->timer_handle))) {
+            TickType_t remaining = xTimerGetExpiryTime(other->timer_handle) - xTaskGetTickCount();
+            if (remaining <= ((uint64_t)other->params.period * 10 * other->params.slack) / portTICK_PERIOD_MS) {
+                xTimerReset(other->timer_handle, 0);
+                mender_scheduler_work_submit(other);
+            }
+        }
+    }
+    xSemaphoreGive(mender_scheduler_works_mutex);
+}
+
+static void
+mender_scheduler_work_submit(mender_scheduler_work_context_t *work_context) {
+
+    assert(NULL != work_context);
+
     /* Exit if the work is already pending or executing */
     if (pdPASS != xSemaphoreTake(work_context->sem_handle, 0)) {
         mender_log_debug("Work '%s' is not activated, already pending or executing", work_context->params.name);
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+        if (true == work_context->activated) {
+            mender_scheduler_stats_trigger(work_context, true);
+        }
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
         return;
     }
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+    mender_scheduler_stats_trigger(work_context, false);
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
 
-    /* Submit the work to the work queue */
-    if (pdPASS != xQueueSend(mender_scheduler_work_queue_handle, &work_context, 0)) {
+    /* Submit the work to the work queue of its priority */
+    if (pdPASS != xQueueSend(mender_scheduler_work_queue_handles[work_context->params.priority], &work_context, 0)) {
         mender_log_warning("Unable to submit work '%s' to the work queue", work_context->params.name);
         xSemaphoreGive(work_context->sem_handle);
+        return;
+    }
+    xSemaphoreGive(mender_scheduler_work_queue_sem_handle);
+}
+
+static mender_err_t
+mender_scheduler_work_queue_receive(mender_scheduler_work_priority_t priority, bool nestable, mender_scheduler_work_context_t **work_context) {
+
+    assert(NULL != work_context);
+
+    /* Try the work queues from the highest priority to the requested one, the work is peeked first because the work queue task is the only receiver */
+    for (size_t index = MENDER_SCHEDULER_WORK_PRIORITY_COUNT; index-- > (size_t)priority;) {
+        if (pdPASS == xQueuePeek(mender_scheduler_work_queue_handles[index], work_context, 0)) {
+            if ((true == nestable) && ((NULL == *work_context) || (false == (*work_context)->params.nestable))) {
+                return MENDER_FAIL;
+            }
+            xQueueReceive(mender_scheduler_work_queue_handles[index], work_context, 0);
+            return MENDER_OK;
+        }
+    }
+
+    return MENDER_FAIL;
+}
+
+static void
+mender_scheduler_work_run(mender_scheduler_work_context_t *work_context) {
+
+    assert(NULL != work_context);
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+    int64_t start = mender_scheduler_stats_get_time();
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
+
+    /* Call work function */
+    mender_scheduler_work_current = work_context;
+    if (MENDER_DONE == work_context->params.function()) {
+
+        /* Work is done, stop timer used to execute the work periodically */
+        xTimerStop(work_context->timer_handle, portMAX_DELAY);
+        while (pdFALSE != xTimerIsTimerActive(work_context->timer_handle)) {
+            vTaskDelay(1);
+        }
     }
+    mender_scheduler_work_current = NULL;
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+    /* Record the execution, before the work can be triggered again */
+    mender_scheduler_stats_execute(work_context, start, mender_scheduler_stats_get_time());
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
+
+    /* Release semaphore used to protect the work function */
+    xSemaphoreGive(work_context->sem_handle);
 }
 
 static void
@@ -380,33 +1137,123 @@ mender_scheduler_work_queue_thread(void *arg) {
     mender_scheduler_work_context_t *work_context = NULL;
 
     /* Handle work to be executed */
-    while (pdPASS == xQueueReceive(mender_scheduler_work_queue_handle, &work_context, portMAX_DELAY)) {
+    while (pdPASS == xSemaphoreTake(mender_scheduler_work_queue_sem_handle, portMAX_DELAY)) {
+
+        /* Retrieve work of highest priority */
+        if (MENDER_OK != mender_scheduler_work_queue_receive(MENDER_SCHEDULER_WORK_PRIORITY_LOW, false, &work_context)) {
+            continue;
+        }
 
         /* Check if empty work is received from the work queue, this ask the work queue thread to terminate */
         if (NULL == work_context) {
             goto END;
         }
 
-        /* Call work function */
-        if (MENDER_DONE == work_context->params.function()) {
-
-            /* Work is done, stop timer used to execute the work periodically */
-            xTimerStop(work_context->timer_handle, portMAX_DELAY);
-            while (pdFALSE != xTimerIsTimerActive(work_context->timer_handle)) {
-                vTaskDelay(1);
-            }
-        }
-
-        /* Release semaphore used to protect the work function */
-        xSemaphoreGive(work_context->sem_handle);
+        /* Execute work function */
+        mender_scheduler_work_run(work_context);
     }
 
 END:
 
     /* Release memory */
-    vQueueDelete(mender_scheduler_work_queue_handle);
-    mender_scheduler_work_queue_handle = NULL;
+    for (size_t priority = 0; priority < MENDER_SCHEDULER_WORK_PRIORITY_COUNT; priority++) {
+        vQueueDelete(mender_scheduler_work_queue_handles[priority]);
+        mender_scheduler_work_queue_handles[priority] = NULL;
+    }
+    vSemaphoreDelete(mender_scheduler_work_queue_sem_handle);
+    mender_scheduler_work_queue_sem_handle    = NULL;
+    mender_scheduler_work_queue_thread_handle = NULL;
+    vSemaphoreDelete(mender_scheduler_works_mutex);
+    mender_scheduler_works_mutex = NULL;
 
     /* Terminate work queue thread */
     vTaskDelete(NULL);
 }
+
+static void
+mender_scheduler_thread(void *arg) {
+
+    assert(NULL != arg);
+
+    /* Get thread context */
+    mender_scheduler_thread_context_t *thread_context = (mender_scheduler_thread_context_t *)arg;
+
+    /* Execute the thread function */
+    thread_context->function(thread_context->arg);
+
+    /* Indicate the end of the thread function, the thread is deleted by mender_scheduler_thread_join so that the thread context and stack can be
+     * reused safely once it returns */
+    xSemaphoreGive(thread_context->sem_handle);
+    while (true) {
+        vTaskDelay(portMAX_DELAY);
+    }
+}
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+
+static int64_t
+mender_scheduler_stats_get_time(void) {
+
+    /* Read system uptime, with the resolution of the system ticks */
+    return (int64_t)xTaskGetTickCount() * portTICK_PERIOD_MS * 1000;
+}
+
+static void
+mender_scheduler_stats_trigger(mender_scheduler_work_context_t *work_context, bool dropped) {
+
+    assert(NULL != work_context);
+    int64_t now = mender_scheduler_stats_get_time();
+
+    /* The statistics are updated from the timer service task and from the work queue thread, the scheduler is suspended to protect them */
+    vTaskSuspendAll();
+
+    /* Count the trigger, the time is saved to compute the latency of the execution */
+    work_context->stats.triggers++;
+    if (true == dropped) {
+        work_context->stats.dropped++;
+    } else {
+        work_context->trigger_time = now;
+    }
+
+    xTaskResumeAll();
+}
+
+static void
+mender_scheduler_stats_execute(mender_scheduler_work_context_t *work_context, int64_t start, int64_t end) {
+
+    assert(NULL != work_context);
+    uint32_t latency  = (uint32_t)((start - work_context->trigger_time) / 1000);
+    uint32_t duration = (uint32_t)((end - start) / 1000);
+
+    vTaskSuspendAll();
+
+    /* Count the execution and update the histograms */
+    work_context->stats.executions++;
+    if (latency > work_context->stats.latency_max) {
+        work_context->stats.latency_max = latency;
+    }
+    if (duration > work_context->stats.duration_max) {
+        work_context->stats.duration_max = duration;
+    }
+    work_context->stats.duration_total += duration;
+    work_context->stats.latency_histogram[mender_scheduler_stats_histogram_index(latency)]++;
+    work_context->stats.duration_histogram[mender_scheduler_stats_histogram_index(duration)]++;
+
+    xTaskResumeAll();
+}
+
+static size_t
+mender_scheduler_stats_histogram_index(uint32_t value) {
+
+    size_t index = 0;
+
+    /* Bucket i counts the values in [2^(i-1), 2^i[, this is the number of significant bits of the value */
+    while ((0 != value) && (index < MENDER_SCHEDULER_WORK_HISTOGRAM_SIZE - 1)) {
+        value >>= 1;
+        index++;
+    }
+
+    return index;
+}
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
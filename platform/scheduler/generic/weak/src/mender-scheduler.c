@@ -64,6 +64,36 @@ mender_scheduler_work_execute(void *handle) {
     return MENDER_NOT_IMPLEMENTED;
 }
 
+__attribute__((weak)) mender_err_t
+mender_scheduler_work_yield(void) {
+
+    /* Nothing to do */
+    return MENDER_NOT_IMPLEMENTED;
+}
+
+__attribute__((weak)) bool
+mender_scheduler_work_is_cancelled(void) {
+
+    /* Nothing to do */
+    return false;
+}
+
+__attribute__((weak)) void *
+mender_scheduler_work_get_current(void) {
+
+    /* Nothing to do */
+    return NULL;
+}
+
+__attribute__((weak)) bool
+mender_scheduler_work_is_deactivating(void *handle) {
+
+    (void)handle;
+
+    /* Nothing to do */
+    return false;
+}
+
 __attribute__((weak)) mender_err_t
 mender_scheduler_work_deactivate(void *handle) {
 
@@ -82,6 +112,38 @@ mender_scheduler_work_delete(void *handle) {
     return MENDER_NOT_IMPLEMENTED;
 }
 
+__attribute__((weak)) mender_err_t
+mender_scheduler_work_get_stats(void *handle, mender_scheduler_work_stats_t *stats, bool reset) {
+
+    (void)handle;
+    (void)stats;
+    (void)reset;
+
+    /* Nothing to do */
+    return MENDER_NOT_IMPLEMENTED;
+}
+
+__attribute__((weak)) mender_err_t
+mender_scheduler_thread_create(void (*function)(void *), void *arg, char *name, void **handle) {
+
+    (void)function;
+    (void)arg;
+    (void)name;
+    (void)handle;
+
+    /* Nothing to do */
+    return MENDER_NOT_IMPLEMENTED;
+}
+
+__attribute__((weak)) mender_err_t
+mender_scheduler_thread_join(void *handle) {
+
+    (void)handle;
+
+    /* Nothing to do */
+    return MENDER_NOT_IMPLEMENTED;
+}
+
 __attribute__((weak)) mender_err_t
 mender_scheduler_mutex_create(void **handle) {
 
@@ -119,6 +181,22 @@ mender_scheduler_mutex_delete(void *handle) {
     return MENDER_NOT_IMPLEMENTED;
 }
 
+__attribute__((weak)) mender_err_t
+mender_scheduler_delay(uint32_t delay_ms) {
+
+    (void)delay_ms;
+
+    /* Nothing to do */
+    return MENDER_NOT_IMPLEMENTED;
+}
+
+__attribute__((weak)) int64_t
+mender_scheduler_get_uptime(void) {
+
+    /* Nothing to do */
+    return 0;
+}
+
 __attribute__((weak)) mender_err_t
 mender_scheduler_exit(void) {
 
@@ -18,10 +18,14 @@
  */
 
 #include <errno.h>
+#include <inttypes.h>
 #include <math.h>
-#include <mqueue.h>
 #include <pthread.h>
-#include <signal.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
 #include <time.h>
 #include <unistd.h>
 #include "mender-log.h"
@@ -41,6 +45,21 @@
 #define CONFIG_MENDER_SCHEDULER_WORK_QUEUE_PRIORITY (0)
 #endif /* CONFIG_MENDER_SCHEDULER_WORK_QUEUE_PRIORITY */
 
+/**
+ * @brief Default thread stack size (kB)
+ */
+#ifndef CONFIG_MENDER_SCHEDULER_THREAD_STACK_SIZE
+#define CONFIG_MENDER_SCHEDULER_THREAD_STACK_SIZE (64)
+#endif /* CONFIG_MENDER_SCHEDULER_THREAD_STACK_SIZE */
+
+/**
+ * @brief Default thread priority
+ * @note The default scheduling policy only permits priority 0, the threads then share the processor with the work queue threads
+ */
+#ifndef CONFIG_MENDER_SCHEDULER_THREAD_PRIORITY
+#define CONFIG_MENDER_SCHEDULER_THREAD_PRIORITY (0)
+#endif /* CONFIG_MENDER_SCHEDULER_THREAD_PRIORITY */
+
 /**
  * @brief Default work queue length
  */
@@ -48,61 +67,326 @@
 #define CONFIG_MENDER_SCHEDULER_WORK_QUEUE_LENGTH (10)
 #endif /* CONFIG_MENDER_SCHEDULER_WORK_QUEUE_LENGTH */
 
+/**
+ * @brief Default number of work queue threads
+ * @note The same work is never executed concurrently, setting more than one thread permits independent works to run in parallel
+ */
+#ifndef CONFIG_MENDER_SCHEDULER_WORK_QUEUE_THREADS
+#define CONFIG_MENDER_SCHEDULER_WORK_QUEUE_THREADS (1)
+#endif /* CONFIG_MENDER_SCHEDULER_WORK_QUEUE_THREADS */
+
+/**
+ * @brief The trace of the works relies on the statistics
+ */
+#if defined(CONFIG_MENDER_SCHEDULER_TRACE_FILE) && !defined(CONFIG_MENDER_SCHEDULER_STATISTICS)
+#define CONFIG_MENDER_SCHEDULER_STATISTICS
+#endif /* CONFIG_MENDER_SCHEDULER_TRACE_FILE && !CONFIG_MENDER_SCHEDULER_STATISTICS */
+
+/**
+ * @brief Index of the work in the timer heap when the timer of the work is not running
+ */
+#define MENDER_SCHEDULER_TIMER_NOT_RUNNING (SIZE_MAX)
+
 /**
  * @brief Work context
  */
 typedef struct {
-    mender_scheduler_work_params_t params;       /**< Work parameters */
-    pthread_mutex_t                sem_handle;   /**< Semaphore used to indicate work is pending or executing */
-    timer_t                        timer_handle; /**< Timer used to periodically execute work */
-    bool                           activated;    /**< Flag indicating the work is activated */
+    mender_scheduler_work_params_t params;         /**< Work parameters */
+    pthread_mutex_t                sem_handle;     /**< Semaphore used to indicate work is pending or executing */
+    int64_t                        timer_deadline; /**< Next expiration of the timer used to periodically execute work (monotonic, ms) */
+    size_t                         timer_index;    /**< Index of the work in the timer heap, MENDER_SCHEDULER_TIMER_NOT_RUNNING if the timer is not running */
+    bool                           activated;      /**< Flag indicating the work is activated */
+    atomic_bool                    cancelled;      /**< Flag indicating the deactivation of the work is pending */
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+    int64_t                        trigger_time;   /**< Time of the last trigger submitting the work to the work queue (monotonic, us) */
+    mender_scheduler_work_stats_t  stats;          /**< Work statistics */
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
 } mender_scheduler_work_context_t;
 
 /**
- *
- * @brief Work queue parameters
+ * @brief Work queue cell
  */
-#define MENDER_SCHEDULER_WORK_QUEUE_NAME  "/mender-work-queue"
-#define MENDER_SCHEDULER_WORK_QUEUE_PERMS (0644)
+typedef struct {
+    atomic_size_t                    sequence;     /**< Sequence number, used to indicate the cell is ready to be written or read */
+    mender_scheduler_work_context_t *work_context; /**< Work context, NULL to ask a work queue thread to terminate */
+} mender_scheduler_work_queue_cell_t;
+
+/**
+ * @brief Work queue, bounded lock-free multi-producer multi-consumer ring buffer
+ */
+typedef struct {
+    mender_scheduler_work_queue_cell_t cells[CONFIG_MENDER_SCHEDULER_WORK_QUEUE_LENGTH]; /**< Cells of the ring buffer */
+    atomic_size_t                      enqueue_pos;                                      /**< Position incremented by the producers */
+    atomic_size_t                      dequeue_pos;                                      /**< Position incremented by the consumers */
+} mender_scheduler_work_queue_t;
+
+/**
+ * @brief Thread context
+ */
+typedef struct {
+    void (*function)(void *); /**< Thread function */
+    void     *arg;            /**< Argument of the thread function */
+    pthread_t thread_handle;  /**< Thread handle */
+} mender_scheduler_thread_context_t;
+
+/**
+ * @brief Start or restart the timer used to periodically execute work
+ * @param work_context Work context
+ * @param delay_ms Delay before the first expiration of the timer (ms)
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_scheduler_timer_start(mender_scheduler_work_context_t *work_context, int64_t delay_ms);
+
+/**
+ * @brief Stop the timer used to periodically execute work
+ * @param work_context Work context
+ */
+static void mender_scheduler_timer_stop(mender_scheduler_work_context_t *work_context);
+
+/**
+ * @brief Restore the heap property after the deadline of the work at the given index of the timer heap has changed
+ * @note Timer mutex must be taken by the caller
+ * @param index Index of the work in the timer heap
+ */
+static void mender_scheduler_timer_heap_update(size_t index);
+
+/**
+ * @brief Remove the work at the given index of the timer heap
+ * @note Timer mutex must be taken by the caller
+ * @param index Index of the work in the timer heap
+ */
+static void mender_scheduler_timer_heap_remove(size_t index);
+
+/**
+ * @brief Expire the timer of the work at the given index of the timer heap, the next deadline is computed and the work is submitted to the work queue
+ * @note Timer mutex must be taken by the caller
+ * @param index Index of the work in the timer heap
+ * @param now Current uptime (ms)
+ */
+static void mender_scheduler_timer_expire(size_t index, int64_t now);
+
+/**
+ * @brief Thread used to handle the timers of the works, the works are sorted by deadline in a min-heap
+ * @param arg Not used
+ * @return Not used
+ */
+static void *mender_scheduler_timer_thread(void *arg);
 
 /**
  * @brief Function used to handle work context timer when it expires
- * @param timer_data Timer data
+ * @param work_context Work context
+ */
+static void mender_scheduler_timer_callback(mender_scheduler_work_context_t *work_context);
+
+/**
+ * @brief Submit work to the work queue of its priority
+ * @param work_context Work context, NULL to ask a work queue thread to terminate
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t mender_scheduler_work_queue_push(mender_scheduler_work_context_t *work_context);
+
+/**
+ * @brief Retrieve work of highest priority from the work queues
+ * @param priority Minimum priority of the work to retrieve
+ * @param work_context Work context
+ * @return MENDER_OK if the function succeeds, MENDER_FAIL if the work queues are empty
+ */
+static mender_err_t mender_scheduler_work_queue_pop(mender_scheduler_work_priority_t priority, mender_scheduler_work_context_t **work_context);
+
+/**
+ * @brief Check if works have been submitted to the work queues and not yet retrieved
+ * @return true if the work queues are not empty, false otherwise
+ */
+static bool mender_scheduler_work_queue_is_pending(void);
+
+/**
+ * @brief Execute work function
+ * @param work_context Work context
  */
-static void mender_scheduler_timer_callback(union sigval timer_data);
+static void mender_scheduler_work_run(mender_scheduler_work_context_t *work_context);
 
 /**
  * @brief Thread used to handle work queue
- * @param arg Not used
+ * @param arg Index of the work queue thread, starting at 1
  * @return Not used
  */
 static void *mender_scheduler_work_queue_thread(void *arg);
 
 /**
- * @brief Work queue handle
+ * @brief Thread created by mender_scheduler_thread_create, it executes the thread function
+ * @param arg Thread context
+ * @return Not used
+ */
+static void *mender_scheduler_thread(void *arg);
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+
+/**
+ * @brief Read the monotonic clock with the resolution needed by the statistics
+ * @return Current time (monotonic, us)
  */
-static mqd_t mender_scheduler_work_queue_handle;
+static int64_t mender_scheduler_stats_get_time(void);
+
+/**
+ * @brief Record a trigger of the work
+ * @param work_context Work context
+ * @param dropped Flag indicating the trigger has been dropped because the work is already pending or executing
+ */
+static void mender_scheduler_stats_trigger(mender_scheduler_work_context_t *work_context, bool dropped);
+
+/**
+ * @brief Record an execution of the work
+ * @param work_context Work context
+ * @param start Start time of the execution (monotonic, us)
+ * @param end End time of the execution (monotonic, us)
+ */
+static void mender_scheduler_stats_execute(mender_scheduler_work_context_t *work_context, int64_t start, int64_t end);
+
+/**
+ * @brief Compute the bucket of the histograms of the works corresponding to the value
+ * @param value Value (ms)
+ * @return Index of the bucket
+ */
+static size_t mender_scheduler_stats_histogram_index(uint32_t value);
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
+
+#ifdef CONFIG_MENDER_SCHEDULER_TRACE_FILE
+
+/**
+ * @brief Write an event to the trace file
+ * @note Statistics mutex must be taken by the caller
+ * @param format Format of the event, using the Chrome trace event format
+ * @param ... Arguments
+ */
+static void mender_scheduler_trace_event(const char *format, ...);
+
+#endif /* CONFIG_MENDER_SCHEDULER_TRACE_FILE */
+
+/**
+ * @brief Work queues, one per priority
+ */
+static mender_scheduler_work_queue_t mender_scheduler_work_queues[MENDER_SCHEDULER_WORK_PRIORITY_COUNT];
+
+/**
+ * @brief Work queue semaphore, counting the works in the queues, idle work queue threads wait on it
+ */
+static sem_t mender_scheduler_work_queue_sem;
+
+/**
+ * @brief Work currently executed by the calling work queue thread, NULL if the calling thread is not a work queue thread
+ */
+static __thread mender_scheduler_work_context_t *mender_scheduler_work_current = NULL;
+
+/**
+ * @brief Flag indicating the calling work queue thread is executing works of higher priority from mender_scheduler_work_yield
+ */
+static __thread bool mender_scheduler_work_yielding = false;
+
+/**
+ * @brief Work queue thread handles
+ */
+static pthread_t mender_scheduler_work_queue_thread_handles[CONFIG_MENDER_SCHEDULER_WORK_QUEUE_THREADS];
+
+/**
+ * @brief Timer heap, works with a running timer sorted by deadline, the next timer to expire is the first one
+ */
+static mender_scheduler_work_context_t **mender_scheduler_timer_heap        = NULL;
+static size_t                            mender_scheduler_timer_heap_length = 0;
+static size_t                            mender_scheduler_timer_heap_size   = 0;
+
+/**
+ * @brief Timer mutex and condition, used to protect the timer heap and to wake up the timer thread
+ */
+static pthread_mutex_t mender_scheduler_timer_mutex;
+static pthread_cond_t  mender_scheduler_timer_cond;
+
+/**
+ * @brief Flag used to ask the timer thread to terminate
+ */
+static bool mender_scheduler_timer_exit = false;
+
+/**
+ * @brief Timer thread handle
+ */
+static pthread_t mender_scheduler_timer_thread_handle;
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
 
 /**
- * @brief Work queue thread handle
+ * @brief Statistics mutex, used to protect the statistics of the works and the trace file
  */
-static pthread_t mender_scheduler_work_queue_thread_handle;
+static pthread_mutex_t mender_scheduler_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
+
+#ifdef CONFIG_MENDER_SCHEDULER_TRACE_FILE
+
+/**
+ * @brief Trace file and number of events written to it
+ */
+static FILE  *mender_scheduler_trace_file   = NULL;
+static size_t mender_scheduler_trace_events = 0;
+
+/**
+ * @brief Thread identifier used in the trace, index of the work queue thread or 0 for the other threads
+ */
+static __thread size_t mender_scheduler_trace_tid = 0;
+
+#endif /* CONFIG_MENDER_SCHEDULER_TRACE_FILE */
 
 mender_err_t
 mender_scheduler_init(void) {
 
     int ret;
 
-    /* Create and start work queue */
-    struct mq_attr mq_attr;
-    memset(&mq_attr, 0, sizeof(struct mq_attr));
-    mq_attr.mq_maxmsg  = CONFIG_MENDER_SCHEDULER_WORK_QUEUE_LENGTH;
-    mq_attr.mq_msgsize = sizeof(mender_scheduler_work_context_t *);
-    mq_unlink(MENDER_SCHEDULER_WORK_QUEUE_NAME);
-    if ((mender_scheduler_work_queue_handle = mq_open(MENDER_SCHEDULER_WORK_QUEUE_NAME, O_CREAT | O_RDWR, MENDER_SCHEDULER_WORK_QUEUE_PERMS, &mq_attr)) < 0) {
-        mender_log_error("Unable to create work queue (errno=%d)", errno);
+    /* Create work queues */
+    for (size_t priority = 0; priority < MENDER_SCHEDULER_WORK_PRIORITY_COUNT; priority++) {
+        mender_scheduler_work_queue_t *work_queue = &mender_scheduler_work_queues[priority];
+        for (size_t index = 0; index < CONFIG_MENDER_SCHEDULER_WORK_QUEUE_LENGTH; index++) {
+            atomic_init(&work_queue->cells[index].sequence, index);
+            work_queue->cells[index].work_context = NULL;
+        }
+        atomic_init(&work_queue->enqueue_pos, 0);
+        atomic_init(&work_queue->dequeue_pos, 0);
+    }
+    if (0 != sem_init(&mender_scheduler_work_queue_sem, 0, 0)) {
+        mender_log_error("Unable to create work queue semaphore (errno=%d)", errno);
+        return MENDER_FAIL;
+    }
+
+    /* Create timer mutex and condition, the condition is using the monotonic clock */
+    pthread_condattr_t pthread_condattr;
+    if (0 != (ret = pthread_mutex_init(&mender_scheduler_timer_mutex, NULL))) {
+        mender_log_error("Unable to create timer mutex (ret=%d)", ret);
         return MENDER_FAIL;
     }
+    if ((0 != (ret = pthread_condattr_init(&pthread_condattr))) || (0 != (ret = pthread_condattr_setclock(&pthread_condattr, CLOCK_MONOTONIC)))
+        || (0 != (ret = pthread_cond_init(&mender_scheduler_timer_cond, &pthread_condattr)))) {
+        mender_log_error("Unable to create timer condition (ret=%d)", ret);
+        return MENDER_FAIL;
+    }
+    pthread_condattr_destroy(&pthread_condattr);
+    mender_scheduler_timer_exit = false;
+
+#ifdef CONFIG_MENDER_SCHEDULER_TRACE_FILE
+    /* Open trace file, the events are written as a JSON array using the Chrome trace event format */
+    if (NULL == (mender_scheduler_trace_file = fopen(CONFIG_MENDER_SCHEDULER_TRACE_FILE, "w"))) {
+        mender_log_error("Unable to open trace file (errno=%d)", errno);
+        return MENDER_FAIL;
+    }
+    fputc('[', mender_scheduler_trace_file);
+    mender_scheduler_trace_events = 0;
+    pthread_mutex_lock(&mender_scheduler_stats_mutex);
+    mender_scheduler_trace_event("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"triggers\"}}");
+    for (size_t index = 0; index < CONFIG_MENDER_SCHEDULER_WORK_QUEUE_THREADS; index++) {
+        mender_scheduler_trace_event(
+            "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"work queue %zu\"}}", index + 1, index + 1);
+    }
+    pthread_mutex_unlock(&mender_scheduler_stats_mutex);
+#endif /* CONFIG_MENDER_SCHEDULER_TRACE_FILE */
+
+    /* Start work queue threads and timer thread */
     pthread_attr_t pthread_attr;
     if (0 != (ret = pthread_attr_init(&pthread_attr))) {
         mender_log_error("Unable to initialize work queue thread attributes (ret=%d)", ret);
@@ -114,14 +398,27 @@ mender_scheduler_init(void) {
         mender_log_error("Unable to set work queue thread stack size (ret=%d)", ret);
         return MENDER_FAIL;
     }
-    if (0 != (ret = pthread_create(&mender_scheduler_work_queue_thread_handle, &pthread_attr, mender_scheduler_work_queue_thread, NULL))) {
-        mender_log_error("Unable to create work queue thread (ret=%d)", ret);
+    for (size_t index = 0; index < CONFIG_MENDER_SCHEDULER_WORK_QUEUE_THREADS; index++) {
+        if (0
+            != (ret = pthread_create(
+                    &mender_scheduler_work_queue_thread_handles[index], &pthread_attr, mender_scheduler_work_queue_thread, (void *)(index + 1)))) {
+            mender_log_error("Unable to create work queue thread (ret=%d)", ret);
+            return MENDER_FAIL;
+        }
+        if (0 != (ret = pthread_setschedprio(mender_scheduler_work_queue_thread_handles[index], CONFIG_MENDER_SCHEDULER_WORK_QUEUE_PRIORITY))) {
+            mender_log_error("Unable to set work queue thread priority (ret=%d)", ret);
+            return MENDER_FAIL;
+        }
+    }
+    if (0 != (ret = pthread_create(&mender_scheduler_timer_thread_handle, &pthread_attr, mender_scheduler_timer_thread, NULL))) {
+        mender_log_error("Unable to create timer thread (ret=%d)", ret);
         return MENDER_FAIL;
     }
-    if (0 != (ret = pthread_setschedprio(mender_scheduler_work_queue_thread_handle, CONFIG_MENDER_SCHEDULER_WORK_QUEUE_PRIORITY))) {
-        mender_log_error("Unable to set work queue thread priority (ret=%d)", ret);
+    if (0 != (ret = pthread_setschedprio(mender_scheduler_timer_thread_handle, CONFIG_MENDER_SCHEDULER_WORK_QUEUE_PRIORITY))) {
+        mender_log_error("Unable to set timer thread priority (ret=%d)", ret);
         return MENDER_FAIL;
     }
+    pthread_attr_destroy(&pthread_attr);
 
     return MENDER_OK;
 }
@@ -132,6 +429,8 @@ mender_scheduler_work_create(mender_scheduler_work_params_t *work_params, void *
     assert(NULL != work_params);
     assert(NULL != work_params->function);
     assert(NULL != work_params->name);
+    assert(work_params->slack < 100);
+    assert(work_params->priority < MENDER_SCHEDULER_WORK_PRIORITY_COUNT);
     assert(NULL != handle);
 
     /* Create work context */
@@ -145,6 +444,9 @@ mender_scheduler_work_create(mender_scheduler_work_params_t *work_params, void *
     /* Copy work parameters */
     work_context->params.function = work_params->function;
     work_context->params.period   = work_params->period;
+    work_context->params.slack    = work_params->slack;
+    work_context->params.priority = work_params->priority;
+    work_context->params.nestable = work_params->nestable;
     if (NULL == (work_context->params.name = strdup(work_params->name))) {
         mender_log_error("Unable to allocate memory");
         goto FAIL;
@@ -156,16 +458,8 @@ mender_scheduler_work_create(mender_scheduler_work_params_t *work_params, void *
         goto FAIL;
     }
 
-    /* Create timer to handle the work periodically */
-    struct sigevent sev;
-    memset(&sev, 0, sizeof(struct sigevent));
-    sev.sigev_notify          = SIGEV_THREAD;
-    sev.sigev_notify_function = mender_scheduler_timer_callback;
-    sev.sigev_value.sival_ptr = work_context;
-    if (0 != timer_create(CLOCK_REALTIME, &sev, &work_context->timer_handle)) {
-        mender_log_error("Unable to create timer");
-        goto FAIL;
-    }
+    /* The timer to handle the work periodically is not running */
+    work_context->timer_index = MENDER_SCHEDULER_TIMER_NOT_RUNNING;
 
     /* Return handle to the new work */
     *handle = (void *)work_context;
@@ -176,7 +470,6 @@ FAIL:
 
     /* Release memory */
     if (NULL != work_context) {
-        timer_delete(work_context->timer_handle);
         pthread_mutex_destroy(&work_context->sem_handle);
         if (NULL != work_context->params.name) {
             free(work_context->params.name);
@@ -205,19 +498,13 @@ mender_scheduler_work_activate(void *handle) {
     if (work_context->params.period > 0) {
 
         /* Start the timer to handle the work */
-        struct itimerspec its;
-        memset(&its, 0, sizeof(struct itimerspec));
-        its.it_value.tv_sec    = work_context->params.period;
-        its.it_interval.tv_sec = work_context->params.period;
-        if (0 != timer_settime(work_context->timer_handle, 0, &its, NULL)) {
+        if (MENDER_OK != mender_scheduler_timer_start(work_context, (int64_t)work_context->params.period * 1000)) {
             mender_log_error("Unable to start timer");
             return MENDER_FAIL;
         }
 
         /* Execute the work now */
-        union sigval timer_data;
-        timer_data.sival_ptr = (void *)work_context;
-        mender_scheduler_timer_callback(timer_data);
+        mender_scheduler_timer_callback(work_context);
     }
 
     /* Indicate the work has been activated */
@@ -234,17 +521,15 @@ mender_scheduler_work_set_period(void *handle, uint32_t period) {
     /* Get work context */
     mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)handle;
 
-    /* Set timer period */
-    work_context->params.period = period;
-    struct itimerspec its;
-    memset(&its, 0, sizeof(struct itimerspec));
+    /* Set timer period, it is clamped to the maximum period of the work parameters */
+    work_context->params.period = (period > INT32_MAX) ? INT32_MAX : (int32_t)period;
     if (work_context->params.period > 0) {
-        its.it_value.tv_sec    = work_context->params.period;
-        its.it_interval.tv_sec = work_context->params.period;
-    }
-    if (0 != timer_settime(work_context->timer_handle, 0, &its, NULL)) {
-        mender_log_error("Unable to set timer period");
-        return MENDER_FAIL;
+        if (MENDER_OK != mender_scheduler_timer_start(work_context, (int64_t)work_context->params.period * 1000)) {
+            mender_log_error("Unable to set timer period");
+            return MENDER_FAIL;
+        }
+    } else {
+        mender_scheduler_timer_stop(work_context);
     }
 
     return MENDER_OK;
@@ -259,13 +544,72 @@ mender_scheduler_work_execute(void *handle) {
     mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)handle;
 
     /* Execute the work now */
-    union sigval timer_data;
-    timer_data.sival_ptr = (void *)work_context;
-    mender_scheduler_timer_callback(timer_data);
+    mender_scheduler_timer_callback(work_context);
 
     return MENDER_OK;
 }
 
+mender_err_t
+mender_scheduler_work_yield(void) {
+
+    mender_scheduler_work_context_t *work_context = NULL;
+
+    /* Nothing to do if the function is not called from a work, or from a work already executed by this function (nesting is limited to one level) */
+    if ((NULL == mender_scheduler_work_current) || (true == mender_scheduler_work_yielding)) {
+        return MENDER_OK;
+    }
+
+    /* Execute the pending nestable works of higher priority, the semaphore counting the works in the queues is taken before retrieving each work
+     * so that it always matches the content of the queues, and it is given back if there is no work of higher priority */
+    mender_scheduler_work_context_t *current = mender_scheduler_work_current;
+    mender_scheduler_work_yielding           = true;
+    while ((current->params.priority + 1 < MENDER_SCHEDULER_WORK_PRIORITY_COUNT) && (0 == sem_trywait(&mender_scheduler_work_queue_sem))) {
+        if (MENDER_OK != mender_scheduler_work_queue_pop(current->params.priority + 1, &work_context)) {
+            sem_post(&mender_scheduler_work_queue_sem);
+            break;
+        }
+        if (false == work_context->params.nestable) {
+            /* Submit the work again so that it is executed by a work queue thread, this gives the semaphore back */
+            if (MENDER_OK != mender_scheduler_work_queue_push(work_context)) {
+                mender_log_warning("Unable to submit work '%s' to the work queue", work_context->params.name);
+                pthread_mutex_unlock(&work_context->sem_handle);
+            }
+            break;
+        }
+        mender_scheduler_work_run(work_context);
+    }
+    mender_scheduler_work_yielding = false;
+    mender_scheduler_work_current  = current;
+
+    return MENDER_OK;
+}
+
+bool
+mender_scheduler_work_is_cancelled(void) {
+
+    /* Check if the deactivation of the calling work is pending */
+    return (NULL != mender_scheduler_work_current) && (true == atomic_load(&mender_scheduler_work_current->cancelled));
+}
+
+void *
+mender_scheduler_work_get_current(void) {
+
+    /* Return the work executed by the calling thread */
+    return mender_scheduler_work_current;
+}
+
+bool
+mender_scheduler_work_is_deactivating(void *handle) {
+
+    assert(NULL != handle);
+
+    /* Get work context */
+    mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)handle;
+
+    /* Check if the deactivation of the work is pending */
+    return atomic_load(&work_context->cancelled);
+}
+
 mender_err_t
 mender_scheduler_work_deactivate(void *handle) {
 
@@ -278,18 +622,16 @@ mender_scheduler_work_deactivate(void *handle) {
     if (true == work_context->activated) {
 
         /* Stop the timer used to periodically execute the work (if it is running) */
-        struct itimerspec its;
-        memset(&its, 0, sizeof(struct itimerspec));
-        if (0 != timer_settime(work_context->timer_handle, 0, &its, NULL)) {
-            mender_log_error("Unable to stop timer");
-            return MENDER_FAIL;
-        }
+        mender_scheduler_timer_stop(work_context);
 
-        /* Wait if the work is pending or executing */
+        /* Cancel the work and wait if it is pending or executing */
+        atomic_store(&work_context->cancelled, true);
         if (0 != pthread_mutex_lock(&work_context->sem_handle)) {
             mender_log_error("Work '%s' is pending or executing", work_context->params.name);
+            atomic_store(&work_context->cancelled, false);
             return MENDER_FAIL;
         }
+        atomic_store(&work_context->cancelled, false);
 
         /* Indicate the work has been deactivated */
         work_context->activated = false;
@@ -306,8 +648,10 @@ mender_scheduler_work_delete(void *handle) {
     /* Get work context */
     mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)handle;
 
+    /* Stop the timer used to periodically execute the work (if it is running) */
+    mender_scheduler_timer_stop(work_context);
+
     /* Release memory */
-    timer_delete(work_context->timer_handle);
     pthread_mutex_destroy(&work_context->sem_handle);
     if (NULL != work_context->params.name) {
         free(work_context->params.name);
@@ -317,6 +661,111 @@ mender_scheduler_work_delete(void *handle) {
     return MENDER_OK;
 }
 
+mender_err_t
+mender_scheduler_work_get_stats(void *handle, mender_scheduler_work_stats_t *stats, bool reset) {
+
+    assert(NULL != handle);
+    assert(NULL != stats);
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+
+    /* Get work context */
+    mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)handle;
+
+    /* Copy the statistics of the work, and reset them if requested */
+    pthread_mutex_lock(&mender_scheduler_stats_mutex);
+    memcpy(stats, &work_context->stats, sizeof(mender_scheduler_work_stats_t));
+    if (true == reset) {
+        memset(&work_context->stats, 0, sizeof(mender_scheduler_work_stats_t));
+    }
+    pthread_mutex_unlock(&mender_scheduler_stats_mutex);
+
+    return MENDER_OK;
+
+#else
+
+    (void)handle;
+    (void)stats;
+    (void)reset;
+
+    /* Statistics are not collected */
+    return MENDER_NOT_IMPLEMENTED;
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
+}
+
+mender_err_t
+mender_scheduler_thread_create(void (*function)(void *), void *arg, char *name, void **handle) {
+
+    assert(NULL != function);
+    assert(NULL != name);
+    assert(NULL != handle);
+
+    mender_scheduler_thread_context_t *thread_context;
+    pthread_attr_t                     pthread_attr;
+    int                                ret;
+
+    /* Create thread context */
+    if (NULL == (thread_context = (mender_scheduler_thread_context_t *)malloc(sizeof(mender_scheduler_thread_context_t)))) {
+        mender_log_error("Unable to allocate memory");
+        goto FAIL;
+    }
+    thread_context->function = function;
+    thread_context->arg      = arg;
+
+    /* Start the thread */
+    if (0 != (ret = pthread_attr_init(&pthread_attr))) {
+        mender_log_error("Unable to initialize thread '%s' attributes (ret=%d)", name, ret);
+        goto FAIL;
+    }
+    if (0
+        != (ret = pthread_attr_setstacksize(&pthread_attr,
+                                            ((CONFIG_MENDER_SCHEDULER_THREAD_STACK_SIZE > 16) ? CONFIG_MENDER_SCHEDULER_THREAD_STACK_SIZE : 16) * 1024))) {
+        mender_log_error("Unable to set thread '%s' stack size (ret=%d)", name, ret);
+        pthread_attr_destroy(&pthread_attr);
+        goto FAIL;
+    }
+    ret = pthread_create(&thread_context->thread_handle, &pthread_attr, mender_scheduler_thread, thread_context);
+    pthread_attr_destroy(&pthread_attr);
+    if (0 != ret) {
+        mender_log_error("Unable to create thread '%s' (ret=%d)", name, ret);
+        goto FAIL;
+    }
+    if (0 != (ret = pthread_setschedprio(thread_context->thread_handle, CONFIG_MENDER_SCHEDULER_THREAD_PRIORITY))) {
+        mender_log_warning("Unable to set thread '%s' priority (ret=%d)", name, ret);
+    }
+
+    /* Return handle to the thread */
+    *handle = thread_context;
+
+    return MENDER_OK;
+
+FAIL:
+
+    /* Release memory */
+    free(thread_context);
+    *handle = NULL;
+
+    return MENDER_FAIL;
+}
+
+mender_err_t
+mender_scheduler_thread_join(void *handle) {
+
+    assert(NULL != handle);
+
+    /* Get thread context */
+    mender_scheduler_thread_context_t *thread_context = (mender_scheduler_thread_context_t *)handle;
+
+    /* Wait for the end of the thread */
+    pthread_join(thread_context->thread_handle, NULL);
+
+    /* Release memory */
+    free(thread_context);
+
+    return MENDER_OK;
+}
+
 mender_err_t
 mender_scheduler_mutex_create(void **handle) {
 
@@ -382,27 +831,267 @@ mender_scheduler_mutex_delete(void *handle) {
     return MENDER_OK;
 }
 
+mender_err_t
+mender_scheduler_delay(uint32_t delay_ms) {
+
+    struct timespec delay;
+    delay.tv_sec  = delay_ms / 1000;
+    delay.tv_nsec = (delay_ms % 1000) * 1000000;
+
+    /* Suspend the calling thread, restart if interrupted by a signal */
+    while (0 != nanosleep(&delay, &delay)) {
+        if (EINTR != errno) {
+            return MENDER_FAIL;
+        }
+    }
+
+    return MENDER_OK;
+}
+
+int64_t
+mender_scheduler_get_uptime(void) {
+
+    struct timespec now;
+
+    /* Read monotonic clock */
+    if (0 != clock_gettime(CLOCK_MONOTONIC, &now)) {
+        return 0;
+    }
+
+    return ((int64_t)now.tv_sec * 1000) + (now.tv_nsec / 1000000);
+}
+
 mender_err_t
 mender_scheduler_exit(void) {
 
-    /* Submit empty work to the work queue, this ask the work queue thread to terminate */
-    mender_scheduler_work_context_t *work_context = NULL;
-    if (0 != mq_send(mender_scheduler_work_queue_handle, (const char *)&work_context, sizeof(mender_scheduler_work_context_t *), 0)) {
-        mender_log_error("Unable to submit empty work to the work queue");
-        return MENDER_FAIL;
+    /* Ask the timer thread to terminate and wait end of execution of the timer thread */
+    pthread_mutex_lock(&mender_scheduler_timer_mutex);
+    mender_scheduler_timer_exit = true;
+    pthread_cond_signal(&mender_scheduler_timer_cond);
+    pthread_mutex_unlock(&mender_scheduler_timer_mutex);
+    pthread_join(mender_scheduler_timer_thread_handle, NULL);
+
+    /* Submit one empty work per work queue thread to the work queue, this ask the work queue threads to terminate */
+    for (size_t index = 0; index < CONFIG_MENDER_SCHEDULER_WORK_QUEUE_THREADS; index++) {
+        while (MENDER_OK != mender_scheduler_work_queue_push(NULL)) {
+            /* Work queue is full, wait for the work queue threads to consume works */
+            mender_scheduler_delay(10);
+        }
+    }
+
+    /* Wait end of execution of the work queue threads */
+    for (size_t index = 0; index < CONFIG_MENDER_SCHEDULER_WORK_QUEUE_THREADS; index++) {
+        pthread_join(mender_scheduler_work_queue_thread_handles[index], NULL);
     }
 
-    /* Wait end of execution of the work queue thread */
-    pthread_join(mender_scheduler_work_queue_thread_handle, NULL);
+    /* Release memory */
+    sem_destroy(&mender_scheduler_work_queue_sem);
+    if (NULL != mender_scheduler_timer_heap) {
+        free(mender_scheduler_timer_heap);
+        mender_scheduler_timer_heap = NULL;
+    }
+    mender_scheduler_timer_heap_length = 0;
+    mender_scheduler_timer_heap_size   = 0;
+    pthread_cond_destroy(&mender_scheduler_timer_cond);
+    pthread_mutex_destroy(&mender_scheduler_timer_mutex);
+
+#ifdef CONFIG_MENDER_SCHEDULER_TRACE_FILE
+    /* Close trace file */
+    pthread_mutex_lock(&mender_scheduler_stats_mutex);
+    if (NULL != mender_scheduler_trace_file) {
+        fputs("\n]\n", mender_scheduler_trace_file);
+        fclose(mender_scheduler_trace_file);
+        mender_scheduler_trace_file = NULL;
+    }
+    pthread_mutex_unlock(&mender_scheduler_stats_mutex);
+#endif /* CONFIG_MENDER_SCHEDULER_TRACE_FILE */
 
     return MENDER_OK;
 }
 
+static mender_err_t
+mender_scheduler_timer_start(mender_scheduler_work_context_t *work_context, int64_t delay_ms) {
+
+    assert(NULL != work_context);
+    mender_err_t ret = MENDER_OK;
+
+    pthread_mutex_lock(&mender_scheduler_timer_mutex);
+
+    /* Compute deadline of the timer */
+    work_context->timer_deadline = mender_scheduler_get_uptime() + delay_ms;
+
+    /* Insert the work in the timer heap if the timer is not already running */
+    if (MENDER_SCHEDULER_TIMER_NOT_RUNNING == work_context->timer_index) {
+        if (mender_scheduler_timer_heap_length == mender_scheduler_timer_heap_size) {
+            size_t                            size = (0 != mender_scheduler_timer_heap_size) ? (2 * mender_scheduler_timer_heap_size) : 8;
+            mender_scheduler_work_context_t **heap = (mender_scheduler_work_context_t **)realloc(mender_scheduler_timer_heap, size * sizeof(mender_scheduler_work_context_t *));
+            if (NULL == heap) {
+                mender_log_error("Unable to allocate memory");
+                ret = MENDER_FAIL;
+                goto END;
+            }
+            mender_scheduler_timer_heap      = heap;
+            mender_scheduler_timer_heap_size = size;
+        }
+        work_context->timer_index                                       = mender_scheduler_timer_heap_length;
+        mender_scheduler_timer_heap[mender_scheduler_timer_heap_length] = work_context;
+        mender_scheduler_timer_heap_length++;
+    }
+    mender_scheduler_timer_heap_update(work_context->timer_index);
+
+    /* Wake up the timer thread if this is now the next timer to expire */
+    if (0 == work_context->timer_index) {
+        pthread_cond_signal(&mender_scheduler_timer_cond);
+    }
+
+END:
+
+    pthread_mutex_unlock(&mender_scheduler_timer_mutex);
+
+    return ret;
+}
+
 static void
-mender_scheduler_timer_callback(union sigval timer_data) {
+mender_scheduler_timer_stop(mender_scheduler_work_context_t *work_context) {
+
+    assert(NULL != work_context);
+
+    pthread_mutex_lock(&mender_scheduler_timer_mutex);
+
+    /* Remove the work from the timer heap if the timer is running, the timer thread computes its next wake up itself */
+    if (MENDER_SCHEDULER_TIMER_NOT_RUNNING != work_context->timer_index) {
+        mender_scheduler_timer_heap_remove(work_context->timer_index);
+    }
+
+    pthread_mutex_unlock(&mender_scheduler_timer_mutex);
+}
+
+static void
+mender_scheduler_timer_heap_update(size_t index) {
+
+    assert(index < mender_scheduler_timer_heap_length);
+    mender_scheduler_work_context_t *work_context = mender_scheduler_timer_heap[index];
+
+    /* Move the work up while its deadline is earlier than the deadline of its parent */
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (mender_scheduler_timer_heap[parent]->timer_deadline <= work_context->timer_deadline) {
+            break;
+        }
+        mender_scheduler_timer_heap[index]              = mender_scheduler_timer_heap[parent];
+        mender_scheduler_timer_heap[index]->timer_index = index;
+        index                                           = parent;
+    }
+
+    /* Move the work down while its deadline is later than the deadline of one of its children */
+    while (true) {
+        size_t child = 2 * index + 1;
+        if (child >= mender_scheduler_timer_heap_length) {
+            break;
+        }
+        if ((child + 1 < mender_scheduler_timer_heap_length)
+            && (mender_scheduler_timer_heap[child + 1]->timer_deadline < mender_scheduler_timer_heap[child]->timer_deadline)) {
+            child++;
+        }
+        if (work_context->timer_deadline <= mender_scheduler_timer_heap[child]->timer_deadline) {
+            break;
+        }
+        mender_scheduler_timer_heap[index]              = mender_scheduler_timer_heap[child];
+        mender_scheduler_timer_heap[index]->timer_index = index;
+        index                                           = child;
+    }
+
+    mender_scheduler_timer_heap[index] = work_context;
+    work_context->timer_index          = index;
+}
+
+static void
+mender_scheduler_timer_heap_remove(size_t index) {
+
+    assert(index < mender_scheduler_timer_heap_length);
+
+    /* Indicate the timer of the work is not running */
+    mender_scheduler_timer_heap[index]->timer_index = MENDER_SCHEDULER_TIMER_NOT_RUNNING;
+
+    /* Replace the work by the last one of the timer heap */
+    mender_scheduler_timer_heap_length--;
+    if (index < mender_scheduler_timer_heap_length) {
+        mender_scheduler_timer_heap[index]              = mender_scheduler_timer_heap[mender_scheduler_timer_heap_length];
+        mender_scheduler_timer_heap[index]->timer_index = index;
+        mender_scheduler_timer_heap_update(index);
+    }
+}
+
+static void *
+mender_scheduler_timer_thread(void *arg) {
+
+    (void)arg;
+
+    pthread_mutex_lock(&mender_scheduler_timer_mutex);
+
+    /* Handle timers until the timer thread is asked to terminate */
+    while (false == mender_scheduler_timer_exit) {
+
+        /* Wait for a timer to be started */
+        if (0 == mender_scheduler_timer_heap_length) {
+            pthread_cond_wait(&mender_scheduler_timer_cond, &mender_scheduler_timer_mutex);
+            continue;
+        }
+
+        /* Wait for the next timer to expire, or for the timer heap to be modified */
+        mender_scheduler_work_context_t *work_context = mender_scheduler_timer_heap[0];
+        int64_t                          now          = mender_scheduler_get_uptime();
+        if (work_context->timer_deadline > now) {
+            struct timespec deadline;
+            deadline.tv_sec  = work_context->timer_deadline / 1000;
+            deadline.tv_nsec = (work_context->timer_deadline % 1000) * 1000000;
+            pthread_cond_timedwait(&mender_scheduler_timer_cond, &mender_scheduler_timer_mutex, &deadline);
+            continue;
+        }
+
+        /* Expire the timers which are due and the ones whose slack window is open, so that the works share the same wake-up */
+        for (size_t index = 0; index < mender_scheduler_timer_heap_length;) {
+            work_context = mender_scheduler_timer_heap[index];
+            if (work_context->timer_deadline - (int64_t)work_context->params.period * 10 * work_context->params.slack <= now) {
+                mender_scheduler_timer_expire(index, now);
+                index = 0;
+            } else {
+                index++;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&mender_scheduler_timer_mutex);
+
+    return NULL;
+}
+
+static void
+mender_scheduler_timer_expire(size_t index, int64_t now) {
+
+    assert(index < mender_scheduler_timer_heap_length);
+    mender_scheduler_work_context_t *work_context = mender_scheduler_timer_heap[index];
+
+    /* Compute the next deadline of the timer */
+    if (work_context->timer_deadline <= now) {
+        /* Timer is due, expirations missed while the system was busy are skipped */
+        work_context->timer_deadline += (int64_t)work_context->params.period * 1000;
+        if (work_context->timer_deadline <= now) {
+            work_context->timer_deadline = now + (int64_t)work_context->params.period * 1000;
+        }
+    } else {
+        /* Timer is advanced within its slack window, the next deadline is aligned on this wake-up */
+        work_context->timer_deadline = now + (int64_t)work_context->params.period * 1000;
+    }
+    mender_scheduler_timer_heap_update(index);
+
+    /* Submit the work to the work queue, this never blocks */
+    mender_scheduler_timer_callback(work_context);
+}
+
+static void
+mender_scheduler_timer_callback(mender_scheduler_work_context_t *work_context) {
 
-    /* Get work context */
-    mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)timer_data.sival_ptr;
     assert(NULL != work_context);
 
     /* Exit if the work is already pending or executing */
@@ -410,51 +1099,322 @@ mender_scheduler_timer_callback(union sigval timer_data) {
     memset(&timeout, 0, sizeof(struct timespec));
     if (0 != pthread_mutex_timedlock(&work_context->sem_handle, &timeout)) {
         mender_log_debug("Work '%s' is not activated, already pending or executing", work_context->params.name);
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+        if (true == work_context->activated) {
+            mender_scheduler_stats_trigger(work_context, true);
+        }
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
         return;
     }
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+    mender_scheduler_stats_trigger(work_context, false);
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
 
     /* Submit the work to the work queue */
-    if (0 != mq_send(mender_scheduler_work_queue_handle, (const char *)&work_context, sizeof(mender_scheduler_work_context_t *), 0)) {
+    if (MENDER_OK != mender_scheduler_work_queue_push(work_context)) {
         mender_log_warning("Unable to submit work '%s' to the work queue", work_context->params.name);
         pthread_mutex_unlock(&work_context->sem_handle);
     }
 }
 
-__attribute__((noreturn)) static void *
+static mender_err_t
+mender_scheduler_work_queue_push(mender_scheduler_work_context_t *work_context) {
+
+    /* Empty works are submitted to the work queue of lowest priority so that pending works are executed first */
+    mender_scheduler_work_queue_t *work_queue
+        = &mender_scheduler_work_queues[(NULL != work_context) ? work_context->params.priority : MENDER_SCHEDULER_WORK_PRIORITY_LOW];
+    mender_scheduler_work_queue_cell_t *cell;
+    size_t                              pos = atomic_load_explicit(&work_queue->enqueue_pos, memory_order_relaxed);
+    size_t                              sequence;
+
+    /* Reserve a cell, the sequence number of the cell is equal to the position when it is free */
+    while (true) {
+        cell     = &work_queue->cells[pos % CONFIG_MENDER_SCHEDULER_WORK_QUEUE_LENGTH];
+        sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        if (sequence == pos) {
+            if (atomic_compare_exchange_weak_explicit(&work_queue->enqueue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if ((intptr_t)sequence - (intptr_t)pos < 0) {
+            /* Work queue is full */
+            return MENDER_FAIL;
+        } else {
+            pos = atomic_load_explicit(&work_queue->enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    /* Write the cell and publish it to the consumers */
+    cell->work_context = work_context;
+    atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+
+    /* Wake up a work queue thread */
+    sem_post(&mender_scheduler_work_queue_sem);
+
+    return MENDER_OK;
+}
+
+static mender_err_t
+mender_scheduler_work_queue_pop(mender_scheduler_work_priority_t priority, mender_scheduler_work_context_t **work_context) {
+
+    assert(NULL != work_context);
+
+    /* Try the work queues from the highest priority to the requested one */
+    for (size_t index = MENDER_SCHEDULER_WORK_PRIORITY_COUNT; index-- > (size_t)priority;) {
+        mender_scheduler_work_queue_t      *work_queue = &mender_scheduler_work_queues[index];
+        mender_scheduler_work_queue_cell_t *cell;
+        size_t                              pos = atomic_load_explicit(&work_queue->dequeue_pos, memory_order_relaxed);
+        size_t                              sequence;
+
+        /* Reserve a cell, the sequence number of the cell is equal to the position plus one when it has been written */
+        while (true) {
+            cell     = &work_queue->cells[pos % CONFIG_MENDER_SCHEDULER_WORK_QUEUE_LENGTH];
+            sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+            if (sequence == pos + 1) {
+                if (atomic_compare_exchange_weak_explicit(&work_queue->dequeue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+                    break;
+                }
+            } else if ((intptr_t)sequence - (intptr_t)(pos + 1) < 0) {
+                /* Work queue is empty */
+                cell = NULL;
+                break;
+            } else {
+                pos = atomic_load_explicit(&work_queue->dequeue_pos, memory_order_relaxed);
+            }
+        }
+
+        /* Read the cell and release it to the producers */
+        if (NULL != cell) {
+            *work_context = cell->work_context;
+            atomic_store_explicit(&cell->sequence, pos + CONFIG_MENDER_SCHEDULER_WORK_QUEUE_LENGTH, memory_order_release);
+            return MENDER_OK;
+        }
+    }
+
+    return MENDER_FAIL;
+}
+
+static bool
+mender_scheduler_work_queue_is_pending(void) {
+
+    /* Compare the positions of the producers and of the consumers of each work queue */
+    for (size_t index = 0; index < MENDER_SCHEDULER_WORK_PRIORITY_COUNT; index++) {
+        mender_scheduler_work_queue_t *work_queue = &mender_scheduler_work_queues[index];
+        if (atomic_load_explicit(&work_queue->enqueue_pos, memory_order_relaxed) != atomic_load_explicit(&work_queue->dequeue_pos, memory_order_relaxed)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void
+mender_scheduler_work_run(mender_scheduler_work_context_t *work_context) {
+
+    assert(NULL != work_context);
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+    int64_t start = mender_scheduler_stats_get_time();
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
+
+    /* Call work function */
+    mender_scheduler_work_current = work_context;
+    if (MENDER_DONE == work_context->params.function()) {
+
+        /* Work is done, stop timer used to execute the work periodically */
+        mender_scheduler_timer_stop(work_context);
+    }
+    mender_scheduler_work_current = NULL;
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+    /* Record the execution, before the work can be triggered again */
+    mender_scheduler_stats_execute(work_context, start, mender_scheduler_stats_get_time());
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
+
+    /* Release semaphore used to protect the work function */
+    pthread_mutex_unlock(&work_context->sem_handle);
+}
+
+static void *
 mender_scheduler_work_queue_thread(void *arg) {
 
-    (void)arg;
     mender_scheduler_work_context_t *work_context = NULL;
+    mender_err_t                     ret;
+
+#ifdef CONFIG_MENDER_SCHEDULER_TRACE_FILE
+    /* Identify the work queue thread in the trace */
+    mender_scheduler_trace_tid = (size_t)arg;
+#else
+    (void)arg;
+#endif /* CONFIG_MENDER_SCHEDULER_TRACE_FILE */
 
     /* Handle work to be executed */
-    while (mq_receive(mender_scheduler_work_queue_handle, (char *)&work_context, sizeof(mender_scheduler_work_context_t *), NULL) > 0) {
+    while (true) {
+
+        /* Wait for work to be submitted to the work queue */
+        if (0 != sem_wait(&mender_scheduler_work_queue_sem)) {
+            if (EINTR != errno) {
+                mender_log_error("Unable to wait for work (errno=%d)", errno);
+                break;
+            }
+            continue;
+        }
+
+        /* Retrieve the work, the semaphore guarantees a work is available but its cell may still be written by a producer which has been
+         * overtaken by the one giving the semaphore, so the work queues are retried until the cell is published */
+        while (MENDER_OK != (ret = mender_scheduler_work_queue_pop(MENDER_SCHEDULER_WORK_PRIORITY_LOW, &work_context))) {
+            if (false == mender_scheduler_work_queue_is_pending()) {
+                mender_log_error("Work queue semaphore does not match the content of the work queues");
+                break;
+            }
+            sched_yield();
+        }
+        if (MENDER_OK != ret) {
+            continue;
+        }
 
         /* Check if empty work is received from the work queue, this ask the work queue thread to terminate */
         if (NULL == work_context) {
-            goto END;
+            break;
         }
 
-        /* Call work function */
-        if (MENDER_DONE == work_context->params.function()) {
+        /* Execute work function */
+        mender_scheduler_work_run(work_context);
+    }
 
-            /* Work is done, stop timer used to execute the work periodically */
-            struct itimerspec its;
-            memset(&its, 0, sizeof(struct itimerspec));
-            if (0 != timer_settime(work_context->timer_handle, 0, &its, NULL)) {
-                mender_log_error("Unable to stop timer");
-            }
-        }
+    return NULL;
+}
 
-        /* Release semaphore used to protect the work function */
-        pthread_mutex_unlock(&work_context->sem_handle);
+static void *
+mender_scheduler_thread(void *arg) {
+
+    assert(NULL != arg);
+
+    /* Get thread context */
+    mender_scheduler_thread_context_t *thread_context = (mender_scheduler_thread_context_t *)arg;
+
+    /* Execute the thread function */
+    thread_context->function(thread_context->arg);
+
+    return NULL;
+}
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+
+static int64_t
+mender_scheduler_stats_get_time(void) {
+
+    struct timespec now;
+
+    /* Read monotonic clock */
+    if (0 != clock_gettime(CLOCK_MONOTONIC, &now)) {
+        return 0;
     }
 
-END:
+    return ((int64_t)now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+}
 
-    /* Release memory */
-    mq_close(mender_scheduler_work_queue_handle);
-    mq_unlink(MENDER_SCHEDULER_WORK_QUEUE_NAME);
+static void
+mender_scheduler_stats_trigger(mender_scheduler_work_context_t *work_context, bool dropped) {
+
+    assert(NULL != work_context);
+    int64_t now = mender_scheduler_stats_get_time();
+
+    pthread_mutex_lock(&mender_scheduler_stats_mutex);
+
+    /* Count the trigger, the time is saved to compute the latency of the execution */
+    work_context->stats.triggers++;
+    if (true == dropped) {
+        work_context->stats.dropped++;
+    } else {
+        work_context->trigger_time = now;
+    }
+
+#ifdef CONFIG_MENDER_SCHEDULER_TRACE_FILE
+    /* Dropped triggers are traced as instant events */
+    if (true == dropped) {
+        mender_scheduler_trace_event("{\"name\":\"%s\",\"cat\":\"dropped\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%" PRId64 ",\"pid\":1,\"tid\":%zu}",
+                                     work_context->params.name,
+                                     now,
+                                     mender_scheduler_trace_tid);
+    }
+#endif /* CONFIG_MENDER_SCHEDULER_TRACE_FILE */
+
+    pthread_mutex_unlock(&mender_scheduler_stats_mutex);
+}
+
+static void
+mender_scheduler_stats_execute(mender_scheduler_work_context_t *work_context, int64_t start, int64_t end) {
+
+    assert(NULL != work_context);
+    uint32_t latency  = (uint32_t)((start - work_context->trigger_time) / 1000);
+    uint32_t duration = (uint32_t)((end - start) / 1000);
+
+    pthread_mutex_lock(&mender_scheduler_stats_mutex);
+
+    /* Count the execution and update the histograms */
+    work_context->stats.executions++;
+    if (latency > work_context->stats.latency_max) {
+        work_context->stats.latency_max = latency;
+    }
+    if (duration > work_context->stats.duration_max) {
+        work_context->stats.duration_max = duration;
+    }
+    work_context->stats.duration_total += duration;
+    work_context->stats.latency_histogram[mender_scheduler_stats_histogram_index(latency)]++;
+    work_context->stats.duration_histogram[mender_scheduler_stats_histogram_index(duration)]++;
+
+#ifdef CONFIG_MENDER_SCHEDULER_TRACE_FILE
+    /* Executions are traced as complete events */
+    mender_scheduler_trace_event("{\"name\":\"%s\",\"cat\":\"work\",\"ph\":\"X\",\"ts\":%" PRId64 ",\"dur\":%" PRId64
+                                 ",\"pid\":1,\"tid\":%zu,\"args\":{\"latency_us\":%" PRId64 "}}",
+                                 work_context->params.name,
+                                 start,
+                                 end - start,
+                                 mender_scheduler_trace_tid,
+                                 start - work_context->trigger_time);
+#endif /* CONFIG_MENDER_SCHEDULER_TRACE_FILE */
+
+    pthread_mutex_unlock(&mender_scheduler_stats_mutex);
+}
+
+static size_t
+mender_scheduler_stats_histogram_index(uint32_t value) {
+
+    size_t index = 0;
+
+    /* Bucket i counts the values in [2^(i-1), 2^i[, this is the number of significant bits of the value */
+    while ((0 != value) && (index < MENDER_SCHEDULER_WORK_HISTOGRAM_SIZE - 1)) {
+        value >>= 1;
+        index++;
+    }
 
-    /* Terminate work queue thread */
-    pthread_exit(NULL);
+    return index;
 }
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
+
+#ifdef CONFIG_MENDER_SCHEDULER_TRACE_FILE
+
+static void
+mender_scheduler_trace_event(const char *format, ...) {
+
+    assert(NULL != format);
+    va_list args;
+
+    /* Nothing to do if the trace file is not opened */
+    if (NULL == mender_scheduler_trace_file) {
+        return;
+    }
+
+    /* Write the event, separated from the previous one */
+    if (mender_scheduler_trace_events > 0) {
+        fputc(',', mender_scheduler_trace_file);
+    }
+    fputc('\n', mender_scheduler_trace_file);
+    va_start(args, format);
+    vfprintf(mender_scheduler_trace_file, format, args);
+    va_end(args);
+    mender_scheduler_trace_events++;
+}
+
+#endif /* CONFIG_MENDER_SCHEDULER_TRACE_FILE */
@@ -35,6 +35,20 @@
 #define CONFIG_MENDER_SCHEDULER_WORK_QUEUE_PRIORITY (5)
 #endif /* CONFIG_MENDER_SCHEDULER_WORK_QUEUE_PRIORITY */
 
+/**
+ * @brief Default thread stack size (kB)
+ */
+#ifndef CONFIG_MENDER_SCHEDULER_THREAD_STACK_SIZE
+#define CONFIG_MENDER_SCHEDULER_THREAD_STACK_SIZE (12)
+#endif /* CONFIG_MENDER_SCHEDULER_THREAD_STACK_SIZE */
+
+/**
+ * @brief Default thread priority, lower than the work queue priority
+ */
+#ifndef CONFIG_MENDER_SCHEDULER_THREAD_PRIORITY
+#define CONFIG_MENDER_SCHEDULER_THREAD_PRIORITY (K_LOWEST_APPLICATION_THREAD_PRIO)
+#endif /* CONFIG_MENDER_SCHEDULER_THREAD_PRIORITY */
+
 /**
  * @brief Work context
  */
@@ -42,8 +56,14 @@ typedef struct {
     mender_scheduler_work_params_t params;       /**< Work parameters */
     struct k_sem                   sem_handle;   /**< Semaphore used to indicate work is pending or executing */
     struct k_timer                 timer_handle; /**< Timer used to periodically execute work */
-    struct k_work                  work_handle;  /**< Work handle used to execute the work function */
+    sys_snode_t                    work_node;    /**< Node used to insert the work in the list of works */
+    sys_snode_t                    pending_node; /**< Node used to insert the work in the list of pending works of its priority */
     bool                           activated;    /**< Flag indicating the work is activated */
+    atomic_t                       cancelled;    /**< Flag indicating the deactivation of the work is pending */
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+    int64_t                        trigger_time; /**< Time of the last trigger submitting the work to the work queue (us) */
+    mender_scheduler_work_stats_t  stats;        /**< Work statistics */
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
 } mender_scheduler_work_context_t;
 
 /**
@@ -52,25 +72,142 @@ typedef struct {
 K_THREAD_STACK_DEFINE(mender_scheduler_work_queue_stack, CONFIG_MENDER_SCHEDULER_WORK_QUEUE_STACK_SIZE * 1024);
 
 /**
- * @brief Function used to handle work context timer when it expires
+ * @brief Mender scheduler thread stack, handle and flag indicating it is used, a single thread can exist at a time
+ */
+K_THREAD_STACK_DEFINE(mender_scheduler_thread_stack, CONFIG_MENDER_SCHEDULER_THREAD_STACK_SIZE * 1024);
+static struct k_thread mender_scheduler_thread_handle;
+static atomic_t        mender_scheduler_thread_used = ATOMIC_INIT(0);
+
+/**
+ * @brief Convert a work period to a timer period, the computation is done in 64 bits and the result is clamped to the maximum timeout
+ * @param period Work period (seconds), it must be positive
+ * @return Timer period
+ */
+static k_timeout_t mender_scheduler_period_to_timeout(int32_t period);
+
+/**
+ * @brief Function used to handle work context timer when it expires, the works whose slack window is open share the wake-up
  * @param handle Timer handler
  */
 static void mender_scheduler_timer_callback(struct k_timer *handle);
 
 /**
- * @brief Function used to handle work
+ * @brief Submit work to the work queue, unless it is not activated, already pending or executing
+ * @param work_context Work context
+ */
+static void mender_scheduler_work_submit(mender_scheduler_work_context_t *work_context);
+
+/**
+ * @brief Retrieve pending work of highest priority
+ * @param priority Minimum priority of the work to retrieve
+ * @param nestable Only retrieve the work if it is nestable, it is left pending otherwise
+ * @return Work context if a work is pending and retrieved, NULL otherwise
+ */
+static mender_scheduler_work_context_t *mender_scheduler_work_get(mender_scheduler_work_priority_t priority, bool nestable);
+
+/**
+ * @brief Execute work function
+ * @param work_context Work context
+ */
+static void mender_scheduler_work_run(mender_scheduler_work_context_t *work_context);
+
+/**
+ * @brief Function used to execute the pending works by priority order
  * @param handle Work handler
  */
 static void mender_scheduler_work_handler(struct k_work *handle);
 
+/**
+ * @brief Thread created by mender_scheduler_thread_create, it executes the thread function
+ * @param p1 Thread function
+ * @param p2 Argument of the thread function
+ * @param p3 Not used
+ */
+static void mender_scheduler_thread(void *p1, void *p2, void *p3);
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+
+/**
+ * @brief Read the system uptime with the resolution needed by the statistics
+ * @return Current time (us)
+ */
+static int64_t mender_scheduler_stats_get_time(void);
+
+/**
+ * @brief Record a trigger of the work
+ * @param work_context Work context
+ * @param dropped Flag indicating the trigger has been dropped because the work is already pending or executing
+ */
+static void mender_scheduler_stats_trigger(mender_scheduler_work_context_t *work_context, bool dropped);
+
+/**
+ * @brief Record an execution of the work
+ * @param work_context Work context
+ * @param start Start time of the execution (us)
+ * @param end End time of the execution (us)
+ */
+static void mender_scheduler_stats_execute(mender_scheduler_work_context_t *work_context, int64_t start, int64_t end);
+
+/**
+ * @brief Compute the bucket of the histograms of the works corresponding to the value
+ * @param value Value (ms)
+ * @return Index of the bucket
+ */
+static size_t mender_scheduler_stats_histogram_index(uint32_t value);
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
+
 /**
  * @brief Mender scheduler work queue handle
  */
 static struct k_work_q mender_scheduler_work_queue_handle;
 
+/**
+ * @brief Work submitted to the work queue to execute the pending works
+ */
+static struct k_work mender_scheduler_work_handle;
+
+/**
+ * @brief List of works, and spinlock used to protect it
+ */
+static sys_slist_t       mender_scheduler_works;
+static struct k_spinlock mender_scheduler_works_lock;
+
+/**
+ * @brief Lists of pending works, one per priority, and spinlock used to protect them
+ */
+static sys_slist_t       mender_scheduler_work_pending[MENDER_SCHEDULER_WORK_PRIORITY_COUNT];
+static struct k_spinlock mender_scheduler_work_pending_lock;
+
+/**
+ * @brief Work currently executed by the work queue thread, NULL if no work is executing
+ */
+static mender_scheduler_work_context_t *mender_scheduler_work_current = NULL;
+
+/**
+ * @brief Flag indicating the work queue thread is executing works of higher priority from mender_scheduler_work_yield
+ */
+static bool mender_scheduler_work_yielding = false;
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+
+/**
+ * @brief Spinlock used to protect the statistics of the works, they are updated from the timer callbacks
+ */
+static struct k_spinlock mender_scheduler_stats_lock;
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
+
 mender_err_t
 mender_scheduler_init(void) {
 
+    /* Initialize lists of works and pending works */
+    sys_slist_init(&mender_scheduler_works);
+    for (size_t priority = 0; priority < MENDER_SCHEDULER_WORK_PRIORITY_COUNT; priority++) {
+        sys_slist_init(&mender_scheduler_work_pending[priority]);
+    }
+    k_work_init(&mender_scheduler_work_handle, mender_scheduler_work_handler);
+
     /* Create and start work queue */
     k_work_queue_init(&mender_scheduler_work_queue_handle);
     k_work_queue_start(&mender_scheduler_work_queue_handle,
@@ -89,6 +226,8 @@ mender_scheduler_work_create(mender_scheduler_work_params_t *work_params, void *
     assert(NULL != work_params);
     assert(NULL != work_params->function);
     assert(NULL != work_params->name);
+    assert(work_params->slack < 100);
+    assert(work_params->priority < MENDER_SCHEDULER_WORK_PRIORITY_COUNT);
     assert(NULL != handle);
 
     /* Create work context */
@@ -102,6 +241,9 @@ mender_scheduler_work_create(mender_scheduler_work_params_t *work_params, void *
     /* Copy work parameters */
     work_context->params.function = work_params->function;
     work_context->params.period   = work_params->period;
+    work_context->params.slack    = work_params->slack;
+    work_context->params.priority = work_params->priority;
+    work_context->params.nestable = work_params->nestable;
     if (NULL == (work_context->params.name = strdup(work_params->name))) {
         mender_log_error("Unable to allocate memory");
         goto FAIL;
@@ -117,8 +259,10 @@ mender_scheduler_work_create(mender_scheduler_work_params_t *work_params, void *
     k_timer_init(&work_context->timer_handle, mender_scheduler_timer_callback, NULL);
     k_timer_user_data_set(&work_context->timer_handle, (void *)work_context);
 
-    /* Create work used to execute work function */
-    k_work_init(&work_context->work_handle, mender_scheduler_work_handler);
+    /* Append the work to the list of works */
+    k_spinlock_key_t key = k_spin_lock(&mender_scheduler_works_lock);
+    sys_slist_append(&mender_scheduler_works, &work_context->work_node);
+    k_spin_unlock(&mender_scheduler_works_lock, key);
 
     /* Return handle to the new work context */
     *handle = (void *)work_context;
@@ -153,7 +297,7 @@ mender_scheduler_work_activate(void *handle) {
     if (work_context->params.period > 0) {
 
         /* Start the timer to handle the work */
-        k_timer_start(&work_context->timer_handle, K_NO_WAIT, K_MSEC(1000 * work_context->params.period));
+        k_timer_start(&work_context->timer_handle, K_NO_WAIT, mender_scheduler_period_to_timeout(work_context->params.period));
     }
 
     /* Indicate the work has been activated */
@@ -171,7 +315,7 @@ mender_scheduler_work_execute(void *handle) {
     mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)handle;
 
     /* Execute the work now */
-    mender_scheduler_timer_callback(&work_context->timer_handle);
+    mender_scheduler_work_submit(work_context);
 
     return MENDER_OK;
 }
@@ -184,10 +328,12 @@ mender_scheduler_work_set_period(void *handle, uint32_t period) {
     /* Get work context */
     mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)handle;
 
-    /* Set timer period */
-    work_context->params.period = period;
+    /* Set timer period, it is clamped to the maximum period of the work parameters */
+    work_context->params.period = (period > INT32_MAX) ? INT32_MAX : (int32_t)period;
     if (work_context->params.period > 0) {
-        k_timer_start(&work_context->timer_handle, K_FOREVER, K_MSEC(1000 * work_context->params.period));
+        k_timer_start(&work_context->timer_handle,
+                      mender_scheduler_period_to_timeout(work_context->params.period),
+                      mender_scheduler_period_to_timeout(work_context->params.period));
     } else {
         k_timer_stop(&work_context->timer_handle);
     }
@@ -195,6 +341,64 @@ mender_scheduler_work_set_period(void *handle, uint32_t period) {
     return MENDER_OK;
 }
 
+mender_err_t
+mender_scheduler_work_yield(void) {
+
+    mender_scheduler_work_context_t *work_context;
+
+    /* Nothing to do if the function is not called from a work, or from a work already executed by this function (nesting is limited to one level) */
+    if ((k_current_get() != k_work_queue_thread_get(&mender_scheduler_work_queue_handle)) || (NULL == mender_scheduler_work_current)
+        || (true == mender_scheduler_work_yielding)) {
+        return MENDER_OK;
+    }
+
+    /* Execute the pending nestable works of higher priority */
+    mender_scheduler_work_context_t *current = mender_scheduler_work_current;
+    mender_scheduler_work_yielding           = true;
+    while ((current->params.priority + 1 < MENDER_SCHEDULER_WORK_PRIORITY_COUNT)
+           && (NULL != (work_context = mender_scheduler_work_get(current->params.priority + 1, true)))) {
+        mender_scheduler_work_run(work_context);
+    }
+    mender_scheduler_work_yielding = false;
+    mender_scheduler_work_current  = current;
+
+    return MENDER_OK;
+}
+
+bool
+mender_scheduler_work_is_cancelled(void) {
+
+    /* Check if the deactivation of the calling work is pending */
+    if ((k_current_get() != k_work_queue_thread_get(&mender_scheduler_work_queue_handle)) || (NULL == mender_scheduler_work_current)) {
+        return false;
+    }
+
+    return (0 != atomic_get(&mender_scheduler_work_current->cancelled));
+}
+
+void *
+mender_scheduler_work_get_current(void) {
+
+    /* Return the work executed by the work queue thread if it is the calling thread */
+    if (k_current_get() != k_work_queue_thread_get(&mender_scheduler_work_queue_handle)) {
+        return NULL;
+    }
+
+    return mender_scheduler_work_current;
+}
+
+bool
+mender_scheduler_work_is_deactivating(void *handle) {
+
+    assert(NULL != handle);
+
+    /* Get work context */
+    mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)handle;
+
+    /* Check if the deactivation of the work is pending */
+    return (0 != atomic_get(&work_context->cancelled));
+}
+
 mender_err_t
 mender_scheduler_work_deactivate(void *handle) {
 
@@ -209,11 +413,14 @@ mender_scheduler_work_deactivate(void *handle) {
         /* Stop the timer used to periodically execute the work (if it is running) */
         k_timer_stop(&work_context->timer_handle);
 
-        /* Wait if the work is pending or executing */
+        /* Cancel the work and wait if it is pending or executing */
+        atomic_set(&work_context->cancelled, 1);
         if (0 != k_sem_take(&work_context->sem_handle, K_FOREVER)) {
             mender_log_error("Work '%s' is pending or executing", work_context->params.name);
+            atomic_set(&work_context->cancelled, 0);
             return MENDER_FAIL;
         }
+        atomic_set(&work_context->cancelled, 0);
 
         /* Indicate the work has been deactivated */
         work_context->activated = false;
@@ -230,6 +437,16 @@ mender_scheduler_work_delete(void *handle) {
     /* Get work context */
     mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)handle;
 
+    /* Remove the work from the list of works */
+    k_spinlock_key_t key = k_spin_lock(&mender_scheduler_works_lock);
+    sys_slist_find_and_remove(&mender_scheduler_works, &work_context->work_node);
+    k_spin_unlock(&mender_scheduler_works_lock, key);
+
+    /* Remove the work from the list of pending works, it may still be there if it has been triggered after its deactivation */
+    key = k_spin_lock(&mender_scheduler_work_pending_lock);
+    sys_slist_find_and_remove(&mender_scheduler_work_pending[work_context->params.priority], &work_context->pending_node);
+    k_spin_unlock(&mender_scheduler_work_pending_lock, key);
+
     /* Release memory */
     if (NULL != work_context->params.name) {
         free(work_context->params.name);
@@ -239,6 +456,89 @@ mender_scheduler_work_delete(void *handle) {
     return MENDER_OK;
 }
 
+mender_err_t
+mender_scheduler_work_get_stats(void *handle, mender_scheduler_work_stats_t *stats, bool reset) {
+
+    assert(NULL != handle);
+    assert(NULL != stats);
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+
+    /* Get work context */
+    mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)handle;
+
+    /* Copy the statistics of the work, and reset them if requested */
+    k_spinlock_key_t key = k_spin_lock(&mender_scheduler_stats_lock);
+    memcpy(stats, &work_context->stats, sizeof(mender_scheduler_work_stats_t));
+    if (true == reset) {
+        memset(&work_context->stats, 0, sizeof(mender_scheduler_work_stats_t));
+    }
+    k_spin_unlock(&mender_scheduler_stats_lock, key);
+
+    return MENDER_OK;
+
+#else
+
+    (void)handle;
+    (void)stats;
+    (void)reset;
+
+    /* Statistics are not collected */
+    return MENDER_NOT_IMPLEMENTED;
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
+}
+
+mender_err_t
+mender_scheduler_thread_create(void (*function)(void *), void *arg, char *name, void **handle) {
+
+    assert(NULL != function);
+    assert(NULL != name);
+    assert(NULL != handle);
+
+    /* Check if the thread is available */
+    if (false == atomic_cas(&mender_scheduler_thread_used, 0, 1)) {
+        mender_log_error("Unable to create thread '%s', a single thread is available", name);
+        *handle = NULL;
+        return MENDER_FAIL;
+    }
+
+    /* Start the thread */
+    k_thread_create(&mender_scheduler_thread_handle,
+                    mender_scheduler_thread_stack,
+                    K_THREAD_STACK_SIZEOF(mender_scheduler_thread_stack),
+                    mender_scheduler_thread,
+                    (void *)function,
+                    arg,
+                    NULL,
+                    CONFIG_MENDER_SCHEDULER_THREAD_PRIORITY,
+                    0,
+                    K_NO_WAIT);
+    k_thread_name_set(&mender_scheduler_thread_handle, name);
+
+    /* Return handle to the thread */
+    *handle = (void *)&mender_scheduler_thread_handle;
+
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_scheduler_thread_join(void *handle) {
+
+    assert(NULL != handle);
+
+    /* Wait for the end of the thread */
+    if (0 != k_thread_join((struct k_thread *)handle, K_FOREVER)) {
+        mender_log_error("Unable to join thread");
+        return MENDER_FAIL;
+    }
+
+    /* The thread can be created again */
+    atomic_clear(&mender_scheduler_thread_used);
+
+    return MENDER_OK;
+}
+
 mender_err_t
 mender_scheduler_mutex_create(void **handle) {
 
@@ -294,6 +594,22 @@ mender_scheduler_mutex_delete(void *handle) {
     return MENDER_OK;
 }
 
+mender_err_t
+mender_scheduler_delay(uint32_t delay_ms) {
+
+    /* Suspend the calling thread */
+    k_msleep(delay_ms);
+
+    return MENDER_OK;
+}
+
+int64_t
+mender_scheduler_get_uptime(void) {
+
+    /* Read system uptime */
+    return k_uptime_get();
+}
+
 mender_err_t
 mender_scheduler_exit(void) {
 
@@ -301,6 +617,20 @@ mender_scheduler_exit(void) {
     return MENDER_OK;
 }
 
+static k_timeout_t
+mender_scheduler_period_to_timeout(int32_t period) {
+
+    /* Compute the timer period, the maximum value of the ticks is reserved to K_FOREVER and 32-bit timeouts are limited to INT32_MAX ticks */
+    uint64_t ticks = k_ms_to_ticks_ceil64((uint64_t)period * MSEC_PER_SEC);
+#ifdef CONFIG_TIMEOUT_64BIT
+    uint64_t max = INT64_MAX - 1;
+#else
+    uint64_t max = INT32_MAX;
+#endif /* CONFIG_TIMEOUT_64BIT */
+
+    return K_TICKS((k_ticks_t)((ticks < max) ? ticks : max));
+}
+
 static void
 mender_scheduler_timer_callback(struct k_timer *handle) {
 
@@ -310,35 +640,199 @@ mender_scheduler_timer_callback(struct k_timer *handle) {
     mender_scheduler_work_context_t *work_context = (mender_scheduler_work_context_t *)k_timer_user_data_get(handle);
     assert(NULL != work_context);
 
+    /* Submit the work to the work queue */
+    mender_scheduler_work_submit(work_context);
+
+    /* Submit the works whose slack window is open so that they share the wake-up, their timers are aligned on this wake-up */
+    mender_scheduler_work_context_t *other;
+    k_spinlock_key_t                 key = k_spin_lock(&mender_scheduler_works_lock);
+    SYS_SLIST_FOR_EACH_CONTAINER(&mender_scheduler_works, other, work_node) {
+        if ((other != work_context) && (true == other->activated) && (other->params.period > 0) && (other->params.slack > 0)) {
+            uint32_t remaining = k_timer_remaining_get(&other->timer_handle);
+            if ((0 != remaining) && (remaining <= (uint64_t)other->params.period * 10 * other->params.slack)) {
+                k_timer_start(
+                    &other->timer_handle, mender_scheduler_period_to_timeout(other->params.period), mender_scheduler_period_to_timeout(other->params.period));
+                mender_scheduler_work_submit(other);
+            }
+        }
+    }
+    k_spin_unlock(&mender_scheduler_works_lock, key);
+}
+
+static void
+mender_scheduler_work_submit(mender_scheduler_work_context_t *work_context) {
+
+    assert(NULL != work_context);
+
     /* Exit if the work is already pending or executing */
     if (0 != k_sem_take(&work_context->sem_handle, K_NO_WAIT)) {
         mender_log_debug("Work '%s' is not activated, already pending or executing", work_context->params.name);
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+        if (true == work_context->activated) {
+            mender_scheduler_stats_trigger(work_context, true);
+        }
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
         return;
     }
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+    mender_scheduler_stats_trigger(work_context, false);
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
 
-    /* Submit the work to the work queue */
-    if (k_work_submit_to_queue(&mender_scheduler_work_queue_handle, &work_context->work_handle) < 0) {
+    /* Append the work to the list of pending works of its priority */
+    k_spinlock_key_t key = k_spin_lock(&mender_scheduler_work_pending_lock);
+    sys_slist_append(&mender_scheduler_work_pending[work_context->params.priority], &work_context->pending_node);
+    k_spin_unlock(&mender_scheduler_work_pending_lock, key);
+
+    /* Submit the work to the work queue, this has no effect if it is already queued */
+    if (k_work_submit_to_queue(&mender_scheduler_work_queue_handle, &mender_scheduler_work_handle) < 0) {
         mender_log_warning("Unable to submit work '%s' to the work queue", work_context->params.name);
-        k_sem_give(&work_context->sem_handle);
+
+        /* Remove the work from the list of pending works so that it can be triggered again, unless it has been retrieved meanwhile */
+        key = k_spin_lock(&mender_scheduler_work_pending_lock);
+        bool removed = sys_slist_find_and_remove(&mender_scheduler_work_pending[work_context->params.priority], &work_context->pending_node);
+        k_spin_unlock(&mender_scheduler_work_pending_lock, key);
+        if (true == removed) {
+            k_sem_give(&work_context->sem_handle);
+        }
     }
 }
 
-static void
-mender_scheduler_work_handler(struct k_work *handle) {
+static mender_scheduler_work_context_t *
+mender_scheduler_work_get(mender_scheduler_work_priority_t priority, bool nestable) {
+
+    mender_scheduler_work_context_t *work_context = NULL;
+    sys_snode_t                     *node         = NULL;
+
+    /* Try the lists of pending works from the highest priority to the requested one */
+    k_spinlock_key_t key = k_spin_lock(&mender_scheduler_work_pending_lock);
+    for (size_t index = MENDER_SCHEDULER_WORK_PRIORITY_COUNT; (NULL == node) && (index-- > (size_t)priority);) {
+        node = sys_slist_peek_head(&mender_scheduler_work_pending[index]);
+        if (NULL != node) {
+            work_context = CONTAINER_OF(node, mender_scheduler_work_context_t, pending_node);
+            if ((true == nestable) && (false == work_context->params.nestable)) {
+                work_context = NULL;
+            } else {
+                sys_slist_get(&mender_scheduler_work_pending[index]);
+            }
+        }
+    }
+    k_spin_unlock(&mender_scheduler_work_pending_lock, key);
 
-    assert(NULL != handle);
+    return work_context;
+}
+
+static void
+mender_scheduler_work_run(mender_scheduler_work_context_t *work_context) {
 
-    /* Get work context */
-    mender_scheduler_work_context_t *work_context = CONTAINER_OF(handle, mender_scheduler_work_context_t, work_handle);
     assert(NULL != work_context);
 
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+    int64_t start = mender_scheduler_stats_get_time();
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
+
     /* Call work function */
+    mender_scheduler_work_current = work_context;
     if (MENDER_DONE == work_context->params.function()) {
 
         /* Work is done, stop timer used to execute the work periodically */
         k_timer_stop(&work_context->timer_handle);
     }
+    mender_scheduler_work_current = NULL;
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+    /* Record the execution, before the work can be triggered again */
+    mender_scheduler_stats_execute(work_context, start, mender_scheduler_stats_get_time());
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
 
     /* Release semaphore used to protect the work function */
     k_sem_give(&work_context->sem_handle);
 }
+
+static void
+mender_scheduler_work_handler(struct k_work *handle) {
+
+    (void)handle;
+    mender_scheduler_work_context_t *work_context;
+
+    /* Execute the pending works by priority order */
+    while (NULL != (work_context = mender_scheduler_work_get(MENDER_SCHEDULER_WORK_PRIORITY_LOW, false))) {
+        mender_scheduler_work_run(work_context);
+    }
+}
+
+static void
+mender_scheduler_thread(void *p1, void *p2, void *p3) {
+
+    (void)p3;
+
+    /* Execute the thread function */
+    ((void (*)(void *))p1)(p2);
+}
+
+#ifdef CONFIG_MENDER_SCHEDULER_STATISTICS
+
+static int64_t
+mender_scheduler_stats_get_time(void) {
+
+    /* Read system uptime, with the resolution of the system ticks */
+    return (int64_t)k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+static void
+mender_scheduler_stats_trigger(mender_scheduler_work_context_t *work_context, bool dropped) {
+
+    assert(NULL != work_context);
+    int64_t now = mender_scheduler_stats_get_time();
+
+    k_spinlock_key_t key = k_spin_lock(&mender_scheduler_stats_lock);
+
+    /* Count the trigger, the time is saved to compute the latency of the execution */
+    work_context->stats.triggers++;
+    if (true == dropped) {
+        work_context->stats.dropped++;
+    } else {
+        work_context->trigger_time = now;
+    }
+
+    k_spin_unlock(&mender_scheduler_stats_lock, key);
+}
+
+static void
+mender_scheduler_stats_execute(mender_scheduler_work_context_t *work_context, int64_t start, int64_t end) {
+
+    assert(NULL != work_context);
+    uint32_t latency  = (uint32_t)((start - work_context->trigger_time) / 1000);
+    uint32_t duration = (uint32_t)((end - start) / 1000);
+
+    k_spinlock_key_t key = k_spin_lock(&mender_scheduler_stats_lock);
+
+    /* Count the execution and update the histograms */
+    work_context->stats.executions++;
+    if (latency > work_context->stats.latency_max) {
+        work_context->stats.latency_max = latency;
+    }
+    if (duration > work_context->stats.duration_max) {
+        work_context->stats.duration_max = duration;
+    }
+    work_context->stats.duration_total += duration;
+    work_context->stats.latency_histogram[mender_scheduler_stats_histogram_index(latency)]++;
+    work_context->stats.duration_histogram[mender_scheduler_stats_histogram_index(duration)]++;
+
+    k_spin_unlock(&mender_scheduler_stats_lock, key);
+}
+
+static size_t
+mender_scheduler_stats_histogram_index(uint32_t value) {
+
+    size_t index = 0;
+
+    /* Bucket i counts the values in [2^(i-1), 2^i[, this is the number of significant bits of the value */
+    while ((0 != value) && (index < MENDER_SCHEDULER_WORK_HISTOGRAM_SIZE - 1)) {
+        value >>= 1;
+        index++;
+    }
+
+    return index;
+}
+
+#endif /* CONFIG_MENDER_SCHEDULER_STATISTICS */
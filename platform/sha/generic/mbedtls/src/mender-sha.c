@@ -0,0 +1,103 @@
+/**
+ * @file      mender-sha.c
+ * @brief     Mender SHA interface for mbedTLS platform
+ *
+ * Copyright joelguittet and mender-mcu-client contributors
+ * Copyright Northern.tech AS
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mbedtls/sha256.h>
+#include <mbedtls/version.h>
+#include "mender-log.h"
+#include "mender-sha.h"
+
+/**
+ * @brief mbedTLS 3.x removed the _ret suffix of the SHA-256 functions
+ * @note The SHA-256 peripheral is used transparently when mbedTLS is configured with an alternative implementation (ESP32 SHA accelerator, ...)
+ */
+#if MBEDTLS_VERSION_NUMBER >= 0x03000000
+#define mender_sha256_mbedtls_starts mbedtls_sha256_starts
+#define mender_sha256_mbedtls_update mbedtls_sha256_update
+#define mender_sha256_mbedtls_finish mbedtls_sha256_finish
+#else
+#define mender_sha256_mbedtls_starts mbedtls_sha256_starts_ret
+#define mender_sha256_mbedtls_update mbedtls_sha256_update_ret
+#define mender_sha256_mbedtls_finish mbedtls_sha256_finish_ret
+#endif /* MBEDTLS_VERSION_NUMBER >= 0x03000000 */
+
+mender_err_t
+mender_sha256_begin(void **handle) {
+
+    assert(NULL != handle);
+    mbedtls_sha256_context *ctx;
+    int                     ret;
+
+    /* Allocate and initialize SHA-256 context */
+    if (NULL == (ctx = (mbedtls_sha256_context *)malloc(sizeof(mbedtls_sha256_context)))) {
+        mender_log_error("Unable to allocate memory");
+        return MENDER_FAIL;
+    }
+    mbedtls_sha256_init(ctx);
+    if (0 != (ret = mender_sha256_mbedtls_starts(ctx, 0))) {
+        mender_log_error("Unable to begin SHA-256 computation (-0x%04x)", (unsigned int)-ret);
+        mbedtls_sha256_free(ctx);
+        free(ctx);
+        return MENDER_FAIL;
+    }
+    *handle = (void *)ctx;
+
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_sha256_update(void *handle, const void *data, size_t length) {
+
+    assert(NULL != handle);
+    int ret;
+
+    /* Hash data */
+    if (0 != (ret = mender_sha256_mbedtls_update((mbedtls_sha256_context *)handle, (const unsigned char *)data, length))) {
+        mender_log_error("Unable to update SHA-256 computation (-0x%04x)", (unsigned int)-ret);
+        return MENDER_FAIL;
+    }
+
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_sha256_end(void *handle, unsigned char *digest) {
+
+    mender_err_t ret = MENDER_OK;
+    int          err;
+
+    /* Check handle */
+    if (NULL == handle) {
+        return MENDER_OK;
+    }
+
+    /* Compute digest if requested */
+    if (NULL != digest) {
+        if (0 != (err = mender_sha256_mbedtls_finish((mbedtls_sha256_context *)handle, digest))) {
+            mender_log_error("Unable to end SHA-256 computation (-0x%04x)", (unsigned int)-err);
+            ret = MENDER_FAIL;
+        }
+    }
+
+    /* Release memory */
+    mbedtls_sha256_free((mbedtls_sha256_context *)handle);
+    free(handle);
+
+    return ret;
+}
@@ -0,0 +1,51 @@
+/**
+ * @file      mender-sha.c
+ * @brief     Mender SHA interface for weak platform
+ *
+ * Copyright joelguittet and mender-mcu-client contributors
+ * Copyright Northern.tech AS
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mender-sha.h"
+
+__attribute__((weak)) mender_err_t
+mender_sha256_begin(void **handle) {
+
+    (void)handle;
+
+    /* Nothing to do */
+    return MENDER_NOT_IMPLEMENTED;
+}
+
+__attribute__((weak)) mender_err_t
+mender_sha256_update(void *handle, const void *data, size_t length) {
+
+    (void)handle;
+    (void)data;
+    (void)length;
+
+    /* Nothing to do */
+    return MENDER_NOT_IMPLEMENTED;
+}
+
+__attribute__((weak)) mender_err_t
+mender_sha256_end(void *handle, unsigned char *digest) {
+
+    (void)handle;
+    (void)digest;
+
+    /* Nothing to do */
+    return MENDER_NOT_IMPLEMENTED;
+}
@@ -0,0 +1,374 @@
+/**
+ * @file      mender-sha.c
+ * @brief     Mender SHA interface for Posix platform
+ *
+ * Copyright joelguittet and mender-mcu-client contributors
+ * Copyright Northern.tech AS
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <pthread.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__linux__)
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#include "mender-log.h"
+#include "mender-sha.h"
+
+/**
+ * @brief SHA-256 block size (bytes)
+ */
+#define MENDER_SHA256_BLOCK_SIZE (64)
+
+/**
+ * @brief Target attribute of the ARMv8 Cryptographic Extension implementation
+ */
+#if defined(__aarch64__) && defined(__linux__)
+#ifdef __clang__
+#define MENDER_SHA256_ARMV8_CE_TARGET __attribute__((target("crypto")))
+#else
+#define MENDER_SHA256_ARMV8_CE_TARGET __attribute__((target("+crypto")))
+#endif /* __clang__ */
+#endif /* __aarch64__ && __linux__ */
+
+/**
+ * @brief SHA-256 context
+ */
+typedef struct {
+    uint32_t state[8];                        /**< Intermediate hash value */
+    uint64_t length;                          /**< Number of bytes hashed */
+    uint8_t  block[MENDER_SHA256_BLOCK_SIZE]; /**< Pending data, not a complete block yet */
+    size_t   block_length;                    /**< Length of the pending data */
+} mender_sha256_context_t;
+
+/**
+ * @brief SHA-256 implementation, processing complete blocks
+ */
+typedef struct {
+    const char *name;                                                           /**< Name of the implementation */
+    void (*compress)(uint32_t state[8], const uint8_t *data, size_t blocks); /**< Process blocks of data */
+} mender_sha256_implementation_t;
+
+/**
+ * @brief SHA-256 round constants
+ */
+static const uint32_t mender_sha256_k[64]
+    = { 0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be,
+        0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa,
+        0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85,
+        0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+        0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
+        0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2 };
+
+/**
+ * @brief SHA-256 initial hash value
+ */
+static const uint32_t mender_sha256_h0[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+/**
+ * @brief Process blocks of data, portable implementation
+ * @param state Intermediate hash value
+ * @param data Data to be processed
+ * @param blocks Number of blocks to be processed
+ */
+static void mender_sha256_compress_software(uint32_t state[8], const uint8_t *data, size_t blocks);
+
+#if defined(__x86_64__)
+/**
+ * @brief Process blocks of data using the Intel SHA extensions
+ * @param state Intermediate hash value
+ * @param data Data to be processed
+ * @param blocks Number of blocks to be processed
+ */
+__attribute__((target("sha,sse4.1"))) static void mender_sha256_compress_sha_ni(uint32_t state[8], const uint8_t *data, size_t blocks);
+#elif defined(__aarch64__) && defined(__linux__)
+/**
+ * @brief Process blocks of data using the ARMv8 Cryptographic Extension
+ * @param state Intermediate hash value
+ * @param data Data to be processed
+ * @param blocks Number of blocks to be processed
+ */
+MENDER_SHA256_ARMV8_CE_TARGET static void mender_sha256_compress_armv8_ce(uint32_t state[8], const uint8_t *data, size_t blocks);
+#endif
+
+/**
+ * @brief Select the fastest SHA-256 implementation supported by the CPU
+ */
+static void mender_sha256_select_implementation(void);
+
+/**
+ * @brief SHA-256 implementation, selected once at runtime
+ */
+static pthread_once_t                  mender_sha256_once           = PTHREAD_ONCE_INIT;
+static mender_sha256_implementation_t mender_sha256_implementation = { "software", &mender_sha256_compress_software };
+
+mender_err_t
+mender_sha256_begin(void **handle) {
+
+    assert(NULL != handle);
+    mender_sha256_context_t *ctx;
+
+    /* Select SHA-256 implementation */
+    pthread_once(&mender_sha256_once, &mender_sha256_select_implementation);
+
+    /* Allocate and initialize SHA-256 context */
+    if (NULL == (ctx = (mender_sha256_context_t *)malloc(sizeof(mender_sha256_context_t)))) {
+        mender_log_error("Unable to allocate memory");
+        return MENDER_FAIL;
+    }
+    memcpy(ctx->state, mender_sha256_h0, sizeof(ctx->state));
+    ctx->length       = 0;
+    ctx->block_length = 0;
+    *handle           = (void *)ctx;
+
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_sha256_update(void *handle, const void *data, size_t length) {
+
+    assert(NULL != handle);
+    mender_sha256_context_t *ctx = (mender_sha256_context_t *)handle;
+    const uint8_t           *ptr = (const uint8_t *)data;
+    size_t                   size;
+
+    ctx->length += length;
+
+    /* Complete the pending block */
+    if (0 != ctx->block_length) {
+        size = ((MENDER_SHA256_BLOCK_SIZE - ctx->block_length) < length) ? (MENDER_SHA256_BLOCK_SIZE - ctx->block_length) : length;
+        memcpy(&ctx->block[ctx->block_length], ptr, size);
+        ctx->block_length += size;
+        ptr += size;
+        length -= size;
+        if (MENDER_SHA256_BLOCK_SIZE != ctx->block_length) {
+            return MENDER_OK;
+        }
+        mender_sha256_implementation.compress(ctx->state, ctx->block, 1);
+        ctx->block_length = 0;
+    }
+
+    /* Process complete blocks directly from the input data */
+    if (length >= MENDER_SHA256_BLOCK_SIZE) {
+        size = length / MENDER_SHA256_BLOCK_SIZE;
+        mender_sha256_implementation.compress(ctx->state, ptr, size);
+        ptr += size * MENDER_SHA256_BLOCK_SIZE;
+        length -= size * MENDER_SHA256_BLOCK_SIZE;
+    }
+
+    /* Keep remaining data for the next call */
+    if (0 != length) {
+        memcpy(ctx->block, ptr, length);
+        ctx->block_length = length;
+    }
+
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_sha256_end(void *handle, unsigned char *digest) {
+
+    mender_sha256_context_t *ctx = (mender_sha256_context_t *)handle;
+
+    /* Check handle */
+    if (NULL == ctx) {
+        return MENDER_OK;
+    }
+
+    /* Compute digest if requested */
+    if (NULL != digest) {
+
+        /* Append padding and length of the message (bits, big endian) */
+        uint64_t bits = ctx->length * 8;
+        ctx->block[ctx->block_length++] = 0x80;
+        if (ctx->block_length > MENDER_SHA256_BLOCK_SIZE - 8) {
+            memset(&ctx->block[ctx->block_length], 0, MENDER_SHA256_BLOCK_SIZE - ctx->block_length);
+            mender_sha256_implementation.compress(ctx->state, ctx->block, 1);
+            ctx->block_length = 0;
+        }
+        memset(&ctx->block[ctx->block_length], 0, MENDER_SHA256_BLOCK_SIZE - 8 - ctx->block_length);
+        for (size_t index = 0; index < 8; index++) {
+            ctx->block[MENDER_SHA256_BLOCK_SIZE - 1 - index] = (uint8_t)(bits >> (8 * index));
+        }
+        mender_sha256_implementation.compress(ctx->state, ctx->block, 1);
+
+        /* Export digest (big endian) */
+        for (size_t index = 0; index < 8; index++) {
+            digest[4 * index]     = (uint8_t)(ctx->state[index] >> 24);
+            digest[4 * index + 1] = (uint8_t)(ctx->state[index] >> 16);
+            digest[4 * index + 2] = (uint8_t)(ctx->state[index] >> 8);
+            digest[4 * index + 3] = (uint8_t)(ctx->state[index]);
+        }
+    }
+
+    /* Release memory */
+    free(ctx);
+
+    return MENDER_OK;
+}
+
+static void
+mender_sha256_select_implementation(void) {
+
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if ((0 != __builtin_cpu_supports("sha")) && (0 != __builtin_cpu_supports("sse4.1"))) {
+        mender_sha256_implementation.name     = "SHA-NI";
+        mender_sha256_implementation.compress = &mender_sha256_compress_sha_ni;
+    }
+#elif defined(__aarch64__) && defined(__linux__)
+    if (0 != (getauxval(AT_HWCAP) & HWCAP_SHA2)) {
+        mender_sha256_implementation.name     = "ARMv8-CE";
+        mender_sha256_implementation.compress = &mender_sha256_compress_armv8_ce;
+    }
+#endif
+    mender_log_info("Using %s SHA-256 implementation", mender_sha256_implementation.name);
+}
+
+#define MENDER_SHA256_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void
+mender_sha256_compress_software(uint32_t state[8], const uint8_t *data, size_t blocks) {
+
+    uint32_t w[64];
+    uint32_t a, b, c, d, e, f, g, h, t1, t2;
+
+    while (blocks-- > 0) {
+
+        /* Compute the message schedule */
+        for (size_t index = 0; index < 16; index++) {
+            w[index] = ((uint32_t)data[4 * index] << 24) | ((uint32_t)data[4 * index + 1] << 16) | ((uint32_t)data[4 * index + 2] << 8)
+                       | (uint32_t)data[4 * index + 3];
+        }
+        for (size_t index = 16; index < 64; index++) {
+            uint32_t s0 = MENDER_SHA256_ROTR(w[index - 15], 7) ^ MENDER_SHA256_ROTR(w[index - 15], 18) ^ (w[index - 15] >> 3);
+            uint32_t s1 = MENDER_SHA256_ROTR(w[index - 2], 17) ^ MENDER_SHA256_ROTR(w[index - 2], 19) ^ (w[index - 2] >> 10);
+            w[index]    = w[index - 16] + s0 + w[index - 7] + s1;
+        }
+
+        /* Compute the rounds */
+        a = state[0];
+        b = state[1];
+        c = state[2];
+        d = state[3];
+        e = state[4];
+        f = state[5];
+        g = state[6];
+        h = state[7];
+        for (size_t index = 0; index < 64; index++) {
+            t1 = h + (MENDER_SHA256_ROTR(e, 6) ^ MENDER_SHA256_ROTR(e, 11) ^ MENDER_SHA256_ROTR(e, 25)) + ((e & f) ^ (~e & g)) + mender_sha256_k[index] + w[index];
+            t2 = (MENDER_SHA256_ROTR(a, 2) ^ MENDER_SHA256_ROTR(a, 13) ^ MENDER_SHA256_ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h  = g;
+            g  = f;
+            f  = e;
+            e  = d + t1;
+            d  = c;
+            c  = b;
+            b  = a;
+            a  = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+
+        data += MENDER_SHA256_BLOCK_SIZE;
+    }
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sha,sse4.1"))) static void
+mender_sha256_compress_sha_ni(uint32_t state[8], const uint8_t *data, size_t blocks) {
+
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i       state0, state1, abef, cdgh, msg, tmp;
+    __m128i       w[4];
+
+    /* Load the state, the SHA instructions work on ABEF and CDGH */
+    tmp    = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[0]), 0xB1);
+    state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[4]), 0x1B);
+    state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+    while (blocks-- > 0) {
+        abef = state0;
+        cdgh = state1;
+
+        /* Compute the rounds 4 by 4, the message schedule is computed on the fly */
+        for (size_t index = 0; index < 16; index++) {
+            if (index < 4) {
+                w[index] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16 * index)), mask);
+            } else {
+                tmp          = _mm_add_epi32(_mm_sha256msg1_epu32(w[index & 3], w[(index + 1) & 3]), _mm_alignr_epi8(w[(index + 3) & 3], w[(index + 2) & 3], 4));
+                w[index & 3] = _mm_sha256msg2_epu32(tmp, w[(index + 3) & 3]);
+            }
+            msg    = _mm_add_epi32(w[index & 3], _mm_loadu_si128((const __m128i *)&mender_sha256_k[4 * index]));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+        }
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+
+        data += MENDER_SHA256_BLOCK_SIZE;
+    }
+
+    /* Save the state */
+    tmp    = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    _mm_storeu_si128((__m128i *)&state[0], _mm_blend_epi16(tmp, state1, 0xF0));
+    _mm_storeu_si128((__m128i *)&state[4], _mm_alignr_epi8(state1, tmp, 8));
+}
+#elif defined(__aarch64__) && defined(__linux__)
+MENDER_SHA256_ARMV8_CE_TARGET static void
+mender_sha256_compress_armv8_ce(uint32_t state[8], const uint8_t *data, size_t blocks) {
+
+    uint32x4_t state0 = vld1q_u32(&state[0]);
+    uint32x4_t state1 = vld1q_u32(&state[4]);
+    uint32x4_t abcd, efgh, msg, tmp;
+    uint32x4_t w[4];
+
+    while (blocks-- > 0) {
+        abcd = state0;
+        efgh = state1;
+
+        /* Compute the rounds 4 by 4, the message schedule is computed on the fly */
+        for (size_t index = 0; index < 16; index++) {
+            if (index < 4) {
+                w[index] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16 * index)));
+            } else {
+                w[index & 3] = vsha256su1q_u32(vsha256su0q_u32(w[index & 3], w[(index + 1) & 3]), w[(index + 2) & 3], w[(index + 3) & 3]);
+            }
+            msg    = vaddq_u32(w[index & 3], vld1q_u32(&mender_sha256_k[4 * index]));
+            tmp    = state0;
+            state0 = vsha256hq_u32(state0, state1, msg);
+            state1 = vsha256h2q_u32(state1, tmp, msg);
+        }
+        state0 = vaddq_u32(state0, abcd);
+        state1 = vaddq_u32(state1, efgh);
+
+        data += MENDER_SHA256_BLOCK_SIZE;
+    }
+
+    /* Save the state */
+    vst1q_u32(&state[0], state0);
+    vst1q_u32(&state[4], state1);
+}
+#endif
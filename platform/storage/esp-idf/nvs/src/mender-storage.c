@@ -26,6 +26,8 @@
  */
 #define MENDER_STORAGE_NVS_PRIVATE_KEY     "key.der"
 #define MENDER_STORAGE_NVS_PUBLIC_KEY      "pubkey.der"
+#define MENDER_STORAGE_NVS_TOKEN           "token.jwt"
+#define MENDER_STORAGE_NVS_TOKEN_EXPIRATION "token.exp"
 #define MENDER_STORAGE_NVS_DEPLOYMENT_DATA "deployment-data.json"
 #define MENDER_STORAGE_NVS_DEVICE_CONFIG   "config.json"
 
@@ -125,6 +127,76 @@ mender_storage_delete_authentication_keys(void) {
     return MENDER_OK;
 }
 
+mender_err_t
+mender_storage_set_authentication_token(char *token, int64_t expiration) {
+
+    assert(NULL != token);
+
+    /* Write authentication token and its expiration */
+    if ((ESP_OK != nvs_set_str(mender_storage_nvs_handle, MENDER_STORAGE_NVS_TOKEN, token))
+        || (ESP_OK != nvs_set_i64(mender_storage_nvs_handle, MENDER_STORAGE_NVS_TOKEN_EXPIRATION, expiration))) {
+        mender_log_error("Unable to write authentication token");
+        return MENDER_FAIL;
+    }
+    if (ESP_OK != nvs_commit(mender_storage_nvs_handle)) {
+        mender_log_error("Unable to write authentication token");
+        return MENDER_FAIL;
+    }
+
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_storage_get_authentication_token(char **token, int64_t *expiration) {
+
+    assert(NULL != token);
+    assert(NULL != expiration);
+    size_t token_length = 0;
+
+    /* Retrieve length of the authentication token */
+    nvs_get_str(mender_storage_nvs_handle, MENDER_STORAGE_NVS_TOKEN, NULL, &token_length);
+    if (0 == token_length) {
+        mender_log_info("Authentication token not available");
+        return MENDER_NOT_FOUND;
+    }
+
+    /* Allocate memory to copy authentication token */
+    if (NULL == (*token = (char *)malloc(token_length + 1))) {
+        mender_log_error("Unable to allocate memory");
+        return MENDER_FAIL;
+    }
+
+    /* Read authentication token */
+    if (ESP_OK != nvs_get_str(mender_storage_nvs_handle, MENDER_STORAGE_NVS_TOKEN, *token, &token_length)) {
+        mender_log_error("Unable to read authentication token");
+        free(*token);
+        *token = NULL;
+        return MENDER_FAIL;
+    }
+
+    /* Read the expiration, it is unknown if it has not been stored with the token */
+    if (ESP_OK != nvs_get_i64(mender_storage_nvs_handle, MENDER_STORAGE_NVS_TOKEN_EXPIRATION, expiration)) {
+        *expiration = 0;
+    }
+
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_storage_delete_authentication_token(void) {
+
+    esp_err_t err;
+
+    /* Delete authentication token and its expiration, the expiration may not have been stored with the token */
+    if ((ESP_OK != nvs_erase_key(mender_storage_nvs_handle, MENDER_STORAGE_NVS_TOKEN))
+        || ((ESP_OK != (err = nvs_erase_key(mender_storage_nvs_handle, MENDER_STORAGE_NVS_TOKEN_EXPIRATION))) && (ESP_ERR_NVS_NOT_FOUND != err))) {
+        mender_log_error("Unable to delete authentication token");
+        return MENDER_FAIL;
+    }
+
+    return MENDER_OK;
+}
+
 mender_err_t
 mender_storage_set_deployment_data(char *deployment_data) {
 
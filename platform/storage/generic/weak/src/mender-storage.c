@@ -58,6 +58,33 @@ mender_storage_delete_authentication_keys(void) {
     return MENDER_NOT_IMPLEMENTED;
 }
 
+__attribute__((weak)) mender_err_t
+mender_storage_set_authentication_token(char *token, int64_t expiration) {
+
+    (void)token;
+    (void)expiration;
+
+    /* Nothing to do */
+    return MENDER_NOT_IMPLEMENTED;
+}
+
+__attribute__((weak)) mender_err_t
+mender_storage_get_authentication_token(char **token, int64_t *expiration) {
+
+    (void)token;
+    (void)expiration;
+
+    /* Nothing to do */
+    return MENDER_NOT_IMPLEMENTED;
+}
+
+__attribute__((weak)) mender_err_t
+mender_storage_delete_authentication_token(void) {
+
+    /* Nothing to do */
+    return MENDER_NOT_IMPLEMENTED;
+}
+
 __attribute__((weak)) mender_err_t
 mender_storage_set_deployment_data(char *deployment_data) {
 
@@ -17,6 +17,7 @@
  * limitations under the License.
  */
 
+#include <errno.h>
 #include <unistd.h>
 #include "mender-log.h"
 #include "mender-storage.h"
@@ -33,6 +34,8 @@
  */
 #define MENDER_STORAGE_NVS_PRIVATE_KEY     CONFIG_MENDER_STORAGE_PATH "key.der"
 #define MENDER_STORAGE_NVS_PUBLIC_KEY      CONFIG_MENDER_STORAGE_PATH "pubkey.der"
+#define MENDER_STORAGE_NVS_TOKEN           CONFIG_MENDER_STORAGE_PATH "token.jwt"
+#define MENDER_STORAGE_NVS_TOKEN_EXPIRATION CONFIG_MENDER_STORAGE_PATH "token.exp"
 #define MENDER_STORAGE_NVS_DEPLOYMENT_DATA CONFIG_MENDER_STORAGE_PATH "deployment-data.json"
 #define MENDER_STORAGE_NVS_DEVICE_CONFIG   CONFIG_MENDER_STORAGE_PATH "config.json"
 #define MENDER_STORAGE_NVS_PROVIDES        CONFIG_MENDER_STORAGE_PATH "provides.txt"
@@ -149,6 +152,55 @@ mender_storage_delete_authentication_keys(void) {
     return MENDER_OK;
 }
 
+mender_err_t
+mender_storage_set_authentication_token(char *token, int64_t expiration) {
+    assert(NULL != token);
+    size_t token_length = strlen(token);
+
+    if (MENDER_OK != mender_storage_write_file(MENDER_STORAGE_NVS_TOKEN, token, token_length)) {
+        return MENDER_FAIL;
+    }
+    if (MENDER_OK != mender_storage_write_file(MENDER_STORAGE_NVS_TOKEN_EXPIRATION, &expiration, sizeof(expiration))) {
+        return MENDER_FAIL;
+    }
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_storage_get_authentication_token(char **token, int64_t *expiration) {
+    assert(NULL != token);
+    assert(NULL != expiration);
+
+    size_t token_length;
+    if (MENDER_OK != mender_storage_read_file(MENDER_STORAGE_NVS_TOKEN, (void **)token, &token_length)) {
+        return MENDER_NOT_FOUND;
+    }
+
+    /* The expiration is unknown if it has not been stored with the token */
+    void  *data        = NULL;
+    size_t data_length = 0;
+    *expiration        = 0;
+    if (MENDER_OK == mender_storage_read_file(MENDER_STORAGE_NVS_TOKEN_EXPIRATION, &data, &data_length)) {
+        if (sizeof(*expiration) == data_length) {
+            memcpy(expiration, data, sizeof(*expiration));
+        }
+        free(data);
+    }
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_storage_delete_authentication_token(void) {
+
+    /* Delete authentication token and its expiration, there is nothing to do if they have never been stored */
+    if (((0 != unlink(MENDER_STORAGE_NVS_TOKEN)) && (ENOENT != errno)) || ((0 != unlink(MENDER_STORAGE_NVS_TOKEN_EXPIRATION)) && (ENOENT != errno))) {
+        mender_log_error("Unable to delete authentication token");
+        return MENDER_FAIL;
+    }
+
+    return MENDER_OK;
+}
+
 mender_err_t
 mender_storage_set_deployment_data(char *deployment_data) {
     assert(NULL != deployment_data);
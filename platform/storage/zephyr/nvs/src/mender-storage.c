@@ -40,6 +40,8 @@
 #define MENDER_STORAGE_NVS_DEPLOYMENT_DATA 3
 #define MENDER_STORAGE_NVS_DEVICE_CONFIG   4
 #define MENDER_STORAGE_NVS_PROVIDES        5
+#define MENDER_STORAGE_NVS_TOKEN           6
+#define MENDER_STORAGE_NVS_TOKEN_EXPIRATION 7
 
 /**
  * @brief NVS storage handle
@@ -168,6 +170,60 @@ mender_storage_delete_authentication_keys(void) {
     return MENDER_OK;
 }
 
+mender_err_t
+mender_storage_set_authentication_token(char *token, int64_t expiration) {
+
+    assert(NULL != token);
+
+    /* Write authentication token and its expiration */
+    if ((nvs_write(&mender_storage_nvs_handle, MENDER_STORAGE_NVS_TOKEN, token, strlen(token) + 1) < 0)
+        || (nvs_write(&mender_storage_nvs_handle, MENDER_STORAGE_NVS_TOKEN_EXPIRATION, &expiration, sizeof(expiration)) < 0)) {
+        mender_log_error("Unable to write authentication token");
+        return MENDER_FAIL;
+    }
+
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_storage_get_authentication_token(char **token, int64_t *expiration) {
+
+    assert(NULL != token);
+    assert(NULL != expiration);
+    size_t token_length = 0;
+
+    /* Read authentication token */
+    mender_err_t ret = nvs_read_alloc(&mender_storage_nvs_handle, MENDER_STORAGE_NVS_TOKEN, (void **)token, &token_length);
+    if (MENDER_OK != ret) {
+        if (MENDER_NOT_FOUND == ret) {
+            mender_log_info("Authentication token not available");
+        } else {
+            mender_log_error("Unable to read authentication token");
+        }
+        return ret;
+    }
+
+    /* Read the expiration, it is unknown if it has not been stored with the token */
+    if ((ssize_t)sizeof(*expiration) != nvs_read(&mender_storage_nvs_handle, MENDER_STORAGE_NVS_TOKEN_EXPIRATION, expiration, sizeof(*expiration))) {
+        *expiration = 0;
+    }
+
+    return MENDER_OK;
+}
+
+mender_err_t
+mender_storage_delete_authentication_token(void) {
+
+    /* Delete authentication token and its expiration */
+    if ((0 != nvs_delete(&mender_storage_nvs_handle, MENDER_STORAGE_NVS_TOKEN))
+        || (0 != nvs_delete(&mender_storage_nvs_handle, MENDER_STORAGE_NVS_TOKEN_EXPIRATION))) {
+        mender_log_error("Unable to delete authentication token");
+        return MENDER_FAIL;
+    }
+
+    return MENDER_OK;
+}
+
 mender_err_t
 mender_storage_set_deployment_data(char *deployment_data) {
 
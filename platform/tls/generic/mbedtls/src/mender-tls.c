@@ -21,6 +21,10 @@
 #include <mbedtls/base64.h>
 #include <mbedtls/bignum.h>
 #include <mbedtls/ctr_drbg.h>
+#ifdef CONFIG_MENDER_TLS_AUTHENTICATION_KEY_TYPE_ECDSA_P256
+#include <mbedtls/ecdsa.h>
+#include <mbedtls/ecp.h>
+#endif /* CONFIG_MENDER_TLS_AUTHENTICATION_KEY_TYPE_ECDSA_P256 */
 #include <mbedtls/entropy.h>
 #ifdef MBEDTLS_ERROR_C
 #include <mbedtls/error.h>
@@ -32,18 +36,66 @@
 #include "mender-storage.h"
 #include "mender-tls.h"
 
+#ifdef CONFIG_MENDER_TLS_AUTHENTICATION_KEY_TYPE_ECDSA_P256
+
+/**
+ * @brief Type of the authentication keys
+ */
+#define MENDER_TLS_PK_TYPE (MBEDTLS_PK_ECKEY)
+
+/**
+ * @brief Keys buffer length (DER encoded)
+ */
+#define MENDER_TLS_PRIVATE_KEY_LENGTH (160)
+#define MENDER_TLS_PUBLIC_KEY_LENGTH  (128)
+
+/**
+ * @brief Signature buffer length (DER encoded)
+ */
+#define MENDER_TLS_SIGNATURE_MAX_LENGTH (MBEDTLS_ECDSA_MAX_SIG_LEN(256))
+
+#else
+
 /**
- * @brief Keys buffer length
+ * @brief Default RSA key size (bits)
  */
-#define MENDER_TLS_PRIVATE_KEY_LENGTH (2048)
-#define MENDER_TLS_PUBLIC_KEY_LENGTH  (768)
+#ifndef CONFIG_MENDER_TLS_RSA_KEY_SIZE
+#define CONFIG_MENDER_TLS_RSA_KEY_SIZE (3072)
+#endif /* CONFIG_MENDER_TLS_RSA_KEY_SIZE */
+
+/**
+ * @brief Type of the authentication keys
+ */
+#define MENDER_TLS_PK_TYPE (MBEDTLS_PK_RSA)
+
+/**
+ * @brief Keys buffer length (DER encoded)
+ * @note The private key holds the modulus, the private exponent and five CRT values of half the size of the modulus
+ */
+#define MENDER_TLS_PRIVATE_KEY_LENGTH ((CONFIG_MENDER_TLS_RSA_KEY_SIZE / 8) * 9 / 2 + 128)
+#define MENDER_TLS_PUBLIC_KEY_LENGTH  ((CONFIG_MENDER_TLS_RSA_KEY_SIZE / 8) + 128)
+
+/**
+ * @brief Signature buffer length
+ */
+#define MENDER_TLS_SIGNATURE_MAX_LENGTH (CONFIG_MENDER_TLS_RSA_KEY_SIZE / 8)
+
+#endif /* CONFIG_MENDER_TLS_AUTHENTICATION_KEY_TYPE_ECDSA_P256 */
 
 /**
  * @brief Signature buffer length (base64 encoded)
  * @note base64 produces 4 bytes of output per 3 bytes of input (padded to be
  *       divisible), see RFC-4648 or man:EVP_EncodeBlock(3)
  */
-#define MENDER_TLS_SIGNATURE_LENGTH (((MBEDTLS_PK_SIGNATURE_MAX_SIZE + 2) / 3) * 4)
+#define MENDER_TLS_SIGNATURE_LENGTH (((MENDER_TLS_SIGNATURE_MAX_LENGTH + 2) / 3) * 4)
+
+/**
+ * @brief Default number of uses of the random generator after which it is reseeded
+ * @note 0 permits to rely only on the reseed interval of mbedTLS
+ */
+#ifndef CONFIG_MENDER_TLS_CTR_DRBG_RESEED_INTERVAL
+#define CONFIG_MENDER_TLS_CTR_DRBG_RESEED_INTERVAL (16)
+#endif /* CONFIG_MENDER_TLS_CTR_DRBG_RESEED_INTERVAL */
 
 #ifdef MBEDTLS_ERROR_C
 #define MBEDTLS_ERR_BUF char err[128]
@@ -70,6 +122,43 @@ static size_t         mender_tls_private_key_length = 0;
 static unsigned char *mender_tls_public_key         = NULL;
 static size_t         mender_tls_public_key_length  = 0;
 
+/**
+ * @brief Public key of the device in PEM format, computed on first use
+ */
+static char *mender_tls_public_key_pem = NULL;
+
+/**
+ * @brief PK context holding the parsed private key of the device, used to sign the payloads
+ */
+static mbedtls_pk_context mender_tls_pk_context;
+
+/**
+ * @brief Random generator, seeded on first use and reseeded periodically, and number of uses since the last seeding
+ */
+static mbedtls_ctr_drbg_context mender_tls_ctr_drbg;
+static mbedtls_entropy_context  mender_tls_entropy;
+static bool                     mender_tls_ctr_drbg_seeded = false;
+static uint32_t                 mender_tls_ctr_drbg_uses   = 0;
+
+/**
+ * @brief Get the random generator, it is seeded on first use and reseeded according to CONFIG_MENDER_TLS_CTR_DRBG_RESEED_INTERVAL
+ * @return Random generator if the function succeeds, NULL otherwise
+ */
+static mbedtls_ctr_drbg_context *mender_tls_get_ctr_drbg(void);
+
+/**
+ * @brief Check the private key is of the configured type and size, the buffers are sized according to the configuration
+ * @param pk_context PK context
+ * @return MENDER_OK if the private key can be used, MENDER_FAIL otherwise
+ */
+static mender_err_t mender_tls_check_private_key(mbedtls_pk_context *pk_context);
+
+/**
+ * @brief Parse the private key of the device in the PK context used to sign the payloads
+ * @return MENDER_OK if the function succeeds, MENDER_NOT_FOUND if the private key is not of the configured type or size, error code otherwise
+ */
+static mender_err_t mender_tls_load_private_key(void);
+
 /**
  * @brief Generate authentication keys
  * @param pk_context PK context
@@ -120,7 +209,13 @@ static mender_err_t mender_tls_pem_write_buffer(const unsigned char *der_data, s
 mender_err_t
 mender_tls_init(void) {
 
-    /* Nothing to do */
+    /* Initialize PK context and random generator, the random generator is seeded on first use */
+    mbedtls_pk_init(&mender_tls_pk_context);
+    mbedtls_ctr_drbg_init(&mender_tls_ctr_drbg);
+    mbedtls_entropy_init(&mender_tls_entropy);
+    mender_tls_ctr_drbg_seeded = false;
+    mender_tls_ctr_drbg_uses   = 0;
+
     return MENDER_OK;
 }
 
@@ -140,6 +235,12 @@ mender_tls_init_authentication_keys(mender_err_t (*get_user_provided_keys)(char
         mender_tls_public_key = NULL;
     }
     mender_tls_public_key_length = 0;
+    if (NULL != mender_tls_public_key_pem) {
+        free(mender_tls_public_key_pem);
+        mender_tls_public_key_pem = NULL;
+    }
+    mbedtls_pk_free(&mender_tls_pk_context);
+    mbedtls_pk_init(&mender_tls_pk_context);
 
     /* Check if recommissioning is forced */
     if (true == recommissioning) {
@@ -193,6 +294,36 @@ mender_tls_init_authentication_keys(mender_err_t (*get_user_provided_keys)(char
         }
     }
 
+    /* Parse the private key once, it is used to sign all the payloads */
+    if ((MENDER_NOT_FOUND == (ret = mender_tls_load_private_key())) && (NULL == user_provided_key)) {
+
+        /* The authentication keys recorded can't be used with the current configuration, new ones are generated */
+        mender_log_warning("Authentication keys do not match the configured key type or size, generating new authentication keys...");
+        free(mender_tls_private_key);
+        mender_tls_private_key        = NULL;
+        mender_tls_private_key_length = 0;
+        free(mender_tls_public_key);
+        mender_tls_public_key        = NULL;
+        mender_tls_public_key_length = 0;
+        if (MENDER_OK
+            != (ret = mender_tls_get_authentication_keys(
+                    &mender_tls_private_key, &mender_tls_private_key_length, &mender_tls_public_key, &mender_tls_public_key_length, NULL, 0))) {
+            mender_log_error("Unable to generate authentication keys");
+            goto END;
+        }
+        if (MENDER_OK
+            != (ret = mender_storage_set_authentication_keys(
+                    mender_tls_private_key, mender_tls_private_key_length, mender_tls_public_key, mender_tls_public_key_length))) {
+            mender_log_error("Unable to record authentication keys");
+            goto END;
+        }
+        ret = mender_tls_load_private_key();
+    }
+    if (MENDER_OK != ret) {
+        mender_log_error("Unable to load authentication keys");
+        goto END;
+    }
+
 END:
     /* Release memory */
     free(user_provided_key);
@@ -206,24 +337,36 @@ mender_tls_get_public_key_pem(char **public_key) {
     assert(NULL != public_key);
     mender_err_t ret;
 
-    /* Compute size of the public key */
-    size_t olen = 0;
-    mender_tls_pem_write_buffer(mender_tls_public_key, mender_tls_public_key_length, NULL, 0, &olen);
-    if (0 == olen) {
-        mender_log_error("Unable to compute public key size");
-        return MENDER_FAIL;
+    /* Convert public key from DER to PEM format on first use */
+    if (NULL == mender_tls_public_key_pem) {
+
+        /* Compute size of the public key */
+        size_t olen = 0;
+        mender_tls_pem_write_buffer(mender_tls_public_key, mender_tls_public_key_length, NULL, 0, &olen);
+        if (0 == olen) {
+            mender_log_error("Unable to compute public key size");
+            return MENDER_FAIL;
+        }
+        if (NULL == (mender_tls_public_key_pem = (char *)malloc(olen))) {
+            mender_log_error("Unable to allocate memory");
+            return MENDER_FAIL;
+        }
+
+        /* Convert public key from DER to PEM format */
+        if (MENDER_OK != (ret = mender_tls_pem_write_buffer(mender_tls_public_key, mender_tls_public_key_length, mender_tls_public_key_pem, olen, &olen))) {
+            mender_log_error("Unable to convert public key");
+            free(mender_tls_public_key_pem);
+            mender_tls_public_key_pem = NULL;
+            return ret;
+        }
     }
-    if (NULL == (*public_key = (char *)malloc(olen))) {
+
+    /* Return a copy of the public key */
+    if (NULL == (*public_key = strdup(mender_tls_public_key_pem))) {
         mender_log_error("Unable to allocate memory");
         return MENDER_FAIL;
     }
 
-    /* Convert public key from DER to PEM format */
-    if (MENDER_OK != (ret = mender_tls_pem_write_buffer(mender_tls_public_key, mender_tls_public_key_length, *public_key, olen, &olen))) {
-        mender_log_error("Unable to convert public key");
-        return ret;
-    }
-
     return MENDER_OK;
 }
 
@@ -234,46 +377,21 @@ mender_tls_sign_payload(char *payload, char **signature, size_t *signature_lengt
     assert(NULL != signature);
     assert(NULL != signature_length);
     int                       ret;
-    mbedtls_pk_context       *pk_context = NULL;
-    mbedtls_ctr_drbg_context *ctr_drbg   = NULL;
-    mbedtls_entropy_context  *entropy    = NULL;
-    unsigned char            *sig        = NULL;
+    mbedtls_ctr_drbg_context *ctr_drbg = NULL;
+    unsigned char            *sig      = NULL;
     size_t                    sig_length;
     MBEDTLS_ERR_BUF;
 
-    /* Initialize mbedtls */
-    if (NULL == (pk_context = (mbedtls_pk_context *)malloc(sizeof(mbedtls_pk_context)))) {
-        mender_log_error("Unable to allocate memory");
+    /* Check if the private key has been loaded */
+    if (MBEDTLS_PK_NONE == mbedtls_pk_get_type(&mender_tls_pk_context)) {
+        mender_log_error("Authentication keys are not loaded");
         ret = -1;
         goto END;
     }
-    mbedtls_pk_init(pk_context);
-    if (NULL == (ctr_drbg = (mbedtls_ctr_drbg_context *)malloc(sizeof(mbedtls_ctr_drbg_context)))) {
-        mender_log_error("Unable to allocate memory");
-        ret = -1;
-        goto END;
-    }
-    mbedtls_ctr_drbg_init(ctr_drbg);
-    if (NULL == (entropy = (mbedtls_entropy_context *)malloc(sizeof(mbedtls_entropy_context)))) {
-        mender_log_error("Unable to allocate memory");
-        ret = -1;
-        goto END;
-    }
-    mbedtls_entropy_init(entropy);
-
-    /* Setup CRT DRBG */
-    if (0 != (ret = mbedtls_ctr_drbg_seed(ctr_drbg, mbedtls_entropy_func, entropy, (const unsigned char *)"mender", strlen("mender")))) {
-        LOG_MBEDTLS_ERROR("Unable to initialize ctr drbg", ret);
-        goto END;
-    }
 
-    /* Parse private key (IMPORTANT NOTE: length must include the ending \0 character) */
-#if MBEDTLS_VERSION_NUMBER >= 0x03000000
-    if (0 != (ret = mbedtls_pk_parse_key(pk_context, mender_tls_private_key, mender_tls_private_key_length, NULL, 0, mbedtls_ctr_drbg_random, ctr_drbg))) {
-#else
-    if (0 != (ret = mbedtls_pk_parse_key(pk_context, mender_tls_private_key, mender_tls_private_key_length, NULL, 0))) {
-#endif /* MBEDTLS_VERSION_NUMBER >= 0x03000000 */
-        LOG_MBEDTLS_ERROR("Unable to parse private key", ret);
+    /* Get random generator */
+    if (NULL == (ctr_drbg = mender_tls_get_ctr_drbg())) {
+        ret = -1;
         goto END;
     }
 
@@ -285,16 +403,18 @@ mender_tls_sign_payload(char *payload, char **signature, size_t *signature_lengt
     }
 
     /* Compute signature */
-    if (NULL == (sig = (unsigned char *)malloc(MBEDTLS_PK_SIGNATURE_MAX_SIZE))) {
+    if (NULL == (sig = (unsigned char *)malloc(MENDER_TLS_SIGNATURE_MAX_LENGTH))) {
         mender_log_error("Unable to allocate memory");
         ret = -1;
         goto END;
     }
-    sig_length = MBEDTLS_PK_SIGNATURE_MAX_SIZE;
+    sig_length = MENDER_TLS_SIGNATURE_MAX_LENGTH;
 #if MBEDTLS_VERSION_NUMBER >= 0x03000000
-    if (0 != (ret = mbedtls_pk_sign(pk_context, MBEDTLS_MD_SHA256, digest, sizeof(digest), sig, sig_length, &sig_length, mbedtls_ctr_drbg_random, ctr_drbg))) {
+    if (0
+        != (ret = mbedtls_pk_sign(
+                &mender_tls_pk_context, MBEDTLS_MD_SHA256, digest, sizeof(digest), sig, sig_length, &sig_length, mbedtls_ctr_drbg_random, ctr_drbg))) {
 #else
-    if (0 != (ret = mbedtls_pk_sign(pk_context, MBEDTLS_MD_SHA256, digest, sizeof(digest), sig, &sig_length, mbedtls_ctr_drbg_random, ctr_drbg))) {
+    if (0 != (ret = mbedtls_pk_sign(&mender_tls_pk_context, MBEDTLS_MD_SHA256, digest, sizeof(digest), sig, &sig_length, mbedtls_ctr_drbg_random, ctr_drbg))) {
 #endif /* MBEDTLS_VERSION_NUMBER >= 0x03000000 */
         LOG_MBEDTLS_ERROR("Unable to compute signature", ret);
         goto END;
@@ -320,20 +440,6 @@ mender_tls_sign_payload(char *payload, char **signature, size_t *signature_lengt
 
 END:
 
-    /* Release mbedtls */
-    if (NULL != entropy) {
-        mbedtls_entropy_free(entropy);
-        free(entropy);
-    }
-    if (NULL != ctr_drbg) {
-        mbedtls_ctr_drbg_free(ctr_drbg);
-        free(ctr_drbg);
-    }
-    if (NULL != pk_context) {
-        mbedtls_pk_free(pk_context);
-        free(pk_context);
-    }
-
     /* Release memory */
     if (NULL != sig) {
         free(sig);
@@ -356,6 +462,17 @@ mender_tls_exit(void) {
         mender_tls_public_key = NULL;
     }
     mender_tls_public_key_length = 0;
+    if (NULL != mender_tls_public_key_pem) {
+        free(mender_tls_public_key_pem);
+        mender_tls_public_key_pem = NULL;
+    }
+
+    /* Release mbedtls */
+    mbedtls_pk_free(&mender_tls_pk_context);
+    mbedtls_ctr_drbg_free(&mender_tls_ctr_drbg);
+    mbedtls_entropy_free(&mender_tls_entropy);
+    mender_tls_ctr_drbg_seeded = false;
+    mender_tls_ctr_drbg_uses   = 0;
 
     return MENDER_OK;
 }
@@ -364,51 +481,32 @@ static mender_err_t
 mender_tls_generate_authentication_keys(mbedtls_pk_context *pk_context) {
 
     mbedtls_ctr_drbg_context *ctr_drbg = NULL;
-    mbedtls_entropy_context  *entropy  = NULL;
     int                       ret;
     MBEDTLS_ERR_BUF;
 
-    if (NULL == (ctr_drbg = (mbedtls_ctr_drbg_context *)malloc(sizeof(mbedtls_ctr_drbg_context)))) {
-        mender_log_error("Unable to allocate memory");
-        ret = -1;
-        goto END;
-    }
-    mbedtls_ctr_drbg_init(ctr_drbg);
-    if (NULL == (entropy = (mbedtls_entropy_context *)malloc(sizeof(mbedtls_entropy_context)))) {
-        mender_log_error("Unable to allocate memory");
+    /* Get random generator */
+    if (NULL == (ctr_drbg = mender_tls_get_ctr_drbg())) {
         ret = -1;
         goto END;
     }
-    mbedtls_entropy_init(entropy);
-
-    /* Setup CRT DRBG */
-    if (0 != (ret = mbedtls_ctr_drbg_seed(ctr_drbg, mbedtls_entropy_func, entropy, (const unsigned char *)"mender", strlen("mender")))) {
-        LOG_MBEDTLS_ERROR("Unable to initialize ctr drbg", ret);
-        goto END;
-    }
 
     /* PK setup */
-    if (0 != (ret = mbedtls_pk_setup(pk_context, mbedtls_pk_info_from_type(MBEDTLS_PK_RSA)))) {
+    if (0 != (ret = mbedtls_pk_setup(pk_context, mbedtls_pk_info_from_type(MENDER_TLS_PK_TYPE)))) {
         LOG_MBEDTLS_ERROR("Unable to setup pk", ret);
         goto END;
     }
 
     /* Generate key pair */
-    if (0 != (ret = mbedtls_rsa_gen_key(mbedtls_pk_rsa(*pk_context), mbedtls_ctr_drbg_random, ctr_drbg, 3072, 65537))) {
+#ifdef CONFIG_MENDER_TLS_AUTHENTICATION_KEY_TYPE_ECDSA_P256
+    if (0 != (ret = mbedtls_ecp_gen_key(MBEDTLS_ECP_DP_SECP256R1, mbedtls_pk_ec(*pk_context), mbedtls_ctr_drbg_random, ctr_drbg))) {
+#else
+    if (0 != (ret = mbedtls_rsa_gen_key(mbedtls_pk_rsa(*pk_context), mbedtls_ctr_drbg_random, ctr_drbg, CONFIG_MENDER_TLS_RSA_KEY_SIZE, 65537))) {
+#endif /* CONFIG_MENDER_TLS_AUTHENTICATION_KEY_TYPE_ECDSA_P256 */
         LOG_MBEDTLS_ERROR("Unable to generate key", ret);
         goto END;
     }
 
 END:
-    /* Release mbedtls */
-    if (NULL != entropy) {
-        mbedtls_entropy_free(entropy);
-        free(entropy);
-    }
-    if (NULL != ctr_drbg) {
-        mbedtls_ctr_drbg_free(ctr_drbg);
-        free(ctr_drbg);
-    }
 
     return (0 != ret) ? MENDER_FAIL : MENDER_OK;
 }
@@ -420,28 +518,14 @@ mender_tls_user_provided_authentication_keys(mbedtls_pk_context *pk_context, con
     assert(0 != user_provided_key_length);
 
     mbedtls_ctr_drbg_context *ctr_drbg = NULL;
-    mbedtls_entropy_context  *entropy  = NULL;
     int                       ret;
     MBEDTLS_ERR_BUF;
 
-    if (NULL == (ctr_drbg = (mbedtls_ctr_drbg_context *)malloc(sizeof(mbedtls_ctr_drbg_context)))) {
-        mender_log_error("Unable to allocate memory");
-        ret = -1;
-        goto END;
-    }
-    mbedtls_ctr_drbg_init(ctr_drbg);
-    if (NULL == (entropy = (mbedtls_entropy_context *)malloc(sizeof(mbedtls_entropy_context)))) {
-        mender_log_error("Unable to allocate memory");
+    /* Get random generator */
+    if (NULL == (ctr_drbg = mender_tls_get_ctr_drbg())) {
         ret = -1;
         goto END;
     }
-    mbedtls_entropy_init(entropy);
-
-    /* Setup CRT DRBG */
-    if (0 != (ret = mbedtls_ctr_drbg_seed(ctr_drbg, mbedtls_entropy_func, entropy, (const unsigned char *)"mender", strlen("mender")))) {
-        LOG_MBEDTLS_ERROR("Unable to initialize ctr drbg", ret);
-        goto END;
-    }
 
     /* Load and parse the private key buffer */
 #if MBEDTLS_VERSION_NUMBER >= 0x03000000
@@ -453,17 +537,14 @@ mender_tls_user_provided_authentication_keys(mbedtls_pk_context *pk_context, con
         goto END;
     }
 
-END:
-    /* Release mbedtls */
-    if (NULL != entropy) {
-        mbedtls_entropy_free(entropy);
-        free(entropy);
-    }
-    if (NULL != ctr_drbg) {
-        mbedtls_ctr_drbg_free(ctr_drbg);
-        free(ctr_drbg);
+    /* Check the private key can be used */
+    if (MENDER_OK != mender_tls_check_private_key(pk_context)) {
+        ret = -1;
+        goto END;
     }
 
+END:
+
     return (0 != ret) ? MENDER_FAIL : MENDER_OK;
 }
 
@@ -570,6 +651,94 @@ END:
     return (0 != ret) ? MENDER_FAIL : MENDER_OK;
 }
 
+static mbedtls_ctr_drbg_context *
+mender_tls_get_ctr_drbg(void) {
+
+    int ret;
+    MBEDTLS_ERR_BUF;
+
+    if (false == mender_tls_ctr_drbg_seeded) {
+
+        /* Setup CRT DRBG */
+        if (0
+            != (ret = mbedtls_ctr_drbg_seed(
+                    &mender_tls_ctr_drbg, mbedtls_entropy_func, &mender_tls_entropy, (const unsigned char *)"mender", strlen("mender")))) {
+            LOG_MBEDTLS_ERROR("Unable to initialize ctr drbg", ret);
+            return NULL;
+        }
+        mender_tls_ctr_drbg_seeded = true;
+        mender_tls_ctr_drbg_uses   = 0;
+
+    } else if ((CONFIG_MENDER_TLS_CTR_DRBG_RESEED_INTERVAL > 0) && (mender_tls_ctr_drbg_uses >= CONFIG_MENDER_TLS_CTR_DRBG_RESEED_INTERVAL)) {
+
+        /* Reseed CTR DRBG with fresh entropy */
+        if (0 != (ret = mbedtls_ctr_drbg_reseed(&mender_tls_ctr_drbg, NULL, 0))) {
+            LOG_MBEDTLS_ERROR("Unable to reseed ctr drbg", ret);
+            return NULL;
+        }
+        mender_tls_ctr_drbg_uses = 0;
+    }
+    mender_tls_ctr_drbg_uses++;
+
+    return &mender_tls_ctr_drbg;
+}
+
+static mender_err_t
+mender_tls_load_private_key(void) {
+
+    int ret;
+    MBEDTLS_ERR_BUF;
+
+    /* Parse private key (IMPORTANT NOTE: length must include the ending \0 character) */
+#if MBEDTLS_VERSION_NUMBER >= 0x03000000
+    mbedtls_ctr_drbg_context *ctr_drbg = NULL;
+    if (NULL == (ctr_drbg = mender_tls_get_ctr_drbg())) {
+        return MENDER_FAIL;
+    }
+    if (0
+        != (ret = mbedtls_pk_parse_key(
+                &mender_tls_pk_context, mender_tls_private_key, mender_tls_private_key_length, NULL, 0, mbedtls_ctr_drbg_random, ctr_drbg))) {
+#else
+    if (0 != (ret = mbedtls_pk_parse_key(&mender_tls_pk_context, mender_tls_private_key, mender_tls_private_key_length, NULL, 0))) {
+#endif /* MBEDTLS_VERSION_NUMBER >= 0x03000000 */
+        LOG_MBEDTLS_ERROR("Unable to parse private key", ret);
+        mbedtls_pk_free(&mender_tls_pk_context);
+        mbedtls_pk_init(&mender_tls_pk_context);
+        return MENDER_FAIL;
+    }
+
+    /* Check the private key can be used */
+    if (MENDER_OK != mender_tls_check_private_key(&mender_tls_pk_context)) {
+        mbedtls_pk_free(&mender_tls_pk_context);
+        mbedtls_pk_init(&mender_tls_pk_context);
+        return MENDER_NOT_FOUND;
+    }
+
+    return MENDER_OK;
+}
+
+static mender_err_t
+mender_tls_check_private_key(mbedtls_pk_context *pk_context) {
+
+    assert(NULL != pk_context);
+
+    /* Check the type of the private key, the buffers are sized according to the configured key type */
+    if (0 == mbedtls_pk_can_do(pk_context, MENDER_TLS_PK_TYPE)) {
+        mender_log_error("Authentication keys are not of the configured type");
+        return MENDER_FAIL;
+    }
+
+#ifndef CONFIG_MENDER_TLS_AUTHENTICATION_KEY_TYPE_ECDSA_P256
+    /* Check the size of the private key, the buffers and the signature are sized according to the configured key size */
+    if (mbedtls_pk_get_bitlen(pk_context) > CONFIG_MENDER_TLS_RSA_KEY_SIZE) {
+        mender_log_error("Authentication keys are larger than the configured size of %d bits", CONFIG_MENDER_TLS_RSA_KEY_SIZE);
+        return MENDER_FAIL;
+    }
+#endif /* CONFIG_MENDER_TLS_AUTHENTICATION_KEY_TYPE_ECDSA_P256 */
+
+    return MENDER_OK;
+}
+
 static mender_err_t
 mender_tls_pem_write_buffer(const unsigned char *der_data, size_t der_len, char *buf, size_t buf_len, size_t *olen) {
 
@@ -60,4 +60,6 @@ typedef struct {
     bool                    encrypted;
 } esp_partition_t;
 
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size);
+
 #endif /* __ESP_PARTITION_H__ */
@@ -0,0 +1,150 @@
+# @file      download_test.py
+# @brief     Download tests of the platform HTTP implementation against a local HTTP server
+#
+# Copyright joelguittet and mender-mcu-client contributors
+# Copyright Northern.tech AS
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Serve a file with several server behaviors and check the test application downloads it entirely and in order.
+
+Usage: python3 download_test.py <path to mender-mcu-client.elf>
+"""
+
+import http.server
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import threading
+
+# Length of the file served, it is not a multiple of the segment size so that the last segment is partial
+FILE_LENGTH = 3 * 1024 * 1024 + 12345
+
+# Maximum length of the partial responses of the "short" behavior
+SHORT_LENGTH = 100 * 1024
+
+# Server behaviors: "range" honors the ranges, "norange" ignores them and replies 200 with the whole file,
+# "short" replies partial responses shorter than the ranges requested, "drop" closes the connection in the middle of one response out of three, starting with the first one
+BEHAVIORS = ["range", "norange", "short", "drop"]
+
+# Timeout of each download (seconds)
+DOWNLOAD_TIMEOUT = 120
+
+
+def file_content(length):
+    """Content of the file served, the pattern doesn't repeat so that data delivered out of order are detected"""
+    return bytes((((index * 2654435761) & 0xFFFFFFFF) >> 24) for index in range(length))
+
+
+class DownloadHandler(http.server.BaseHTTPRequestHandler):
+    """Request handler serving the file with the behavior given by the first element of the path"""
+
+    protocol_version = "HTTP/1.1"
+    content = b""
+    requests = 0
+    lock = threading.Lock()
+
+    def log_message(self, format, *args):
+        pass
+
+    def do_GET(self):
+        behavior = self.path.strip("/").split("/")[0]
+        match = re.match(r"bytes=(\d+)-(\d*)$", self.headers.get("Range", ""))
+        with DownloadHandler.lock:
+            DownloadHandler.requests += 1
+            count = DownloadHandler.requests
+        if behavior not in BEHAVIORS:
+            self.send_response(404)
+            self.send_header("Content-Length", "0")
+            self.end_headers()
+            return
+        if ("norange" == behavior) or (match is None):
+            self.send_response(200)
+            self.send_header("Content-Length", str(len(self.content)))
+            self.end_headers()
+            self.wfile.write(self.content)
+            return
+        first = int(match.group(1))
+        last = min(int(match.group(2)), len(self.content) - 1) if match.group(2) else len(self.content) - 1
+        if "short" == behavior:
+            last = min(last, first + SHORT_LENGTH - 1)
+        body = self.content[first : last + 1]
+        self.send_response(206)
+        self.send_header("Content-Range", "bytes %d-%d/%d" % (first, last, len(self.content)))
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        if ("drop" == behavior) and (1 == count % 3):
+            self.wfile.write(body[: len(body) // 2])
+            self.wfile.flush()
+            self.close_connection = True
+            return
+        self.wfile.write(body)
+
+
+def download(application, url, path, asynchronous):
+    """Download the file with the test application, return True if it succeeds"""
+    try:
+        arguments = [application, "--download", url, "--output", path] + (["--async"] if asynchronous else [])
+        result = subprocess.run(arguments, capture_output=True, text=True, timeout=DOWNLOAD_TIMEOUT)
+    except subprocess.TimeoutExpired:
+        print("Download timeout")
+        return False
+    print(result.stdout, end="")
+    if 0 != result.returncode:
+        print(result.stderr, end="")
+        return False
+    return True
+
+
+def main():
+    if 2 != len(sys.argv):
+        print(__doc__)
+        return 1
+    application = os.path.abspath(sys.argv[1])
+
+    # Start the server on a free port
+    DownloadHandler.content = file_content(FILE_LENGTH)
+    server = http.server.ThreadingHTTPServer(("127.0.0.1", 0), DownloadHandler)
+    thread = threading.Thread(target=server.serve_forever, daemon=True)
+    thread.start()
+
+    # Download the file with each behavior of the server and compare it to the content served, then with asynchronous requests which are not ranged
+    failures = 0
+    with tempfile.TemporaryDirectory() as directory:
+        for behavior, asynchronous in [(behavior, False) for behavior in BEHAVIORS] + [("range", True)]:
+            print("Download with '%s' server behavior%s" % (behavior, " and asynchronous requests" if asynchronous else ""))
+            DownloadHandler.requests = 0
+            path = os.path.join(directory, "%s%s.bin" % (behavior, "-async" if asynchronous else ""))
+            url = "http://127.0.0.1:%d/%s/artifact.mender" % (server.server_address[1], behavior)
+            if not download(application, url, path, asynchronous):
+                print("FAILED: download failed")
+                failures += 1
+                continue
+            with open(path, "rb") as f:
+                data = f.read()
+            if data != DownloadHandler.content:
+                offset = next((index for index in range(min(len(data), len(DownloadHandler.content))) if data[index] != DownloadHandler.content[index]), None)
+                print("FAILED: %d bytes received, %d bytes expected, first difference at offset %s" % (len(data), len(DownloadHandler.content), offset))
+                failures += 1
+                continue
+            print("PASSED: %d requests" % DownloadHandler.requests)
+
+    server.shutdown()
+    return 0 if 0 == failures else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
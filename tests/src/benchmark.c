@@ -0,0 +1,592 @@
+/**
+ * @file      benchmark.c
+ * @brief     Micro-benchmarks of the platform TLS and SHA implementations
+ *
+ * Copyright joelguittet and mender-mcu-client contributors
+ * Copyright Northern.tech AS
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <malloc.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "benchmark.h"
+#include "mender-log.h"
+#include "mender-sha.h"
+#include "mender-storage.h"
+#include "mender-tls.h"
+
+/**
+ * @brief Description of the platform TLS implementation and of the authentication keys
+ */
+#ifndef BENCHMARK_TLS_TYPE
+#define BENCHMARK_TLS_TYPE "unknown"
+#endif /* BENCHMARK_TLS_TYPE */
+#ifndef BENCHMARK_KEY_TYPE
+#define BENCHMARK_KEY_TYPE "default"
+#endif /* BENCHMARK_KEY_TYPE */
+
+/**
+ * @brief Description of the platform SHA implementation
+ */
+#ifndef BENCHMARK_SHA_TYPE
+#define BENCHMARK_SHA_TYPE "unknown"
+#endif /* BENCHMARK_SHA_TYPE */
+
+/**
+ * @brief Template of the temporary working directory of the TLS benchmarks, the authentication keys generated are stored in it
+ */
+#define BENCHMARK_TLS_DIRECTORY "/tmp/mender-benchmark-XXXXXX"
+
+/**
+ * @brief Length of the data hashed by each execution of the SHA-256 benchmarks
+ */
+#define BENCHMARK_SHA_DATA_LENGTH (1024 * 1024)
+
+/**
+ * @brief Size of the stack of the thread executing the benchmarks, it is painted to measure the stack usage
+ */
+#define BENCHMARK_STACK_SIZE (256 * 1024)
+
+/**
+ * @brief Pattern used to paint the stack of the thread executing the benchmarks
+ */
+#define BENCHMARK_STACK_PATTERN (0xA5)
+
+/**
+ * @brief Benchmark operation
+ */
+typedef struct {
+    const char *name;                /**< Name of the operation */
+    mender_err_t (*function)(void); /**< Function performing the operation once */
+    size_t length;                   /**< Length of the data processed by each execution (bytes), 0 to report operations per second */
+} benchmark_operation_t;
+
+/**
+ * @brief Benchmark context
+ */
+typedef struct {
+    const benchmark_operation_t *operation; /**< Operation to benchmark */
+    double                       duration;  /**< Minimum duration of the benchmark (seconds) */
+    double                       elapsed;   /**< Duration of the benchmark (seconds) */
+    uint32_t                     count;     /**< Number of executions of the operation */
+    uint32_t                     errors;    /**< Number of executions of the operation that failed */
+} benchmark_context_t;
+
+#ifdef BENCHMARK_HEAP_USAGE
+
+/**
+ * @brief Heap usage, the allocation functions are wrapped at link time to track it
+ * @note Memory allocated by the C library itself is not tracked, the heap usage is only meaningful relatively to the beginning of a benchmark
+ */
+static pthread_mutex_t benchmark_heap_mutex   = PTHREAD_MUTEX_INITIALIZER;
+static int64_t         benchmark_heap_current = 0;
+static int64_t         benchmark_heap_peak    = 0;
+
+#endif /* BENCHMARK_HEAP_USAGE */
+
+/**
+ * @brief Payload signed by the benchmark, similar to an authentication request
+ */
+static char benchmark_payload[] = "{\"id_data\":\"{\\\"mac\\\":\\\"00:11:22:33:44:55\\\"}\",\"pubkey\":\"-----BEGIN PUBLIC KEY-----\\n...\\n-----END PUBLIC KEY-----\\n\"}";
+
+/**
+ * @brief Data hashed by the SHA-256 benchmarks
+ */
+static uint8_t benchmark_sha_data[BENCHMARK_SHA_DATA_LENGTH];
+
+#ifdef BENCHMARK_HEAP_USAGE
+
+/**
+ * @brief Allocation functions wrapped at link time, and functions provided by the linker to reach the original ones
+ */
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t nmemb, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+void  __wrap_free(void *ptr);
+char *__wrap_strdup(const char *s);
+char *__wrap_strndup(const char *s, size_t n);
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void  __real_free(void *ptr);
+char *__real_strdup(const char *s);
+char *__real_strndup(const char *s, size_t n);
+
+/**
+ * @brief Update the heap usage
+ * @param delta Variation of the heap usage (bytes)
+ */
+static void benchmark_heap_update(int64_t delta);
+
+#endif /* BENCHMARK_HEAP_USAGE */
+
+/**
+ * @brief Get user-provided keys callback, the keys are always generated by the platform TLS implementation
+ * @param user_provided_key User provided key, not used
+ * @param user_provided_key_length User provided key length, not used
+ * @return MENDER_OK
+ */
+static mender_err_t benchmark_get_user_provided_keys(char **user_provided_key, size_t *user_provided_key_length);
+
+/**
+ * @brief Generate new authentication keys and save them in the storage
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t benchmark_key_generation(void);
+
+/**
+ * @brief Load the authentication keys from the storage
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t benchmark_key_load(void);
+
+/**
+ * @brief Load the authentication keys from the storage and convert the public key to PEM format, the difference with the loading is the cost of the conversion
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t benchmark_key_load_public_key_pem(void);
+
+/**
+ * @brief Get the public key in PEM format, the platform TLS implementation may keep it from the previous call
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t benchmark_public_key_pem(void);
+
+/**
+ * @brief Sign a payload similar to an authentication request
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t benchmark_sign_payload(void);
+
+/**
+ * @brief Hash the data of the SHA-256 benchmarks
+ * @param chunk_length Length of the chunks of data given to the SHA-256 implementation (bytes)
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t benchmark_sha256(size_t chunk_length);
+
+/**
+ * @brief Hash the data of the SHA-256 benchmarks by chunks of 512 bytes, this is the size of the blocks given by the artifact parser
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t benchmark_sha256_512(void);
+
+/**
+ * @brief Hash the data of the SHA-256 benchmarks by chunks of 4 kilobytes
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t benchmark_sha256_4096(void);
+
+/**
+ * @brief Hash the data of the SHA-256 benchmarks at once
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t benchmark_sha256_all(void);
+
+/**
+ * @brief Thread executing the operation until the duration of the benchmark is elapsed
+ * @param arg Benchmark context
+ * @return Always NULL
+ */
+static void *benchmark_thread(void *arg);
+
+/**
+ * @brief Run a benchmark and print its results
+ * @param operation Operation to benchmark
+ * @param duration Minimum duration of the benchmark (seconds)
+ * @return EXIT_SUCCESS if all the executions of the operation succeed, EXIT_FAILURE otherwise
+ */
+static int benchmark_run(const benchmark_operation_t *operation, uint32_t duration);
+
+/**
+ * @brief Operations measured by the benchmark, the keys are generated first so that the following operations use them
+ */
+static const benchmark_operation_t benchmark_operations[] = {
+    { "key generation", &benchmark_key_generation, 0 },
+    { "key load", &benchmark_key_load, 0 },
+    { "key load + PEM", &benchmark_key_load_public_key_pem, 0 },
+    { "public key PEM", &benchmark_public_key_pem, 0 },
+    { "payload signature", &benchmark_sign_payload, 0 },
+};
+
+/**
+ * @brief SHA-256 operations measured by the benchmark
+ */
+static const benchmark_operation_t benchmark_sha_operations[] = {
+    { "SHA-256 512 B", &benchmark_sha256_512, BENCHMARK_SHA_DATA_LENGTH },
+    { "SHA-256 4 KiB", &benchmark_sha256_4096, BENCHMARK_SHA_DATA_LENGTH },
+    { "SHA-256 1 MiB", &benchmark_sha256_all, BENCHMARK_SHA_DATA_LENGTH },
+};
+
+int
+benchmark_tls(uint32_t duration) {
+
+    int   ret          = EXIT_SUCCESS;
+    char  directory[]  = BENCHMARK_TLS_DIRECTORY;
+    char *working_path = NULL;
+
+    /* Move to a temporary directory so that the authentication keys of the client are not replaced, the default storage path is relative */
+    if (NULL == (working_path = getcwd(NULL, 0))) {
+        printf("Unable to get the working directory\n");
+        return EXIT_FAILURE;
+    }
+    if (NULL == mkdtemp(directory)) {
+        printf("Unable to create the temporary directory\n");
+        free(working_path);
+        return EXIT_FAILURE;
+    }
+    if (0 != chdir(directory)) {
+        printf("Unable to move to the temporary directory '%s'\n", directory);
+        rmdir(directory);
+        free(working_path);
+        return EXIT_FAILURE;
+    }
+
+    /* Initialize the modules used by the benchmarks */
+    if ((MENDER_OK != mender_log_init()) || (MENDER_OK != mender_storage_init()) || (MENDER_OK != mender_tls_init())) {
+        printf("Unable to initialize the platform TLS implementation\n");
+        ret = EXIT_FAILURE;
+        goto END;
+    }
+
+    /* Run the benchmarks */
+    printf("TLS implementation '%s', %s authentication keys\n", BENCHMARK_TLS_TYPE, BENCHMARK_KEY_TYPE);
+    printf("%-20s %12s %12s %14s %14s %8s\n", "operation", "executions", "ops/sec", "peak heap (B)", "max stack (B)", "errors");
+    for (size_t index = 0; index < sizeof(benchmark_operations) / sizeof(benchmark_operations[0]); index++) {
+        if (EXIT_SUCCESS != benchmark_run(&benchmark_operations[index], duration)) {
+            ret = EXIT_FAILURE;
+        }
+    }
+
+    /* Delete the authentication keys generated */
+    mender_storage_delete_authentication_keys();
+
+    /* Release the modules used by the benchmarks */
+    mender_tls_exit();
+    mender_storage_exit();
+    mender_log_exit();
+
+END:
+
+    /* Go back to the working directory and remove the temporary directory */
+    if ((0 != chdir(working_path)) || (0 != rmdir(directory))) {
+        printf("Unable to remove the temporary directory '%s'\n", directory);
+        ret = EXIT_FAILURE;
+    }
+    free(working_path);
+
+    return ret;
+}
+
+int
+benchmark_sha(uint32_t duration) {
+
+    int ret = EXIT_SUCCESS;
+
+    /* Initialize the modules used by the benchmarks */
+    if (MENDER_OK != mender_log_init()) {
+        printf("Unable to initialize the log\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Initialize the data to be hashed */
+    for (size_t index = 0; index < BENCHMARK_SHA_DATA_LENGTH; index++) {
+        benchmark_sha_data[index] = (uint8_t)(index * 31 + 7);
+    }
+
+    /* Run the benchmarks */
+    printf("SHA implementation '%s'\n", BENCHMARK_SHA_TYPE);
+    printf("%-20s %12s %12s %14s %14s %8s\n", "operation", "executions", "MB/s", "peak heap (B)", "max stack (B)", "errors");
+    for (size_t index = 0; index < sizeof(benchmark_sha_operations) / sizeof(benchmark_sha_operations[0]); index++) {
+        if (EXIT_SUCCESS != benchmark_run(&benchmark_sha_operations[index], duration)) {
+            ret = EXIT_FAILURE;
+        }
+    }
+
+    /* Release the modules used by the benchmarks */
+    mender_log_exit();
+
+    return ret;
+}
+
+#ifdef BENCHMARK_HEAP_USAGE
+
+void *
+__wrap_malloc(size_t size) {
+
+    void *ptr = __real_malloc(size);
+    if (NULL != ptr) {
+        benchmark_heap_update((int64_t)malloc_usable_size(ptr));
+    }
+
+    return ptr;
+}
+
+void *
+__wrap_calloc(size_t nmemb, size_t size) {
+
+    void *ptr = __real_calloc(nmemb, size);
+    if (NULL != ptr) {
+        benchmark_heap_update((int64_t)malloc_usable_size(ptr));
+    }
+
+    return ptr;
+}
+
+void *
+__wrap_realloc(void *ptr, size_t size) {
+
+    int64_t previous = (NULL != ptr) ? (int64_t)malloc_usable_size(ptr) : 0;
+    void   *tmp      = __real_realloc(ptr, size);
+    if (NULL != tmp) {
+        benchmark_heap_update((int64_t)malloc_usable_size(tmp) - previous);
+    } else if (0 == size) {
+        benchmark_heap_update(-previous);
+    }
+
+    return tmp;
+}
+
+void
+__wrap_free(void *ptr) {
+
+    if (NULL != ptr) {
+        benchmark_heap_update(-(int64_t)malloc_usable_size(ptr));
+    }
+    __real_free(ptr);
+}
+
+char *
+__wrap_strdup(const char *s) {
+
+    char *ptr = __real_strdup(s);
+    if (NULL != ptr) {
+        benchmark_heap_update((int64_t)malloc_usable_size(ptr));
+    }
+
+    return ptr;
+}
+
+char *
+__wrap_strndup(const char *s, size_t n) {
+
+    char *ptr = __real_strndup(s, n);
+    if (NULL != ptr) {
+        benchmark_heap_update((int64_t)malloc_usable_size(ptr));
+    }
+
+    return ptr;
+}
+
+static void
+benchmark_heap_update(int64_t delta) {
+
+    pthread_mutex_lock(&benchmark_heap_mutex);
+    benchmark_heap_current += delta;
+    if (benchmark_heap_current > benchmark_heap_peak) {
+        benchmark_heap_peak = benchmark_heap_current;
+    }
+    pthread_mutex_unlock(&benchmark_heap_mutex);
+}
+
+#endif /* BENCHMARK_HEAP_USAGE */
+
+static mender_err_t
+benchmark_get_user_provided_keys(char **user_provided_key, size_t *user_provided_key_length) {
+
+    (void)user_provided_key;
+    (void)user_provided_key_length;
+
+    /* Nothing to do */
+    return MENDER_OK;
+}
+
+static mender_err_t
+benchmark_key_generation(void) {
+
+    /* Delete the authentication keys and generate new ones */
+    return mender_tls_init_authentication_keys(&benchmark_get_user_provided_keys, true);
+}
+
+static mender_err_t
+benchmark_key_load(void) {
+
+    /* Load the authentication keys from the storage */
+    return mender_tls_init_authentication_keys(&benchmark_get_user_provided_keys, false);
+}
+
+static mender_err_t
+benchmark_key_load_public_key_pem(void) {
+
+    mender_err_t ret;
+
+    /* Load the authentication keys from the storage */
+    if (MENDER_OK != (ret = mender_tls_init_authentication_keys(&benchmark_get_user_provided_keys, false))) {
+        return ret;
+    }
+
+    /* Convert the public key to PEM format */
+    return benchmark_public_key_pem();
+}
+
+static mender_err_t
+benchmark_public_key_pem(void) {
+
+    mender_err_t ret;
+    char        *public_key = NULL;
+
+    /* Get the public key in PEM format */
+    ret = mender_tls_get_public_key_pem(&public_key);
+    free(public_key);
+
+    return ret;
+}
+
+static mender_err_t
+benchmark_sign_payload(void) {
+
+    mender_err_t ret;
+    char        *signature        = NULL;
+    size_t       signature_length = 0;
+
+    /* Sign the payload */
+    ret = mender_tls_sign_payload(benchmark_payload, &signature, &signature_length);
+    free(signature);
+
+    return ret;
+}
+
+static mender_err_t
+benchmark_sha256(size_t chunk_length) {
+
+    mender_err_t  ret;
+    void         *handle = NULL;
+    unsigned char digest[MENDER_SHA256_DIGEST_SIZE];
+
+    /* Hash the data chunk by chunk */
+    if (MENDER_OK != (ret = mender_sha256_begin(&handle))) {
+        return ret;
+    }
+    for (size_t index = 0; index < BENCHMARK_SHA_DATA_LENGTH; index += chunk_length) {
+        if (MENDER_OK != (ret = mender_sha256_update(handle, &benchmark_sha_data[index], chunk_length))) {
+            mender_sha256_end(handle, NULL);
+            return ret;
+        }
+    }
+
+    return mender_sha256_end(handle, digest);
+}
+
+static mender_err_t
+benchmark_sha256_512(void) {
+    return benchmark_sha256(512);
+}
+
+static mender_err_t
+benchmark_sha256_4096(void) {
+    return benchmark_sha256(4096);
+}
+
+static mender_err_t
+benchmark_sha256_all(void) {
+    return benchmark_sha256(BENCHMARK_SHA_DATA_LENGTH);
+}
+
+static void *
+benchmark_thread(void *arg) {
+
+    benchmark_context_t *context = (benchmark_context_t *)arg;
+    struct timespec      begin, now;
+
+    /* Execute the operation at least once, until the duration of the benchmark is elapsed */
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    do {
+        if (MENDER_OK != context->operation->function()) {
+            context->errors++;
+        }
+        context->count++;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        context->elapsed = (double)(now.tv_sec - begin.tv_sec) + (double)(now.tv_nsec - begin.tv_nsec) / 1000000000.0;
+    } while (context->elapsed < context->duration);
+
+    return NULL;
+}
+
+static int
+benchmark_run(const benchmark_operation_t *operation, uint32_t duration) {
+
+    benchmark_context_t context = { .operation = operation, .duration = (double)duration, .elapsed = 0, .count = 0, .errors = 0 };
+    pthread_attr_t      attr;
+    pthread_t           thread;
+    unsigned char      *stack;
+    size_t              stack_usage = 0;
+    char                heap_usage[24];
+#ifdef BENCHMARK_HEAP_USAGE
+    int64_t heap_baseline;
+#endif /* BENCHMARK_HEAP_USAGE */
+
+    /* Allocate and paint the stack of the thread, it is not allocated in the heap so that it doesn't count in the heap usage */
+    if (MAP_FAILED == (stack = (unsigned char *)mmap(NULL, BENCHMARK_STACK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0))) {
+        printf("%-20s unable to allocate stack\n", operation->name);
+        return EXIT_FAILURE;
+    }
+    memset(stack, BENCHMARK_STACK_PATTERN, BENCHMARK_STACK_SIZE);
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, stack, BENCHMARK_STACK_SIZE);
+
+#ifdef BENCHMARK_HEAP_USAGE
+    /* Reset the peak of the heap usage */
+    pthread_mutex_lock(&benchmark_heap_mutex);
+    heap_baseline       = benchmark_heap_current;
+    benchmark_heap_peak = benchmark_heap_current;
+    pthread_mutex_unlock(&benchmark_heap_mutex);
+#endif /* BENCHMARK_HEAP_USAGE */
+
+    /* Execute the benchmark */
+    if (0 != pthread_create(&thread, &attr, &benchmark_thread, &context)) {
+        printf("%-20s unable to create thread\n", operation->name);
+        pthread_attr_destroy(&attr);
+        munmap(stack, BENCHMARK_STACK_SIZE);
+        return EXIT_FAILURE;
+    }
+    pthread_join(thread, NULL);
+    pthread_attr_destroy(&attr);
+
+    /* Measure the stack usage, the stack grows downwards from the end of the buffer */
+    while ((stack_usage < BENCHMARK_STACK_SIZE) && (BENCHMARK_STACK_PATTERN == stack[stack_usage])) {
+        stack_usage++;
+    }
+    stack_usage = BENCHMARK_STACK_SIZE - stack_usage;
+    munmap(stack, BENCHMARK_STACK_SIZE);
+
+    /* Print the results, the heap usage is only available if the allocation functions are wrapped */
+#ifdef BENCHMARK_HEAP_USAGE
+    snprintf(heap_usage, sizeof(heap_usage), "%lld", (long long)(benchmark_heap_peak - heap_baseline));
+#else
+    snprintf(heap_usage, sizeof(heap_usage), "-");
+#endif /* BENCHMARK_HEAP_USAGE */
+    printf("%-20s %12u %12.2f %14s %14zu %8u\n",
+           operation->name,
+           (unsigned int)context.count,
+           (0 != operation->length) ? (double)context.count * (double)operation->length / context.elapsed / 1000000.0 : (double)context.count / context.elapsed,
+           heap_usage,
+           stack_usage,
+           (unsigned int)context.errors);
+
+    return (0 == context.errors) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
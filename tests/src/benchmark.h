@@ -0,0 +1,49 @@
+/**
+ * @file      benchmark.h
+ * @brief     Micro-benchmarks of the platform TLS and SHA implementations
+ *
+ * Copyright joelguittet and mender-mcu-client contributors
+ * Copyright Northern.tech AS
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stdint.h>
+
+/**
+ * @brief Run the micro-benchmarks of the platform TLS implementation and print the results
+ * @note The benchmark is executed in a temporary working directory, the authentication keys generated are stored in it and deleted at the end
+ * @param duration Duration of each benchmark (seconds), each operation is executed at least once
+ * @return EXIT_SUCCESS if all the operations succeed, EXIT_FAILURE otherwise
+ */
+int benchmark_tls(uint32_t duration);
+
+/**
+ * @brief Run the micro-benchmarks of the platform SHA implementation and print the throughput
+ * @param duration Duration of each benchmark (seconds), each operation is executed at least once
+ * @return EXIT_SUCCESS if all the operations succeed, EXIT_FAILURE otherwise
+ */
+int benchmark_sha(uint32_t duration);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __BENCHMARK_H__ */
@@ -0,0 +1,239 @@
+/**
+ * @file      download.c
+ * @brief     Download test of the platform HTTP implementation
+ *
+ * Copyright joelguittet and mender-mcu-client contributors
+ * Copyright Northern.tech AS
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include "download.h"
+#include "mender-http.h"
+#include "mender-log.h"
+
+/**
+ * @brief Number of concurrent asynchronous requests
+ */
+#define DOWNLOAD_ASYNC_REQUESTS (3)
+
+/**
+ * @brief Download context
+ */
+typedef struct {
+    FILE        *file;         /**< Local file, NULL if the data are not written */
+    size_t       length;       /**< Length of the data received (bytes) */
+    uint32_t     connected;    /**< Number of MENDER_HTTP_EVENT_CONNECTED events */
+    uint32_t     disconnected; /**< Number of MENDER_HTTP_EVENT_DISCONNECTED events */
+    uint32_t     errors;       /**< Number of MENDER_HTTP_EVENT_ERROR events */
+    bool         done;         /**< Flag indicating the asynchronous request is completed */
+    mender_err_t result;       /**< Result of the asynchronous request */
+    int          status;       /**< Status code of the asynchronous request */
+} download_context_t;
+
+/**
+ * @brief Mutex and condition used to wait for the completion of the asynchronous requests
+ */
+static pthread_mutex_t download_async_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  download_async_cond  = PTHREAD_COND_INITIALIZER;
+
+/**
+ * @brief HTTP callback, the data received are written to the local file
+ * @param event Event
+ * @param data Data received
+ * @param data_length Length of the data received
+ * @param params Download context
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t download_http_callback(mender_http_client_event_t event, void *data, size_t data_length, void *params);
+
+/**
+ * @brief HTTP done callback of the asynchronous requests
+ * @param result Result of the request
+ * @param status Status code of the request
+ * @param params Download context
+ */
+static void download_http_done(mender_err_t result, int status, void *params);
+
+int
+download_test(char *url, const char *path) {
+
+    int                  ret     = EXIT_FAILURE;
+    download_context_t   context = { .file = NULL, .length = 0, .connected = 0, .disconnected = 0, .errors = 0 };
+    mender_http_config_t config  = { .host = url };
+    mender_err_t         err;
+    int                  status = 0;
+
+    /* Initialize the modules used by the test */
+    if ((MENDER_OK != mender_log_init()) || (MENDER_OK != mender_http_init(&config))) {
+        printf("Unable to initialize the platform HTTP implementation\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Open the local file */
+    if (NULL == (context.file = fopen(path, "wb"))) {
+        printf("Unable to open file '%s'\n", path);
+        goto END;
+    }
+
+    /* Download the file, requests without authentication to absolute URLs are the ones used to download artifacts */
+    err = mender_http_perform(NULL, url, MENDER_HTTP_GET, NULL, NULL, &download_http_callback, &context, &status);
+    printf("Downloaded %zu bytes, status %d, %u connected, %u disconnected, %u errors\n",
+           context.length,
+           status,
+           (unsigned int)context.connected,
+           (unsigned int)context.disconnected,
+           (unsigned int)context.errors);
+
+    /* Check the result, the upper layer expects one connection and one disconnection whatever the number of requests performed */
+    if ((MENDER_OK != err) || (200 != status) || (1 != context.connected) || (1 != context.disconnected) || (0 != context.errors)) {
+        printf("Download failed\n");
+        goto END;
+    }
+
+    ret = EXIT_SUCCESS;
+
+END:
+
+    /* Close the local file */
+    if ((NULL != context.file) && (0 != fclose(context.file))) {
+        printf("Unable to write file '%s'\n", path);
+        ret = EXIT_FAILURE;
+    }
+
+    /* Release the modules used by the test */
+    mender_http_exit();
+    mender_log_exit();
+
+    return ret;
+}
+
+int
+download_async_test(char *url, const char *path) {
+
+    int                  ret = EXIT_FAILURE;
+    download_context_t   contexts[DOWNLOAD_ASYNC_REQUESTS];
+    mender_http_config_t config = { .host = url };
+    size_t               started;
+
+    /* Initialize the modules used by the test */
+    memset(contexts, 0, sizeof(contexts));
+    if ((MENDER_OK != mender_log_init()) || (MENDER_OK != mender_http_init(&config))) {
+        printf("Unable to initialize the platform HTTP implementation\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Open the local file, only the data of the first request are written */
+    if (NULL == (contexts[0].file = fopen(path, "wb"))) {
+        printf("Unable to open file '%s'\n", path);
+        goto END;
+    }
+
+    /* Start the requests, they are performed concurrently by the HTTP event loop */
+    for (started = 0; started < DOWNLOAD_ASYNC_REQUESTS; started++) {
+        if (MENDER_OK
+            != mender_http_perform_async(NULL, url, MENDER_HTTP_GET, NULL, NULL, &download_http_callback, &download_http_done, &contexts[started])) {
+            printf("Unable to start asynchronous request %zu\n", started);
+            break;
+        }
+    }
+
+    /* Wait for the completion of the requests started */
+    pthread_mutex_lock(&download_async_mutex);
+    for (size_t index = 0; index < started; index++) {
+        while (false == contexts[index].done) {
+            pthread_cond_wait(&download_async_cond, &download_async_mutex);
+        }
+    }
+    pthread_mutex_unlock(&download_async_mutex);
+    if (DOWNLOAD_ASYNC_REQUESTS != started) {
+        goto END;
+    }
+
+    /* Check the result of each request, all of them receive the whole file */
+    ret = EXIT_SUCCESS;
+    for (size_t index = 0; index < DOWNLOAD_ASYNC_REQUESTS; index++) {
+        printf("Request %zu downloaded %zu bytes, status %d, %u connected, %u disconnected, %u errors\n",
+               index,
+               contexts[index].length,
+               contexts[index].status,
+               (unsigned int)contexts[index].connected,
+               (unsigned int)contexts[index].disconnected,
+               (unsigned int)contexts[index].errors);
+        if ((MENDER_OK != contexts[index].result) || (200 != contexts[index].status) || (1 != contexts[index].connected)
+            || (1 != contexts[index].disconnected) || (0 != contexts[index].errors) || (contexts[0].length != contexts[index].length)) {
+            printf("Download failed\n");
+            ret = EXIT_FAILURE;
+        }
+    }
+
+END:
+
+    /* Close the local file */
+    if ((NULL != contexts[0].file) && (0 != fclose(contexts[0].file))) {
+        printf("Unable to write file '%s'\n", path);
+        ret = EXIT_FAILURE;
+    }
+
+    /* Release the modules used by the test */
+    mender_http_exit();
+    mender_log_exit();
+
+    return ret;
+}
+
+static mender_err_t
+download_http_callback(mender_http_client_event_t event, void *data, size_t data_length, void *params) {
+
+    download_context_t *context = (download_context_t *)params;
+
+    /* Treatment depending of the event */
+    switch (event) {
+        case MENDER_HTTP_EVENT_CONNECTED:
+            context->connected++;
+            break;
+        case MENDER_HTTP_EVENT_DATA_RECEIVED:
+            if ((NULL != context->file) && (fwrite(data, sizeof(unsigned char), data_length, context->file) != data_length)) {
+                printf("Unable to write data\n");
+                return MENDER_FAIL;
+            }
+            context->length += data_length;
+            break;
+        case MENDER_HTTP_EVENT_DISCONNECTED:
+            context->disconnected++;
+            break;
+        case MENDER_HTTP_EVENT_ERROR:
+            context->errors++;
+            break;
+        default:
+            break;
+    }
+
+    return MENDER_OK;
+}
+
+static void
+download_http_done(mender_err_t result, int status, void *params) {
+
+    download_context_t *context = (download_context_t *)params;
+
+    /* Save the result and wake up the test */
+    pthread_mutex_lock(&download_async_mutex);
+    context->result = result;
+    context->status = status;
+    context->done   = true;
+    pthread_cond_broadcast(&download_async_cond);
+    pthread_mutex_unlock(&download_async_mutex);
+}
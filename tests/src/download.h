@@ -0,0 +1,50 @@
+/**
+ * @file      download.h
+ * @brief     Download test of the platform HTTP implementation
+ *
+ * Copyright joelguittet and mender-mcu-client contributors
+ * Copyright Northern.tech AS
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DOWNLOAD_H__
+#define __DOWNLOAD_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * @brief Download a file the way artifacts are downloaded and write the data to a local file
+ * @note The data are written in the order they are transmitted by the platform HTTP implementation, the content of the file permits to check it
+ * @param url URL of the file to download
+ * @param path Path of the local file
+ * @return EXIT_SUCCESS if the file is downloaded and the HTTP events are consistent, EXIT_FAILURE otherwise
+ */
+int download_test(char *url, const char *path);
+
+/**
+ * @brief Download a file with concurrent asynchronous requests and write the data of the first one to a local file
+ * @note The other requests only check the length of the data received, they permit to check several requests progress concurrently
+ * @param url URL of the file to download
+ * @param path Path of the local file
+ * @return EXIT_SUCCESS if the file is downloaded by all the requests and the HTTP events are consistent, EXIT_FAILURE otherwise
+ */
+int download_async_test(char *url, const char *path);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __DOWNLOAD_H__ */
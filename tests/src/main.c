@@ -23,6 +23,8 @@
 #include <regex.h>
 #include <signal.h>
 #include <stdio.h>
+#include "benchmark.h"
+#include "download.h"
 #include "mender-client.h"
 #include "mender-configure.h"
 #include "mender-flash.h"
@@ -39,6 +41,10 @@ static const struct option mender_client_options[] = { { "help", 0, NULL, 'h' },
                                                        { "device_type", 1, NULL, 'd' },
                                                        { "tenant_token", 1, NULL, 't' },
                                                        { "private_key", 1, NULL, 'p' },
+                                                       { "benchmark", 1, NULL, 'b' },
+                                                       { "download", 1, NULL, 'l' },
+                                                       { "output", 1, NULL, 'o' },
+                                                       { "async", 0, NULL, 's' },
                                                        { NULL, 0, NULL, 0 } };
 
 /**
@@ -168,6 +174,25 @@ restart_cb(void) {
     return MENDER_OK;
 }
 
+/**
+ * @brief Authentication keys state callback
+ * @param state Authentication keys state
+ * @param elapsed Time elapsed since the keys started being retrieved or generated (ms)
+ * @return MENDER_OK if the function succeeds, error code otherwise
+ */
+static mender_err_t
+keys_state_cb(mender_client_keys_state_t state, uint32_t elapsed) {
+
+    /* We can do something else if required */
+    if (MENDER_CLIENT_KEYS_STATE_PENDING == state) {
+        mender_log_info("Authentication keys are being retrieved or generated");
+    } else {
+        mender_log_info("Authentication keys are %s after %u ms", (MENDER_CLIENT_KEYS_STATE_READY == state) ? "ready" : "not available", (unsigned int)elapsed);
+    }
+
+    return MENDER_OK;
+}
+
 /**
  * @brief Get identity callback
  * @return MENDER_OK if the function succeeds, error code otherwise
@@ -467,6 +492,10 @@ print_usage(const char *argv0) {
     printf("\t--device_type, -d: Device type\n");
     printf("\t--tenant_token, -t: Tenant token (optional)\n");
     printf("\t--private_key, -p: Key path (optional)\n");
+    printf("\t--benchmark, -b: Run the TLS and SHA benchmarks for the given duration in seconds and exit\n");
+    printf("\t--download, -l: Download the given URL the way artifacts are downloaded, write the data to the output file and exit\n");
+    printf("\t--output, -o: Output file of the download (optional, default is 'download.bin')\n");
+    printf("\t--async, -s: Download the given URL with concurrent asynchronous requests (optional)\n");
 }
 
 /**
@@ -484,6 +513,9 @@ main(int argc, char **argv) {
     char *device_type   = NULL;
     char *tenant_token  = NULL;
     char *private_key   = NULL;
+    char *download_url  = NULL;
+    char *output_path   = NULL;
+    bool  async         = false;
 
     /* Initialize sig handler */
     struct sigaction action;
@@ -495,7 +527,7 @@ main(int argc, char **argv) {
 
     /* Parse options */
     int opt;
-    while (-1 != (opt = getopt_long(argc, argv, "hm:a:d:t:", mender_client_options, NULL))) {
+    while (-1 != (opt = getopt_long(argc, argv, "hb:l:o:sm:a:d:t:", mender_client_options, NULL))) {
         switch (opt) {
             case 'h':
                 /* Help */
@@ -522,6 +554,26 @@ main(int argc, char **argv) {
                 /* Key path */
                 private_key = strdup(optarg);
                 break;
+            case 'b':
+                /* Benchmarks */
+                ret = benchmark_tls((uint32_t)strtoul(optarg, NULL, 10));
+                if (EXIT_SUCCESS != benchmark_sha((uint32_t)strtoul(optarg, NULL, 10))) {
+                    ret = EXIT_FAILURE;
+                }
+                goto END;
+                break;
+            case 'l':
+                /* Download URL */
+                download_url = strdup(optarg);
+                break;
+            case 'o':
+                /* Output file */
+                output_path = strdup(optarg);
+                break;
+            case 's':
+                /* Asynchronous download */
+                async = true;
+                break;
             default:
                 /* Unknown option */
                 ret = EXIT_FAILURE;
@@ -531,6 +583,16 @@ main(int argc, char **argv) {
         }
     }
 
+    /* Download test */
+    if (NULL != download_url) {
+        if (true == async) {
+            ret = download_async_test(download_url, (NULL != output_path) ? output_path : "download.bin");
+        } else {
+            ret = download_test(download_url, (NULL != output_path) ? output_path : "download.bin");
+        }
+        goto END;
+    }
+
     /* Verify mandatory options */
     if ((NULL == mac_address) || (NULL == artifact_name) || (NULL == device_type)) {
         ret = EXIT_FAILURE;
@@ -571,7 +633,8 @@ main(int argc, char **argv) {
                                                           .deployment_status      = deployment_status_cb,
                                                           .restart                = restart_cb,
                                                           .get_identity           = get_identity_cb,
-                                                          .get_user_provided_keys = get_user_provided_keys_cb };
+                                                          .get_user_provided_keys = get_user_provided_keys_cb,
+                                                          .keys_state             = keys_state_cb };
     if (MENDER_OK != mender_client_init(&mender_client_config, &mender_client_callbacks)) {
         mender_log_error("Unable to initialize mender-client");
         ret = EXIT_FAILURE;
@@ -649,6 +712,8 @@ END:
         free(tenant_token);
     }
     free(private_key);
+    free(download_url);
+    free(output_path);
 
     return ret;
 }